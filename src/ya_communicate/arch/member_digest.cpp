@@ -0,0 +1,182 @@
+#include "member_digest.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace ya::arch {
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+uint64_t fnv1a(std::string_view data, uint64_t hash = FNV_OFFSET) {
+  for (unsigned char c : data) {
+    hash = (hash ^ c) * FNV_PRIME;
+  }
+  return hash;
+}
+
+// Calls on_part for every piece of text between separators
+template <typename F>
+void split(std::string_view text, char separator, F on_part) {
+  while (!text.empty()) {
+    size_t end = text.find(separator);
+    on_part(text.substr(0, end));
+    if (end == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(end + 1);
+  }
+}
+
+}  // namespace
+
+std::string MemberDigest::Entry::encode() const {
+  return id + "," + address + "," + data_url;
+}
+
+std::optional<MemberDigest::Entry> MemberDigest::Entry::decode(
+    std::string_view text) {
+  size_t first = text.find(',');
+  size_t second = first == std::string_view::npos
+                      ? std::string_view::npos
+                      : text.find(',', first + 1);
+  if (second == std::string_view::npos || first == 0 ||
+      second == first + 1) {
+    return std::nullopt;
+  }
+  Entry entry;
+  entry.id = text.substr(0, first);
+  entry.address = text.substr(first + 1, second - first - 1);
+  entry.data_url = text.substr(second + 1);
+  return entry;
+}
+
+MemberDigest::MemberDigest(std::vector<Entry> entries)
+    : m_entries(std::move(entries)) {
+  std::sort(m_entries.begin(), m_entries.end(),
+            [](const Entry& a, const Entry& b) {
+              size_t x = bucket_of(a.address);
+              size_t y = bucket_of(b.address);
+              return x != y ? x < y : a.address < b.address;
+            });
+
+  m_buckets.fill(FNV_OFFSET);
+  for (const auto& entry : m_entries) {
+    uint64_t& hash = m_buckets[bucket_of(entry.address)];
+    hash = fnv1a(entry.encode(), hash);
+    hash = fnv1a(";", hash);
+  }
+  m_root = FNV_OFFSET;
+  for (uint64_t bucket : m_buckets) {
+    m_root = fnv1a(encode_hash(bucket) + ",", m_root);
+  }
+}
+
+std::vector<size_t> MemberDigest::diff(const Buckets& other) const {
+  std::vector<size_t> indexes;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    if (m_buckets[i] != other[i]) {
+      indexes.push_back(i);
+    }
+  }
+  return indexes;
+}
+
+std::string MemberDigest::encode_entries(
+    const std::vector<size_t>& buckets) const {
+  std::string out;
+  for (const auto& entry : m_entries) {
+    if (std::find(buckets.begin(), buckets.end(),
+                  bucket_of(entry.address)) != buckets.end()) {
+      if (!out.empty()) {
+        out += ";";
+      }
+      out += entry.encode();
+    }
+  }
+  return out;
+}
+
+size_t MemberDigest::bucket_of(std::string_view address) {
+  return fnv1a(address) % BUCKETS;
+}
+
+std::string MemberDigest::encode_hash(uint64_t hash) {
+  char buf[16];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), hash, 16);
+  return std::string(buf, end);
+}
+
+std::optional<uint64_t> MemberDigest::decode_hash(std::string_view text) {
+  uint64_t hash = 0;
+  auto [end, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), hash, 16);
+  if (ec != std::errc() || end != text.data() + text.size()) {
+    return std::nullopt;
+  }
+  return hash;
+}
+
+std::string MemberDigest::encode_buckets(const Buckets& buckets) {
+  std::string out;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    out += (i == 0 ? "" : ",") + encode_hash(buckets[i]);
+  }
+  return out;
+}
+
+std::optional<MemberDigest::Buckets> MemberDigest::decode_buckets(
+    std::string_view text) {
+  Buckets buckets{};
+  size_t count = 0;
+  bool valid = true;
+  split(text, ',', [&](std::string_view part) {
+    auto hash = decode_hash(part);
+    if (!hash || count == BUCKETS) {
+      valid = false;
+      return;
+    }
+    buckets[count++] = *hash;
+  });
+  if (!valid || count != BUCKETS) {
+    return std::nullopt;
+  }
+  return buckets;
+}
+
+std::string MemberDigest::encode_indexes(const std::vector<size_t>& indexes) {
+  std::string out;
+  for (size_t index : indexes) {
+    out += (out.empty() ? "" : ",") + std::to_string(index);
+  }
+  return out;
+}
+
+std::vector<size_t> MemberDigest::decode_indexes(std::string_view text) {
+  std::vector<size_t> indexes;
+  split(text, ',', [&](std::string_view part) {
+    size_t index = 0;
+    auto [end, ec] =
+        std::from_chars(part.data(), part.data() + part.size(), index);
+    if (ec == std::errc() && end == part.data() + part.size() &&
+        index < BUCKETS) {
+      indexes.push_back(index);
+    }
+  });
+  return indexes;
+}
+
+std::vector<MemberDigest::Entry> MemberDigest::decode_entries(
+    std::string_view text) {
+  std::vector<Entry> entries;
+  split(text, ';', [&](std::string_view part) {
+    if (auto entry = Entry::decode(part)) {
+      entries.push_back(std::move(*entry));
+    }
+  });
+  return entries;
+}
+
+}  // namespace ya::arch
@@ -0,0 +1,66 @@
+#ifndef MEMBER_DIGEST_H
+#define MEMBER_DIGEST_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ya::arch {
+
+// Two-level Merkle summary of a membership view, for anti-entropy.
+//
+// Entries fall into BUCKETS buckets by a hash of their address; each
+// bucket hashes its entries in address order and the root hashes the
+// buckets. Two nodes first compare roots (one hash), then bucket hashes,
+// then trade only the entries of the buckets that differ, so a sync costs
+// a few hundred bytes when views agree and grows with the difference, not
+// with the cluster. Hashes are FNV-1a, the same on every platform.
+class MemberDigest {
+ public:
+  static constexpr size_t BUCKETS = 32;
+  using Buckets = std::array<uint64_t, BUCKETS>;
+
+  struct Entry {
+    std::string id;
+    std::string address;
+    std::string data_url;
+
+    std::string encode() const;  // id,address,data_url
+    static std::optional<Entry> decode(std::string_view text);
+  };
+
+  explicit MemberDigest(std::vector<Entry> entries);
+
+  uint64_t root() const { return m_root; }
+  const Buckets& buckets() const { return m_buckets; }
+  size_t size() const { return m_entries.size(); }
+
+  // Indexes of the buckets that differ from other
+  std::vector<size_t> diff(const Buckets& other) const;
+
+  // Our entries of the given buckets, ';' separated
+  std::string encode_entries(const std::vector<size_t>& buckets) const;
+
+  static size_t bucket_of(std::string_view address);
+
+  // Wire forms: hashes in hex, lists ',' or ';' separated
+  static std::string encode_hash(uint64_t hash);
+  static std::optional<uint64_t> decode_hash(std::string_view text);
+  static std::string encode_buckets(const Buckets& buckets);
+  static std::optional<Buckets> decode_buckets(std::string_view text);
+  static std::string encode_indexes(const std::vector<size_t>& indexes);
+  static std::vector<size_t> decode_indexes(std::string_view text);
+  static std::vector<Entry> decode_entries(std::string_view text);
+
+ private:
+  std::vector<Entry> m_entries;  // Sorted by bucket, then address
+  Buckets m_buckets{};
+  uint64_t m_root = 0;
+};
+
+}  // namespace ya::arch
+
+#endif
@@ -0,0 +1,567 @@
+#include "membership.h"
+
+#include <sstream>
+
+namespace ya::arch {
+
+SystemClock& SystemClock::instance() {
+  static SystemClock clock;
+  return clock;
+}
+
+Clock::time_point SystemClock::now() const {
+  return std::chrono::steady_clock::now();
+}
+
+uint64_t SystemClock::epoch_ms() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+Membership::Membership(const MembershipOptions& options, Transport& transport,
+                       const Clock& clock, Listener listener)
+    : m_options(options),
+      m_transport(transport),
+      m_clock(clock),
+      m_listener(std::move(listener)),
+      m_start(clock.now()),
+      m_next_announce(m_start),
+      m_next_probe(m_start),
+      m_next_sync(m_start + options.sync_interval) {
+  set_zone(options.region, options.zone);
+}
+
+void Membership::tick() {
+  auto now = m_clock.now();
+  std::string announcement;
+  std::vector<std::string> probes;
+  std::vector<std::string> exchanges;
+  std::string exchange;
+  std::string sync_peer;
+  std::string sync;
+  std::vector<module::StatusEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (now >= m_next_announce) {
+      m_next_announce = now + m_options.announce_interval;
+      announcement = "NODE|" + m_options.id + "|" + m_options.address + "|" +
+                     m_options.data_url + "|" + m_zones->key();
+      ++m_stats.broadcasts;
+    }
+
+    // Unanswered probes: suspect first, evict after suspect_limit
+    for (auto it = m_members.begin(); it != m_members.end();) {
+      Member& member = it->second;
+      if (member.probing && now >= member.probe_deadline) {
+        member.probing = false;
+        if (++member.misses >= m_options.suspect_limit) {
+          // A member that never answered never joined either
+          if (!member.unverified) {
+            events.push_back(
+                {module::StatusEvent::TYPE::LEAVE, member.status});
+            ++m_stats.leaves;
+            m_dirty = true;
+          }
+          if (m_sync_joiner == it->first) {
+            m_sync_joiner.clear();
+          }
+          it = m_members.erase(it);
+          continue;
+        }
+      }
+      ++it;
+    }
+
+    bool probe_round = now >= m_next_probe;
+    if (probe_round) {
+      m_next_probe = now + m_options.probe_interval;
+    }
+    // Only nodes we have not heard from are asked, each round; members
+    // learned second hand are asked right away the first time
+    for (auto& [address, member] : m_members) {
+      bool quiet =
+          probe_round && now - member.last_seen >= m_options.probe_interval;
+      bool unheard = member.unverified && member.misses == 0;
+      if (!member.probing && (quiet || unheard)) {
+        member.probing = true;
+        member.probe_deadline = now + m_options.probe_timeout;
+        probes.push_back(address);
+      }
+    }
+
+    if (probe_round) {
+      // The representative trades summaries with the other zones (or the
+      // seeds, until it knows any); everyone else asks the representative
+      module::ZoneSummary local = local_summary_locked();
+      exchange = "ZONES";
+      if (local.representative == m_options.address) {
+        exchanges = m_zones->representatives(now);
+        if (exchanges.empty()) {
+          exchanges = m_zone_seeds;
+        }
+        exchange += "|" + m_zones->encode(local, now);
+      } else {
+        exchanges.push_back(local.representative);
+      }
+      std::erase(exchanges, m_options.address);
+    }
+
+    // Anti-entropy with the newest member first, so a (re)joining node gets
+    // our whole view at once; otherwise the members take turns
+    if (!m_sync_joiner.empty()) {
+      sync_peer = std::move(m_sync_joiner);
+      m_sync_joiner.clear();
+    } else if (now >= m_next_sync && !m_members.empty()) {
+      m_next_sync = now + m_options.sync_interval;
+      auto it = m_members.upper_bound(m_sync_cursor);
+      for (size_t n = 0; n < m_members.size(); ++n, ++it) {
+        if (it == m_members.end()) {
+          it = m_members.begin();
+        }
+        if (!it->second.unverified) {
+          m_sync_cursor = it->first;
+          sync_peer = it->first;
+          break;
+        }
+      }
+    }
+    if (!sync_peer.empty()) {
+      sync = "SYNC|" + m_zones->key() + "|" +
+             MemberDigest::encode_hash(digest_locked().root());
+      ++m_stats.syncs;
+    }
+    m_stats.requests +=
+        probes.size() + exchanges.size() + (sync_peer.empty() ? 0 : 1);
+    if (m_dirty) {
+      publish_locked();
+    }
+  }
+
+  notify(events);
+  if (!announcement.empty()) {
+    m_transport.broadcast(announcement);
+  }
+  for (const auto& address : probes) {
+    m_transport.send(address, "STATUS", [this, address](const std::string&) {
+      on_probe_reply(address);
+    });
+  }
+  for (const auto& address : exchanges) {
+    m_transport.send(address, exchange, [this](const std::string& reply) {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.replies;
+      }
+      m_zones->merge_all(reply, m_clock.now());
+    });
+  }
+  if (!sync_peer.empty()) {
+    m_transport.send(sync_peer, sync,
+                     [this, sync_peer](const std::string& reply) {
+                       on_sync_reply(sync_peer, reply);
+                     });
+  }
+}
+
+std::string Membership::handle(const std::string& message) {
+  std::vector<module::StatusEvent> events;
+  std::string reply;
+  if (message == "STATUS") {
+    auto status = local_status();
+    std::stringstream ss;
+    ss << status.id << "|" << status.address << "|" << status.uptime << "|"
+       << status.info;
+    reply = ss.str();
+  } else if (message.rfind("ZONES", 0) == 0) {
+    // ZONES[|summaries]: merge what the asker knows, answer with ours
+    auto now = m_clock.now();
+    if (message.size() > 6) {
+      m_zones->merge_all(std::string_view(message).substr(6), now);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    reply = m_zones->encode(local_summary_locked(), now);
+  } else if (message.rfind("NODE|", 0) == 0) {
+    reply = handle_node(message, events);
+  } else if (message.rfind("STATUS|", 0) == 0) {
+    reply = handle_status(message, events);
+  } else if (message.rfind("SYNC|", 0) == 0) {
+    reply = handle_sync(message);
+  } else if (message.rfind("SYNCGET|", 0) == 0) {
+    reply = handle_sync_get(message);
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.handled;
+  }
+  notify(events);
+  return reply;
+}
+
+// NODE|id|address|data_url|region/zone. Announcements of known nodes count
+// as heartbeats; nodes of other zones are only known through their zone's
+// summary.
+std::string Membership::handle_node(
+    const std::string& message, std::vector<module::StatusEvent>& events) {
+  std::stringstream ss(message);
+  std::string type, id, address, data_url, zone;
+  std::getline(ss, type, '|');
+  std::getline(ss, id, '|');
+  std::getline(ss, address, '|');
+  std::getline(ss, data_url, '|');
+  std::getline(ss, zone);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (zone.empty()) {
+    zone = "default/default";  // Older node
+  }
+  if (id == m_options.id || address == m_options.address ||
+      zone != m_zones->key()) {
+    return "";
+  }
+  auto [it, inserted] = m_members.try_emplace(address);
+  Member& member = it->second;
+  if (inserted) {
+    member.status = NodeStatus{id, address, 0, "discovered"};
+    events.push_back({module::StatusEvent::TYPE::JOIN, member.status});
+    ++m_stats.joins;
+    m_dirty = true;
+    m_sync_joiner = address;
+  }
+  confirm_locked(member, events);
+  if (member.data_url != data_url) {
+    member.data_url = data_url;
+    m_dirty = true;
+  }
+  member.last_seen = m_clock.now();
+  member.misses = 0;
+  return "";
+}
+
+// STATUS|id|address|uptime|info, a full status pushed by a member
+std::string Membership::handle_status(
+    const std::string& message, std::vector<module::StatusEvent>& events) {
+  std::stringstream ss(message);
+  std::string type, id, address, info;
+  long long uptime = 0;
+  std::getline(ss, type, '|');
+  std::getline(ss, id, '|');
+  std::getline(ss, address, '|');
+  ss >> uptime;
+  ss.ignore(1);
+  std::getline(ss, info);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (address == m_options.address) {
+    return "";
+  }
+  auto [it, inserted] = m_members.try_emplace(address);
+  Member& member = it->second;
+  member.status = NodeStatus{id, address, uptime, info};
+  member.last_seen = m_clock.now();
+  member.misses = 0;
+  m_dirty = true;
+  if (inserted) {
+    events.push_back({module::StatusEvent::TYPE::JOIN, member.status});
+    ++m_stats.joins;
+  } else if (member.unverified) {
+    confirm_locked(member, events);
+  } else {
+    events.push_back({module::StatusEvent::TYPE::UPDATE, member.status});
+  }
+  return "";
+}
+
+// SYNC|region/zone|root. Answers SYNC when our view has the same root,
+// otherwise SYNC|bucket hashes so the asker can tell which buckets differ.
+std::string Membership::handle_sync(const std::string& message) {
+  std::string_view rest = std::string_view(message).substr(5);
+  size_t bar = rest.find('|');
+  if (bar == std::string_view::npos) {
+    return "SYNC";
+  }
+  auto root = MemberDigest::decode_hash(rest.substr(bar + 1));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  MemberDigest digest = digest_locked();
+  if (rest.substr(0, bar) != m_zones->key() || !root ||
+      *root == digest.root()) {
+    return "SYNC";
+  }
+  return "SYNC|" + MemberDigest::encode_buckets(digest.buckets());
+}
+
+// SYNCGET|region/zone|buckets|entries: the asker's entries of the buckets
+// that differ. Takes them in and answers SYNCGET|our entries of those.
+std::string Membership::handle_sync_get(const std::string& message) {
+  std::string_view rest = std::string_view(message).substr(8);
+  size_t first = rest.find('|');
+  size_t second = first == std::string_view::npos
+                      ? std::string_view::npos
+                      : rest.find('|', first + 1);
+  if (second == std::string_view::npos) {
+    return "SYNCGET|";
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (rest.substr(0, first) != m_zones->key()) {
+    return "SYNCGET|";
+  }
+  auto buckets =
+      MemberDigest::decode_indexes(rest.substr(first + 1, second - first - 1));
+  std::string reply = "SYNCGET|" + digest_locked().encode_entries(buckets);
+  merge_entries_locked(rest.substr(second + 1));
+  return reply;
+}
+
+void Membership::on_probe_reply(const std::string& address) {
+  std::vector<module::StatusEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.replies;
+    auto it = m_members.find(address);
+    if (it != m_members.end()) {
+      it->second.probing = false;
+      it->second.misses = 0;
+      it->second.last_seen = m_clock.now();
+      confirm_locked(it->second, events);
+    }
+  }
+  notify(events);
+}
+
+// A member learned second hand answered: only now does it join, so a
+// stale entry in another node's view never shows up as JOIN then LEAVE
+void Membership::confirm_locked(Member& member,
+                                std::vector<module::StatusEvent>& events) {
+  if (!member.unverified) {
+    return;
+  }
+  member.unverified = false;
+  events.push_back({module::StatusEvent::TYPE::JOIN, member.status});
+  ++m_stats.joins;
+  m_dirty = true;
+}
+
+void Membership::on_sync_reply(const std::string& address,
+                               const std::string& reply) {
+  std::string request;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.replies;
+    if (reply.rfind("SYNC|", 0) != 0) {
+      return;  // Views agree
+    }
+    auto buckets =
+        MemberDigest::decode_buckets(std::string_view(reply).substr(5));
+    if (!buckets) {
+      return;
+    }
+    MemberDigest digest = digest_locked();
+    auto differ = digest.diff(*buckets);
+    if (differ.empty()) {
+      return;  // Changed meanwhile
+    }
+    request = "SYNCGET|" + m_zones->key() + "|" +
+              MemberDigest::encode_indexes(differ) + "|" +
+              digest.encode_entries(differ);
+    ++m_stats.requests;
+  }
+
+  m_transport.send(address, request, [this](const std::string& answer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.replies;
+    if (answer.rfind("SYNCGET|", 0) == 0) {
+      merge_entries_locked(std::string_view(answer).substr(8));
+    }
+  });
+}
+
+// Members learned second hand stay unverified until they answer a probe,
+// see confirm_locked()
+void Membership::merge_entries_locked(std::string_view encoded) {
+  auto now = m_clock.now();
+  for (auto& entry : MemberDigest::decode_entries(encoded)) {
+    if (entry.id == m_options.id || entry.address == m_options.address) {
+      continue;
+    }
+    auto [it, inserted] = m_members.try_emplace(entry.address);
+    Member& member = it->second;
+    if (!inserted) {
+      if (member.data_url.empty() && !entry.data_url.empty()) {
+        member.data_url = entry.data_url;
+        m_dirty = true;
+      }
+      continue;
+    }
+    member.status = NodeStatus{entry.id, entry.address, 0, "discovered"};
+    member.data_url = entry.data_url;
+    member.last_seen = now - m_options.probe_interval;
+    member.unverified = true;
+    ++m_stats.synced;
+  }
+}
+
+// Our view for anti-entropy: ourselves and the members in good standing.
+// Suspects and unverified members are left out so they do not spread
+// (back) to nodes that dropped them.
+MemberDigest Membership::digest_locked() const {
+  std::vector<MemberDigest::Entry> entries{
+      {m_options.id, m_options.address, m_options.data_url}};
+  for (const auto& [address, member] : m_members) {
+    if (member.misses == 0 && !member.probing && !member.unverified) {
+      entries.push_back({member.status.id, address, member.data_url});
+    }
+  }
+  return MemberDigest(std::move(entries));
+}
+
+void Membership::touch(const std::string& address) {
+  std::vector<module::StatusEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_members.find(address);
+    if (it != m_members.end()) {
+      it->second.last_seen = m_clock.now();
+      it->second.misses = 0;
+      confirm_locked(it->second, events);
+    }
+  }
+  notify(events);
+}
+
+void Membership::set_data_url(const std::string& data_url) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_options.data_url = data_url;
+}
+
+void Membership::set_zone(const std::string& region, const std::string& zone) {
+  for (const auto& name : {region, zone}) {
+    if (name.empty() || name.find_first_of(",;|/") != std::string::npos) {
+      throw CommException("Invalid region or zone name: " + name);
+    }
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_options.region = region;
+  m_options.zone = zone;
+  m_zones = std::make_unique<module::ZoneDirectory>(
+      region, zone, m_options.probe_interval * m_options.suspect_limit);
+}
+
+void Membership::add_zone_seed(const std::string& address) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_zone_seeds.push_back(address);
+}
+
+NodeStatus Membership::local_status() const {
+  auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
+                    m_clock.now() - m_start)
+                    .count();
+  return NodeStatus{m_options.id, m_options.address, uptime, "healthy"};
+}
+
+std::shared_ptr<const NodeTable> Membership::snapshot() const {
+  if (m_dirty.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_dirty) {
+      publish_locked();
+    }
+  }
+  return m_table.load(std::memory_order_acquire);
+}
+
+void Membership::publish_locked() const {
+  NodeTable::Builder builder;
+  for (const auto& [_, member] : m_members) {
+    if (!member.unverified) {
+      builder.add(member.status, member.data_url);
+    }
+  }
+  m_table.store(builder.build(++m_version), std::memory_order_release);
+  m_dirty.store(false, std::memory_order_release);
+}
+
+std::vector<NodeStatus> Membership::members() const {
+  std::vector<NodeStatus> statuses;
+  for (const auto& entry : *snapshot()) {
+    statuses.push_back(entry.status());
+  }
+  return statuses;
+}
+
+std::vector<std::string> Membership::addresses() const {
+  auto table = snapshot();
+  std::vector<std::string> addresses;
+  addresses.reserve(table->size());
+  for (const auto& entry : *table) {
+    addresses.emplace_back(entry.address);
+  }
+  return addresses;
+}
+
+std::string Membership::data_url(const std::string& address) const {
+  auto table = snapshot();
+  const auto* entry = table->find(address);
+  return entry ? std::string(entry->data_url) : "";
+}
+
+module::ZoneSummary Membership::local_summary() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return local_summary_locked();
+}
+
+// Our zone as its representative would describe it: the representative
+// is the live member with the lowest id
+module::ZoneSummary Membership::local_summary_locked() const {
+  module::ZoneSummary summary;
+  summary.region = m_options.region;
+  summary.zone = m_options.zone;
+  summary.nodes = 1;
+  summary.healthy = 1;
+  std::vector<std::pair<std::string, std::string>> live{
+      {m_options.id, m_options.address}};
+  for (const auto& [address, member] : m_members) {
+    if (member.unverified) {
+      continue;
+    }
+    ++summary.nodes;
+    if (member.misses == 0) {
+      ++summary.healthy;
+      live.emplace_back(member.status.id, address);
+    }
+  }
+  summary.representative = module::ZoneDirectory::elect(live);
+  summary.version = m_clock.epoch_ms();
+  return summary;
+}
+
+std::vector<module::ZoneSummary> Membership::zones() const {
+  std::vector<module::ZoneSummary> zones{local_summary()};
+  for (auto& summary : m_zones->remote(m_clock.now())) {
+    zones.push_back(std::move(summary));
+  }
+  return zones;
+}
+
+std::vector<module::RegionSummary> Membership::regions() const {
+  return m_zones->regions(local_summary(), m_clock.now());
+}
+
+bool Membership::is_representative() const {
+  return local_summary().representative == m_options.address;
+}
+
+Membership::Stats Membership::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void Membership::notify(const std::vector<module::StatusEvent>& events) {
+  if (m_listener) {
+    for (const auto& event : events) {
+      m_listener(event);
+    }
+  }
+}
+
+}  // namespace ya::arch
@@ -0,0 +1,200 @@
+#ifndef MEMBERSHIP_H
+#define MEMBERSHIP_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "module/status_feed.h"
+#include "member_digest.h"
+#include "module/zones.h"
+#include "node_def.h"
+#include "node_table.h"
+
+namespace ya::arch {
+
+// Time source of a Membership. P2P uses SystemClock; the simulator moves a
+// virtual clock forward so runs are fast and repeatable.
+class Clock {
+ public:
+  using time_point = std::chrono::steady_clock::time_point;
+
+  virtual ~Clock() = default;
+  virtual time_point now() const = 0;
+  // Wall clock in ms, comparable between nodes (zone summary versions)
+  virtual uint64_t epoch_ms() const = 0;
+};
+
+class SystemClock : public Clock {
+ public:
+  static SystemClock& instance();
+
+  time_point now() const override;
+  uint64_t epoch_ms() const override;
+};
+
+// How a Membership reaches other nodes. P2P maps it onto its rep and pub
+// sockets, the simulator onto an in-process event queue.
+class Transport {
+ public:
+  using ReplyHandler = std::function<void(const std::string& reply)>;
+
+  virtual ~Transport() = default;
+
+  // Delivers request to the node listening on address, whose
+  // Membership::handle() answers it. on_reply runs with a non-empty answer;
+  // it is simply never called if the request or reply is lost. Should not
+  // wait for the answer: tick() sends every probe of a round in turn.
+  virtual void send(const std::string& address, const std::string& request,
+                    ReplyHandler on_reply) = 0;
+
+  // Delivers message to every node of our zone, replies are discarded
+  virtual void broadcast(const std::string& message) = 0;
+};
+
+struct MembershipOptions {
+  std::string id;
+  std::string address;   // Listen url, how other nodes name this one
+  std::string data_url;  // Announced data lane, empty for none
+  std::string region = "default";
+  std::string zone = "default";
+
+  std::chrono::milliseconds announce_interval{5000};
+  std::chrono::milliseconds probe_interval{5000};  // Also zone exchanges
+  std::chrono::milliseconds probe_timeout{2000};
+  std::chrono::milliseconds sync_interval{2000};  // Anti-entropy rounds
+  int suspect_limit = 3;  // Failed probes in a row before eviction
+};
+
+// The P2P membership protocol without sockets, threads or sleeps:
+//   - every announce_interval, NODE|id|address|data_url|region/zone goes
+//     to the zone, and announcements of new nodes are joins
+//   - nodes not heard from for probe_interval are asked STATUS; after
+//     suspect_limit unanswered probes in a row they leave
+//   - the zone's representative trades ZONES summaries with the other
+//     zones' representatives (see module::ZoneDirectory)
+//   - every sync_interval, and right after a node joins, views are
+//     compared with one member through a MemberDigest and the entries
+//     that differ are traded both ways (SYNC, then SYNCGET); members
+//     learned this way are probed at once and join when they answer
+// The owner calls tick() regularly and feeds every incoming message to
+// handle(). Thread-safe; the transport and listener are called without
+// the lock held, so replies may be handled on any thread, including the
+// one that sent the request.
+class Membership {
+ public:
+  using Listener = std::function<void(const module::StatusEvent&)>;
+
+  struct Stats {
+    uint64_t broadcasts = 0;  // Announcements sent
+    uint64_t requests = 0;    // Probes and zone exchanges sent
+    uint64_t replies = 0;     // Answers received to those
+    uint64_t handled = 0;     // Messages passed to handle()
+    uint64_t joins = 0;
+    uint64_t leaves = 0;
+    uint64_t syncs = 0;   // Anti-entropy rounds started
+    uint64_t synced = 0;  // Members learned from another node's view
+  };
+
+  Membership(const MembershipOptions& options, Transport& transport,
+             const Clock& clock, Listener listener = nullptr);
+
+  // Announces, probes, evicts and exchanges zone summaries as they fall due
+  void tick();
+
+  // Handles a request or broadcast, returns the reply ("" for none)
+  std::string handle(const std::string& message);
+
+  // Any sign of life from a member, e.g. traffic on another channel
+  void touch(const std::string& address);
+
+  // Both only before the first tick()
+  void set_data_url(const std::string& data_url);
+  void set_zone(const std::string& region, const std::string& zone);
+  void add_zone_seed(const std::string& address);
+
+  NodeStatus local_status() const;
+
+  // Current members, O(1) and lock-free unless something changed since the
+  // last snapshot; the table stays valid as long as it is held
+  std::shared_ptr<const NodeTable> snapshot() const;
+
+  // Copies out of snapshot(), for convenience
+  std::vector<NodeStatus> members() const;
+  std::vector<std::string> addresses() const;
+  std::string data_url(const std::string& address) const;  // "" if unknown
+
+  module::ZoneSummary local_summary() const;
+  std::vector<module::ZoneSummary> zones() const;  // Ours first
+  std::vector<module::RegionSummary> regions() const;
+  bool is_representative() const;
+
+  Stats stats() const;
+  const MembershipOptions& options() const { return m_options; }
+
+  // Prevent copying
+  Membership(const Membership&) = delete;
+  Membership& operator=(const Membership&) = delete;
+
+ private:
+  struct Member {
+    NodeStatus status;
+    std::string data_url;
+    Clock::time_point last_seen;
+    int misses = 0;  // Failed probes in a row
+    bool probing = false;
+    Clock::time_point probe_deadline;
+    // Learned from another node's view and not heard from directly yet:
+    // probed, but not published, synced or counted until it answers
+    bool unverified = false;
+  };
+
+  std::string handle_node(const std::string& message,
+                          std::vector<module::StatusEvent>& events);
+  std::string handle_status(const std::string& message,
+                            std::vector<module::StatusEvent>& events);
+  std::string handle_sync(const std::string& message);
+  std::string handle_sync_get(const std::string& message);
+  void on_probe_reply(const std::string& address);
+  void on_sync_reply(const std::string& address, const std::string& reply);
+  void confirm_locked(Member& member,
+                      std::vector<module::StatusEvent>& events);
+  void merge_entries_locked(std::string_view encoded);
+  MemberDigest digest_locked() const;
+  void publish_locked() const;
+  module::ZoneSummary local_summary_locked() const;
+  void notify(const std::vector<module::StatusEvent>& events);
+
+  MembershipOptions m_options;
+  Transport& m_transport;
+  const Clock& m_clock;
+  Listener m_listener;
+  const Clock::time_point m_start;
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, Member> m_members;
+  std::unique_ptr<module::ZoneDirectory> m_zones;
+  std::vector<std::string> m_zone_seeds;
+  Clock::time_point m_next_announce;
+  Clock::time_point m_next_probe;
+  Clock::time_point m_next_sync;
+  std::string m_sync_cursor;  // Last member synced with, round robin
+  std::string m_sync_joiner;  // Newest member, synced with next tick
+  Stats m_stats;
+
+  // Published copy of m_members for readers, rebuilt lazily after changes
+  mutable std::atomic<std::shared_ptr<const NodeTable>> m_table{
+      NodeTable::empty()};
+  mutable std::atomic<bool> m_dirty{false};
+  mutable uint64_t m_version = 0;
+};
+
+}  // namespace ya::arch
+
+#endif
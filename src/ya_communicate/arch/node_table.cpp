@@ -0,0 +1,67 @@
+#include "node_table.h"
+
+#include <algorithm>
+
+namespace ya::arch {
+
+NodeStatus NodeTable::Entry::status() const {
+  return NodeStatus{std::string(id), std::string(address), uptime,
+                    std::string(info)};
+}
+
+void NodeTable::Builder::add(const NodeStatus& status,
+                             const std::string& data_url) {
+  m_rows.push_back(Row{status, data_url});
+}
+
+std::shared_ptr<const NodeTable> NodeTable::Builder::build(uint64_t version) {
+  std::sort(m_rows.begin(), m_rows.end(), [](const Row& a, const Row& b) {
+    return a.status.address < b.status.address;
+  });
+
+  // make_shared cannot reach the private constructor
+  std::shared_ptr<NodeTable> table(new NodeTable());
+  table->m_version = version;
+
+  // Size the buffer first, so the views taken below never move
+  size_t bytes = 0;
+  for (const auto& row : m_rows) {
+    bytes += row.status.id.size() + row.status.address.size() +
+             row.data_url.size() + row.status.info.size();
+  }
+  table->m_strings.reserve(bytes);
+  table->m_entries.reserve(m_rows.size());
+
+  auto intern = [&table](const std::string& text) {
+    size_t offset = table->m_strings.size();
+    table->m_strings.append(text);
+    return std::string_view(table->m_strings).substr(offset, text.size());
+  };
+  for (const auto& row : m_rows) {
+    Entry entry;
+    entry.id = intern(row.status.id);
+    entry.address = intern(row.status.address);
+    entry.data_url = intern(row.data_url);
+    entry.info = intern(row.status.info);
+    entry.uptime = row.status.uptime;
+    table->m_entries.push_back(entry);
+  }
+  m_rows.clear();
+  return table;
+}
+
+std::shared_ptr<const NodeTable> NodeTable::empty() {
+  static const std::shared_ptr<const NodeTable> table = Builder().build(0);
+  return table;
+}
+
+const NodeTable::Entry* NodeTable::find(std::string_view address) const {
+  auto it = std::lower_bound(
+      m_entries.begin(), m_entries.end(), address,
+      [](const Entry& entry, std::string_view key) {
+        return entry.address < key;
+      });
+  return it != m_entries.end() && it->address == address ? &*it : nullptr;
+}
+
+}  // namespace ya::arch
@@ -0,0 +1,75 @@
+#ifndef NODE_TABLE_H
+#define NODE_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "node_def.h"
+
+namespace ya::arch {
+
+// Immutable snapshot of the known nodes.
+//
+// Readers share one table through a shared_ptr and never lock or copy;
+// membership builds a new table when nodes join, leave or change and swaps
+// it in. Entries are a flat array sorted by address, and all their
+// strings live in one buffer, so a scan touches two allocations no matter
+// how many nodes there are.
+class NodeTable {
+ public:
+  struct Entry {
+    std::string_view id;
+    std::string_view address;
+    std::string_view data_url;  // Empty when the node has no data lane
+    std::string_view info;
+    long long uptime = 0;
+
+    NodeStatus status() const;
+  };
+
+  // Collects rows for one table
+  class Builder {
+   public:
+    void add(const NodeStatus& status, const std::string& data_url = "");
+    std::shared_ptr<const NodeTable> build(uint64_t version);
+
+   private:
+    struct Row {
+      NodeStatus status;
+      std::string data_url;
+    };
+    std::vector<Row> m_rows;
+  };
+
+  // The table with no nodes
+  static std::shared_ptr<const NodeTable> empty();
+
+  uint64_t version() const { return m_version; }  // Increases with changes
+  size_t size() const { return m_entries.size(); }
+  bool is_empty() const { return m_entries.empty(); }
+
+  const Entry& operator[](size_t index) const { return m_entries[index]; }
+  std::vector<Entry>::const_iterator begin() const { return m_entries.begin(); }
+  std::vector<Entry>::const_iterator end() const { return m_entries.end(); }
+
+  // Binary search by address, nullptr if unknown
+  const Entry* find(std::string_view address) const;
+
+  // Prevent copying, tables are shared instead
+  NodeTable(const NodeTable&) = delete;
+  NodeTable& operator=(const NodeTable&) = delete;
+
+ private:
+  NodeTable() = default;
+
+  uint64_t m_version = 0;
+  std::string m_strings;  // Every string of every entry, back to back
+  std::vector<Entry> m_entries;
+};
+
+}  // namespace ya::arch
+
+#endif
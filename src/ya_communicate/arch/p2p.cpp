@@ -4,9 +4,7 @@
 #include <nng/protocol/pubsub0/pub.h>
 #include <nng/protocol/pubsub0/sub.h>
 #include <nng/protocol/reqrep0/rep.h>
-#include <nng/protocol/reqrep0/req.h>
 #include <nng/supplemental/http/http.h>
-#include <nng/supplemental/tls/tls.h>
 
 #include <cstring>
 #include <map>
@@ -15,6 +13,14 @@
 #include <stop_token>
 #include <thread>
 
+#include "membership.h"
+#include "module/endpoint.h"
+#include "module/http.h"
+#include "module/pipeline.h"
+#include "module/requester.h"
+#include "module/runtime.h"
+#include "yautils.h"
+
 namespace ya::arch {
 
 class P2P::Impl {
@@ -26,7 +32,17 @@ class P2P::Impl {
         m_listen_url(listen_url),
         m_broadcast_url(broadcast_url),
         m_running(false),
-        m_start_time(std::chrono::steady_clock::now()) {
+        m_cert_file(cert_file),
+        m_key_file(key_file),
+        m_link(*this),
+        m_membership(membership_options(id, listen_url), m_link,
+                     SystemClock::instance(),
+                     [this](const module::StatusEvent& event) {
+                       if (event.type == module::StatusEvent::TYPE::LEAVE) {
+                         m_lanes.drop_flow(event.status.address);
+                       }
+                       m_feed.publish(event);
+                     }) {
     // Initialize server socket (req/rep)
     if ((m_rv = nng_rep0_open(&m_server_socket)) != 0) {
       throw CommException("Failed to open server socket: " +
@@ -52,32 +68,27 @@ class P2P::Impl {
                           std::string(nng_strerror(m_rv)));
     }
 
-    // Configure TLS if cert_file and key_file are provided
-    if (!cert_file.empty() && !key_file.empty()) {
-      nng_tls_config* tls_config;
-      if ((m_rv = nng_tls_config_alloc(&tls_config, NNG_TLS_MODE_SERVER)) !=
-          0) {
-        throw CommException("Failed to allocate TLS config: " +
-                            std::string(nng_strerror(m_rv)));
-      }
-
-      if ((m_rv = nng_tls_config_own_cert(tls_config, cert_file.c_str(),
-                                          key_file.c_str(), nullptr)) != 0) {
-        nng_tls_config_free(tls_config);
-        throw CommException("Failed to load TLS cert: " +
-                            std::string(nng_strerror(m_rv)));
-      }
-
-      if ((m_rv = nng_socket_set_ptr(m_server_socket, NNG_OPT_TLS_CONFIG,
-                                     tls_config)) != 0 ||
-          (m_rv = nng_socket_set_ptr(m_pub_socket, NNG_OPT_TLS_CONFIG,
-                                     tls_config)) != 0 ||
-          (m_rv = nng_socket_set_ptr(m_sub_socket, NNG_OPT_TLS_CONFIG,
-                                     tls_config)) != 0) {
-        nng_tls_config_free(tls_config);
-        throw CommException("Failed to set TLS config: " +
-                            std::string(nng_strerror(m_rv)));
-      }
+    // TLS contexts are shared through TlsCache and attached per endpoint
+    // (server side for listeners, client side for dialers) in start()
+    m_tls.cert_file = cert_file;
+    m_tls.key_file = key_file;
+    m_tls.ca_file = cert_file;  // Nodes share the cert and trust only it
+
+    m_feed.set_snapshot([this] { return known_statuses(); });
+    m_http.route("GET", "/nodes",
+                 [this](const module::HttpRequest&, module::HttpResponse& res) {
+                   std::string body = "[";
+                   for (const auto& status : known_statuses()) {
+                     if (body.size() > 1) {
+                       body += ", ";
+                     }
+                     body += module::to_json(status);
+                   }
+                   res.set_body(body + "]");
+                 });
+    m_feed.attach(m_http, "/events");
+    if (!m_cert_file.empty() && !m_key_file.empty()) {
+      m_http.set_tls(m_cert_file, m_key_file);
     }
   }
 
@@ -96,16 +107,16 @@ class P2P::Impl {
     m_running = true;
 
     // Start server (req/rep)
-    if ((m_rv = nng_listen(m_server_socket, m_listen_url.c_str(),
-                           &m_server_listener, 0)) != 0) {
+    if ((m_rv = module::listen_endpoint(m_server_socket, m_listen_url, m_tls,
+                                        &m_server_listener)) != 0) {
       m_running = false;
       throw CommException("Failed to listen on " + m_listen_url + ": " +
                           std::string(nng_strerror(m_rv)));
     }
 
     // Start publisher (pub)
-    if ((m_rv = nng_listen(m_pub_socket, m_broadcast_url.c_str(),
-                           &m_pub_listener, 0)) != 0) {
+    if ((m_rv = module::listen_endpoint(m_pub_socket, m_broadcast_url, m_tls,
+                                        &m_pub_listener)) != 0) {
       m_running = false;
       nng_listener_close(m_server_listener);
       throw CommException("Failed to listen on broadcast " + m_broadcast_url +
@@ -113,8 +124,8 @@ class P2P::Impl {
     }
 
     // Start subscriber (sub)
-    if ((m_rv = nng_dial(m_sub_socket, m_broadcast_url.c_str(), &m_sub_dialer,
-                         0)) != 0) {
+    if ((m_rv = module::dial_endpoint(m_sub_socket, m_broadcast_url, m_tls,
+                                      &m_sub_dialer)) != 0) {
       m_running = false;
       nng_listener_close(m_server_listener);
       nng_listener_close(m_pub_listener);
@@ -122,10 +133,49 @@ class P2P::Impl {
                           std::string(nng_strerror(m_rv)));
     }
 
-    m_server_thread = std::thread([this] { run_server(); });
-    m_broadcast_thread = std::thread([this] { run_broadcaster(); });
-    m_subscriber_thread = std::thread([this] { run_subscriber(); });
-    m_node_manager_thread = std::thread([this] { run_node_manager(); });
+    // Data lane, on its own socket so bulk payloads never share a queue
+    // with STATUS requests and discovery
+    if (!m_data_url.empty()) {
+      try {
+        m_data_puller = std::make_unique<module::Pipeline>(
+            module::Pipeline::ROLE::PULLER, m_data_url, m_tls);
+        m_data_puller->set_timeout(DATA_POLL);
+      } catch (const std::exception& e) {
+        m_running = false;
+        nng_listener_close(m_server_listener);
+        nng_listener_close(m_pub_listener);
+        nng_dialer_close(m_sub_dialer);
+        throw CommException("Failed to listen on data " + m_data_url + ": " +
+                            e.what());
+      }
+    }
+
+    // Sockets may have started more nng threads, keep them on the I/O CPUs
+    // and ours off them (no-ops unless Runtime was configured)
+    auto& runtime = module::Runtime::instance();
+    runtime.pin_io_threads();
+    m_server_thread = std::thread([this, &runtime] {
+      runtime.pin_current_thread();
+      run_server();
+    });
+    m_subscriber_thread = std::thread([this, &runtime] {
+      runtime.pin_current_thread();
+      run_subscriber();
+    });
+    m_node_manager_thread = std::thread([this, &runtime] {
+      runtime.pin_current_thread();
+      run_node_manager();
+    });
+    if (m_data_puller) {
+      m_data_sender_thread = std::thread([this, &runtime] {
+        runtime.pin_current_thread();
+        run_data_sender();
+      });
+      m_data_receiver_thread = std::thread([this, &runtime] {
+        runtime.pin_current_thread();
+        run_data_receiver();
+      });
+    }
   }
 
   void stop() {
@@ -141,63 +191,35 @@ class P2P::Impl {
     if (m_server_thread.joinable()) {
       m_server_thread.join();
     }
-    if (m_broadcast_thread.joinable()) {
-      m_broadcast_thread.join();
-    }
     if (m_subscriber_thread.joinable()) {
       m_subscriber_thread.join();
     }
     if (m_node_manager_thread.joinable()) {
       m_node_manager_thread.join();
     }
+    m_peer_pool.WaitIdle();  // Requests in flight finish or time out
+    if (m_data_sender_thread.joinable()) {
+      m_data_sender_thread.join();
+    }
+    if (m_data_receiver_thread.joinable()) {
+      m_data_receiver_thread.join();
+    }
+    m_data_peers.clear();
+    m_data_puller.reset();
     stop_http_server();
   }
 
-  NodeStatus get_local_status() const {
-    auto now = std::chrono::steady_clock::now();
-    auto uptime =
-        std::chrono::duration_cast<std::chrono::seconds>(now - m_start_time)
-            .count();
-    return NodeStatus{m_id, m_listen_url, uptime, "healthy"};
-  }
+  NodeStatus get_local_status() const { return m_membership.local_status(); }
 
   std::vector<NodeStatus> query_all_status() {
     std::vector<NodeStatus> statuses;
-    std::lock_guard<std::mutex> lock(m_nodes_mutex);
     statuses.push_back(get_local_status());
 
-    for (const auto& [url, status] : m_nodes) {
+    auto table = m_membership.snapshot();
+    for (const auto& entry : *table) {
       try {
-        nng_socket client_socket;
-        nng_dialer dialer;
-        if ((m_rv = nng_req0_open(&client_socket)) != 0) {
-          continue;
-        }
-
-        if ((m_rv = nng_dial(client_socket, url.c_str(), &dialer, 0)) != 0) {
-          nng_close(client_socket);
-          continue;
-        }
-
-        const char* req = "STATUS";
-        if ((m_rv = nng_send(client_socket, (void*)req, strlen(req) + 1, 0)) !=
-            0) {
-          nng_close(client_socket);
-          continue;
-        }
-
-        char* buf = nullptr;
-        size_t sz;
-        if ((m_rv = nng_recv(client_socket, &buf, &sz, NNG_FLAG_ALLOC)) != 0) {
-          nng_close(client_socket);
-          continue;
-        }
-
-        std::string reply(buf, sz - 1);
-        nng_free(buf, sz);
-        nng_close(client_socket);
-
-        std::stringstream ss(reply);
+        std::string url(entry.address);
+        std::stringstream ss(request_peer(url, "STATUS"));
         std::string id, address, info;
         long uptime;
         std::getline(ss, id, '|');
@@ -215,29 +237,107 @@ class P2P::Impl {
     return statuses;
   }
 
-  void subscribe_status(std::function<void(const NodeStatus&)> callback) {
-    std::lock_guard<std::mutex> lock(m_callback_mutex);
-    m_status_callback = callback;
+  size_t subscribe_status(std::function<void(const NodeStatus&)> callback) {
+    return m_feed.subscribe(
+        [callback = std::move(callback)](const module::StatusEvent& event) {
+          if (event.type != module::StatusEvent::TYPE::LEAVE) {
+            callback(event.status);
+          }
+        });
   }
 
+  size_t subscribe_events(module::StatusFeed::Listener listener) {
+    return m_feed.subscribe(std::move(listener));
+  }
+
+  void unsubscribe_status(size_t id) { m_feed.unsubscribe(id); }
+
   std::vector<std::string> get_known_nodes() const {
-    std::lock_guard<std::mutex> lock(m_nodes_mutex);
-    std::vector<std::string> urls;
-    for (const auto& [url, _] : m_nodes) {
-      urls.push_back(url);
+    return m_membership.addresses();
+  }
+
+  std::shared_ptr<const NodeTable> get_node_table() const {
+    return m_membership.snapshot();
+  }
+
+  void set_data_url(const std::string& data_url) {
+    if (m_running) {
+      throw CommException("Data url must be set before start()");
     }
-    return urls;
+    m_data_url = data_url;
+    m_membership.set_data_url(data_url);
   }
 
-  void start_http_server(int port) {
-    // use module::http
+  void set_data_handler(DataHandler handler) {
+    std::lock_guard<std::mutex> lock(m_data_mutex);
+    m_data_handler = std::move(handler);
   }
 
+  bool send(const std::string& node_url, const std::string& payload,
+            module::LANE lane) {
+    if (!m_data_puller) {
+      return false;  // Peers could not answer us, and we announce no lane
+    }
+    auto table = m_membership.snapshot();
+    const auto* entry = table->find(node_url);
+    if (!entry || entry->data_url.empty()) {
+      return false;
+    }
+    return m_lanes.push(lane, node_url, payload);
+  }
+
+  module::LaneScheduler::Stats lane_stats() const { return m_lanes.stats(); }
+
+  void set_zone(const std::string& region, const std::string& zone) {
+    if (m_running) {
+      throw CommException("Zone must be set before start()");
+    }
+    m_membership.set_zone(region, zone);
+  }
+
+  void add_zone_seed(const std::string& url) {
+    m_membership.add_zone_seed(url);
+  }
+
+  std::vector<module::ZoneSummary> get_zones() const {
+    return m_membership.zones();
+  }
+
+  std::vector<module::RegionSummary> get_regions() const {
+    return m_membership.regions();
+  }
+
+  bool is_zone_representative() const {
+    return m_membership.is_representative();
+  }
+
+  void start_http_server(int port) { m_http.start(port); }
+
   void stop_http_server() {
-    // use module::http
+    m_feed.disconnect_all();  // Wake SSE streams so stop() can join them
+    m_http.stop();
   }
 
  private:
+  static MembershipOptions membership_options(const std::string& id,
+                                              const std::string& address) {
+    MembershipOptions options;
+    options.id = id;
+    options.address = address;
+    return options;
+  }
+
+  // Local node first, then every known peer
+  std::vector<NodeStatus> known_statuses() const {
+    auto table = m_membership.snapshot();
+    std::vector<NodeStatus> statuses{get_local_status()};
+    statuses.reserve(table->size() + 1);
+    for (const auto& entry : *table) {
+      statuses.push_back(entry.status());
+    }
+    return statuses;
+  }
+
   void run_server() {
     while (m_running) {
       char* buf = nullptr;
@@ -252,35 +352,13 @@ class P2P::Impl {
       std::string req(buf, sz - 1);
       nng_free(buf, sz);
 
-      if (req == "STATUS") {
-        auto status = get_local_status();
-        std::stringstream ss;
-        ss << status.id << "|" << status.address << "|" << status.uptime << "|"
-           << status.info;
-        std::string reply = ss.str();
-
-        if ((m_rv = nng_send(m_server_socket, (void*)reply.c_str(),
-                             reply.size() + 1, 0)) != 0) {
-          fprintf(stderr, "Server send failed: %s\n", nng_strerror(m_rv));
-        }
-      }
-    }
-  }
-
-  void run_broadcaster() {
-    while (m_running) {
-      auto status = get_local_status();
-      std::stringstream ss;
-      ss << "NODE|" << status.id << "|" << status.address;
-      std::string msg = ss.str();
-
-      if ((m_rv = nng_send(m_pub_socket, (void*)msg.c_str(), msg.size() + 1,
-                           0)) != 0) {
-        fprintf(stderr, "Broadcast failed: %s\n", nng_strerror(m_rv));
+      // STATUS probes and ZONES exchanges
+      std::string reply = m_membership.handle(req);
+      if (!reply.empty() &&
+          (m_rv = nng_send(m_server_socket, (void*)reply.c_str(),
+                           reply.size() + 1, 0)) != 0) {
+        fprintf(stderr, "Server send failed: %s\n", nng_strerror(m_rv));
       }
-
-      // Broadcast status every 5 seconds
-      std::this_thread::sleep_for(std::chrono::seconds(5));
     }
   }
 
@@ -299,86 +377,171 @@ class P2P::Impl {
       std::string msg(buf, sz - 1);
       nng_free(buf, sz);
 
-      // Parse message (format: type|id|address or
-      // STATUS|id|address|uptime|info)
-      std::stringstream ss(msg);
-      std::string type, id, address;
-      std::getline(ss, type, '|');
-      std::getline(ss, id, '|');
-      std::getline(ss, address, '|');
-
-      if (type == "NODE") {
-        // Node discovery: add to nodes list
-        std::lock_guard<std::mutex> lock(m_nodes_mutex);
-        if (id != m_id && address != m_listen_url) {
-          m_nodes[address] = NodeStatus{id, address, 0, "discovered"};
-        }
-      } else if (type == "STATUS") {
-        long uptime;
-        std::string info;
-        ss >> uptime;
-        ss.ignore(1);
-        std::getline(ss, info);
+      // Discovery (NODE) and pushed status (STATUS) of our zone
+      m_membership.handle(msg);
+    }
+  }
 
-        std::lock_guard<std::mutex> lock(m_nodes_mutex);
-        m_nodes[address] = NodeStatus{id, address, uptime, info};
+  // Announcements, probes and zone exchanges run on the membership's
+  // schedule; the requests themselves go to m_peer_pool
+  void run_node_manager() {
+    while (m_running) {
+      m_membership.tick();
+      std::this_thread::sleep_for(TICK);
+    }
+  }
 
-        std::lock_guard<std::mutex> cb_lock(m_callback_mutex);
-        if (m_status_callback) {
-          m_status_callback(NodeStatus{id, address, uptime, info});
+  // Serves the lanes: CONTROL first, DATA round robin between nodes. A node
+  // that does not take a message within DATA_TIMEOUT loses its queue, so
+  // one stalled peer holds the others up only briefly.
+  void run_data_sender() {
+    while (m_running) {
+      auto item = m_lanes.pop(DATA_POLL);
+      if (!item) {
+        continue;
+      }
+
+      std::string data_url = m_membership.data_url(item->flow);
+      auto& peer = m_data_peers[item->flow];
+      if (data_url.empty()) {
+        m_data_peers.erase(item->flow);  // Left since the message was queued
+        continue;
+      }
+
+      std::string frame = std::string(module::to_string(item->lane)) + "|" +
+                          m_listen_url + "|" + item->message;
+      try {
+        if (!peer || peer->url != data_url) {
+          peer = std::make_unique<DataPeer>(data_url, m_tls);
         }
+        peer->pusher.send(frame);
+      } catch (const std::exception& e) {
+        fprintf(stderr, "Data send to %s failed: %s\n", item->flow.c_str(),
+                e.what());
+        m_data_peers.erase(item->flow);
+        m_lanes.drop_flow(item->flow);
       }
     }
   }
 
-  void run_node_manager() {
+  void run_data_receiver() {
     while (m_running) {
-      std::lock_guard<std::mutex> lock(m_nodes_mutex);
-      auto nodes_copy = m_nodes;
-      for (auto it = nodes_copy.begin(); it != nodes_copy.end(); ++it) {
-        try {
-          nng_socket client_socket;
-          nng_dialer dialer;
-          if ((m_rv = nng_req0_open(&client_socket)) != 0) {
-            continue;
-          }
-
-          if ((m_rv = nng_dial(client_socket, it->first.c_str(), &dialer, 0)) !=
-              0) {
-            m_nodes.erase(it->first);  // Remove unreachable node
-            nng_close(client_socket);
-            continue;
-          }
+      std::string frame;
+      try {
+        frame = m_data_puller->receive();
+      } catch (const std::exception&) {
+        continue;  // DATA_POLL timeout, check m_running again
+      }
 
-          const char* req = "STATUS";
-          if ((m_rv = nng_send(client_socket, (void*)req, strlen(req) + 1,
-                               0)) != 0) {
-            m_nodes.erase(it->first);
-            nng_close(client_socket);
-            continue;
-          }
+      // Format: lane|from|payload, the payload may contain '|'
+      size_t lane_end = frame.find('|');
+      size_t from_end = lane_end == std::string::npos
+                            ? std::string::npos
+                            : frame.find('|', lane_end + 1);
+      if (from_end == std::string::npos) {
+        continue;
+      }
+      std::string from = frame.substr(lane_end + 1, from_end - lane_end - 1);
+      m_membership.touch(from);  // Data is as good a sign of life as a reply
 
-          char* buf = nullptr;
-          size_t sz;
-          if ((m_rv = nng_recv(client_socket, &buf, &sz, NNG_FLAG_ALLOC)) !=
-              0) {
-            m_nodes.erase(it->first);
-            nng_close(client_socket);
-            continue;
-          }
+      DataHandler handler;
+      {
+        std::lock_guard<std::mutex> lock(m_data_mutex);
+        handler = m_data_handler;
+      }
+      if (handler) {
+        handler(from, frame.substr(from_end + 1));
+      }
+    }
+  }
 
-          nng_free(buf, sz);
-          nng_close(client_socket);
-        } catch (...) {
-          m_nodes.erase(it->first);
-        }
+  // Peers are asked over one long-lived connection each, so periodic
+  // queries do not pay a TCP (and TLS) handshake every time. A failed
+  // request drops the connection; the next one dials afresh.
+  std::string request_peer(const std::string& url, const std::string& msg) {
+    std::shared_ptr<Peer> peer;
+    {
+      std::lock_guard<std::mutex> lock(m_peers_mutex);
+      auto& slot = m_peers[url];
+      if (!slot) {
+        slot = std::make_shared<Peer>();
       }
+      peer = slot;
+    }
 
-      // Check nodes every 10 seconds
-      std::this_thread::sleep_for(std::chrono::seconds(10));
+    std::lock_guard<std::mutex> lock(peer->mutex);  // req0 is one-at-a-time
+    try {
+      if (!peer->client) {
+        peer->client = std::make_unique<module::Requester>(url, m_tls);
+        peer->client->set_timeout(PEER_TIMEOUT);
+      }
+      return peer->client->request(msg);
+    } catch (...) {
+      peer->client.reset();
+      std::lock_guard<std::mutex> peers_lock(m_peers_mutex);
+      m_peers.erase(url);
+      throw;
     }
   }
 
+  struct Peer {
+    std::mutex mutex;
+    std::unique_ptr<module::Requester> client;
+  };
+
+  // Membership transport: requests over the per-peer requesters on
+  // m_peer_pool, so a dead peer holds up one worker for PEER_TIMEOUT
+  // instead of the whole tick, and answers handled there; broadcasts on
+  // our pub socket
+  class Link : public Transport {
+   public:
+    explicit Link(Impl& impl) : m_impl(impl) {}
+
+    void send(const std::string& address, const std::string& request,
+              ReplyHandler on_reply) override {
+      m_impl.m_peer_pool.Post(
+          [this, address, request, on_reply = std::move(on_reply)] {
+            std::string reply;
+            try {
+              reply = m_impl.request_peer(address, request);
+            } catch (...) {
+              return;  // Counts as a missed probe once it times out
+            }
+            if (!reply.empty()) {
+              on_reply(reply);
+            }
+          });
+    }
+
+    void broadcast(const std::string& message) override {
+      int rv;
+      if ((rv = nng_send(m_impl.m_pub_socket, (void*)message.c_str(),
+                         message.size() + 1, 0)) != 0) {
+        fprintf(stderr, "Broadcast failed: %s\n", nng_strerror(rv));
+      }
+    }
+
+   private:
+    Impl& m_impl;
+  };
+
+  struct DataPeer {
+    DataPeer(const std::string& data_url, const module::TlsOptions& tls)
+        : url(data_url),
+          pusher(module::Pipeline::ROLE::PUSHER, data_url, tls) {
+      pusher.set_timeout(DATA_TIMEOUT);
+    }
+
+    std::string url;
+    module::Pipeline pusher;
+  };
+
+  static constexpr auto PEER_TIMEOUT = std::chrono::seconds(2);
+  static constexpr size_t PEER_WORKERS = 4;
+  static constexpr auto TICK = std::chrono::milliseconds(500);
+  static constexpr auto DATA_TIMEOUT = std::chrono::milliseconds(200);
+  static constexpr auto DATA_POLL = std::chrono::milliseconds(100);
+
   std::string m_id;
   std::string m_listen_url;
   std::string m_broadcast_url;
@@ -389,20 +552,37 @@ class P2P::Impl {
   nng_socket m_sub_socket;
   nng_dialer m_sub_dialer;
   std::thread m_server_thread;
-  std::thread m_broadcast_thread;
   std::thread m_subscriber_thread;
   std::thread m_node_manager_thread;
-  std::map<std::string, NodeStatus> m_nodes;
-  mutable std::mutex m_nodes_mutex;
-  std::function<void(const NodeStatus&)> m_status_callback;
-  mutable std::mutex m_callback_mutex;
   std::atomic<bool> m_running;
-  std::chrono::steady_clock::time_point m_start_time;
   int m_rv;
 
   std::string m_cert_file;
   std::string m_key_file;
-  std::thread m_http_thread;
+  module::TlsOptions m_tls;
+  std::map<std::string, std::shared_ptr<Peer>> m_peers;
+  std::mutex m_peers_mutex;
+
+  Link m_link;
+  Membership m_membership;
+
+  // Data lane; m_data_peers is only touched by the sender thread
+  std::string m_data_url;
+  std::unique_ptr<module::Pipeline> m_data_puller;
+  std::map<std::string, std::unique_ptr<DataPeer>> m_data_peers;
+  module::LaneScheduler m_lanes;
+  DataHandler m_data_handler;
+  std::mutex m_data_mutex;
+  std::thread m_data_sender_thread;
+  std::thread m_data_receiver_thread;
+
+  // Declared after everything the handlers touch, so the server stops first
+  module::StatusFeed m_feed;
+  module::Http m_http;
+
+  // Membership requests and their reply handlers; last, so it drains
+  // before anything they touch goes away
+  YaUtils::ThreadPool m_peer_pool{PEER_WORKERS};
 };
 
 P2P::P2P(const std::string& id, const std::string& listen_url,
@@ -423,14 +603,59 @@ std::vector<NodeStatus> P2P::query_all_status() {
 
 NodeStatus P2P::get_local_status() const { return m_impl->get_local_status(); }
 
-void P2P::subscribe_status(std::function<void(const NodeStatus&)> callback) {
-  m_impl->subscribe_status(callback);
+size_t P2P::subscribe_status(std::function<void(const NodeStatus&)> callback) {
+  return m_impl->subscribe_status(std::move(callback));
+}
+
+size_t P2P::subscribe_events(module::StatusFeed::Listener listener) {
+  return m_impl->subscribe_events(std::move(listener));
 }
 
+void P2P::unsubscribe_status(size_t id) { m_impl->unsubscribe_status(id); }
+
 std::vector<std::string> P2P::get_known_nodes() const {
   return m_impl->get_known_nodes();
 }
 
+std::shared_ptr<const NodeTable> P2P::get_node_table() const {
+  return m_impl->get_node_table();
+}
+
+void P2P::set_data_url(const std::string& data_url) {
+  m_impl->set_data_url(data_url);
+}
+
+void P2P::set_data_handler(DataHandler handler) {
+  m_impl->set_data_handler(std::move(handler));
+}
+
+bool P2P::send(const std::string& node_url, const std::string& payload,
+               module::LANE lane) {
+  return m_impl->send(node_url, payload, lane);
+}
+
+module::LaneScheduler::Stats P2P::lane_stats() const {
+  return m_impl->lane_stats();
+}
+
+void P2P::set_zone(const std::string& region, const std::string& zone) {
+  m_impl->set_zone(region, zone);
+}
+
+void P2P::add_zone_seed(const std::string& url) { m_impl->add_zone_seed(url); }
+
+std::vector<module::ZoneSummary> P2P::get_zones() const {
+  return m_impl->get_zones();
+}
+
+std::vector<module::RegionSummary> P2P::get_regions() const {
+  return m_impl->get_regions();
+}
+
+bool P2P::is_zone_representative() const {
+  return m_impl->is_zone_representative();
+}
+
 void P2P::start_http_server(int port) { m_impl->start_http_server(port); }
 
 void P2P::stop_http_server() { m_impl->stop_http_server(); }
@@ -6,13 +6,23 @@
 #include <string>
 #include <vector>
 
+#include "arch/node_table.h"
+#include "module/lanes.h"
+#include "module/status_feed.h"
+#include "module/zones.h"
 #include "node_def.h"
 
 namespace ya::arch {
 
 class P2P {
  public:
-  // Constructor with TLS support
+  // Payload from another node's data lane, from is its listen url
+  using DataHandler =
+      std::function<void(const std::string& from, const std::string& payload)>;
+
+  // Constructor with TLS support. Over tls+ urls every node presents
+  // cert_file and verifies peers against it, so the nodes share a
+  // certificate or cert_file holds the CA that signed theirs.
   P2P(const std::string& id, const std::string& listen_url,
       const std::string& broadcast_url, const std::string& cert_file = "",
       const std::string& key_file = "");
@@ -30,13 +40,54 @@ class P2P {
   // Get local node status
   NodeStatus get_local_status() const;
 
-  // Subscribe to status updates (callback receives new status)
-  void subscribe_status(std::function<void(const NodeStatus&)> callback);
+  // Subscribe to status updates (callback receives new status). Any number
+  // of callbacks may be registered; the returned id removes one again.
+  size_t subscribe_status(std::function<void(const NodeStatus&)> callback);
+
+  // Subscribe to membership deltas (join/update/leave)
+  size_t subscribe_events(module::StatusFeed::Listener listener);
+
+  void unsubscribe_status(size_t id);
 
   // Get current known nodes
   std::vector<std::string> get_known_nodes() const;
 
-  // Start HTTP server on specified port
+  // Known nodes as a shared immutable snapshot: no lock and no copy, and
+  // unaffected by later membership changes
+  std::shared_ptr<const NodeTable> get_node_table() const;
+
+  // Application traffic runs on its own push/pull sockets and threads, so
+  // it never delays heartbeats and status queries. Set the address this
+  // node receives data on before start(); it is announced with discovery.
+  void set_data_url(const std::string& data_url);
+  void set_data_handler(DataHandler handler);
+
+  // Queues payload for a known node (a get_known_nodes() entry). CONTROL
+  // messages overtake queued DATA; DATA is shared fairly between nodes.
+  // False if the node has no data address yet or its queue is full.
+  bool send(const std::string& node_url, const std::string& payload,
+            module::LANE lane = module::LANE::DATA);
+
+  module::LaneScheduler::Stats lane_stats() const;
+
+  // Zone-aware membership. Nodes only track the members of their own zone
+  // (discovery from other zones is ignored); the zone's representative,
+  // its live member with the lowest id, exchanges one aggregated summary
+  // per zone with the other representatives. Set before start(); nodes
+  // that never call it share the zone "default/default".
+  void set_zone(const std::string& region, const std::string& zone);
+
+  // Listen url of any node in another zone, used to find the other
+  // representatives while none are known
+  void add_zone_seed(const std::string& url);
+
+  // Our zone first, then every other zone heard of recently
+  std::vector<module::ZoneSummary> get_zones() const;
+  std::vector<module::RegionSummary> get_regions() const;
+  bool is_zone_representative() const;
+
+  // Start HTTP server on specified port. Serves GET /nodes and a
+  // Server-Sent Events stream of membership changes on GET /events.
   void start_http_server(int port);
 
   // Stop HTTP server
@@ -0,0 +1,208 @@
+#include "simulator.h"
+
+#include <algorithm>
+
+namespace ya::arch {
+
+uint64_t VirtualClock::epoch_ms() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             m_now.time_since_epoch())
+      .count();
+}
+
+void VirtualClock::advance_to(time_point when) {
+  m_now = std::max(m_now, when);
+}
+
+struct Simulator::Node {
+  std::unique_ptr<Link> link;
+  std::unique_ptr<Membership> membership;
+  std::string zone;
+  int group = 0;
+};
+
+// Transport of one simulated node
+class Simulator::Link : public Transport {
+ public:
+  Link(Simulator& simulator, size_t index)
+      : m_simulator(simulator), m_index(index) {}
+
+  void send(const std::string& address, const std::string& request,
+            ReplyHandler on_reply) override {
+    auto it = m_simulator.m_addresses.find(address);
+    if (it == m_simulator.m_addresses.end()) {
+      ++m_simulator.m_stats.sent;
+      m_simulator.m_stats.bytes += request.size();
+      ++m_simulator.m_stats.dropped;
+      return;
+    }
+    size_t to = it->second;
+    Simulator& simulator = m_simulator;
+    size_t from = m_index;
+    simulator.transmit(
+        from, to, request.size(),
+        [&simulator, from, to, request, on_reply = std::move(on_reply)] {
+          std::string reply =
+              simulator.m_nodes[to]->membership->handle(request);
+          if (!reply.empty()) {
+            simulator.transmit(to, from, reply.size(),
+                               [on_reply, reply] { on_reply(reply); });
+          }
+        });
+  }
+
+  void broadcast(const std::string& message) override {
+    const Node& self = *m_simulator.m_nodes[m_index];
+    auto shared = std::make_shared<const std::string>(message);
+    Simulator& simulator = m_simulator;
+    for (size_t to : m_simulator.m_zones[self.zone]) {
+      if (to != m_index) {
+        simulator.transmit(m_index, to, shared->size(),
+                           [&simulator, to, shared] {
+                             simulator.m_nodes[to]->membership->handle(
+                                 *shared);
+                           });
+      }
+    }
+  }
+
+ private:
+  Simulator& m_simulator;
+  const size_t m_index;
+};
+
+Simulator::Simulator() : Simulator(SimOptions{}) {}
+
+Simulator::Simulator(const SimOptions& options)
+    : m_options(options), m_start(m_clock.now()), m_rng(options.seed) {}
+
+Simulator::~Simulator() = default;
+
+size_t Simulator::add_node(const MembershipOptions& options) {
+  size_t index = m_nodes.size();
+  auto node = std::make_unique<Node>();
+  node->link = std::make_unique<Link>(*this, index);
+  node->membership =
+      std::make_unique<Membership>(options, *node->link, m_clock);
+  node->zone = options.region + "/" + options.zone;
+  m_addresses[options.address] = index;
+  m_zones[node->zone].push_back(index);
+  m_nodes.push_back(std::move(node));
+
+  auto tick = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      m_options.tick);
+  schedule_tick(index, std::chrono::nanoseconds(
+                           static_cast<int64_t>(next_unit() * tick.count())));
+  return index;
+}
+
+Membership& Simulator::node(size_t index) {
+  return *m_nodes.at(index)->membership;
+}
+
+void Simulator::set_latency(std::chrono::milliseconds latency,
+                            std::chrono::milliseconds jitter) {
+  m_options.latency = latency;
+  m_options.jitter = jitter;
+}
+
+void Simulator::partition(size_t index, int group) {
+  m_nodes.at(index)->group = group;
+}
+
+void Simulator::heal() {
+  for (auto& node : m_nodes) {
+    node->group = 0;
+  }
+}
+
+void Simulator::run_for(std::chrono::milliseconds duration) {
+  auto until = m_clock.now() + duration;
+  while (step(until)) {
+  }
+  m_clock.advance_to(until);
+}
+
+bool Simulator::run_until(const std::function<bool()>& done,
+                          std::chrono::milliseconds limit) {
+  auto deadline = m_clock.now() + limit;
+  while (!done()) {
+    if (m_clock.now() >= deadline) {
+      return false;
+    }
+    auto until = std::min(deadline, m_clock.now() + m_options.tick);
+    while (step(until)) {
+    }
+    m_clock.advance_to(until);
+  }
+  return true;
+}
+
+std::chrono::milliseconds Simulator::elapsed() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(m_clock.now() -
+                                                               m_start);
+}
+
+void Simulator::schedule(std::chrono::nanoseconds delay,
+                         std::function<void()> run) {
+  m_events.push(Event{m_clock.now() + delay, m_seq++, std::move(run)});
+}
+
+void Simulator::schedule_tick(size_t index, std::chrono::nanoseconds delay) {
+  schedule(delay, [this, index] {
+    ++m_stats.ticks;
+    m_nodes[index]->membership->tick();
+    schedule_tick(index, m_options.tick);
+  });
+}
+
+void Simulator::transmit(size_t from, size_t to, size_t bytes,
+                         std::function<void()> run) {
+  ++m_stats.sent;
+  m_stats.bytes += bytes;
+  if (m_options.loss > 0 && next_unit() < m_options.loss) {
+    ++m_stats.dropped;
+    return;
+  }
+  auto delay = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      m_options.latency);
+  if (m_options.jitter.count() > 0) {
+    auto jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        m_options.jitter);
+    delay += std::chrono::nanoseconds(
+        static_cast<int64_t>(next_unit() * jitter.count()));
+  }
+  schedule(delay, [this, from, to, run = std::move(run)] {
+    if (m_nodes[from]->group != m_nodes[to]->group) {
+      ++m_stats.dropped;
+      return;
+    }
+    ++m_stats.delivered;
+    run();
+  });
+}
+
+bool Simulator::step(Clock::time_point until) {
+  if (m_events.empty() || m_events.top().at > until) {
+    return false;
+  }
+  Event event = m_events.top();
+  m_events.pop();
+  m_clock.advance_to(event.at);
+  event.run();
+  return true;
+}
+
+// splitmix64, so runs match across standard libraries
+uint64_t Simulator::next_random() {
+  uint64_t z = (m_rng += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+double Simulator::next_unit() {
+  return static_cast<double>(next_random() >> 11) * 0x1.0p-53;
+}
+
+}  // namespace ya::arch
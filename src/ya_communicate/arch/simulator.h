@@ -0,0 +1,126 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "membership.h"
+
+namespace ya::arch {
+
+// Clock that only moves when the simulator says so
+class VirtualClock : public Clock {
+ public:
+  time_point now() const override { return m_now; }
+  uint64_t epoch_ms() const override;
+
+  void advance_to(time_point when);
+
+ private:
+  time_point m_now{};
+};
+
+struct SimOptions {
+  uint64_t seed = 1;
+  std::chrono::milliseconds latency{1};  // One way, per message
+  std::chrono::milliseconds jitter{0};   // Added uniformly on top
+  double loss = 0.0;                     // Chance a message is dropped
+  std::chrono::milliseconds tick{500};   // How often nodes run tick()
+};
+
+// Many Membership instances on one simulated network, in one thread and
+// in virtual time: an hour of protocol runs in seconds, and a run depends
+// on nothing but the options and seed, so convergence time and message
+// counts can be asserted exactly.
+//
+// Broadcasts reach the other nodes of the sender's zone, as P2P's pub
+// socket would on a LAN. Latency, loss and partitions apply to every
+// message and reply; a partition also drops messages already in flight.
+class Simulator {
+ public:
+  struct Stats {
+    uint64_t sent = 0;       // Messages and replies put on the network
+    uint64_t bytes = 0;      // Their total size
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;    // Lost, partitioned or to unknown addresses
+    uint64_t ticks = 0;
+  };
+
+  Simulator();
+  explicit Simulator(const SimOptions& options);
+  ~Simulator();
+
+  // Adds a node, ticking from a random point within the first tick
+  size_t add_node(const MembershipOptions& options);
+  Membership& node(size_t index);
+  size_t size() const { return m_nodes.size(); }
+
+  void set_loss(double loss) { m_options.loss = loss; }
+  void set_latency(std::chrono::milliseconds latency,
+                   std::chrono::milliseconds jitter = {});
+
+  // Nodes only reach nodes of the same group; all start in group 0
+  void partition(size_t index, int group);
+  void heal();
+
+  void run_for(std::chrono::milliseconds duration);
+
+  // Runs until done() holds (checked every tick) or limit passes.
+  // Returns whether done() held.
+  bool run_until(const std::function<bool()>& done,
+                 std::chrono::milliseconds limit);
+
+  std::chrono::milliseconds elapsed() const;
+  const Stats& stats() const { return m_stats; }
+  const VirtualClock& clock() const { return m_clock; }
+
+  // Prevent copying
+  Simulator(const Simulator&) = delete;
+  Simulator& operator=(const Simulator&) = delete;
+
+ private:
+  class Link;
+  struct Node;
+
+  struct Event {
+    Clock::time_point at;
+    uint64_t seq;  // Ties broken in scheduling order, for determinism
+    std::function<void()> run;
+
+    bool operator>(const Event& other) const {
+      return at != other.at ? at > other.at : seq > other.seq;
+    }
+  };
+
+  void schedule(std::chrono::nanoseconds delay, std::function<void()> run);
+  void schedule_tick(size_t index, std::chrono::nanoseconds delay);
+  // Schedules run after the link delay unless the message is lost; a
+  // partition is checked on arrival
+  void transmit(size_t from, size_t to, size_t bytes,
+                std::function<void()> run);
+  bool step(Clock::time_point until);
+
+  uint64_t next_random();
+  double next_unit();  // Uniform in [0, 1)
+
+  SimOptions m_options;
+  VirtualClock m_clock;
+  const Clock::time_point m_start;
+  uint64_t m_rng;
+  uint64_t m_seq = 0;
+  std::priority_queue<Event, std::vector<Event>, std::greater<>> m_events;
+  std::vector<std::unique_ptr<Node>> m_nodes;
+  std::map<std::string, size_t> m_addresses;
+  std::map<std::string, std::vector<size_t>> m_zones;  // Broadcast domains
+  Stats m_stats;
+};
+
+}  // namespace ya::arch
+
+#endif
@@ -3,22 +3,26 @@
 #include <nng/nng.h>
 #include <nng/protocol/bus0/bus.h>
 
+#include <chrono>
 #include <cstring>
 #include <iostream>
-#include <regex>
 #include <stdexcept>
 #include <string>
 
+#include "endpoint.h"
+#include "msgpool.h"
+#include "node_def.h"
+
 namespace ya::module {
 
 class Bus::Impl {
  public:
-  Impl(const std::string& address) : socket_(0) {
-    if (!std::regex_match(
-            address,
-            std::regex("(tcp://[\\w\\d\\.:]+:\\d+|inproc://[\\w\\d]+)"))) {
+  Impl(const std::string& address, const TlsOptions& tls)
+      : socket_(0), tls_(tls) {
+    if (!is_valid_address(address)) {
       throw std::runtime_error("Invalid address format: " + address);
     }
+    stats_ = StatsRegistry::instance().create("bus", address);
 
     int rv;
     if ((rv = nng_bus0_open(&socket_)) != 0) {
@@ -31,7 +35,7 @@ class Bus::Impl {
                                std::string(nng_strerror(rv)));
     }
     std::cout << "Bus node binding to " << address << std::endl;
-    if ((rv = nng_listen(socket_, address.c_str(), nullptr, 0)) != 0) {
+    if ((rv = listen_endpoint(socket_, address, tls)) != 0) {
       nng_close(socket_);
       throw std::runtime_error("Failed to listen on " + address + ": " +
                                std::string(nng_strerror(rv)));
@@ -47,17 +51,33 @@ class Bus::Impl {
   void send(const std::string& message) {
     nng_msg* msg;
     int rv;
-    if ((rv = nng_msg_alloc(&msg, message.size())) != 0) {
+    if ((msg = MessagePool::acquire(message.size())) == nullptr) {
+      stats_->on_error();
       throw std::runtime_error("Failed to allocate message: " +
-                               std::string(nng_strerror(rv)));
+                               std::string(nng_strerror(NNG_ENOMEM)));
     }
     memcpy(nng_msg_body(msg), message.data(), message.size());
-    std::cout << "Sending: " << message << std::endl;
+    InFlight in_flight(*stats_);
+    auto start = std::chrono::steady_clock::now();
     if ((rv = nng_sendmsg(socket_, msg, 0)) != 0) {
-      nng_msg_free(msg);
+      MessagePool::release(msg);
+      stats_->on_failure(rv == NNG_ETIMEDOUT);
       throw std::runtime_error("Failed to send message: " +
                                std::string(nng_strerror(rv)));
     }
+    stats_->latency.Record(std::chrono::steady_clock::now() - start);
+    stats_->on_send(message.size());
+  }
+
+  void connect(const std::string& address) {
+    if (!is_valid_address(address)) {
+      throw std::runtime_error("Invalid address format: " + address);
+    }
+    int rv;
+    if ((rv = dial_endpoint(socket_, address, tls_)) != 0) {
+      throw std::runtime_error("Failed to dial " + address + ": " +
+                               std::string(nng_strerror(rv)));
+    }
   }
 
   std::string receive() {
@@ -65,19 +85,18 @@ class Bus::Impl {
     for (int retry = 0; retry < max_retries; ++retry) {
       nng_msg* msg;
       int rv;
-      std::cout << "Attempting to receive message (retry " << retry + 1 << ")"
-                << std::endl;
       if ((rv = nng_recvmsg(socket_, &msg, 0)) == 0) {
+        stats_->on_receive(nng_msg_len(msg));
         std::string result(static_cast<char*>(nng_msg_body(msg)),
                            nng_msg_len(msg));
-        nng_msg_free(msg);
-        std::cout << "Received message: " << result << std::endl;
+        MessagePool::release(msg);
         return result;
       }
       if (rv == NNG_ETIMEDOUT) {
-        std::cout << "Receive timed out, retrying..." << std::endl;
+        stats_->on_timeout();
         continue;
       }
+      stats_->on_error();
       throw std::runtime_error("Failed to receive message: " +
                                std::string(nng_strerror(rv)));
     }
@@ -85,17 +104,25 @@ class Bus::Impl {
                              std::to_string(max_retries) + " retries");
   }
 
+  const SocketStats& stats() const { return *stats_; }
+
  private:
   nng_socket socket_;
+  TlsOptions tls_;  // Reused by connect()
+  std::shared_ptr<SocketStats> stats_;
 };
 
-Bus::Bus(const std::string& address)
-    : m_impl(std::make_unique<Impl>(address)) {}
+Bus::Bus(const std::string& address, const TlsOptions& tls)
+    : m_impl(std::make_unique<Impl>(address, tls)) {}
 
 Bus::~Bus() {}
 
 void Bus::send(const std::string& message) { m_impl->send(message); }
 
+void Bus::connect(const std::string& address) { m_impl->connect(address); }
+
 std::string Bus::receive() { return m_impl->receive(); }
 
+const SocketStats& Bus::stats() const { return m_impl->stats(); }
+
 }  // namespace ya::module
@@ -3,16 +3,25 @@
 
 #include <memory>
 
+#include "stats.h"
+#include "tls.h"
+
 namespace ya::module {
 
 class Bus {
  public:
-  Bus(const std::string& address);
+  // tls is used when address is tls+tcp://
+  Bus(const std::string& address, const TlsOptions& tls = {});
   ~Bus();
 
+  // Also dial another bus node, making this node a peer of both meshes
+  void connect(const std::string& address);
+
   void send(const std::string& message);
   std::string receive();
 
+  const SocketStats& stats() const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> m_impl;
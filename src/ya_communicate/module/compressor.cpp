@@ -0,0 +1,336 @@
+#include "compressor.h"
+
+#if defined(YA_HAS_LZ4)
+#include <lz4.h>
+#endif
+#if defined(YA_HAS_ZSTD)
+#include <zdict.h>
+#include <zstd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+#include "node_def.h"
+
+namespace ya::module {
+
+namespace {
+
+// Frame layout: [0xC5 'Y'] [algo:1] [original size:4, little endian] [body]
+constexpr unsigned char FRAME_MAGIC_0 = 0xC5;
+constexpr unsigned char FRAME_MAGIC_1 = 'Y';
+// Refuse to inflate frames claiming more than this, to bound a corrupt header
+constexpr uint32_t MAX_ORIGINAL_SIZE = 256u * 1024 * 1024;
+
+void write_header(std::string& out, Compressor::ALGO algo, uint32_t size) {
+  out.push_back(static_cast<char>(FRAME_MAGIC_0));
+  out.push_back(static_cast<char>(FRAME_MAGIC_1));
+  out.push_back(static_cast<char>(algo));
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<char>((size >> (8 * i)) & 0xFF));
+  }
+}
+
+uint32_t read_size(std::string_view frame) {
+  uint32_t size = 0;
+  for (int i = 0; i < 4; ++i) {
+    size |= static_cast<uint32_t>(static_cast<unsigned char>(frame[3 + i]))
+            << (8 * i);
+  }
+  return size;
+}
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+#if defined(YA_HAS_ZSTD)
+// zstd contexts are expensive to create; keep one pair per thread
+struct ZstdContexts {
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  ZSTD_DCtx* dctx = ZSTD_createDCtx();
+  ~ZstdContexts() {
+    ZSTD_freeCCtx(cctx);
+    ZSTD_freeDCtx(dctx);
+  }
+};
+
+ZstdContexts& zstd_contexts() {
+  thread_local ZstdContexts contexts;
+  return contexts;
+}
+#endif
+
+}  // namespace
+
+double Compressor::Stats::ratio() const {
+  return wire_bytes == 0 ? 1.0
+                         : static_cast<double>(raw_bytes) /
+                               static_cast<double>(wire_bytes);
+}
+
+class Compressor::Impl {
+ public:
+  Impl(const Options& options) : m_options(options) {
+    if (!is_supported(m_options.algo)) {
+      throw CommException("Compression algorithm not compiled in");
+    }
+#if defined(YA_HAS_ZSTD)
+    if (m_options.algo == ALGO::ZSTD && !m_options.dictionary.empty()) {
+      m_cdict = ZSTD_createCDict(m_options.dictionary.data(),
+                                 m_options.dictionary.size(), m_options.level);
+      m_ddict = ZSTD_createDDict(m_options.dictionary.data(),
+                                 m_options.dictionary.size());
+      if (!m_cdict || !m_ddict) {
+        ZSTD_freeCDict(m_cdict);
+        ZSTD_freeDDict(m_ddict);
+        throw CommException("Failed to load zstd dictionary");
+      }
+    }
+#endif
+  }
+
+  ~Impl() {
+#if defined(YA_HAS_ZSTD)
+    ZSTD_freeCDict(m_cdict);
+    ZSTD_freeDDict(m_ddict);
+#endif
+  }
+
+  std::string encode(std::string_view payload) {
+    auto start = std::chrono::steady_clock::now();
+    std::string out;
+    bool compressed = false;
+
+    if (m_options.algo != ALGO::NONE && payload.size() >= m_options.threshold &&
+        payload.size() <= MAX_ORIGINAL_SIZE) {
+      compressed = compress(payload, out);
+    }
+    if (!compressed) {
+      out.clear();
+      out.reserve(HEADER_SIZE + payload.size());
+      write_header(out, ALGO::NONE, static_cast<uint32_t>(payload.size()));
+      out.append(payload);
+    }
+
+    m_encoded.fetch_add(1, std::memory_order_relaxed);
+    if (compressed) {
+      m_compressed.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_raw_bytes.fetch_add(payload.size(), std::memory_order_relaxed);
+    m_wire_bytes.fetch_add(out.size(), std::memory_order_relaxed);
+    m_encode_ns.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+    return out;
+  }
+
+  std::string decode(std::string_view frame) {
+    if (!is_frame(frame)) {
+      throw CommException("Invalid compressed frame header");
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto algo = static_cast<ALGO>(static_cast<unsigned char>(frame[2]));
+    uint32_t size = read_size(frame);
+    std::string_view body = frame.substr(HEADER_SIZE);
+    if (size > MAX_ORIGINAL_SIZE) {
+      throw CommException("Compressed frame too large");
+    }
+
+    std::string out;
+    switch (algo) {
+      case ALGO::NONE:
+        if (body.size() != size) {
+          throw CommException("Truncated frame");
+        }
+        out.assign(body);
+        break;
+#if defined(YA_HAS_LZ4)
+      case ALGO::LZ4: {
+        out.resize(size);
+        int n = LZ4_decompress_safe(body.data(), out.data(),
+                                    static_cast<int>(body.size()),
+                                    static_cast<int>(size));
+        if (n < 0 || static_cast<uint32_t>(n) != size) {
+          throw CommException("LZ4 decompression failed");
+        }
+        break;
+      }
+#endif
+#if defined(YA_HAS_ZSTD)
+      case ALGO::ZSTD: {
+        out.resize(size);
+        auto& ctx = zstd_contexts();
+        size_t n = m_ddict ? ZSTD_decompress_usingDDict(
+                                 ctx.dctx, out.data(), size, body.data(),
+                                 body.size(), m_ddict)
+                           : ZSTD_decompressDCtx(ctx.dctx, out.data(), size,
+                                                 body.data(), body.size());
+        if (ZSTD_isError(n) || n != size) {
+          throw CommException("zstd decompression failed");
+        }
+        break;
+      }
+#endif
+      default:
+        throw CommException("Unsupported compression algorithm in frame");
+    }
+
+    m_decoded.fetch_add(1, std::memory_order_relaxed);
+    m_decode_ns.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+    return out;
+  }
+
+  Stats stats() const {
+    Stats s;
+    s.encoded = m_encoded.load(std::memory_order_relaxed);
+    s.compressed = m_compressed.load(std::memory_order_relaxed);
+    s.decoded = m_decoded.load(std::memory_order_relaxed);
+    s.raw_bytes = m_raw_bytes.load(std::memory_order_relaxed);
+    s.wire_bytes = m_wire_bytes.load(std::memory_order_relaxed);
+    s.encode_ns = m_encode_ns.load(std::memory_order_relaxed);
+    s.decode_ns = m_decode_ns.load(std::memory_order_relaxed);
+    return s;
+  }
+
+  const Options& options() const { return m_options; }
+
+ private:
+  // Compress payload into out; false if the result would not be smaller
+  bool compress(std::string_view payload, std::string& out) {
+    switch (m_options.algo) {
+#if defined(YA_HAS_LZ4)
+      case ALGO::LZ4: {
+        int bound = LZ4_compressBound(static_cast<int>(payload.size()));
+        out.resize(HEADER_SIZE + bound);
+        int n = LZ4_compress_fast(payload.data(), out.data() + HEADER_SIZE,
+                                  static_cast<int>(payload.size()), bound,
+                                  std::max(1, m_options.level));
+        if (n <= 0 || static_cast<size_t>(n) >= payload.size()) {
+          return false;
+        }
+        out.resize(HEADER_SIZE + n);
+        break;
+      }
+#endif
+#if defined(YA_HAS_ZSTD)
+      case ALGO::ZSTD: {
+        size_t bound = ZSTD_compressBound(payload.size());
+        out.resize(HEADER_SIZE + bound);
+        auto& ctx = zstd_contexts();
+        size_t n =
+            m_cdict ? ZSTD_compress_usingCDict(ctx.cctx, out.data() + HEADER_SIZE,
+                                               bound, payload.data(),
+                                               payload.size(), m_cdict)
+                    : ZSTD_compressCCtx(ctx.cctx, out.data() + HEADER_SIZE,
+                                        bound, payload.data(), payload.size(),
+                                        m_options.level);
+        if (ZSTD_isError(n) || n >= payload.size()) {
+          return false;
+        }
+        out.resize(HEADER_SIZE + n);
+        break;
+      }
+#endif
+      default:
+        return false;
+    }
+
+    std::string header;
+    write_header(header, m_options.algo,
+                 static_cast<uint32_t>(payload.size()));
+    std::memcpy(out.data(), header.data(), HEADER_SIZE);
+    return true;
+  }
+
+  Options m_options;
+#if defined(YA_HAS_ZSTD)
+  ZSTD_CDict* m_cdict = nullptr;
+  ZSTD_DDict* m_ddict = nullptr;
+#endif
+  std::atomic<uint64_t> m_encoded{0};
+  std::atomic<uint64_t> m_compressed{0};
+  std::atomic<uint64_t> m_decoded{0};
+  std::atomic<uint64_t> m_raw_bytes{0};
+  std::atomic<uint64_t> m_wire_bytes{0};
+  std::atomic<uint64_t> m_encode_ns{0};
+  std::atomic<uint64_t> m_decode_ns{0};
+};
+
+Compressor::Compressor(const Options& options)
+    : m_impl(std::make_unique<Impl>(options)) {}
+
+Compressor::~Compressor() {}
+
+std::string Compressor::encode(std::string_view payload) {
+  return m_impl->encode(payload);
+}
+
+std::string Compressor::decode(std::string_view frame) {
+  return m_impl->decode(frame);
+}
+
+Compressor::Stats Compressor::stats() const { return m_impl->stats(); }
+
+const Compressor::Options& Compressor::options() const {
+  return m_impl->options();
+}
+
+bool Compressor::is_frame(std::string_view data) {
+  return data.size() >= HEADER_SIZE &&
+         static_cast<unsigned char>(data[0]) == FRAME_MAGIC_0 &&
+         static_cast<unsigned char>(data[1]) == FRAME_MAGIC_1;
+}
+
+bool Compressor::is_supported(ALGO algo) {
+  switch (algo) {
+    case ALGO::NONE:
+      return true;
+    case ALGO::LZ4:
+#if defined(YA_HAS_LZ4)
+      return true;
+#else
+      return false;
+#endif
+    case ALGO::ZSTD:
+#if defined(YA_HAS_ZSTD)
+      return true;
+#else
+      return false;
+#endif
+  }
+  return false;
+}
+
+std::string Compressor::train_dictionary(
+    const std::vector<std::string>& samples, size_t dict_size) {
+#if defined(YA_HAS_ZSTD)
+  std::string buffer;
+  std::vector<size_t> sizes;
+  sizes.reserve(samples.size());
+  for (const auto& sample : samples) {
+    buffer.append(sample);
+    sizes.push_back(sample.size());
+  }
+
+  std::string dict(dict_size, '\0');
+  size_t n = ZDICT_trainFromBuffer(dict.data(), dict.size(), buffer.data(),
+                                   sizes.data(),
+                                   static_cast<unsigned>(sizes.size()));
+  if (ZDICT_isError(n)) {
+    throw CommException("Failed to train zstd dictionary: " +
+                        std::string(ZDICT_getErrorName(n)));
+  }
+  dict.resize(n);
+  return dict;
+#else
+  (void)samples;
+  (void)dict_size;
+  throw CommException("zstd support not compiled in");
+#endif
+}
+
+}  // namespace ya::module
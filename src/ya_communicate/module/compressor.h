@@ -0,0 +1,76 @@
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ya::module {
+
+// Transparent payload compression for the communicate modules.
+//
+// Every encoded payload is wrapped in a small self-describing frame
+// (magic, algorithm, original size), so a receiving socket decodes whatever
+// the sending side picked without a separate handshake. Payloads below the
+// threshold, or that do not shrink, are framed as NONE and sent as-is.
+class Compressor {
+ public:
+  enum class ALGO : uint8_t { NONE = 0, LZ4 = 1, ZSTD = 2 };
+
+  struct Options {
+    ALGO algo = ALGO::NONE;
+    size_t threshold = 256;  // Smaller payloads are never compressed
+    int level = 1;           // zstd level, or lz4 acceleration
+    std::string dictionary;  // Shared zstd dictionary (see train_dictionary)
+  };
+
+  struct Stats {
+    uint64_t encoded = 0;        // Payloads passed through encode()
+    uint64_t compressed = 0;     // Of those, how many were compressed
+    uint64_t decoded = 0;        // Frames passed through decode()
+    uint64_t raw_bytes = 0;      // Payload bytes before encode()
+    uint64_t wire_bytes = 0;     // Frame bytes after encode()
+    uint64_t encode_ns = 0;      // CPU time spent encoding
+    uint64_t decode_ns = 0;      // CPU time spent decoding
+
+    double ratio() const;
+  };
+
+  static constexpr size_t HEADER_SIZE = 7;
+
+  explicit Compressor(const Options& options);
+  ~Compressor();
+
+  // Wrap payload into a frame, compressing it when worthwhile
+  std::string encode(std::string_view payload);
+
+  // Unwrap a frame produced by encode(); throws CommException if corrupt
+  std::string decode(std::string_view frame);
+
+  Stats stats() const;
+  const Options& options() const;
+
+  // Whether data starts with a compressor frame header
+  static bool is_frame(std::string_view data);
+
+  // Whether the algorithm was compiled in
+  static bool is_supported(ALGO algo);
+
+  // Train a zstd dictionary from representative small messages
+  static std::string train_dictionary(const std::vector<std::string>& samples,
+                                      size_t dict_size = 16 * 1024);
+
+  // Prevent copying
+  Compressor(const Compressor&) = delete;
+  Compressor& operator=(const Compressor&) = delete;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+}  // namespace ya::module
+
+#endif
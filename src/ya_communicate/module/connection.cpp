@@ -0,0 +1,73 @@
+#include "connection.h"
+
+#include <algorithm>
+#include <random>
+
+namespace ya::module {
+
+const char* to_string(CONNECTION_STATE state) {
+  switch (state) {
+    case CONNECTION_STATE::CONNECTING:
+      return "connecting";
+    case CONNECTION_STATE::CONNECTED:
+      return "connected";
+    case CONNECTION_STATE::RECONNECTING:
+      return "reconnecting";
+  }
+  return "unknown";
+}
+
+std::chrono::milliseconds ReconnectPolicy::jittered(
+    std::chrono::milliseconds base) const {
+  double spread = std::clamp(jitter, 0.0, 1.0);
+  if (spread == 0 || base.count() == 0) {
+    return base;
+  }
+  thread_local std::mt19937 rng{std::random_device{}()};
+  std::uniform_real_distribution<double> factor(1 - spread, 1 + spread);
+  return std::chrono::milliseconds(
+      std::max<long long>(1, static_cast<long long>(base.count() * factor(rng))));
+}
+
+ConnectionTracker::ConnectionTracker(std::string address,
+                                     ConnectionCallback callback)
+    : m_address(std::move(address)), m_callback(std::move(callback)) {
+  m_info.since = std::chrono::steady_clock::now();
+}
+
+ConnectionInfo ConnectionTracker::info() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_info;
+}
+
+void ConnectionTracker::on_pipe(bool added, uint32_t pipe) {
+  ConnectionEvent event;
+  event.type = added ? ConnectionEvent::TYPE::CONNECTED
+                     : ConnectionEvent::TYPE::DISCONNECTED;
+  event.address = m_address;
+  event.pipe = pipe;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CONNECTION_STATE previous = m_info.state;
+    if (added) {
+      ++m_info.pipes;
+      ++m_info.connects;
+      m_info.state = CONNECTION_STATE::CONNECTED;
+    } else if (m_info.pipes > 0) {
+      --m_info.pipes;
+      ++m_info.disconnects;
+      if (m_info.pipes == 0) {
+        m_info.state = CONNECTION_STATE::RECONNECTING;
+      }
+    }
+    if (m_info.state != previous) {
+      m_info.since = std::chrono::steady_clock::now();
+    }
+    event.pipes = m_info.pipes;
+  }
+  if (m_callback) {
+    m_callback(event);
+  }
+}
+
+}  // namespace ya::module
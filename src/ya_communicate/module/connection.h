@@ -0,0 +1,81 @@
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace ya::module {
+
+enum class CONNECTION_STATE {
+  CONNECTING,    // No peer yet
+  CONNECTED,     // At least one live pipe
+  RECONNECTING,  // Was connected, every pipe has gone away
+};
+
+const char* to_string(CONNECTION_STATE state);
+
+struct ConnectionEvent {
+  enum class TYPE { CONNECTED, DISCONNECTED };
+
+  TYPE type = TYPE::CONNECTED;
+  std::string address;  // Endpoint of the socket
+  uint32_t pipe = 0;    // nng pipe id
+  size_t pipes = 0;     // Live pipes after this event
+};
+
+// Runs on an nng thread, keep it short and do not call back into the socket
+using ConnectionCallback = std::function<void(const ConnectionEvent&)>;
+
+// How a dialing socket connects and redials.
+//
+// nng redials a lost peer by itself, doubling the wait from min_interval up
+// to max_interval. Both are scaled by a random factor in [1 - jitter,
+// 1 + jitter] per socket, so clients that lost the same server during a
+// rolling restart do not all come back in the same instant.
+struct ReconnectPolicy {
+  std::chrono::milliseconds min_interval{100};
+  std::chrono::milliseconds max_interval{5000};  // 0 = no backoff
+  double jitter = 0.2;
+
+  // true: the constructor fails if the peer is not up (the old behaviour).
+  // false: return at once and keep dialing in the background; sends queue
+  // until connected and connection() tells where things stand.
+  bool wait_for_peer = true;
+
+  ConnectionCallback on_event;
+
+  // base scaled by a random factor in [1 - jitter, 1 + jitter]
+  std::chrono::milliseconds jittered(std::chrono::milliseconds base) const;
+};
+
+struct ConnectionInfo {
+  CONNECTION_STATE state = CONNECTION_STATE::CONNECTING;
+  size_t pipes = 0;
+  uint64_t connects = 0;
+  uint64_t disconnects = 0;
+  std::chrono::steady_clock::time_point since;  // Last state change
+};
+
+// Follows the pipes of one socket. Fed by nng pipe notifications, see
+// track_connections() in endpoint.h.
+class ConnectionTracker {
+ public:
+  ConnectionTracker(std::string address, ConnectionCallback callback);
+
+  ConnectionInfo info() const;
+
+  void on_pipe(bool added, uint32_t pipe);
+
+ private:
+  std::string m_address;
+  ConnectionCallback m_callback;
+  mutable std::mutex m_mutex;
+  ConnectionInfo m_info;
+};
+
+}  // namespace ya::module
+
+#endif
@@ -0,0 +1,106 @@
+#include "endpoint.h"
+
+#include <nng/supplemental/tls/tls.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace ya::module {
+
+namespace {
+
+// Endpoint helpers report through nng error codes like the calls they
+// replace, so callers keep their cleanup paths
+std::shared_ptr<TlsContext> context_for(TLS_MODE mode, const TlsOptions& tls,
+                                        const std::string& address) {
+  try {
+    return TlsCache::instance().get(mode, tls);
+  } catch (const std::exception& e) {
+    fprintf(stderr, "TLS setup for %s failed: %s\n", address.c_str(),
+            e.what());
+    return nullptr;
+  }
+}
+
+void on_pipe_event(nng_pipe pipe, nng_pipe_ev event, void* arg) {
+  static_cast<ConnectionTracker*>(arg)->on_pipe(
+      event == NNG_PIPE_EV_ADD_POST, static_cast<uint32_t>(nng_pipe_id(pipe)));
+}
+
+}  // namespace
+
+int dial_endpoint(nng_socket socket, const std::string& address,
+                  const TlsOptions& tls, nng_dialer* dialer,
+                  const ReconnectPolicy& policy) {
+  std::shared_ptr<TlsContext> context;
+  if (is_tls_address(address)) {
+    context = context_for(TLS_MODE::CLIENT, tls, address);
+    if (!context) {
+      return NNG_ECRYPTO;
+    }
+  }
+  nng_dialer d;
+  int rv;
+  if ((rv = nng_dialer_create(&d, socket, address.c_str())) != 0) {
+    return rv;
+  }
+  auto min_interval = policy.jittered(policy.min_interval);
+  auto max_interval = policy.jittered(policy.max_interval);
+  if ((context && (rv = nng_dialer_set_ptr(d, NNG_OPT_TLS_CONFIG,
+                                           context->native())) != 0) ||
+      (rv = nng_dialer_set_ms(d, NNG_OPT_RECONNMINT,
+                              static_cast<nng_duration>(
+                                  min_interval.count()))) != 0 ||
+      (rv = nng_dialer_set_ms(d, NNG_OPT_RECONNMAXT,
+                              static_cast<nng_duration>(
+                                  std::max(max_interval, min_interval)
+                                      .count()))) != 0 ||
+      (rv = nng_dialer_start(d, policy.wait_for_peer ? 0
+                                                     : NNG_FLAG_NONBLOCK)) !=
+          0) {
+    nng_dialer_close(d);
+    return rv;
+  }
+  if (dialer != nullptr) {
+    *dialer = d;
+  }
+  return 0;
+}
+
+int listen_endpoint(nng_socket socket, const std::string& address,
+                    const TlsOptions& tls, nng_listener* listener,
+                    int flags) {
+  if (!is_tls_address(address)) {
+    return nng_listen(socket, address.c_str(), listener, flags);
+  }
+  auto context = context_for(TLS_MODE::SERVER, tls, address);
+  if (!context) {
+    return NNG_ECRYPTO;
+  }
+  nng_listener l;
+  int rv;
+  if ((rv = nng_listener_create(&l, socket, address.c_str())) != 0) {
+    return rv;
+  }
+  if ((rv = nng_listener_set_ptr(l, NNG_OPT_TLS_CONFIG, context->native())) !=
+          0 ||
+      (rv = nng_listener_start(l, flags)) != 0) {
+    nng_listener_close(l);
+    return rv;
+  }
+  if (listener != nullptr) {
+    *listener = l;
+  }
+  return 0;
+}
+
+int track_connections(nng_socket socket, ConnectionTracker* tracker) {
+  int rv;
+  if ((rv = nng_pipe_notify(socket, NNG_PIPE_EV_ADD_POST, on_pipe_event,
+                            tracker)) != 0) {
+    return rv;
+  }
+  return nng_pipe_notify(socket, NNG_PIPE_EV_REM_POST, on_pipe_event, tracker);
+}
+
+}  // namespace ya::module
@@ -0,0 +1,33 @@
+#ifndef ENDPOINT_H
+#define ENDPOINT_H
+
+#include <nng/nng.h>
+
+#include <string>
+
+#include "connection.h"
+#include "tls.h"
+
+namespace ya::module {
+
+// nng_dial/nng_listen that attach a shared TLS context (client side for
+// dialers, server side for listeners) when the address is tls+tcp://.
+// Return an nng error code like the functions they replace; a TLS context
+// that cannot be built (unreadable or invalid PEM) is NNG_ECRYPTO.
+//
+// Dialers also take their redial timing from policy, and only wait for the
+// first connection when policy.wait_for_peer is set.
+int dial_endpoint(nng_socket socket, const std::string& address,
+                  const TlsOptions& tls, nng_dialer* dialer = nullptr,
+                  const ReconnectPolicy& policy = {});
+int listen_endpoint(nng_socket socket, const std::string& address,
+                    const TlsOptions& tls, nng_listener* listener = nullptr,
+                    int flags = 0);
+
+// Feeds pipe add/remove notifications of socket into tracker, which must
+// outlive the socket. Call before dialing so the first connect is seen.
+int track_connections(nng_socket socket, ConnectionTracker* tracker);
+
+}  // namespace ya::module
+
+#endif
@@ -5,47 +5,375 @@
 #include <nng/supplemental/tls/tls.h>
 
 #include <atomic>
-#include <cstring>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 
 #include "node_def.h"
+#include "runtime.h"
 
 namespace ya::module {
 
-class Http::Impl {
+namespace {
+
+constexpr size_t MAX_REQUEST_BODY = 4 * 1024 * 1024;
+constexpr int STREAM_WRITE_TIMEOUT_MS = 10000;
+
+// nng offers no header iteration, and the request is gone once a stream
+// hijacks the connection, so these are copied for stream handlers
+constexpr const char* STREAM_HEADERS[] = {"Accept", "Authorization",
+                                          "Last-Event-ID", "User-Agent"};
+
+std::string read_file(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw CommException("Failed to open " + path);
+  }
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+std::string error_body(std::string_view message) {
+  std::string body = "{\"error\": \"";
+  for (char c : message) {
+    if (c == '"' || c == '\\') {
+      body += '\\';
+    }
+    body += c;
+  }
+  return body + "\"}";
+}
+
+const char* reason_of(int status) {
+  switch (status) {
+    case 200:
+      return "OK";
+    case 201:
+      return "Created";
+    case 204:
+      return "No Content";
+    case 400:
+      return "Bad Request";
+    case 404:
+      return "Not Found";
+    case 405:
+      return "Method Not Allowed";
+    case 500:
+      return "Internal Server Error";
+    default:
+      return "";
+  }
+}
+
+std::string stream_head(const std::string& content_type) {
+  return "HTTP/1.1 200 OK\r\n"
+         "Content-Type: " +
+         content_type +
+         "\r\n"
+         "Cache-Control: no-cache\r\n"
+         "Transfer-Encoding: chunked\r\n"
+         "Connection: close\r\n\r\n";
+}
+
+void append_chunk(std::string& out, std::string_view chunk) {
+  char size[24];
+  int len = std::snprintf(size, sizeof(size), "%zx\r\n", chunk.size());
+  out.append(size, static_cast<size_t>(len));
+  out.append(chunk);
+  out.append("\r\n");
+}
+
+// Writes chunks straight to a hijacked connection
+class ChunkedStream : public HttpStream {
  public:
-  Impl() {}
-  ~Impl() {}
+  ChunkedStream(nng_http_conn* conn, const std::atomic<bool>& running)
+      : conn_(conn), running_(running) {
+    if (nng_aio_alloc(&aio_, nullptr, nullptr) != 0) {
+      aio_ = nullptr;
+      ok_ = false;
+      return;
+    }
+    nng_aio_set_timeout(aio_, STREAM_WRITE_TIMEOUT_MS);
+  }
 
-  static void handle_nodes_request(nng_aio* aio) {
-    auto* req = static_cast<nng_http_req*>(nng_aio_get_input(aio, 0));
-    nng_http_res* res = nullptr;
-    if (nng_http_res_alloc(&res) != 0) {
-      nng_aio_finish(aio, NNG_ENOMEM);
+  ~ChunkedStream() override {
+    if (ok_) {
+      std::string_view last = "0\r\n\r\n";
+      send_raw(last);
+    }
+    if (aio_ != nullptr) {
+      nng_aio_free(aio_);
+    }
+    nng_http_conn_close(conn_);
+  }
+
+  bool begin(const std::string& content_type) {
+    return send_raw(stream_head(content_type));
+  }
+
+  bool write(std::string_view chunk) override {
+    if (!open()) {
+      ok_ = false;
+      return false;
+    }
+    if (chunk.empty()) {
+      return true;  // A zero-length chunk would end the body
+    }
+    char size[24];
+    int len = std::snprintf(size, sizeof(size), "%zx\r\n", chunk.size());
+    nng_iov iov[3] = {
+        {size, static_cast<size_t>(len)},
+        {const_cast<char*>(chunk.data()), chunk.size()},
+        {const_cast<char*>("\r\n"), 2},
+    };
+    return send(iov, 3);
+  }
+
+  bool open() const override { return ok_ && running_; }
+
+ private:
+  bool send_raw(std::string_view data) {
+    nng_iov iov = {const_cast<char*>(data.data()), data.size()};
+    return send(&iov, 1);
+  }
+
+  bool send(nng_iov* iov, unsigned count) {
+    if (aio_ == nullptr || nng_aio_set_iov(aio_, count, iov) != 0) {
+      return ok_ = false;
+    }
+    nng_http_conn_write_all(conn_, aio_);
+    nng_aio_wait(aio_);
+    return ok_ = nng_aio_result(aio_) == 0;
+  }
+
+  nng_http_conn* conn_;
+  nng_aio* aio_ = nullptr;
+  const std::atomic<bool>& running_;
+  bool ok_ = true;
+};
+
+// Chunks written while a send is in flight are framed into one buffer and go
+// out together when it completes, so a slow client costs memory, not a
+// thread. The aio callback reports completions through on_ready().
+class PushStream : public HttpPushStream {
+ public:
+  explicit PushStream(nng_http_conn* conn) : conn_(conn) {}
+
+  ~PushStream() override {
+    shutdown();
+    if (aio_ != nullptr) {
+      nng_aio_free(aio_);
+    }
+  }
+
+  bool begin(const std::string& content_type) {
+    if (nng_aio_alloc(&aio_, on_sent, this) != 0) {
+      aio_ = nullptr;
+      closed_ = true;
+      return false;
+    }
+    nng_aio_set_timeout(aio_, STREAM_WRITE_TIMEOUT_MS);
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_ = stream_head(content_type);
+    send();
+    return true;
+  }
+
+  bool write(std::string_view chunk) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_ || closing_) {
+      return false;
+    }
+    if (chunk.empty()) {
+      return true;  // A zero-length chunk would end the body
+    }
+    append_chunk(queued_, chunk);
+    send();
+    return true;
+  }
+
+  bool open() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !closed_ && !closing_;
+  }
+
+  bool busy() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sending_ || !queued_.empty();
+  }
+
+  void on_ready(std::function<void()> callback) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_ = std::move(callback);
+  }
+
+  void close() override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_ || closing_) {
       return;
     }
-    std::string response = "{}";
-    nng_http_res_set_status(res, NNG_HTTP_STATUS_OK);
-    nng_http_res_set_header(res, "Content-Type", "application/json");
-    nng_http_res_copy_data(res, response.c_str(), response.size());
-    nng_aio_set_output(aio, 0, res);
-    nng_aio_finish(aio, 0);
+    closing_ = true;
+    queued_ += "0\r\n\r\n";
+    send();
   }
 
-  static void handle_status_request(nng_aio* aio) {
-    auto* req = static_cast<nng_http_req*>(nng_aio_get_input(aio, 0));
-    nng_http_res* res = nullptr;
-    if (nng_http_res_alloc(&res) != 0) {
-      nng_aio_finish(aio, NNG_ENOMEM);
+  // Once the terminator has gone out or the client is gone
+  bool finished() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_ && !sending_;
+  }
+
+  // Aborts a pending send and drops the connection; must not run on the aio
+  // callback
+  void shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+      queued_.clear();
+    }
+    if (aio_ != nullptr) {
+      nng_aio_stop(aio_);  // Waits for a running callback
+    }
+    if (conn_ != nullptr) {
+      nng_http_conn_close(conn_);
+      conn_ = nullptr;
+    }
+  }
+
+ private:
+  static void on_sent(void* arg) { static_cast<PushStream*>(arg)->sent(); }
+
+  void sent() {
+    std::function<void()> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      sending_ = false;
+      if (nng_aio_result(aio_) != 0) {
+        closed_ = true;
+        queued_.clear();
+      } else if (!queued_.empty()) {
+        send();
+        return;
+      } else if (closing_) {
+        closed_ = true;
+      }
+      ready = ready_;
+    }
+    if (ready) {
+      ready();
+    }
+  }
+
+  // Called with mutex_ held; nng completes the aio on its own threads, never
+  // inside nng_http_conn_write_all, so holding the lock here is safe
+  void send() {
+    if (sending_ || queued_.empty() || closed_) {
       return;
     }
+    in_flight_.swap(queued_);
+    queued_.clear();
+    nng_iov iov = {in_flight_.data(), in_flight_.size()};
+    nng_aio_set_iov(aio_, 1, &iov);
+    sending_ = true;
+    nng_http_conn_write_all(conn_, aio_);
+  }
 
-    const char* body = "{\"status\": \"ok\"}";
-    nng_http_res_set_status(res, NNG_HTTP_STATUS_OK);
-    nng_http_res_set_header(res, "Content-Type", "application/json");
-    nng_http_res_copy_data(res, body, strlen(body));
-    nng_aio_set_output(aio, 0, res);
-    nng_aio_finish(aio, 0);
+  nng_http_conn* conn_;
+  nng_aio* aio_ = nullptr;
+  mutable std::mutex mutex_;
+  std::string queued_;
+  std::string in_flight_;  // Owned by the aio while sending_
+  std::function<void()> ready_;
+  bool sending_ = false;
+  bool closing_ = false;
+  bool closed_ = false;
+};
+
+// Stream handlers outlive the nng request, so they get their own copy
+struct OwnedRequest {
+  std::string method;
+  std::string path;
+  std::string query;
+  std::string body;
+  std::vector<std::pair<std::string, std::string>> params;
+  std::vector<std::pair<std::string, std::string>> headers;
+
+  HttpRequest view() const {
+    HttpRequest request;
+    request.method = method;
+    request.path = path;
+    request.query = query;
+    request.body = body;
+    for (const auto& [name, value] : params) {
+      request.params.emplace_back(name, value);
+    }
+    request.header = [this](const char* name) -> std::string_view {
+      for (const auto& [key, value] : headers) {
+        if (key == name) {
+          return value;
+        }
+      }
+      return {};
+    };
+    return request;
+  }
+};
+
+}  // namespace
+
+class Http::Impl {
+ public:
+  Impl() { m_stats = StatsRegistry::instance().create("http", ""); }
+
+  ~Impl() { stop(); }
+
+  void set_tls(const std::string& cert_file, const std::string& key_file) {
+    if (m_http_running) {
+      throw CommException("TLS must be configured before the server starts");
+    }
+    m_cert_file = cert_file;
+    m_key_file = key_file;
+  }
+
+  void route(const std::string& method, const std::string& pattern,
+             HttpHandler handler) {
+    if (m_http_running) {
+      throw CommException("Routes must be added before the server starts");
+    }
+    m_router.add(method, pattern,
+                 HttpRoute{std::move(handler), {}, {}, {}});
+  }
+
+  void stream(const std::string& method, const std::string& pattern,
+              HttpStreamHandler handler, const std::string& content_type) {
+    if (m_http_running) {
+      throw CommException("Routes must be added before the server starts");
+    }
+    m_router.add(method, pattern,
+                 HttpRoute{{}, std::move(handler), {}, content_type});
+  }
+
+  void push_stream(const std::string& method, const std::string& pattern,
+                   HttpPushHandler handler, const std::string& content_type) {
+    if (m_http_running) {
+      throw CommException("Routes must be added before the server starts");
+    }
+    m_router.add(method, pattern,
+                 HttpRoute{{}, {}, std::move(handler), content_type});
+  }
+
+  static void dispatch(nng_aio* aio) {
+    auto* req = static_cast<nng_http_req*>(nng_aio_get_input(aio, 0));
+    auto* handler = static_cast<nng_http_handler*>(nng_aio_get_input(aio, 1));
+    auto* self = static_cast<Impl*>(nng_http_handler_get_data(handler));
+    self->handle(aio, req);
   }
 
   void start(int port) {
@@ -53,7 +381,11 @@ class Http::Impl {
       throw CommException("HTTP server is already running");
     }
 
-    std::string addr = "http://0.0.0.0:" + std::to_string(port);
+    add_builtin_routes();
+
+    bool tls = !m_cert_file.empty() && !m_key_file.empty();
+    std::string addr =
+        (tls ? "https://0.0.0.0:" : "http://0.0.0.0:") + std::to_string(port);
     nng_url* url = nullptr;
 
     // Parse URL
@@ -62,117 +394,384 @@ class Http::Impl {
     }
 
     // Allocate HTTP server
-    if (nng_http_server_hold(&m_http_server, url) != 0) {
+    if ((m_rv = nng_http_server_hold(&m_http_server, url)) != 0) {
       nng_url_free(url);
-      throw CommException("Failed to create HTTP server");
+      throw CommException("Failed to create HTTP server: " +
+                          std::string(nng_strerror(m_rv)));
     }
+    nng_url_free(url);
 
-    // Configure TLS if cert_file and key_file were provided
-    if (!m_cert_file.empty() && !m_key_file.empty()) {
-      nng_tls_config* tls_config;
-      if ((m_rv = nng_tls_config_alloc(&tls_config, NNG_TLS_MODE_SERVER)) !=
-          0) {
-        nng_http_server_release(m_http_server);
-        nng_url_free(url);
-        throw CommException("Failed to allocate TLS config for HTTP");
+    try {
+      if (tls) {
+        configure_tls();
       }
-      if ((m_rv = nng_tls_config_own_cert(tls_config, m_cert_file.c_str(),
-                                          m_key_file.c_str(), nullptr)) != 0) {
-        nng_tls_config_free(tls_config);
-        nng_http_server_release(m_http_server);
-        nng_url_free(url);
-        throw CommException("Failed to load TLS cert for HTTP");
+
+      // Everything goes through one tree handler and our router
+      nng_http_handler* handler = nullptr;
+      if ((m_rv = nng_http_handler_alloc(&handler, "/", dispatch)) != 0) {
+        throw CommException("Failed to create HTTP handler: " +
+                            std::string(nng_strerror(m_rv)));
       }
-      if ((m_rv = nng_http_server_set_tls(m_http_server, tls_config)) != 0) {
-        nng_tls_config_free(tls_config);
-        nng_http_server_release(m_http_server);
-        nng_url_free(url);
-        throw CommException("Failed to set TLS config for HTTP");
+      nng_http_handler_set_tree(handler);
+      nng_http_handler_set_method(handler, nullptr);  // Any method
+      nng_http_handler_collect_body(handler, true, MAX_REQUEST_BODY);
+      nng_http_handler_set_data(handler, this, nullptr);
+      if ((m_rv = nng_http_server_add_handler(m_http_server, handler)) != 0) {
+        nng_http_handler_free(handler);
+        throw CommException("Failed to add HTTP handler: " +
+                            std::string(nng_strerror(m_rv)));
       }
-    }
+      // The server owns the handler from here on
 
-    // Allocate handler for /status
-    if (nng_http_handler_alloc(&m_http_handler_status, "/status",
-                               handle_status_request) != 0) {
+      m_stats->set_address(addr);  // stats() references stay valid
+      m_http_running = true;
+      if ((m_rv = nng_http_server_start(m_http_server)) != 0) {
+        m_http_running = false;
+        throw CommException("Failed to start HTTP server: " +
+                            std::string(nng_strerror(m_rv)));
+      }
+    } catch (...) {
       nng_http_server_release(m_http_server);
-      nng_url_free(url);
-      throw CommException("Failed to create HTTP status handler");
+      m_http_server = nullptr;
+      throw;
     }
-    nng_http_handler_set_method(m_http_handler_status, "GET");
-    nng_http_handler_set_data(m_http_handler_status, this, nullptr);
-    if (nng_http_server_add_handler(m_http_server, m_http_handler_status) !=
-        0) {
-      nng_http_handler_free(m_http_handler_status);
-      nng_http_server_release(m_http_server);
-      nng_url_free(url);
-      throw CommException("Failed to add HTTP status handler");
+  }
+
+  void stop() {
+    if (!m_http_running) return;
+
+    m_http_running = false;
+    if (m_http_server) {
+      nng_http_server_stop(m_http_server);
+      nng_http_server_release(m_http_server);  // Frees the handler too
+      m_http_server = nullptr;
     }
 
-    // Allocate handler for /nodes
-    if (nng_http_handler_alloc(&m_http_handler_nodes, "/nodes",
-                               handle_nodes_request) != 0) {
-      nng_http_handler_free(m_http_handler_status);
-      nng_http_server_release(m_http_server);
-      nng_url_free(url);
-      throw CommException("Failed to create HTTP nodes handler");
+    // Streams notice m_http_running on their next write
+    std::list<Stream> streams;
+    {
+      std::lock_guard<std::mutex> lock(m_streams_mutex);
+      streams.swap(m_streams);
     }
-    nng_http_handler_set_method(m_http_handler_nodes, "GET");
-    nng_http_handler_set_data(m_http_handler_nodes, this, nullptr);
-    if (nng_http_server_add_handler(m_http_server, m_http_handler_nodes) != 0) {
-      nng_http_handler_free(m_http_handler_status);
-      nng_http_handler_free(m_http_handler_nodes);
-      nng_http_server_release(m_http_server);
-      nng_url_free(url);
-      throw CommException("Failed to add HTTP nodes handler");
+    for (auto& stream : streams) {
+      stream.thread.join();
     }
 
-    // Start the server
-    if (nng_http_server_start(m_http_server) != 0) {
-      nng_http_handler_free(m_http_handler_status);
-      nng_http_handler_free(m_http_handler_nodes);
-      nng_http_server_release(m_http_server);
-      nng_url_free(url);
-      throw CommException("Failed to start HTTP server");
+    // Holders may keep their references, writes fail from here on
+    std::list<std::shared_ptr<PushStream>> pushes;
+    {
+      std::lock_guard<std::mutex> lock(m_streams_mutex);
+      pushes.swap(m_pushes);
+    }
+    for (auto& push : pushes) {
+      push->shutdown();
     }
+  }
 
-    nng_url_free(url);
+  bool running() const { return m_http_running; }
+
+  const SocketStats& stats() const { return *m_stats; }
+
+ private:
+  // Registered last so applications can provide their own versions
+  void add_builtin_routes() {
+    if (!m_router.contains("GET", "/status")) {
+      route("GET", "/status", [](const HttpRequest&, HttpResponse& res) {
+        res.set_body_ref("{\"status\": \"ok\"}");
+      });
+    }
+    if (!m_router.contains("GET", "/nodes")) {
+      route("GET", "/nodes", [](const HttpRequest&, HttpResponse& res) {
+        res.set_body_ref("{}");
+      });
+    }
+    if (!m_router.contains("GET", "/metrics")) {
+      route("GET", "/metrics", [](const HttpRequest&, HttpResponse& res) {
+        res.content_type = "text/plain; version=0.0.4; charset=utf-8";
+        res.set_body(StatsRegistry::instance().to_prometheus());
+      });
+    }
+    if (!m_router.contains("GET", "/threads")) {
+      route("GET", "/threads", [](const HttpRequest&, HttpResponse& res) {
+        res.content_type = "text/plain; charset=utf-8";
+        res.set_body(Runtime::report());
+      });
+    }
   }
 
-  void stop() {
-    if (!m_http_running) return;
+  void configure_tls() {
+    nng_tls_config* tls_config;
+    if ((m_rv = nng_tls_config_alloc(&tls_config, NNG_TLS_MODE_SERVER)) != 0) {
+      throw CommException("Failed to allocate TLS config for HTTP");
+    }
+    std::string cert = read_file(m_cert_file);
+    std::string key = read_file(m_key_file);
+    if ((m_rv = nng_tls_config_own_cert(tls_config, cert.c_str(), key.c_str(),
+                                        nullptr)) != 0) {
+      nng_tls_config_free(tls_config);
+      throw CommException("Failed to load TLS cert for HTTP: " +
+                          std::string(nng_strerror(m_rv)));
+    }
+    m_rv = nng_http_server_set_tls(m_http_server, tls_config);
+    nng_tls_config_free(tls_config);  // The server holds its own reference
+    if (m_rv != 0) {
+      throw CommException("Failed to set TLS config for HTTP: " +
+                          std::string(nng_strerror(m_rv)));
+    }
+  }
 
-    m_http_running = false;
-    if (m_http_server) {
-      nng_http_server_stop(m_http_server);
-      nng_http_server_release(m_http_server);
+  void handle(nng_aio* aio, nng_http_req* req) {
+    auto start = std::chrono::steady_clock::now();
+    std::string_view uri = nng_http_req_get_uri(req);
+    size_t query = uri.find('?');
+
+    HttpRequest request;
+    request.method = nng_http_req_get_method(req);
+    request.path = uri.substr(0, query);
+    if (query != std::string_view::npos) {
+      request.query = uri.substr(query + 1);
+    }
+    void* data = nullptr;
+    size_t size = 0;
+    nng_http_req_get_data(req, &data, &size);
+    request.body = std::string_view(static_cast<char*>(data), size);
+    request.header = [req](const char* name) -> std::string_view {
+      const char* value = nng_http_req_get_header(req, name);
+      return value != nullptr ? value : std::string_view();
+    };
+    m_stats->on_receive(size);
+
+    HttpResponse response;
+    const HttpRoute* route = nullptr;
+    switch (m_router.find(request.method, request.path, route,
+                          request.params)) {
+      case HttpRouter::MATCH::NOT_FOUND:
+        response.status = 404;
+        response.set_body_ref("{\"error\": \"not found\"}");
+        break;
+      case HttpRouter::MATCH::METHOD_NOT_ALLOWED:
+        response.status = 405;
+        response.headers.emplace_back("Allow", m_router.allowed(request.path));
+        response.set_body_ref("{\"error\": \"method not allowed\"}");
+        break;
+      case HttpRouter::MATCH::FOUND:
+        if (route->stream) {
+          start_stream(aio, req, request, *route);
+          return;
+        }
+        if (route->push) {
+          start_push(aio, req, request, *route);
+          return;
+        }
+        try {
+          route->handler(request, response);
+        } catch (const std::exception& e) {
+          m_stats->on_error();
+          response = HttpResponse();
+          response.status = 500;
+          response.set_body(error_body(e.what()));
+        }
+        break;
+    }
+    m_stats->latency.Record(std::chrono::steady_clock::now() - start);
+    reply(aio, response);
+  }
+
+  void reply(nng_aio* aio, const HttpResponse& response) {
+    nng_http_res* res = nullptr;
+    if (nng_http_res_alloc(&res) != 0) {
+      m_stats->on_error();
+      nng_aio_finish(aio, NNG_ENOMEM);
+      return;
+    }
+    nng_http_res_set_status(res, static_cast<uint16_t>(response.status));
+    if (const char* reason = reason_of(response.status); *reason != '\0') {
+      nng_http_res_set_reason(res, reason);
+    }
+    nng_http_res_set_header(res, "Content-Type",
+                            response.content_type.c_str());
+    for (const auto& [name, value] : response.headers) {
+      nng_http_res_set_header(res, name.c_str(), value.c_str());
+    }
+    int rv;
+    if (response.by_ref) {
+      // No copy, the handler guarantees the storage outlives the reply
+      rv = nng_http_res_set_data(res, response.body_ref.data(),
+                                 response.body_ref.size());
+    } else {
+      rv = nng_http_res_copy_data(res, response.body.data(),
+                                  response.body.size());
+    }
+    if (rv != 0) {
+      nng_http_res_free(res);
+      m_stats->on_error();
+      nng_aio_finish(aio, rv);
+      return;
     }
-    if (m_http_handler_status) {
-      nng_http_handler_free(m_http_handler_status);
+    m_stats->on_send(response.by_ref ? response.body_ref.size()
+                                     : response.body.size());
+    nng_aio_set_output(aio, 0, res);
+    nng_aio_finish(aio, 0);
+  }
+
+  static std::unique_ptr<OwnedRequest> own(nng_http_req* req,
+                                           const HttpRequest& request) {
+    auto owned = std::make_unique<OwnedRequest>();
+    owned->method = request.method;
+    owned->path = request.path;
+    owned->query = request.query;
+    owned->body = request.body;
+    for (const auto& [name, value] : request.params) {
+      owned->params.emplace_back(name, value);
     }
-    if (m_http_handler_nodes) {
-      nng_http_handler_free(m_http_handler_nodes);
+    for (const char* name : STREAM_HEADERS) {
+      if (const char* value = nng_http_req_get_header(req, name)) {
+        owned->headers.emplace_back(name, value);
+      }
     }
-    m_http_server = nullptr;
-    m_http_handler_status = nullptr;
-    m_http_handler_nodes = nullptr;
+    return owned;
   }
 
- private:
-  nng_http_server* m_http_server;
-  nng_http_handler* m_http_handler_status;
-  nng_http_handler* m_http_handler_nodes;
-  std::atomic<bool> m_http_running;
+  // Takes the connection away from nng's request/reply cycle; replies with
+  // an error instead when that fails
+  nng_http_conn* hijack(nng_aio* aio) {
+    auto* conn = static_cast<nng_http_conn*>(nng_aio_get_input(aio, 2));
+    if (nng_http_hijack(conn) != 0) {
+      HttpResponse response;
+      response.status = 500;
+      response.set_body_ref("{\"error\": \"stream unavailable\"}");
+      reply(aio, response);
+      return nullptr;
+    }
+    nng_aio_finish(aio, 0);  // Connection is ours now
+    return conn;
+  }
+
+  void start_push(nng_aio* aio, nng_http_req* req, const HttpRequest& request,
+                  const HttpRoute& route) {
+    auto owned = own(req, request);
+    nng_http_conn* conn = hijack(aio);
+    if (conn == nullptr) {
+      return;
+    }
+
+    auto stream = std::make_shared<PushStream>(conn);
+    if (!stream->begin(route.content_type)) {
+      m_stats->on_error();
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_streams_mutex);
+      if (!m_http_running) {
+        return;  // stop() has already swept the list
+      }
+      m_pushes.remove_if(
+          [](const auto& push) { return push->finished(); });
+      m_pushes.push_back(stream);
+    }
+    try {
+      route.push(owned->view(), stream);
+    } catch (const std::exception&) {
+      m_stats->on_error();
+      stream->close();
+    }
+  }
+
+  void start_stream(nng_aio* aio, nng_http_req* req,
+                    const HttpRequest& request, const HttpRoute& route) {
+    auto owned = own(req, request);
+    nng_http_conn* conn = hijack(aio);
+    if (conn == nullptr) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_streams_mutex);
+    reap_streams();
+    auto done = std::make_shared<std::atomic<bool>>(false);
+    auto& slot = m_streams.emplace_back();
+    slot.done = done;
+    slot.thread = std::thread([this, conn, &route, done,
+                               owned = std::move(owned)]() {
+      StreamDone finished{*done};
+      ChunkedStream stream(conn, m_http_running);
+      if (!stream.begin(route.content_type)) {
+        m_stats->on_error();
+        return;
+      }
+      HttpRequest view = owned->view();
+      try {
+        route.stream(view, stream);
+      } catch (const std::exception&) {
+        m_stats->on_error();
+      }
+    });
+  }
+
+  struct Stream {
+    std::thread thread;
+    std::shared_ptr<std::atomic<bool>> done;
+  };
+
+  // Marks a stream thread joinable without blocking, even on early return
+  struct StreamDone {
+    std::atomic<bool>& done;
+    ~StreamDone() { done = true; }
+  };
+
+  // Called with m_streams_mutex held
+  void reap_streams() {
+    for (auto it = m_streams.begin(); it != m_streams.end();) {
+      if (*it->done) {
+        it->thread.join();
+        it = m_streams.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  HttpRouter m_router;
+  nng_http_server* m_http_server = nullptr;
+  std::atomic<bool> m_http_running{false};
   std::string m_cert_file;
   std::string m_key_file;
-  int m_rv;
+  std::shared_ptr<SocketStats> m_stats;
+  std::mutex m_streams_mutex;
+  std::list<Stream> m_streams;
+  std::list<std::shared_ptr<PushStream>> m_pushes;
+  int m_rv = 0;
 };
 
 Http::Http() { m_impl = std::make_unique<Impl>(); }
 
 Http::~Http() {}
 
+void Http::set_tls(const std::string& cert_file, const std::string& key_file) {
+  m_impl->set_tls(cert_file, key_file);
+}
+
+void Http::route(const std::string& method, const std::string& pattern,
+                 HttpHandler handler) {
+  m_impl->route(method, pattern, std::move(handler));
+}
+
+void Http::stream(const std::string& method, const std::string& pattern,
+                  HttpStreamHandler handler, const std::string& content_type) {
+  m_impl->stream(method, pattern, std::move(handler), content_type);
+}
+
+void Http::push_stream(const std::string& method, const std::string& pattern,
+                       HttpPushHandler handler,
+                       const std::string& content_type) {
+  m_impl->push_stream(method, pattern, std::move(handler), content_type);
+}
+
 void Http::start(int port) { m_impl->start(port); }
 
 void Http::stop() { m_impl->stop(); }
 
+bool Http::running() const { return m_impl->running(); }
+
+const SocketStats& Http::stats() const { return m_impl->stats(); }
+
 }  // namespace ya::module
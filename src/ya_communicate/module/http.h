@@ -2,15 +2,54 @@
 #define HTTP_H
 
 #include <memory>
+#include <string>
+
+#include "router.h"
+#include "stats.h"
 
 namespace ya::module {
 
+// HTTP/1.1 service on top of nng's http server. One catch-all nng handler
+// dispatches through an HttpRouter, so routes support path parameters.
+// Connections are kept alive between requests (and pipelined requests are
+// answered in order) unless the client asks to close.
+//
+// Built-in routes, added at start() unless already registered:
+// GET /status, GET /nodes, GET /metrics (Prometheus), GET /threads (CPU
+// placement of every thread, see Runtime).
 class Http {
  public:
   Http();
   ~Http();
+
+  // Serve https:// with the given PEM files, must be called before start()
+  void set_tls(const std::string& cert_file, const std::string& key_file);
+
+  // Routes must be registered before start(), see HttpRouter for patterns
+  void route(const std::string& method, const std::string& pattern,
+             HttpHandler handler);
+
+  // Chunked (Transfer-Encoding: chunked) response. The handler runs on its
+  // own thread and may write for as long as it likes; the connection is
+  // closed when it returns.
+  void stream(const std::string& method, const std::string& pattern,
+              HttpStreamHandler handler,
+              const std::string& content_type = "application/octet-stream");
+
+  // Chunked response without a thread per client. The handler gets the
+  // stream and returns; whoever keeps the stream writes to it later and is
+  // told through on_ready() when a write has gone out.
+  void push_stream(
+      const std::string& method, const std::string& pattern,
+      HttpPushHandler handler,
+      const std::string& content_type = "application/octet-stream");
+
   void start(int port);
   void stop();
+  bool running() const;
+
+  // Requests in/out; latency is time spent in the handler
+  const SocketStats& stats() const;
 
  private:
   class Impl;
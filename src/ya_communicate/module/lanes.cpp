@@ -0,0 +1,137 @@
+#include "lanes.h"
+
+namespace ya::module {
+
+const char* to_string(LANE lane) {
+  switch (lane) {
+    case LANE::CONTROL:
+      return "control";
+    case LANE::DATA:
+      return "data";
+  }
+  return "unknown";
+}
+
+LaneScheduler::LaneScheduler() : LaneScheduler(Options{}) {}
+
+LaneScheduler::LaneScheduler(const Options& options) : m_options(options) {}
+
+bool LaneScheduler::push(LANE lane, const std::string& flow,
+                         std::string message) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_closed) {
+      return false;
+    }
+    if (lane == LANE::CONTROL) {
+      if (m_control.size() >= m_options.control_capacity) {
+        ++m_stats.rejected;
+        return false;
+      }
+      m_control.push_back(Item{LANE::CONTROL, flow, std::move(message)});
+    } else {
+      Flow& entry = m_flows[flow];
+      if (entry.queue.size() >= m_options.flow_capacity) {
+        ++m_stats.rejected;
+        return false;
+      }
+      if (entry.queue.empty()) {
+        m_active.push_back(flow);
+      }
+      entry.queue.push_back(std::move(message));
+      ++m_data_queued;
+    }
+  }
+  m_cv.notify_one();
+  return true;
+}
+
+std::optional<LaneScheduler::Item> LaneScheduler::pop(
+    std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv.wait_for(lock, timeout, [this] {
+    return m_closed || !m_control.empty() || !m_active.empty();
+  });
+  if (m_closed) {
+    return std::nullopt;
+  }
+  return next_locked();
+}
+
+std::optional<LaneScheduler::Item> LaneScheduler::next_locked() {
+  if (!m_control.empty()) {
+    Item item = std::move(m_control.front());
+    m_control.pop_front();
+    ++m_stats.control_sent;
+    return item;
+  }
+
+  // Deficit round robin: the front flow sends while its head fits into the
+  // deficit, then goes to the back. Terminates because every visit adds a
+  // quantum until the head fits.
+  while (!m_active.empty()) {
+    auto it = m_flows.find(m_active.front());
+    Flow& flow = it->second;
+    if (!flow.credited) {
+      flow.deficit += m_options.quantum;
+      flow.credited = true;
+    }
+    size_t size = flow.queue.front().size();
+    if (size > flow.deficit) {
+      flow.credited = false;
+      m_active.push_back(m_active.front());
+      m_active.pop_front();
+      continue;
+    }
+
+    flow.deficit -= size;
+    Item item{LANE::DATA, it->first, std::move(flow.queue.front())};
+    flow.queue.pop_front();
+    --m_data_queued;
+    ++m_stats.data_sent;
+    if (flow.queue.empty()) {
+      // Idle flows keep no credit, or they would burst when they return
+      m_active.pop_front();
+      m_flows.erase(it);
+    }
+    return item;
+  }
+  return std::nullopt;
+}
+
+size_t LaneScheduler::drop_flow(const std::string& flow) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_flows.find(flow);
+  if (it == m_flows.end()) {
+    return 0;
+  }
+  size_t dropped = it->second.queue.size();
+  m_data_queued -= dropped;
+  m_flows.erase(it);
+  for (auto active = m_active.begin(); active != m_active.end(); ++active) {
+    if (*active == flow) {
+      m_active.erase(active);
+      break;
+    }
+  }
+  return dropped;
+}
+
+void LaneScheduler::close() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+  }
+  m_cv.notify_all();
+}
+
+LaneScheduler::Stats LaneScheduler::stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Stats stats = m_stats;
+  stats.control_queued = m_control.size();
+  stats.data_queued = m_data_queued;
+  stats.flows = m_active.size();
+  return stats;
+}
+
+}  // namespace ya::module
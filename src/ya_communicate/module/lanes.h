@@ -0,0 +1,95 @@
+#ifndef LANES_H
+#define LANES_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace ya::module {
+
+enum class LANE : uint8_t { CONTROL = 0, DATA = 1 };
+
+const char* to_string(LANE lane);
+
+// Outgoing message queue with two priority lanes.
+//
+// CONTROL is served strictly before DATA, so a heartbeat or membership
+// message never waits behind bulk payloads. DATA is split into flows (one
+// per peer) that share the sender by deficit round robin over bytes: each
+// backlogged flow may send up to quantum bytes per round, so a flow of
+// large messages cannot starve one of small messages. Both lanes are
+// bounded; push() fails instead of blocking once a queue is full.
+class LaneScheduler {
+ public:
+  struct Options {
+    size_t quantum = 16 * 1024;     // DATA bytes per flow and round
+    size_t flow_capacity = 1024;    // Queued DATA messages per flow
+    size_t control_capacity = 256;  // Queued CONTROL messages
+  };
+
+  struct Item {
+    LANE lane = LANE::DATA;
+    std::string flow;
+    std::string message;
+  };
+
+  struct Stats {
+    uint64_t control_sent = 0;  // Items returned by pop(), per lane
+    uint64_t data_sent = 0;
+    uint64_t rejected = 0;      // push() calls refused because a queue was full
+    size_t control_queued = 0;
+    size_t data_queued = 0;
+    size_t flows = 0;           // DATA flows with queued messages
+  };
+
+  LaneScheduler();
+  explicit LaneScheduler(const Options& options);
+
+  // Queues a message for flow, false if the lane (or the flow) is full or
+  // the scheduler is closed. CONTROL keeps one queue for all flows.
+  bool push(LANE lane, const std::string& flow, std::string message);
+
+  // Next item to send, waiting up to timeout. Returns nullopt on timeout,
+  // or once the scheduler is closed.
+  std::optional<Item> pop(std::chrono::milliseconds timeout);
+
+  // Drops everything queued for a flow, e.g. when the peer left
+  size_t drop_flow(const std::string& flow);
+
+  // Wakes pop() and refuses further pushes
+  void close();
+
+  Stats stats() const;
+
+  // Prevent copying
+  LaneScheduler(const LaneScheduler&) = delete;
+  LaneScheduler& operator=(const LaneScheduler&) = delete;
+
+ private:
+  struct Flow {
+    std::deque<std::string> queue;
+    size_t deficit = 0;
+    bool credited = false;  // Got its quantum in the current round
+  };
+
+  std::optional<Item> next_locked();
+
+  const Options m_options;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_closed = false;
+  std::deque<Item> m_control;
+  std::map<std::string, Flow> m_flows;
+  std::deque<std::string> m_active;  // Backlogged flows in round-robin order
+  size_t m_data_queued = 0;
+  Stats m_stats;
+};
+
+}  // namespace ya::module
+
+#endif
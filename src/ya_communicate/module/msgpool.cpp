@@ -0,0 +1,194 @@
+#include "msgpool.h"
+
+#include <nng/nng.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace ya::module {
+
+namespace {
+
+// 64 B, 256 B, 1 KiB, ... 1 MiB
+constexpr size_t CLASS_COUNT = 8;
+constexpr size_t MIN_CLASS_SIZE = 64;
+// Upper bound on cached bytes per size class and thread
+constexpr size_t CLASS_BUDGET = 1024 * 1024;
+constexpr size_t MAX_CACHED_PER_CLASS = 128;
+
+constexpr size_t class_size(size_t index) { return MIN_CLASS_SIZE << (2 * index); }
+
+static_assert(class_size(CLASS_COUNT - 1) == MessagePool::MAX_POOLED_SIZE);
+
+constexpr size_t class_limit(size_t index) {
+  return std::clamp<size_t>(CLASS_BUDGET / class_size(index), 2,
+                            MAX_CACHED_PER_CLASS);
+}
+
+// Smallest class that can hold size bytes, or CLASS_COUNT if none
+size_t class_for_size(size_t size) {
+  for (size_t i = 0; i < CLASS_COUNT; ++i) {
+    if (size <= class_size(i)) {
+      return i;
+    }
+  }
+  return CLASS_COUNT;
+}
+
+// Largest class a message of this capacity can serve, or CLASS_COUNT if none
+size_t class_for_capacity(size_t capacity) {
+  for (size_t i = CLASS_COUNT; i > 0; --i) {
+    if (capacity >= class_size(i - 1)) {
+      return i - 1;
+    }
+  }
+  return CLASS_COUNT;
+}
+
+struct Counters {
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> recycled{0};
+  std::atomic<uint64_t> dropped{0};
+};
+
+std::atomic<bool> g_enabled{true};
+
+// Counters of live thread caches, plus totals folded in from exited threads
+std::mutex g_counters_mutex;
+std::vector<Counters*> g_live_counters;
+MessagePool::Stats g_retired;
+
+void bump(std::atomic<uint64_t>& counter) {
+  // Only the owning thread writes, so a plain load/store pair suffices
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+
+struct ThreadCache {
+  std::array<std::vector<nng_msg*>, CLASS_COUNT> lists;
+  Counters counters;
+
+  ThreadCache() {
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+      lists[i].reserve(class_limit(i));
+    }
+    std::lock_guard<std::mutex> lock(g_counters_mutex);
+    g_live_counters.push_back(&counters);
+  }
+
+  ~ThreadCache() {
+    for (auto& list : lists) {
+      for (nng_msg* msg : list) {
+        nng_msg_free(msg);
+      }
+    }
+    std::lock_guard<std::mutex> lock(g_counters_mutex);
+    g_retired.hits += counters.hits.load(std::memory_order_relaxed);
+    g_retired.misses += counters.misses.load(std::memory_order_relaxed);
+    g_retired.recycled += counters.recycled.load(std::memory_order_relaxed);
+    g_retired.dropped += counters.dropped.load(std::memory_order_relaxed);
+    std::erase(g_live_counters, &counters);
+  }
+};
+
+ThreadCache& thread_cache() {
+  thread_local ThreadCache cache;
+  return cache;
+}
+
+}  // namespace
+
+double MessagePool::Stats::hit_rate() const {
+  uint64_t total = hits + misses;
+  return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+}
+
+nng_msg* MessagePool::acquire(size_t size) {
+  nng_msg* msg = nullptr;
+  size_t index = class_for_size(size);
+  if (!enabled() || index == CLASS_COUNT) {
+    return nng_msg_alloc(&msg, size) == 0 ? msg : nullptr;
+  }
+
+  auto& cache = thread_cache();
+  auto& list = cache.lists[index];
+  if (!list.empty()) {
+    msg = list.back();
+    list.pop_back();
+    bump(cache.counters.hits);
+    nng_msg_header_clear(msg);
+    nng_msg_clear(msg);
+    // Within capacity, so this only adjusts the length
+    if (nng_msg_realloc(msg, size) != 0) {
+      nng_msg_free(msg);
+      return nullptr;
+    }
+    return msg;
+  }
+
+  bump(cache.counters.misses);
+  // Allocate the full class size so the body can be reused for any size
+  // in this class once the message is recycled
+  if (nng_msg_alloc(&msg, class_size(index)) != 0) {
+    return nullptr;
+  }
+  nng_msg_chop(msg, class_size(index) - size);
+  return msg;
+}
+
+void MessagePool::release(nng_msg* msg) {
+  if (!msg) {
+    return;
+  }
+  if (!enabled()) {
+    nng_msg_free(msg);
+    return;
+  }
+
+  auto& cache = thread_cache();
+  size_t index = class_for_capacity(nng_msg_capacity(msg));
+  if (index == CLASS_COUNT || cache.lists[index].size() >= class_limit(index)) {
+    bump(cache.counters.dropped);
+    nng_msg_free(msg);
+    return;
+  }
+  bump(cache.counters.recycled);
+  cache.lists[index].push_back(msg);
+}
+
+MessagePool::Stats MessagePool::stats() {
+  std::lock_guard<std::mutex> lock(g_counters_mutex);
+  Stats total = g_retired;
+  for (const Counters* counters : g_live_counters) {
+    total.hits += counters->hits.load(std::memory_order_relaxed);
+    total.misses += counters->misses.load(std::memory_order_relaxed);
+    total.recycled += counters->recycled.load(std::memory_order_relaxed);
+    total.dropped += counters->dropped.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+void MessagePool::reset_stats() {
+  std::lock_guard<std::mutex> lock(g_counters_mutex);
+  g_retired = Stats{};
+  for (Counters* counters : g_live_counters) {
+    counters->hits.store(0, std::memory_order_relaxed);
+    counters->misses.store(0, std::memory_order_relaxed);
+    counters->recycled.store(0, std::memory_order_relaxed);
+    counters->dropped.store(0, std::memory_order_relaxed);
+  }
+}
+
+void MessagePool::set_enabled(bool enabled) {
+  g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool MessagePool::enabled() {
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+}  // namespace ya::module
@@ -0,0 +1,50 @@
+#ifndef MSGPOOL_H
+#define MSGPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+typedef struct nng_msg nng_msg;
+
+namespace ya::module {
+
+// Thread-local, size-classed cache of nng messages.
+//
+// nng_sendmsg takes ownership of the message it is given, so a sent message
+// never comes back. Instead, messages the modules receive are released into
+// the calling thread's cache and handed out again by the next send on that
+// thread, reusing their body allocation. Each cache is bounded per size class
+// and freed when its thread exits.
+class MessagePool {
+ public:
+  struct Stats {
+    uint64_t hits = 0;      // acquire() served from cache
+    uint64_t misses = 0;    // acquire() fell back to nng_msg_alloc
+    uint64_t recycled = 0;  // release() kept the message
+    uint64_t dropped = 0;   // release() freed it (cache full or oversized)
+
+    double hit_rate() const;
+  };
+
+  // Largest body a pooled message can hold; bigger ones bypass the pool
+  static constexpr size_t MAX_POOLED_SIZE = 1024 * 1024;
+
+  // Message with an empty header and a body of exactly size bytes.
+  // Returns nullptr if allocation fails.
+  static nng_msg* acquire(size_t size);
+
+  // Give a message back instead of nng_msg_free
+  static void release(nng_msg* msg);
+
+  // Process-wide totals across all threads
+  static Stats stats();
+  static void reset_stats();
+
+  // Disable to fall back to plain nng_msg_alloc/nng_msg_free (benchmarking)
+  static void set_enabled(bool enabled);
+  static bool enabled();
+};
+
+}  // namespace ya::module
+
+#endif
@@ -4,20 +4,26 @@
 #include <nng/protocol/pipeline0/pull.h>
 #include <nng/protocol/pipeline0/push.h>
 
+#include <chrono>
 #include <cstring>
-#include <regex>
 #include <stdexcept>
 #include <string>
 
+#include "endpoint.h"
+#include "msgpool.h"
+#include "node_def.h"
+
 namespace ya::module {
 
 class Pipeline::Impl {
  public:
-  Impl(ROLE role, const std::string& address) : role_(role), socket_(0) {
-    // Basic address validation (e.g., tcp://host:port)
-    if (!std::regex_match(address, std::regex("tcp://[\\w\\d\\.:]+:\\d+"))) {
+  Impl(ROLE role, const std::string& address, const TlsOptions& tls,
+       const ReconnectPolicy& reconnect)
+      : role_(role), socket_(0), tracker_(address, reconnect.on_event) {
+    if (!is_valid_address(address)) {
       throw std::runtime_error("Invalid address format: " + address);
     }
+    stats_ = StatsRegistry::instance().create("pipeline", address);
 
     int rv;
     if (role == ROLE::PUSHER) {
@@ -25,7 +31,9 @@ class Pipeline::Impl {
         throw std::runtime_error("Failed to open push socket: " +
                                  std::string(nng_strerror(rv)));
       }
-      if ((rv = nng_dial(socket_, address.c_str(), nullptr, 0)) != 0) {
+      if ((rv = track_connections(socket_, &tracker_)) != 0 ||
+          (rv = dial_endpoint(socket_, address, tls, nullptr, reconnect)) !=
+              0) {
         nng_close(socket_);
         throw std::runtime_error("Failed to dial " + address + ": " +
                                  std::string(nng_strerror(rv)));
@@ -35,7 +43,8 @@ class Pipeline::Impl {
         throw std::runtime_error("Failed to open pull socket: " +
                                  std::string(nng_strerror(rv)));
       }
-      if ((rv = nng_listen(socket_, address.c_str(), nullptr, 0)) != 0) {
+      if ((rv = track_connections(socket_, &tracker_)) != 0 ||
+          (rv = listen_endpoint(socket_, address, tls)) != 0) {
         nng_close(socket_);
         throw std::runtime_error("Failed to listen on " + address + ": " +
                                  std::string(nng_strerror(rv)));
@@ -53,18 +62,29 @@ class Pipeline::Impl {
     if (role_ != ROLE::PUSHER) {
       throw std::runtime_error("Send operation only allowed for PUSHER role");
     }
+    std::string encoded;
+    if (compressor_) {
+      encoded = compressor_->encode(message);
+    }
+    const std::string& payload = compressor_ ? encoded : message;
     nng_msg* msg;
     int rv;
-    if ((rv = nng_msg_alloc(&msg, message.size())) != 0) {
+    if ((msg = MessagePool::acquire(payload.size())) == nullptr) {
+      stats_->on_error();
       throw std::runtime_error("Failed to allocate message: " +
-                               std::string(nng_strerror(rv)));
+                               std::string(nng_strerror(NNG_ENOMEM)));
     }
-    memcpy(nng_msg_body(msg), message.data(), message.size());
+    memcpy(nng_msg_body(msg), payload.data(), payload.size());
+    InFlight in_flight(*stats_);
+    auto start = std::chrono::steady_clock::now();
     if ((rv = nng_sendmsg(socket_, msg, 0)) != 0) {
-      nng_msg_free(msg);
+      MessagePool::release(msg);
+      stats_->on_failure(rv == NNG_ETIMEDOUT);
       throw std::runtime_error("Failed to send message: " +
                                std::string(nng_strerror(rv)));
     }
+    stats_->latency.Record(std::chrono::steady_clock::now() - start);
+    stats_->on_send(payload.size());
   }
 
   std::string receive() {
@@ -75,21 +95,54 @@ class Pipeline::Impl {
     nng_msg* msg;
     int rv;
     if ((rv = nng_recvmsg(socket_, &msg, 0)) != 0) {
+      stats_->on_failure(rv == NNG_ETIMEDOUT);
       throw std::runtime_error("Failed to receive message: " +
                                std::string(nng_strerror(rv)));
     }
+    stats_->on_receive(nng_msg_len(msg));
     std::string result(static_cast<char*>(nng_msg_body(msg)), nng_msg_len(msg));
-    nng_msg_free(msg);
+    MessagePool::release(msg);
+    if (compressor_ && Compressor::is_frame(result)) {
+      return compressor_->decode(result);
+    }
     return result;
   }
 
+  void set_timeout(std::chrono::milliseconds timeout) {
+    int rv;
+    auto ms = static_cast<nng_duration>(timeout.count());
+    if ((rv = nng_socket_set_ms(socket_, role_ == ROLE::PUSHER
+                                             ? NNG_OPT_SENDTIMEO
+                                             : NNG_OPT_RECVTIMEO,
+                                ms)) != 0) {
+      throw std::runtime_error("Failed to set timeout: " +
+                               std::string(nng_strerror(rv)));
+    }
+  }
+
+  void set_compression(const Compressor::Options& options) {
+    compressor_ = std::make_unique<Compressor>(options);
+  }
+
+  Compressor::Stats compression_stats() const {
+    return compressor_ ? compressor_->stats() : Compressor::Stats{};
+  }
+
+  const SocketStats& stats() const { return *stats_; }
+
+  ConnectionInfo connection() const { return tracker_.info(); }
+
  private:
   ROLE role_;
   nng_socket socket_;
+  std::unique_ptr<Compressor> compressor_;
+  std::shared_ptr<SocketStats> stats_;
+  ConnectionTracker tracker_;  // Notified until ~Impl() closes socket_
 };
 
-Pipeline::Pipeline(ROLE role, const std::string& address)
-    : m_impl(std::make_unique<Impl>(role, address)) {}
+Pipeline::Pipeline(ROLE role, const std::string& address,
+                   const TlsOptions& tls, const ReconnectPolicy& reconnect)
+    : m_impl(std::make_unique<Impl>(role, address, tls, reconnect)) {}
 
 Pipeline::~Pipeline() {}
 
@@ -97,4 +150,22 @@ void Pipeline::send(const std::string& message) { m_impl->send(message); }
 
 std::string Pipeline::receive() { return m_impl->receive(); }
 
+void Pipeline::set_timeout(std::chrono::milliseconds timeout) {
+  m_impl->set_timeout(timeout);
+}
+
+void Pipeline::set_compression(const Compressor::Options& options) {
+  m_impl->set_compression(options);
+}
+
+Compressor::Stats Pipeline::compression_stats() const {
+  return m_impl->compression_stats();
+}
+
+const SocketStats& Pipeline::stats() const { return m_impl->stats(); }
+
+ConnectionInfo Pipeline::connection() const {
+  return m_impl->connection();
+}
+
 }  // namespace ya::module
@@ -1,8 +1,14 @@
 #ifndef PIPELINE_H
 #define PIPELINE_H
 
+#include <chrono>
 #include <memory>
 
+#include "compressor.h"
+#include "connection.h"
+#include "stats.h"
+#include "tls.h"
+
 namespace ya::module {
 
 class Pipeline {
@@ -10,12 +16,27 @@ class Pipeline {
   enum class ROLE { PUSHER, PULLER };
 
  public:
-  Pipeline(ROLE role, const std::string& address);
+  // tls is used when address is tls+tcp://, reconnect when pushing (the
+  // pusher dials)
+  Pipeline(ROLE role, const std::string& address, const TlsOptions& tls = {},
+           const ReconnectPolicy& reconnect = {});
   ~Pipeline();
 
   void send(const std::string& message);
   std::string receive();
 
+  // Bounds send() (no connected puller) and receive(); both then throw
+  void set_timeout(std::chrono::milliseconds timeout);
+
+  // Both ends must enable compression; the puller decodes any algorithm
+  void set_compression(const Compressor::Options& options);
+  Compressor::Stats compression_stats() const;
+
+  const SocketStats& stats() const;
+
+  // Live pipes and reconnect history of this socket
+  ConnectionInfo connection() const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> m_impl;
@@ -3,23 +3,25 @@
 #include <nng/nng.h>
 #include <nng/protocol/pubsub0/pub.h>
 
+#include <chrono>
 #include <cstring>
 #include <iostream>
-#include <regex>
 #include <stdexcept>
 #include <string>
 
+#include "endpoint.h"
+#include "msgpool.h"
+#include "node_def.h"
+
 namespace ya::module {
 
 class Publisher::Impl {
  public:
-  Impl(const std::string& address) : socket_(0) {
-    // Validate address: tcp://host:port or inproc://name
-    if (!std::regex_match(
-            address,
-            std::regex("(tcp://[\\w\\d\\.:]+:\\d+|inproc://[\\w\\d\\.:]+)"))) {
+  Impl(const std::string& address, const TlsOptions& tls) : socket_(0) {
+    if (!is_valid_address(address)) {
       throw std::runtime_error("Invalid address format: " + address);
     }
+    stats_ = StatsRegistry::instance().create("publisher", address);
 
     int rv;
     if ((rv = nng_pub0_open(&socket_)) != 0) {
@@ -27,7 +29,7 @@ class Publisher::Impl {
                                std::string(nng_strerror(rv)));
     }
     std::cout << "Publisher binding to " << address << std::endl;
-    if ((rv = nng_listen(socket_, address.c_str(), nullptr, 0)) != 0) {
+    if ((rv = listen_endpoint(socket_, address, tls)) != 0) {
       nng_close(socket_);
       throw std::runtime_error("Failed to listen on " + address + ": " +
                                std::string(nng_strerror(rv)));
@@ -41,28 +43,58 @@ class Publisher::Impl {
   }
 
   void publish(const std::string& topic, const std::string& message) {
-    std::string full_message = topic.empty() ? message : topic + ":" + message;
+    // The topic prefix stays uncompressed so subscriber filtering still works
+    std::string encoded;
+    if (compressor_) {
+      encoded = compressor_->encode(message);
+    }
+    const std::string& payload = compressor_ ? encoded : message;
+    // Assemble "topic:payload" directly in the message body
+    size_t prefix = topic.empty() ? 0 : topic.size() + 1;
+    size_t size = prefix + payload.size();
     nng_msg* msg;
     int rv;
-    if ((rv = nng_msg_alloc(&msg, full_message.size())) != 0) {
+    if ((msg = MessagePool::acquire(size)) == nullptr) {
+      stats_->on_error();
       throw std::runtime_error("Failed to allocate message: " +
-                               std::string(nng_strerror(rv)));
+                               std::string(nng_strerror(NNG_ENOMEM)));
+    }
+    auto* body = static_cast<char*>(nng_msg_body(msg));
+    if (prefix != 0) {
+      memcpy(body, topic.data(), topic.size());
+      body[topic.size()] = ':';
     }
-    memcpy(nng_msg_body(msg), full_message.data(), full_message.size());
-    std::cout << "Publishing: " << full_message << std::endl;
+    memcpy(body + prefix, payload.data(), payload.size());
+    InFlight in_flight(*stats_);
+    auto start = std::chrono::steady_clock::now();
     if ((rv = nng_sendmsg(socket_, msg, 0)) != 0) {
-      nng_msg_free(msg);
+      MessagePool::release(msg);
+      stats_->on_failure(rv == NNG_ETIMEDOUT);
       throw std::runtime_error("Failed to publish message: " +
                                std::string(nng_strerror(rv)));
     }
+    stats_->latency.Record(std::chrono::steady_clock::now() - start);
+    stats_->on_send(size);
+  }
+
+  void set_compression(const Compressor::Options& options) {
+    compressor_ = std::make_unique<Compressor>(options);
+  }
+
+  Compressor::Stats compression_stats() const {
+    return compressor_ ? compressor_->stats() : Compressor::Stats{};
   }
 
+  const SocketStats& stats() const { return *stats_; }
+
  private:
   nng_socket socket_;
+  std::unique_ptr<Compressor> compressor_;
+  std::shared_ptr<SocketStats> stats_;
 };
 
-Publisher::Publisher(const std::string& address)
-    : m_impl(std::make_unique<Impl>(address)) {}
+Publisher::Publisher(const std::string& address, const TlsOptions& tls)
+    : m_impl(std::make_unique<Impl>(address, tls)) {}
 
 Publisher::~Publisher() {}
 
@@ -70,4 +102,14 @@ void Publisher::publish(const std::string& topic, const std::string& message) {
   m_impl->publish(topic, message);
 }
 
+void Publisher::set_compression(const Compressor::Options& options) {
+  m_impl->set_compression(options);
+}
+
+Compressor::Stats Publisher::compression_stats() const {
+  return m_impl->compression_stats();
+}
+
+const SocketStats& Publisher::stats() const { return m_impl->stats(); }
+
 }  // namespace ya::module
@@ -3,15 +3,26 @@
 
 #include <memory>
 
+#include "compressor.h"
+#include "stats.h"
+#include "tls.h"
+
 namespace ya::module {
 
 class Publisher {
  public:
-  Publisher(const std::string &address);
+  // tls is used when address is tls+tcp://
+  Publisher(const std::string &address, const TlsOptions &tls = {});
   ~Publisher();
 
   void publish(const std::string &topic, const std::string &message);
 
+  // Compress payloads above the threshold; subscribers must enable it too
+  void set_compression(const Compressor::Options &options);
+  Compressor::Stats compression_stats() const;
+
+  const SocketStats &stats() const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> m_impl;
@@ -8,11 +8,19 @@
 #include <nng/supplemental/http/http.h>
 #include <nng/supplemental/tls/tls.h>
 
+#include <chrono>
 #include <cstring>
 
+#include "endpoint.h"
+#include "msgpool.h"
+
 namespace ya::module {
-Requester::Requester(const std::string& url)
-    : m_socket(nullptr), m_dialer(nullptr) {
+Requester::Requester(const std::string& url, const TlsOptions& tls,
+                     const ReconnectPolicy& reconnect)
+    : m_socket(nullptr),
+      m_dialer(nullptr),
+      m_stats(StatsRegistry::instance().create("requester", url)),
+      m_tracker(std::make_unique<ConnectionTracker>(url, reconnect.on_event)) {
   nng_socket s;
   nng_dialer d;
   int rv;
@@ -22,7 +30,8 @@ Requester::Requester(const std::string& url)
                         std::string(nng_strerror(rv)));
   }
 
-  if ((rv = nng_dial(s, url.c_str(), &d, 0)) != 0) {
+  if ((rv = track_connections(s, m_tracker.get())) != 0 ||
+      (rv = dial_endpoint(s, url, tls, &d, reconnect)) != 0) {
     nng_close(s);
     throw CommException("Failed to dial " + url + ": " +
                         std::string(nng_strerror(rv)));
@@ -43,30 +52,57 @@ Requester::~Requester() {
   }
 }
 
+void Requester::set_timeout(std::chrono::milliseconds timeout) {
+  int rv;
+  if ((rv = nng_socket_set_ms(*(nng_socket*)m_socket, NNG_OPT_RECVTIMEO,
+                              static_cast<nng_duration>(timeout.count()))) !=
+      0) {
+    throw CommException("Failed to set receive timeout: " +
+                        std::string(nng_strerror(rv)));
+  }
+}
+
 std::string Requester::request(const std::string& msg) {
   int rv;
-  // Send request
-  char* send_buf = new char[msg.size() + 1];
-  std::strcpy(send_buf, msg.c_str());
+  InFlight in_flight(*m_stats);
+  auto start = std::chrono::steady_clock::now();
+  // Send request (including null terminator)
+  nng_msg* req = MessagePool::acquire(msg.size() + 1);
+  if (!req) {
+    m_stats->on_error();
+    throw CommException("Failed to allocate request: " +
+                        std::string(nng_strerror(NNG_ENOMEM)));
+  }
+  std::memcpy(nng_msg_body(req), msg.c_str(), msg.size() + 1);
 
-  if ((rv = nng_send(*(nng_socket*)m_socket, send_buf, msg.size() + 1,
-                     NNG_FLAG_ALLOC)) != 0) {
-    delete[] send_buf;
+  if ((rv = nng_sendmsg(*(nng_socket*)m_socket, req, 0)) != 0) {
+    MessagePool::release(req);
+    m_stats->on_failure(rv == NNG_ETIMEDOUT);
     throw CommException("Failed to send request: " +
                         std::string(nng_strerror(rv)));
   }
 
+  m_stats->on_send(msg.size() + 1);
+
   // Receive reply
-  char* recv_buf = nullptr;
-  size_t sz;
-  if ((rv = nng_recv(*(nng_socket*)m_socket, &recv_buf, &sz, NNG_FLAG_ALLOC)) !=
-      0) {
+  nng_msg* rep = nullptr;
+  if ((rv = nng_recvmsg(*(nng_socket*)m_socket, &rep, 0)) != 0) {
+    m_stats->on_failure(rv == NNG_ETIMEDOUT);
     throw CommException("Failed to receive reply: " +
                         std::string(nng_strerror(rv)));
   }
 
-  std::string reply(recv_buf, sz - 1);
-  nng_free(recv_buf, sz);
+  m_stats->latency.Record(std::chrono::steady_clock::now() - start);
+  size_t sz = nng_msg_len(rep);
+  m_stats->on_receive(sz);
+
+  std::string reply(static_cast<char*>(nng_msg_body(rep)),
+                    sz > 0 ? sz - 1 : 0);  // Exclude null terminator
+  MessagePool::release(rep);
   return reply;
 }
+
+const SocketStats& Requester::stats() const { return *m_stats; }
+
+ConnectionInfo Requester::connection() const { return m_tracker->info(); }
 }  // namespace ya::module
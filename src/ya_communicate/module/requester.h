@@ -1,18 +1,36 @@
 #ifndef REQUESTER_H
 #define REQUESTER_H
 
+#include <chrono>
+#include <memory>
+
+#include "connection.h"
 #include "node_def.h"
+#include "stats.h"
+#include "tls.h"
 
 namespace ya::module {
 
 class Requester {
  public:
-  Requester(const std::string& url);
+  // tls is used when url is tls+tcp://. With reconnect.wait_for_peer off
+  // the server does not have to be up yet, requests wait for it.
+  Requester(const std::string& url, const TlsOptions& tls = {},
+            const ReconnectPolicy& reconnect = {});
   ~Requester();
 
   // Send a request and receive a reply (blocking)
   std::string request(const std::string& msg);
 
+  // Give up on a reply after this long (default: wait forever)
+  void set_timeout(std::chrono::milliseconds timeout);
+
+  // Latency is request->reply
+  const SocketStats& stats() const;
+
+  // Live pipes and reconnect history of this socket
+  ConnectionInfo connection() const;
+
   // Prevent copying
   Requester(const Requester&) = delete;
   Requester& operator=(const Requester&) = delete;
@@ -20,6 +38,8 @@ class Requester {
  private:
   void* m_socket;  // Opaque pointer to NNG socket
   void* m_dialer;  // Opaque pointer to NNG dialer
+  std::shared_ptr<SocketStats> m_stats;
+  std::unique_ptr<ConnectionTracker> m_tracker;  // Notified until closed
 };
 
 }  // namespace ya::module
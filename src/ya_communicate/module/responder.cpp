@@ -10,10 +10,15 @@
 
 #include <cstring>
 
+#include "endpoint.h"
+#include "msgpool.h"
+
 namespace ya::module {
 
-Reponder::Reponder(const std::string& url)
-    : m_socket(nullptr), m_listener(nullptr) {
+Reponder::Reponder(const std::string& url, const TlsOptions& tls)
+    : m_socket(nullptr),
+      m_listener(nullptr),
+      m_stats(StatsRegistry::instance().create("responder", url)) {
   nng_socket s;
   nng_listener l;
   int rv;
@@ -23,7 +28,7 @@ Reponder::Reponder(const std::string& url)
                         std::string(nng_strerror(rv)));
   }
 
-  if ((rv = nng_listen(s, url.c_str(), &l, 0)) != 0) {
+  if ((rv = listen_endpoint(s, url, tls, &l)) != 0) {
     nng_close(s);
     throw CommException("Failed to listen on " + url + ": " +
                         std::string(nng_strerror(rv)));
@@ -45,31 +50,44 @@ Reponder::~Reponder() {
 }
 
 std::string Reponder::receive() {
-  char* buf = nullptr;
-  size_t sz;
+  nng_msg* req = nullptr;
   int rv;
 
-  if ((rv = nng_recv(*(nng_socket*)m_socket, &buf, &sz, NNG_FLAG_ALLOC)) != 0) {
+  if ((rv = nng_recvmsg(*(nng_socket*)m_socket, &req, 0)) != 0) {
+    m_stats->on_failure(rv == NNG_ETIMEDOUT);
     throw CommException("Failed to receive: " + std::string(nng_strerror(rv)));
   }
 
-  std::string msg(buf, sz - 1);  // Exclude null terminator
-  nng_free(buf, sz);             // Free buffer
+  m_received_at = std::chrono::steady_clock::now();
+  size_t sz = nng_msg_len(req);
+  m_stats->on_receive(sz);
+
+  std::string msg(static_cast<char*>(nng_msg_body(req)),
+                  sz > 0 ? sz - 1 : 0);  // Exclude null terminator
+  MessagePool::release(req);             // Body is reused by the reply
   return msg;
 }
 
 void Reponder::send(const std::string& msg) {
   int rv;
   // Copy string to include null terminator
-  char* buf = new char[msg.size() + 1];
-  std::strcpy(buf, msg.c_str());
+  nng_msg* rep = MessagePool::acquire(msg.size() + 1);
+  if (!rep) {
+    m_stats->on_error();
+    throw CommException("Failed to allocate reply: " +
+                        std::string(nng_strerror(NNG_ENOMEM)));
+  }
+  std::memcpy(nng_msg_body(rep), msg.c_str(), msg.size() + 1);
 
-  if ((rv = nng_send(*(nng_socket*)m_socket, buf, msg.size() + 1,
-                     NNG_FLAG_ALLOC)) != 0) {
-    delete[] buf;  // Free if send fails
+  if ((rv = nng_sendmsg(*(nng_socket*)m_socket, rep, 0)) != 0) {
+    MessagePool::release(rep);  // Still ours if send fails
+    m_stats->on_failure(rv == NNG_ETIMEDOUT);
     throw CommException("Failed to send: " + std::string(nng_strerror(rv)));
   }
-  // NNG_FLAG_ALLOC means NNG frees buf
+  m_stats->latency.Record(std::chrono::steady_clock::now() - m_received_at);
+  m_stats->on_send(msg.size() + 1);
 }
 
+const SocketStats& Reponder::stats() const { return *m_stats; }
+
 }  // namespace ya::module
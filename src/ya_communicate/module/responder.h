@@ -1,15 +1,20 @@
 #ifndef RESPONDER_H
 #define RESPONDER_H
 
+#include <chrono>
+#include <memory>
 #include <string>
 
 #include "node_def.h"
+#include "stats.h"
+#include "tls.h"
 
 namespace ya::module {
 
 class Reponder {
  public:
-  Reponder(const std::string& url);
+  // tls is used when url is tls+tcp://, and needs a cert and key
+  Reponder(const std::string& url, const TlsOptions& tls = {});
   ~Reponder();
 
   // Receive a message (blocking)
@@ -18,6 +23,9 @@ class Reponder {
   // Send a reply to the last received message
   void send(const std::string& msg);
 
+  // Latency is receive->send, i.e. time spent handling a request
+  const SocketStats& stats() const;
+
   // Prevent copying
   Reponder(const Reponder&) = delete;
   Reponder& operator=(const Reponder&) = delete;
@@ -25,6 +33,8 @@ class Reponder {
  private:
   void* m_socket;    // Opaque pointer to NNG socket
   void* m_listener;  // Opaque pointer to NNG listener
+  std::shared_ptr<SocketStats> m_stats;
+  std::chrono::steady_clock::time_point m_received_at;
 };
 
 }  // namespace ya::module
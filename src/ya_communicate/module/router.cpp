@@ -0,0 +1,204 @@
+#include "router.h"
+
+#include <stdexcept>
+
+namespace ya::module {
+
+std::string_view HttpRequest::param(std::string_view name) const {
+  for (const auto& [key, value] : params) {
+    if (key == name) {
+      return value;
+    }
+  }
+  return {};
+}
+
+void HttpResponse::set_body(std::string data) {
+  body = std::move(data);
+  body_ref = {};
+  by_ref = false;
+}
+
+void HttpResponse::set_body_ref(std::string_view data) {
+  body.clear();
+  body_ref = data;
+  by_ref = true;
+}
+
+struct HttpRouter::Node {
+  enum class KIND { STATIC, PARAM, WILDCARD };
+
+  KIND kind = KIND::STATIC;
+  std::string prefix;  // Edge label for STATIC, parameter name otherwise
+  std::vector<std::unique_ptr<Node>> children;  // Distinct first characters
+  std::unique_ptr<Node> param;
+  std::unique_ptr<Node> wildcard;
+  std::vector<std::pair<std::string, HttpRoute>> routes;  // By method
+};
+
+HttpRouter::HttpRouter() : m_root(std::make_unique<Node>()) {}
+
+HttpRouter::~HttpRouter() {}
+
+void HttpRouter::add(std::string_view method, std::string_view pattern,
+                     HttpRoute route) {
+  if (pattern.empty() || pattern[0] != '/') {
+    throw std::invalid_argument("Route must start with '/': " +
+                                std::string(pattern));
+  }
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    if ((pattern[i] == ':' || pattern[i] == '*') && pattern[i - 1] != '/') {
+      throw std::invalid_argument(
+          "Parameters must start a path segment: " + std::string(pattern));
+    }
+  }
+  if (!!route.handler + !!route.stream + !!route.push != 1) {
+    throw std::invalid_argument("Route needs exactly one handler: " +
+                                std::string(pattern));
+  }
+
+  Node* node = insert(m_root.get(), pattern);
+  for (const auto& [registered, _] : node->routes) {
+    if (registered == method) {
+      throw std::invalid_argument("Duplicate route: " + std::string(method) +
+                                  " " + std::string(pattern));
+    }
+  }
+  node->routes.emplace_back(std::string(method), std::move(route));
+  ++m_routes;
+}
+
+HttpRouter::Node* HttpRouter::insert(Node* node, std::string_view pattern) {
+  if (pattern.empty()) {
+    return node;
+  }
+
+  if (pattern[0] == ':' || pattern[0] == '*') {
+    bool wildcard = pattern[0] == '*';
+    std::string_view name = pattern.substr(1, pattern.find('/') - 1);
+    if (name.empty() || (wildcard && name.size() + 1 != pattern.size())) {
+      throw std::invalid_argument("Bad parameter in route near: " +
+                                  std::string(pattern));
+    }
+    auto& slot = wildcard ? node->wildcard : node->param;
+    if (!slot) {
+      slot = std::make_unique<Node>();
+      slot->kind = wildcard ? Node::KIND::WILDCARD : Node::KIND::PARAM;
+      slot->prefix = name;
+    } else if (slot->prefix != name) {
+      throw std::invalid_argument("Conflicting parameter names '" +
+                                  slot->prefix + "' and '" +
+                                  std::string(name) + "'");
+    }
+    return insert(slot.get(), pattern.substr(name.size() + 1));
+  }
+
+  std::string_view text = pattern.substr(0, pattern.find_first_of(":*"));
+  for (auto& child : node->children) {
+    if (child->prefix[0] != text[0]) {
+      continue;
+    }
+    size_t common = 0;
+    while (common < child->prefix.size() && common < text.size() &&
+           child->prefix[common] == text[common]) {
+      ++common;
+    }
+    if (common < child->prefix.size()) {
+      // Split the edge at the shared prefix
+      auto split = std::make_unique<Node>();
+      split->prefix = child->prefix.substr(0, common);
+      child->prefix.erase(0, common);
+      split->children.push_back(std::move(child));
+      child = std::move(split);
+    }
+    return insert(child.get(), pattern.substr(common));
+  }
+  auto& child = node->children.emplace_back(std::make_unique<Node>());
+  child->prefix = text;
+  return insert(child.get(), pattern.substr(text.size()));
+}
+
+const HttpRouter::Node* HttpRouter::match(const Node* node,
+                                          std::string_view path,
+                                          Params& params) {
+  if (path.empty() && !node->routes.empty()) {
+    return node;
+  }
+  if (!path.empty()) {
+    for (const auto& child : node->children) {
+      if (path.starts_with(child->prefix)) {
+        if (auto* found =
+                match(child.get(), path.substr(child->prefix.size()), params)) {
+          return found;
+        }
+        break;  // No other child shares the first character
+      }
+    }
+  }
+  if (node->param) {
+    std::string_view segment = path.substr(0, path.find('/'));
+    if (!segment.empty()) {
+      params.emplace_back(node->param->prefix, segment);
+      if (auto* found =
+              match(node->param.get(), path.substr(segment.size()), params)) {
+        return found;
+      }
+      params.pop_back();
+    }
+  }
+  if (node->wildcard && !node->wildcard->routes.empty()) {
+    params.emplace_back(node->wildcard->prefix, path);
+    return node->wildcard.get();
+  }
+  return nullptr;
+}
+
+HttpRouter::MATCH HttpRouter::find(std::string_view method,
+                                   std::string_view path,
+                                   const HttpRoute*& route,
+                                   Params& params) const {
+  params.clear();
+  const Node* node = match(m_root.get(), path, params);
+  if (node == nullptr) {
+    return MATCH::NOT_FOUND;
+  }
+  const HttpRoute* get = nullptr;
+  for (const auto& [registered, candidate] : node->routes) {
+    if (registered == method) {
+      route = &candidate;
+      return MATCH::FOUND;
+    }
+    if (registered == "GET") {
+      get = &candidate;
+    }
+  }
+  if (method == "HEAD" && get != nullptr) {
+    route = get;
+    return MATCH::FOUND;
+  }
+  return MATCH::METHOD_NOT_ALLOWED;
+}
+
+bool HttpRouter::contains(std::string_view method,
+                          std::string_view path) const {
+  const HttpRoute* route = nullptr;
+  Params params;
+  return find(method, path, route, params) == MATCH::FOUND;
+}
+
+std::string HttpRouter::allowed(std::string_view path) const {
+  Params params;
+  const Node* node = match(m_root.get(), path, params);
+  std::string methods;
+  if (node != nullptr) {
+    for (const auto& [method, _] : node->routes) {
+      if (!methods.empty()) {
+        methods += ", ";
+      }
+      methods += method;
+    }
+  }
+  return methods;
+}
+
+}  // namespace ya::module
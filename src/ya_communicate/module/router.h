@@ -0,0 +1,146 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ya::module {
+
+// A request as seen by a handler. All views point into the underlying
+// connection buffers and are only valid for the duration of the call.
+struct HttpRequest {
+  std::string_view method;
+  std::string_view path;   // Without the query string
+  std::string_view query;  // Text after '?', empty when absent
+  std::string_view body;
+  std::vector<std::pair<std::string_view, std::string_view>> params;
+
+  // Value of a ":name" or "*name" path parameter, empty when absent
+  std::string_view param(std::string_view name) const;
+
+  // Header lookup, filled in by the server
+  std::function<std::string_view(const char*)> header;
+};
+
+struct HttpResponse {
+  int status = 200;
+  std::string content_type = "application/json";
+  std::vector<std::pair<std::string, std::string>> headers;
+
+  // Body copied into the reply once
+  void set_body(std::string body);
+
+  // Zero-copy body. The handler owns the storage and must keep it alive and
+  // unchanged while the server runs (e.g. static text or a pre-rendered
+  // document the handler never mutates in place).
+  void set_body_ref(std::string_view body);
+
+  std::string body;
+  std::string_view body_ref;
+  bool by_ref = false;
+};
+
+using HttpHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
+
+// Chunked response body, written from the stream handler's own thread
+class HttpStream {
+ public:
+  virtual ~HttpStream() = default;
+
+  // Sends one chunk; false once the client went away or the server stops
+  virtual bool write(std::string_view chunk) = 0;
+
+  // False once write() would fail, lets idle producers notice shutdown
+  virtual bool open() const = 0;
+};
+
+using HttpStreamHandler = std::function<void(const HttpRequest&, HttpStream&)>;
+
+// Chunked response body that no thread blocks on. Chunks are queued and sent
+// by the connection in the background, so one producer can feed many streams.
+class HttpPushStream {
+ public:
+  virtual ~HttpPushStream() = default;
+
+  // Queues one chunk; false once the client went away or the server stops
+  virtual bool write(std::string_view chunk) = 0;
+
+  // False once write() would fail
+  virtual bool open() const = 0;
+
+  // True while queued chunks are still being sent
+  virtual bool busy() const = 0;
+
+  // Called from an nng thread each time the stream stops being busy and once
+  // when it closes. It must not block and must not drop the last reference.
+  virtual void on_ready(std::function<void()> callback) = 0;
+
+  // Ends the body after the queued chunks
+  virtual void close() = 0;
+};
+
+// Runs on the server thread and must return promptly; keep the stream to
+// write to it later
+using HttpPushHandler =
+    std::function<void(const HttpRequest&, std::shared_ptr<HttpPushStream>)>;
+
+// Exactly one of the three is set
+struct HttpRoute {
+  HttpHandler handler;
+  HttpStreamHandler stream;
+  HttpPushHandler push;
+  std::string content_type;  // For streams, sent with the headers
+};
+
+// Radix tree over URL paths. Patterns are static text mixed with
+// ":name" (one path segment) and a trailing "*name" (rest of the path):
+//
+//   /nodes
+//   /nodes/:id
+//   /nodes/:id/peers
+//   /files/*path
+//
+// Static edges are prefix-compressed; on lookup static children win over
+// parameters, which win over wildcards. add() is not thread-safe, find()
+// is read-only and may run concurrently once routes are registered.
+class HttpRouter {
+ public:
+  enum class MATCH { FOUND, NOT_FOUND, METHOD_NOT_ALLOWED };
+  using Params = std::vector<std::pair<std::string_view, std::string_view>>;
+
+  HttpRouter();
+  ~HttpRouter();
+
+  // Throws std::invalid_argument on malformed or conflicting patterns
+  void add(std::string_view method, std::string_view pattern, HttpRoute route);
+
+  // On FOUND, route points at the registered route and params holds views
+  // into the pattern names and path. HEAD falls back to GET.
+  MATCH find(std::string_view method, std::string_view path,
+             const HttpRoute*& route, Params& params) const;
+
+  // True when method and path would reach a registered route
+  bool contains(std::string_view method, std::string_view path) const;
+
+  // Methods registered for a path, for the Allow header of a 405
+  std::string allowed(std::string_view path) const;
+
+  size_t size() const { return m_routes; }
+
+ private:
+  struct Node;
+  static Node* insert(Node* node, std::string_view pattern);
+  static const Node* match(const Node* node, std::string_view path,
+                           Params& params);
+
+  std::unique_ptr<Node> m_root;
+  size_t m_routes = 0;
+};
+
+}  // namespace ya::module
+
+#endif
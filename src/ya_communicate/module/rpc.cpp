@@ -0,0 +1,430 @@
+#include "rpc.h"
+
+#include <nng/nng.h>
+#include <nng/protocol/reqrep0/rep.h>
+#include <nng/protocol/reqrep0/req.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "endpoint.h"
+#include "msgpool.h"
+#include "runtime.h"
+
+namespace ya::module {
+
+namespace {
+
+constexpr size_t ID_SIZE = sizeof(uint32_t);
+constexpr size_t STATUS_SIZE = 1;
+
+// A worker whose receives keep failing sleeps 1ms, 2ms, ... up to this
+// between attempts instead of spinning; stop() waits at most this long
+constexpr auto MAX_ERROR_BACKOFF = std::chrono::milliseconds(100);
+
+// Fibonacci hashing, sequential IDs land in different slots
+size_t hash_id(uint32_t id) { return id * 0x9E3779B1u; }
+
+}  // namespace
+
+const char* to_string(RPC_STATUS status) {
+  switch (status) {
+    case RPC_STATUS::OK:
+      return "ok";
+    case RPC_STATUS::UNKNOWN_METHOD:
+      return "unknown method";
+    case RPC_STATUS::BAD_REQUEST:
+      return "bad request";
+    case RPC_STATUS::HANDLER_ERROR:
+      return "handler error";
+  }
+  return "unknown status";
+}
+
+RpcReply::~RpcReply() {
+  if (m_msg != nullptr) {
+    MessagePool::release(static_cast<nng_msg*>(m_msg));
+  }
+}
+
+char* RpcReply::allocate(size_t size) {
+  if (m_msg != nullptr) {
+    MessagePool::release(static_cast<nng_msg*>(m_msg));
+  }
+  nng_msg* msg = MessagePool::acquire(STATUS_SIZE + size);
+  if (msg == nullptr) {
+    m_msg = nullptr;
+    throw CommException("Failed to allocate reply: " +
+                        std::string(nng_strerror(NNG_ENOMEM)));
+  }
+  m_msg = msg;
+  return static_cast<char*>(nng_msg_body(msg)) + STATUS_SIZE;
+}
+
+void RpcMethodTable::add(uint32_t id, RpcRawHandler handler) {
+  if (find(id) != nullptr) {
+    throw std::invalid_argument("Duplicate RPC method: " + std::to_string(id));
+  }
+  // Keep the load factor at or below 1/2 so probes stay short
+  if ((m_size + 1) * 2 > m_slots.size()) {
+    grow();
+  }
+  Slot& slot = m_slots[index_of(id)];
+  slot.id = id;
+  slot.used = true;
+  slot.handler = std::move(handler);
+  ++m_size;
+}
+
+const RpcRawHandler* RpcMethodTable::find(uint32_t id) const {
+  if (m_slots.empty()) {
+    return nullptr;
+  }
+  const Slot& slot = m_slots[index_of(id)];
+  return slot.used ? &slot.handler : nullptr;
+}
+
+// Slot holding id, or the empty slot where it would go
+size_t RpcMethodTable::index_of(uint32_t id) const {
+  size_t mask = m_slots.size() - 1;
+  size_t i = hash_id(id) & mask;
+  while (m_slots[i].used && m_slots[i].id != id) {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+void RpcMethodTable::grow() {
+  std::vector<Slot> old = std::move(m_slots);
+  m_slots = std::vector<Slot>(old.empty() ? 16 : old.size() * 2);
+  for (auto& slot : old) {
+    if (slot.used) {
+      m_slots[index_of(slot.id)] = std::move(slot);
+    }
+  }
+}
+
+class RpcServer::Impl {
+ public:
+  Impl(const std::string& url, const TlsOptions& tls, size_t workers)
+      : stats_(StatsRegistry::instance().create("rpc_server", url)),
+        workers_(workers == 0 ? 1 : workers) {
+    int rv;
+    if ((rv = nng_rep0_open(&socket_)) != 0) {
+      throw CommException("Failed to open RPC server socket: " +
+                          std::string(nng_strerror(rv)));
+    }
+    if ((rv = listen_endpoint(socket_, url, tls, &listener_)) != 0) {
+      nng_close(socket_);
+      throw CommException("Failed to listen on " + url + ": " +
+                          std::string(nng_strerror(rv)));
+    }
+  }
+
+  ~Impl() {
+    stop();
+    nng_listener_close(listener_);
+    nng_close(socket_);
+  }
+
+  void start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+      return;
+    }
+    for (size_t i = 0; i < workers_; ++i) {
+      nng_ctx ctx;
+      int rv;
+      if ((rv = nng_ctx_open(&ctx, socket_)) != 0) {
+        stop_locked();
+        throw CommException("Failed to open RPC context: " +
+                            std::string(nng_strerror(rv)));
+      }
+      contexts_.push_back(ctx);
+    }
+    running_ = true;
+    for (nng_ctx ctx : contexts_) {
+      threads_.emplace_back(&Impl::serve, this, ctx);
+    }
+  }
+
+  void stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_locked();
+  }
+
+  // Each worker owns a context, which carries its own request/reply state,
+  // so workers receive and answer independently on the shared socket
+  void serve(nng_ctx ctx) {
+    Runtime::instance().pin_current_thread();
+    auto backoff = std::chrono::milliseconds(0);
+    while (true) {
+      nng_msg* request = nullptr;
+      int rv = nng_ctx_recvmsg(ctx, &request, 0);
+      if (rv == NNG_ECLOSED || !running_) {
+        if (rv == 0) {
+          MessagePool::release(request);
+        }
+        break;
+      }
+      if (rv != 0) {
+        stats_->on_failure(rv == NNG_ETIMEDOUT);
+        if (rv != NNG_ETIMEDOUT) {
+          backoff = std::clamp(backoff * 2, std::chrono::milliseconds(1),
+                               MAX_ERROR_BACKOFF);
+          std::this_thread::sleep_for(backoff);
+        }
+        continue;
+      }
+      backoff = std::chrono::milliseconds(0);
+      auto received_at = std::chrono::steady_clock::now();
+      size_t size = nng_msg_len(request);
+      stats_->on_receive(size);
+
+      RpcReply reply;
+      std::string error;
+      RPC_STATUS status = dispatch(
+          std::string_view(static_cast<char*>(nng_msg_body(request)), size),
+          reply, error);
+      MessagePool::release(request);  // Cached for this worker's next reply
+
+      try {
+        if (status != RPC_STATUS::OK) {
+          if (error.empty()) {
+            error = to_string(status);
+          }
+          std::memcpy(reply.allocate(error.size()), error.data(),
+                      error.size());
+        } else if (reply.m_msg == nullptr) {
+          reply.allocate(0);  // Handler had nothing to say
+        }
+      } catch (const CommException&) {
+        stats_->on_error();
+        continue;  // Out of memory, the client times out
+      }
+      auto* msg = static_cast<nng_msg*>(reply.m_msg);
+      *static_cast<uint8_t*>(nng_msg_body(msg)) = static_cast<uint8_t>(status);
+      size_t reply_size = nng_msg_len(msg);
+
+      if ((rv = nng_ctx_sendmsg(ctx, msg, 0)) != 0) {
+        if (rv == NNG_ECLOSED) {
+          break;  // reply still owns msg
+        }
+        stats_->on_failure(rv == NNG_ETIMEDOUT);
+        continue;
+      }
+      reply.m_msg = nullptr;  // nng owns it now
+      stats_->latency.Record(std::chrono::steady_clock::now() - received_at);
+      stats_->on_send(reply_size);
+    }
+  }
+
+  RPC_STATUS dispatch(std::string_view request, RpcReply& reply,
+                      std::string& error) {
+    if (request.size() < ID_SIZE) {
+      return RPC_STATUS::BAD_REQUEST;
+    }
+    uint32_t id = detail::load_le<uint32_t>(request.data());
+    const RpcRawHandler* handler = methods_.find(id);
+    if (handler == nullptr) {
+      error = "Unknown RPC method: " + std::to_string(id);
+      return RPC_STATUS::UNKNOWN_METHOD;
+    }
+    try {
+      return (*handler)(request.substr(ID_SIZE), reply);
+    } catch (const std::exception& e) {
+      error = e.what();
+      return RPC_STATUS::HANDLER_ERROR;
+    }
+  }
+
+  RpcMethodTable methods_;  // Read-only while running
+  std::atomic<bool> running_ = false;
+  std::shared_ptr<SocketStats> stats_;
+
+ private:
+  void stop_locked() {
+    running_ = false;
+    // Closing a context fails its pending receive with NNG_ECLOSED
+    for (nng_ctx ctx : contexts_) {
+      nng_ctx_close(ctx);
+    }
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+    threads_.clear();
+    contexts_.clear();
+  }
+
+  size_t workers_;
+  nng_socket socket_;
+  nng_listener listener_;
+  std::mutex mutex_;
+  std::vector<nng_ctx> contexts_;
+  std::vector<std::thread> threads_;
+};
+
+RpcServer::RpcServer(const std::string& url, const TlsOptions& tls,
+                     size_t workers)
+    : m_impl(std::make_unique<Impl>(url, tls, workers)) {}
+
+RpcServer::~RpcServer() {}
+
+void RpcServer::add_raw(uint32_t id, RpcRawHandler handler) {
+  if (m_impl->running_) {
+    throw std::logic_error("RPC methods must be added before start()");
+  }
+  m_impl->methods_.add(id, std::move(handler));
+}
+
+void RpcServer::start() { m_impl->start(); }
+
+void RpcServer::stop() { m_impl->stop(); }
+
+bool RpcServer::running() const { return m_impl->running_; }
+
+const SocketStats& RpcServer::stats() const { return *m_impl->stats_; }
+
+class RpcClient::Impl {
+ public:
+  Impl(const std::string& url, const TlsOptions& tls)
+      : stats_(StatsRegistry::instance().create("rpc_client", url)) {
+    int rv;
+    if ((rv = nng_req0_open(&socket_)) != 0) {
+      throw CommException("Failed to open RPC client socket: " +
+                          std::string(nng_strerror(rv)));
+    }
+    if ((rv = dial_endpoint(socket_, url, tls, &dialer_)) != 0) {
+      nng_close(socket_);
+      throw CommException("Failed to dial " + url + ": " +
+                          std::string(nng_strerror(rv)));
+    }
+  }
+
+  ~Impl() {
+    for (nng_ctx ctx : idle_) {
+      nng_ctx_close(ctx);
+    }
+    nng_dialer_close(dialer_);
+    nng_close(socket_);
+  }
+
+  // Contexts are kept for reuse, one per concurrent call at most
+  nng_ctx acquire() {
+    nng_ctx ctx;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!idle_.empty()) {
+        ctx = idle_.back();
+        idle_.pop_back();
+        nng_ctx_set_ms(ctx, NNG_OPT_RECVTIMEO, timeout_);
+        return ctx;
+      }
+    }
+    int rv;
+    if ((rv = nng_ctx_open(&ctx, socket_)) != 0) {
+      stats_->on_error();
+      throw CommException("Failed to open RPC context: " +
+                          std::string(nng_strerror(rv)));
+    }
+    nng_ctx_set_ms(ctx, NNG_OPT_RECVTIMEO, timeout_);
+    return ctx;
+  }
+
+  void release(nng_ctx ctx) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.push_back(ctx);
+  }
+
+  nng_socket socket_;
+  nng_dialer dialer_;
+  std::atomic<nng_duration> timeout_ = NNG_DURATION_INFINITE;
+  std::shared_ptr<SocketStats> stats_;
+
+ private:
+  std::mutex mutex_;
+  std::vector<nng_ctx> idle_;
+};
+
+RpcClient::RpcClient(const std::string& url, const TlsOptions& tls)
+    : m_impl(std::make_unique<Impl>(url, tls)) {}
+
+RpcClient::~RpcClient() {}
+
+void RpcClient::set_timeout(std::chrono::milliseconds timeout) {
+  m_impl->timeout_ = static_cast<nng_duration>(timeout.count());
+}
+
+const SocketStats& RpcClient::stats() const { return *m_impl->stats_; }
+
+void RpcClient::call_raw(uint32_t id, size_t size, Writer write,
+                         const void* request, Reader read, void* response) {
+  SocketStats& stats = *m_impl->stats_;
+  // May throw, so before anything that would need freeing
+  nng_ctx ctx = m_impl->acquire();
+  nng_msg* msg = MessagePool::acquire(ID_SIZE + size);
+  if (msg == nullptr) {
+    m_impl->release(ctx);
+    stats.on_error();
+    throw CommException("Failed to allocate request: " +
+                        std::string(nng_strerror(NNG_ENOMEM)));
+  }
+  char* body = static_cast<char*>(nng_msg_body(msg));
+  detail::store_le(body, id);
+  try {
+    write(request, body + ID_SIZE);
+  } catch (...) {
+    MessagePool::release(msg);
+    m_impl->release(ctx);
+    throw;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  int rv;
+  if ((rv = nng_ctx_sendmsg(ctx, msg, 0)) != 0) {
+    MessagePool::release(msg);  // Still ours if send fails
+    m_impl->release(ctx);
+    stats.on_failure(rv == NNG_ETIMEDOUT);
+    throw CommException("Failed to send RPC: " + std::string(nng_strerror(rv)));
+  }
+  stats.on_send(ID_SIZE + size);
+
+  nng_msg* reply = nullptr;
+  if ((rv = nng_ctx_recvmsg(ctx, &reply, 0)) != 0) {
+    // A late reply to this request is discarded by the next one on ctx
+    m_impl->release(ctx);
+    stats.on_failure(rv == NNG_ETIMEDOUT);
+    throw CommException("Failed to receive RPC reply: " +
+                        std::string(nng_strerror(rv)));
+  }
+  m_impl->release(ctx);
+  stats.latency.Record(std::chrono::steady_clock::now() - start);
+  size_t reply_size = nng_msg_len(reply);
+  stats.on_receive(reply_size);
+
+  std::string_view data(static_cast<char*>(nng_msg_body(reply)), reply_size);
+  if (data.empty()) {
+    MessagePool::release(reply);
+    throw CommException("Empty RPC reply");
+  }
+  auto status = static_cast<RPC_STATUS>(data[0]);
+  data.remove_prefix(STATUS_SIZE);
+  if (status != RPC_STATUS::OK) {
+    std::string error(data);
+    MessagePool::release(reply);
+    throw RpcError(status, error);
+  }
+  bool ok = read(response, data);
+  MessagePool::release(reply);
+  if (!ok) {
+    throw CommException("Malformed RPC reply for method " +
+                        std::to_string(id));
+  }
+}
+
+}  // namespace ya::module
@@ -0,0 +1,194 @@
+#ifndef RPC_H
+#define RPC_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "node_def.h"
+#include "rpc_codec.h"
+#include "stats.h"
+#include "tls.h"
+
+namespace ya::module {
+
+// Typed request/response RPC on top of req/rep.
+//
+// A method is a type naming its ID and message structs, shared by both ends:
+//
+//   struct Add {
+//     static constexpr uint32_t ID = 1;
+//     using Request = AddRequest;    // Structs with YA_RPC_FIELDS
+//     using Response = AddResponse;
+//   };
+//
+//   RpcServer server("tcp://127.0.0.1:5555");
+//   server.add<Add>([](const AddRequest& r) { return AddResponse{r.a + r.b}; });
+//   server.start();
+//
+//   RpcClient client("tcp://127.0.0.1:5555");
+//   AddResponse sum = client.call<Add>({1, 2});
+//
+// Wire format: request [method id: u32 LE][payload], reply [status: u8]
+// [payload], where a non-OK reply carries an error message as payload.
+
+enum class RPC_STATUS : uint8_t {
+  OK = 0,
+  UNKNOWN_METHOD = 1,
+  BAD_REQUEST = 2,     // Payload did not decode as the method's Request
+  HANDLER_ERROR = 3,   // Handler threw
+};
+
+const char* to_string(RPC_STATUS status);
+
+// Thrown by RpcClient::call when the server answers with an error
+class RpcError : public CommException {
+ public:
+  RpcError(RPC_STATUS status, const std::string& msg)
+      : CommException(msg), m_status(status) {}
+
+  RPC_STATUS status() const { return m_status; }
+
+ private:
+  RPC_STATUS m_status;
+};
+
+// Where a handler writes its reply payload. The buffer is the outgoing
+// message itself, taken from MessagePool.
+class RpcReply {
+ public:
+  ~RpcReply();
+
+  // Buffer of exactly size bytes, valid until the handler returns
+  char* allocate(size_t size);
+
+ private:
+  friend class RpcServer;
+  void* m_msg = nullptr;  // Opaque pointer to nng_msg
+};
+
+// Handlers receive the undecoded payload, see RpcServer::add<M>()
+using RpcRawHandler =
+    std::function<RPC_STATUS(std::string_view request, RpcReply& reply)>;
+
+// Open addressing table from method ID to handler. Lookups touch one
+// contiguous array and never allocate.
+class RpcMethodTable {
+ public:
+  // Throws std::invalid_argument if id is already registered
+  void add(uint32_t id, RpcRawHandler handler);
+  const RpcRawHandler* find(uint32_t id) const;
+  size_t size() const { return m_size; }
+
+ private:
+  struct Slot {
+    uint32_t id = 0;
+    bool used = false;
+    RpcRawHandler handler;
+  };
+
+  size_t index_of(uint32_t id) const;
+  void grow();
+
+  std::vector<Slot> m_slots;
+  size_t m_size = 0;
+};
+
+// Serves registered methods with several nng contexts on one rep socket,
+// so slow handlers do not hold up other requests.
+class RpcServer {
+ public:
+  // Listens immediately; tls is used when url is tls+tcp://
+  RpcServer(const std::string& url, const TlsOptions& tls = {},
+            size_t workers = 4);
+  ~RpcServer();
+
+  // Methods must be registered before start()
+  template <typename M>
+  void add(std::function<typename M::Response(const typename M::Request&)>
+               handler) {
+    add_raw(M::ID, [handler = std::move(handler)](std::string_view payload,
+                                                  RpcReply& reply) {
+      typename M::Request request;
+      if (!rpc_decode(payload, request) || !payload.empty()) {
+        return RPC_STATUS::BAD_REQUEST;
+      }
+      typename M::Response response = handler(request);
+      rpc_encode(response, reply.allocate(rpc_size(response)));
+      return RPC_STATUS::OK;
+    });
+  }
+
+  void add_raw(uint32_t id, RpcRawHandler handler);
+
+  void start();
+  void stop();
+  bool running() const;
+
+  // Latency is receive->reply, i.e. time spent handling a request
+  const SocketStats& stats() const;
+
+  RpcServer(const RpcServer&) = delete;
+  RpcServer& operator=(const RpcServer&) = delete;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+// Calls methods on an RpcServer. Safe to share between threads, every call
+// in flight uses its own nng context.
+class RpcClient {
+ public:
+  // tls is used when url is tls+tcp://
+  RpcClient(const std::string& url, const TlsOptions& tls = {});
+  ~RpcClient();
+
+  // Throws RpcError if the server reports a failure, CommException if the
+  // call itself fails or times out
+  template <typename M>
+  typename M::Response call(const typename M::Request& request) {
+    using Request = typename M::Request;
+    using Response = typename M::Response;
+    Response response;
+    call_raw(
+        M::ID, rpc_size(request),
+        [](const void* in, char* out) {
+          rpc_encode(*static_cast<const Request*>(in), out);
+        },
+        &request,
+        [](void* out, std::string_view payload) {
+          return rpc_decode(payload, *static_cast<Response*>(out)) &&
+                 payload.empty();
+        },
+        &response);
+    return response;
+  }
+
+  // Give up on a reply after this long (default: wait forever)
+  void set_timeout(std::chrono::milliseconds timeout);
+
+  // Latency is request->reply
+  const SocketStats& stats() const;
+
+  RpcClient(const RpcClient&) = delete;
+  RpcClient& operator=(const RpcClient&) = delete;
+
+ private:
+  // Function pointers rather than std::function, so a call never allocates
+  using Writer = void (*)(const void* in, char* out);
+  using Reader = bool (*)(void* out, std::string_view payload);
+  void call_raw(uint32_t id, size_t size, Writer write, const void* request,
+                Reader read, void* response);
+
+  class Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+}  // namespace ya::module
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef RPC_CODEC_H
+#define RPC_CODEC_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace ya::module {
+
+// Binary codec for RPC messages, generated at compile time from the types.
+//
+// Integers and floats are fixed-width little endian, bool is one byte,
+// enums use their underlying type, strings and vectors are a u32 length
+// followed by the elements, std::array is its elements. Structs opt in by
+// listing their members:
+//
+//   struct Point {
+//     int32_t x;
+//     int32_t y;
+//     std::string label;
+//     YA_RPC_FIELDS(x, y, label)
+//   };
+//
+// The encoded size is computed up front, so a message is written straight
+// into a buffer of the right size without intermediate allocations.
+#define YA_RPC_FIELDS(...)                                    \
+  auto rpc_fields() { return std::tie(__VA_ARGS__); }         \
+  auto rpc_fields() const { return std::tie(__VA_ARGS__); }
+
+template <typename T, typename = void>
+struct RpcCodec;  // Unsupported type
+
+namespace detail {
+
+template <typename T>
+void store_le(char* out, T value) {
+  if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      out[i] = bytes[sizeof(T) - 1 - i];
+    }
+  } else {
+    std::memcpy(out, &value, sizeof(T));
+  }
+}
+
+template <typename T>
+T load_le(const char* in) {
+  T value;
+  if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+    char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      bytes[i] = in[sizeof(T) - 1 - i];
+    }
+    std::memcpy(&value, bytes, sizeof(T));
+  } else {
+    std::memcpy(&value, in, sizeof(T));
+  }
+  return value;
+}
+
+inline bool read_length(std::string_view& in, uint32_t& length) {
+  if (in.size() < sizeof(uint32_t)) {
+    return false;
+  }
+  length = load_le<uint32_t>(in.data());
+  in.remove_prefix(sizeof(uint32_t));
+  return true;
+}
+
+}  // namespace detail
+
+template <typename T>
+concept RpcStruct = requires(T& value) { value.rpc_fields(); };
+
+template <typename T>
+struct RpcCodec<T, std::enable_if_t<std::is_arithmetic_v<T>>> {
+  static size_t size(const T&) { return sizeof(T); }
+  static char* write(const T& value, char* out) {
+    detail::store_le(out, value);
+    return out + sizeof(T);
+  }
+  static bool read(std::string_view& in, T& value) {
+    if (in.size() < sizeof(T)) {
+      return false;
+    }
+    value = detail::load_le<T>(in.data());
+    in.remove_prefix(sizeof(T));
+    return true;
+  }
+};
+
+template <>
+struct RpcCodec<bool> {
+  static size_t size(const bool&) { return 1; }
+  static char* write(const bool& value, char* out) {
+    *out = value ? 1 : 0;
+    return out + 1;
+  }
+  static bool read(std::string_view& in, bool& value) {
+    if (in.empty() || static_cast<uint8_t>(in[0]) > 1) {
+      return false;
+    }
+    value = in[0] == 1;
+    in.remove_prefix(1);
+    return true;
+  }
+};
+
+template <typename T>
+struct RpcCodec<T, std::enable_if_t<std::is_enum_v<T>>> {
+  using Underlying = std::underlying_type_t<T>;
+  static size_t size(const T&) { return sizeof(Underlying); }
+  static char* write(const T& value, char* out) {
+    return RpcCodec<Underlying>::write(static_cast<Underlying>(value), out);
+  }
+  static bool read(std::string_view& in, T& value) {
+    Underlying raw;
+    if (!RpcCodec<Underlying>::read(in, raw)) {
+      return false;
+    }
+    value = static_cast<T>(raw);
+    return true;
+  }
+};
+
+template <>
+struct RpcCodec<std::string> {
+  static size_t size(const std::string& value) {
+    return sizeof(uint32_t) + value.size();
+  }
+  static char* write(const std::string& value, char* out) {
+    detail::store_le(out, static_cast<uint32_t>(value.size()));
+    std::memcpy(out + sizeof(uint32_t), value.data(), value.size());
+    return out + sizeof(uint32_t) + value.size();
+  }
+  static bool read(std::string_view& in, std::string& value) {
+    uint32_t length;
+    if (!detail::read_length(in, length) || in.size() < length) {
+      return false;
+    }
+    value.assign(in.data(), length);
+    in.remove_prefix(length);
+    return true;
+  }
+};
+
+template <typename T>
+struct RpcCodec<std::vector<T>> {
+  static size_t size(const std::vector<T>& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      return sizeof(uint32_t) + value.size() * sizeof(T);
+    } else {
+      size_t total = sizeof(uint32_t);
+      for (const auto& item : value) {
+        total += RpcCodec<T>::size(item);
+      }
+      return total;
+    }
+  }
+  static char* write(const std::vector<T>& value, char* out) {
+    detail::store_le(out, static_cast<uint32_t>(value.size()));
+    out += sizeof(uint32_t);
+    for (const auto& item : value) {
+      out = RpcCodec<T>::write(item, out);
+    }
+    return out;
+  }
+  static bool read(std::string_view& in, std::vector<T>& value) {
+    uint32_t count;
+    // Every element takes at least a byte, so a bogus count cannot make
+    // us reserve more than the message could possibly hold
+    if (!detail::read_length(in, count) || in.size() < count) {
+      return false;
+    }
+    value.clear();
+    value.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      if (!RpcCodec<T>::read(in, value.emplace_back())) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+template <typename T, size_t N>
+struct RpcCodec<std::array<T, N>> {
+  static size_t size(const std::array<T, N>& value) {
+    size_t total = 0;
+    for (const auto& item : value) {
+      total += RpcCodec<T>::size(item);
+    }
+    return total;
+  }
+  static char* write(const std::array<T, N>& value, char* out) {
+    for (const auto& item : value) {
+      out = RpcCodec<T>::write(item, out);
+    }
+    return out;
+  }
+  static bool read(std::string_view& in, std::array<T, N>& value) {
+    for (auto& item : value) {
+      if (!RpcCodec<T>::read(in, item)) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+template <RpcStruct T>
+struct RpcCodec<T> {
+  template <typename F>
+  using Decay = std::remove_cvref_t<F>;
+
+  static size_t size(const T& value) {
+    return std::apply(
+        [](const auto&... fields) {
+          return (size_t{0} + ... + RpcCodec<Decay<decltype(fields)>>::size(fields));
+        },
+        value.rpc_fields());
+  }
+  static char* write(const T& value, char* out) {
+    std::apply(
+        [&out](const auto&... fields) {
+          ((out = RpcCodec<Decay<decltype(fields)>>::write(fields, out)), ...);
+        },
+        value.rpc_fields());
+    return out;
+  }
+  static bool read(std::string_view& in, T& value) {
+    return std::apply(
+        [&in](auto&... fields) {
+          return (RpcCodec<Decay<decltype(fields)>>::read(in, fields) && ...);
+        },
+        value.rpc_fields());
+  }
+};
+
+// Bytes rpc_encode() will write for value
+template <typename T>
+size_t rpc_size(const T& value) {
+  return RpcCodec<T>::size(value);
+}
+
+// Writes value at out, which must hold rpc_size(value) bytes; returns the end
+template <typename T>
+char* rpc_encode(const T& value, char* out) {
+  return RpcCodec<T>::write(value, out);
+}
+
+// Reads value from the front of in and consumes it; false if malformed
+template <typename T>
+bool rpc_decode(std::string_view& in, T& value) {
+  return RpcCodec<T>::read(in, value);
+}
+
+}  // namespace ya::module
+
+#endif
@@ -0,0 +1,265 @@
+#include "runtime.h"
+
+#include <nng/nng.h>
+#include <nng/protocol/reqrep0/req.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+#include "node_def.h"
+#include "platform_def.h"
+#include "yautils.h"
+
+#if defined(YA_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <filesystem>
+#endif
+
+#if defined(YA_HAS_HWINFO)
+#include "yahwinfo.h"
+#endif
+
+namespace ya::module {
+
+namespace {
+
+struct LogicalCpu {
+  int id;
+  int core;
+  int node;
+};
+
+std::vector<LogicalCpu> topology() {
+  std::vector<LogicalCpu> cpus;
+#if defined(YA_HAS_HWINFO)
+  YaHwinfo hwinfo;
+  for (const auto& logical : hwinfo.getCPUTopology().logical) {
+    cpus.push_back({logical.id, logical.core, logical.numa_node});
+  }
+#else
+  // Without hwinfo every logical CPU counts as its own core on one node
+  int count = static_cast<int>(std::thread::hardware_concurrency());
+  for (int cpu = 0; cpu < count; ++cpu) {
+    cpus.push_back({cpu, cpu, 0});
+  }
+#endif
+  return cpus;
+}
+
+#if defined(YA_LINUX)
+bool set_affinity(pid_t tid, const std::vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(tid, sizeof(set), &set) == 0;
+}
+
+std::vector<int> get_affinity(pid_t tid) {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(tid, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+// Threads of this process with their names (truncated to 15 characters)
+std::vector<std::pair<pid_t, std::string>> threads() {
+  std::vector<std::pair<pid_t, std::string>> result;
+  std::error_code ec;
+  for (const auto& entry :
+       std::filesystem::directory_iterator("/proc/self/task", ec)) {
+    pid_t tid;
+    try {
+      tid = std::stoi(entry.path().filename().string());
+    } catch (const std::exception&) {
+      continue;
+    }
+    std::ifstream comm(entry.path() / "comm");
+    std::string name;
+    std::getline(comm, name);
+    result.emplace_back(tid, name);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+#endif
+
+void validate(const std::vector<int>& cpus) {
+#if defined(YA_LINUX)
+  long configured = sysconf(_SC_NPROCESSORS_CONF);
+#else
+  long configured = std::thread::hardware_concurrency();
+#endif
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= configured) {
+      throw CommException("No such CPU: " + std::to_string(cpu));
+    }
+  }
+}
+
+}  // namespace
+
+Runtime& Runtime::instance() {
+  static Runtime runtime;
+  return runtime;
+}
+
+RuntimeOptions Runtime::recommended() {
+  RuntimeOptions options;
+  std::vector<LogicalCpu> cpus = topology();
+  if (cpus.size() < 8) {
+    return options;
+  }
+
+  // Physical cores of the first node, each with its hyperthreads
+  int node = cpus.front().node;
+  std::vector<int> cores;
+  std::map<int, std::vector<int>> siblings;
+  for (const auto& cpu : cpus) {
+    if (cpu.node != node) {
+      continue;
+    }
+    if (!siblings.count(cpu.core)) {
+      cores.push_back(cpu.core);
+    }
+    siblings[cpu.core].push_back(cpu.id);
+  }
+  if (cores.size() < 2) {
+    return options;
+  }
+
+  // Core 0 tends to take interrupts and housekeeping, so nng gets the top
+  size_t io_cores = std::clamp<size_t>(cores.size() / 8, 1, 4);
+  for (size_t i = 0; i < cores.size(); ++i) {
+    auto& target =
+        i >= cores.size() - io_cores ? options.io_cpus : options.app_cpus;
+    const auto& ids = siblings[cores[i]];
+    target.insert(target.end(), ids.begin(), ids.end());
+  }
+  std::sort(options.io_cpus.begin(), options.io_cpus.end());
+  std::sort(options.app_cpus.begin(), options.app_cpus.end());
+  options.poller_threads = static_cast<int>(io_cores);
+  options.task_threads = static_cast<int>(options.io_cpus.size());
+  return options;
+}
+
+void Runtime::configure(const RuntimeOptions& options) {
+  validate(options.io_cpus);
+  validate(options.app_cpus);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_options = options;
+  }
+
+  auto set = [](nng_init_parameter parameter, int value) {
+    if (value > 0) {
+      nng_init_set_parameter(parameter, static_cast<uint64_t>(value));
+    }
+  };
+  set(NNG_INIT_NUM_TASK_THREADS, options.task_threads);
+  set(NNG_INIT_MAX_TASK_THREADS, options.task_threads);
+  set(NNG_INIT_NUM_EXPIRE_THREADS, options.expire_threads);
+  set(NNG_INIT_MAX_EXPIRE_THREADS, options.expire_threads);
+  set(NNG_INIT_NUM_POLLER_THREADS, options.poller_threads);
+  set(NNG_INIT_MAX_POLLER_THREADS, options.poller_threads);
+  set(NNG_INIT_NUM_RESOLVER_THREADS, options.resolver_threads);
+
+#if defined(YA_LINUX)
+  if (!options.io_cpus.empty()) {
+    // nng starts its threads on first use and they inherit our affinity,
+    // so start it from the I/O CPUs and move back afterwards
+    std::vector<int> original = get_affinity(0);
+    set_affinity(0, options.io_cpus);
+    nng_socket socket;
+    if (nng_req0_open(&socket) == 0) {
+      nng_close(socket);
+    }
+    set_affinity(0, original);
+    pin_io_threads();
+  }
+#endif
+}
+
+RuntimeOptions Runtime::options() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_options;
+}
+
+int Runtime::pin_io_threads() {
+  int pinned = 0;
+#if defined(YA_LINUX)
+  std::vector<int> cpus = options().io_cpus;
+  if (cpus.empty()) {
+    return 0;
+  }
+  for (const auto& [tid, name] : threads()) {
+    if (name.rfind("nng:", 0) == 0 && set_affinity(tid, cpus)) {
+      ++pinned;
+    }
+  }
+#endif
+  return pinned;
+}
+
+bool Runtime::pin_current_thread() {
+  return pin_current_thread(options().app_cpus);
+}
+
+bool Runtime::pin_current_thread(const std::vector<int>& cpus) {
+  if (cpus.empty()) {
+    return false;
+  }
+#if defined(YA_LINUX)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+std::vector<ThreadPlacement> Runtime::placement() {
+  std::vector<ThreadPlacement> result;
+#if defined(YA_LINUX)
+  for (const auto& [tid, name] : threads()) {
+    result.push_back(ThreadPlacement{tid, name, get_affinity(tid)});
+  }
+#endif
+  return result;
+}
+
+std::string Runtime::report() {
+  std::string out;
+  for (const auto& thread : placement()) {
+    out += std::to_string(thread.tid) + " " + thread.name + " cpus=" +
+           format_cpu_list(thread.cpus) + "\n";
+  }
+  return out;
+}
+
+std::vector<int> Runtime::parse_cpu_list(const std::string& list) {
+  return YaUtils::CpuList::Parse(list);
+}
+
+std::string Runtime::format_cpu_list(const std::vector<int>& cpus) {
+  return YaUtils::CpuList::Format(cpus);
+}
+
+}  // namespace ya::module
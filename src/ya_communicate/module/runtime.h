@@ -0,0 +1,79 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ya::module {
+
+// How many threads nng runs and which CPUs they, and ours, run on.
+struct RuntimeOptions {
+  // nng thread counts (NNG_INIT_*), 0 keeps nng's default
+  int task_threads = 0;      // Completion callbacks
+  int expire_threads = 0;    // Timeouts
+  int poller_threads = 0;    // Socket readiness (epoll/kqueue)
+  int resolver_threads = 0;  // Name resolution for dialers
+
+  std::vector<int> io_cpus;   // nng's threads, empty = not pinned
+  std::vector<int> app_cpus;  // P2P, RPC worker and other handler threads
+};
+
+// Where a thread of this process is allowed to run
+struct ThreadPlacement {
+  int tid = 0;
+  std::string name;
+  std::vector<int> cpus;
+};
+
+// Process-wide nng thread and CPU placement.
+//
+// On big machines nng's pollers and task threads otherwise share every core
+// with the application and get preempted by it, which shows up as tail
+// latency. Giving them a few dedicated cores (near the NIC's NUMA node) and
+// keeping handler threads off those cores avoids that.
+//
+// Affinity is only applied on Linux; elsewhere pinning is a no-op.
+class Runtime {
+ public:
+  static Runtime& instance();
+
+  // Defaults from the CPU topology (YaHwinfo when built with it): the last
+  // 1/8 of the physical cores of the first NUMA node, 1 to 4 cores, go to
+  // nng and the rest of that node to the application. Machines with fewer
+  // than 8 logical CPUs get nng's defaults and no pinning.
+  static RuntimeOptions recommended();
+
+  // Sets nng's thread counts and starts its threads on io_cpus. Must run
+  // before any other nng call in the process, nng ignores thread counts
+  // once it is initialized. Throws CommException if a CPU does not exist.
+  void configure(const RuntimeOptions& options);
+  RuntimeOptions options() const;
+
+  // Re-pins threads named "nng:*" to io_cpus, e.g. after nng started more
+  // of them. Returns the number of threads pinned.
+  int pin_io_threads();
+
+  // Pins the calling thread to app_cpus, false if unset or not supported
+  bool pin_current_thread();
+  static bool pin_current_thread(const std::vector<int>& cpus);
+
+  // Every thread of the process with the CPUs it may run on
+  static std::vector<ThreadPlacement> placement();
+  static std::string report();  // One line per thread, for logs
+
+  // "0-3,8,10-11" <-> {0, 1, 2, 3, 8, 10, 11}; parse throws
+  // std::invalid_argument on malformed lists
+  static std::vector<int> parse_cpu_list(const std::string& list);
+  static std::string format_cpu_list(const std::vector<int>& cpus);
+
+ private:
+  Runtime() = default;
+
+  mutable std::mutex m_mutex;
+  RuntimeOptions m_options;
+};
+
+}  // namespace ya::module
+
+#endif
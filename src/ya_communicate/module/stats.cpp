@@ -0,0 +1,122 @@
+#include "stats.h"
+
+#include <sstream>
+
+namespace ya::module {
+
+namespace {
+
+std::string escape_label(const std::string& value) {
+  std::string out;
+  out.reserve(value.size());
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '"':
+        out += "\\\"";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += c;
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+StatsRegistry& StatsRegistry::instance() {
+  static StatsRegistry registry;
+  return registry;
+}
+
+std::shared_ptr<SocketStats> StatsRegistry::create(const std::string& module,
+                                                   const std::string& address) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto stats = std::make_shared<SocketStats>(m_next_id++, module, address);
+  std::erase_if(m_sockets, [](const auto& weak) { return weak.expired(); });
+  m_sockets.push_back(stats);
+  return stats;
+}
+
+std::vector<std::shared_ptr<SocketStats>> StatsRegistry::sockets() {
+  std::vector<std::shared_ptr<SocketStats>> live;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::erase_if(m_sockets, [](const auto& weak) { return weak.expired(); });
+  for (const auto& weak : m_sockets) {
+    if (auto stats = weak.lock()) {
+      live.push_back(std::move(stats));
+    }
+  }
+  return live;
+}
+
+std::string StatsRegistry::to_prometheus() {
+  auto live = sockets();
+  std::ostringstream out;
+
+  auto labels = [](const SocketStats& s) {
+    return "module=\"" + escape_label(s.module) + "\",address=\"" +
+           escape_label(s.address()) + "\",socket=\"" + std::to_string(s.id) +
+           "\"";
+  };
+  auto counter = [&](const char* name, const char* help, auto value) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " counter\n";
+    for (const auto& s : live) {
+      out << name << "{" << labels(*s) << "} " << value(*s) << "\n";
+    }
+  };
+  auto relaxed = [](const auto& atomic) {
+    return atomic.load(std::memory_order_relaxed);
+  };
+
+  out << "# HELP ya_socket_messages_total Messages sent or received.\n";
+  out << "# TYPE ya_socket_messages_total counter\n";
+  for (const auto& s : live) {
+    out << "ya_socket_messages_total{" << labels(*s) << ",direction=\"in\"} "
+        << relaxed(s->messages_in) << "\n";
+    out << "ya_socket_messages_total{" << labels(*s) << ",direction=\"out\"} "
+        << relaxed(s->messages_out) << "\n";
+  }
+  out << "# HELP ya_socket_bytes_total Payload bytes sent or received.\n";
+  out << "# TYPE ya_socket_bytes_total counter\n";
+  for (const auto& s : live) {
+    out << "ya_socket_bytes_total{" << labels(*s) << ",direction=\"in\"} "
+        << relaxed(s->bytes_in) << "\n";
+    out << "ya_socket_bytes_total{" << labels(*s) << ",direction=\"out\"} "
+        << relaxed(s->bytes_out) << "\n";
+  }
+  counter("ya_socket_errors_total", "Failed socket operations.",
+          [&](const SocketStats& s) { return relaxed(s.errors); });
+  counter("ya_socket_timeouts_total", "Socket operations that timed out.",
+          [&](const SocketStats& s) { return relaxed(s.timeouts); });
+
+  out << "# HELP ya_socket_queue_depth Operations currently in flight.\n";
+  out << "# TYPE ya_socket_queue_depth gauge\n";
+  for (const auto& s : live) {
+    out << "ya_socket_queue_depth{" << labels(*s) << "} "
+        << relaxed(s->queue_depth) << "\n";
+  }
+
+  out << "# HELP ya_socket_latency_seconds Request to reply (or send) "
+         "latency.\n";
+  out << "# TYPE ya_socket_latency_seconds summary\n";
+  for (const auto& s : live) {
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+      out << "ya_socket_latency_seconds{" << labels(*s) << ",quantile=\"" << q
+          << "\"} " << s->latency.Percentile(q * 100) / 1e9 << "\n";
+    }
+    out << "ya_socket_latency_seconds_sum{" << labels(*s) << "} "
+        << s->latency.Sum() / 1e9 << "\n";
+    out << "ya_socket_latency_seconds_count{" << labels(*s) << "} "
+        << s->latency.Count() << "\n";
+  }
+  return out.str();
+}
+
+}  // namespace ya::module
@@ -0,0 +1,113 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "yautils.h"
+
+namespace ya::module {
+
+// Counters for one socket. All updates are lock-free; readers see a
+// consistent-enough view for monitoring without stopping writers.
+struct SocketStats {
+  SocketStats(uint64_t id, std::string module, std::string address)
+      : id(id), module(std::move(module)), m_address(std::move(address)) {}
+
+  // Assigned by StatsRegistry; sockets may share module and address (e.g.
+  // several subscribers dialing one publisher), the id tells them apart
+  const uint64_t id;
+  const std::string module;  // e.g. "pipeline", "requester"
+
+  // URL the socket listens on or dials. A server that is created before
+  // it knows its port sets it on start(), keeping its counters.
+  std::string address() const {
+    std::lock_guard<std::mutex> lock(m_address_mutex);
+    return m_address;
+  }
+  void set_address(std::string address) {
+    std::lock_guard<std::mutex> lock(m_address_mutex);
+    m_address = std::move(address);
+  }
+
+  std::atomic<uint64_t> messages_in{0};
+  std::atomic<uint64_t> messages_out{0};
+  std::atomic<uint64_t> bytes_in{0};
+  std::atomic<uint64_t> bytes_out{0};
+  std::atomic<uint64_t> errors{0};
+  std::atomic<uint64_t> timeouts{0};
+  std::atomic<int64_t> queue_depth{0};  // Operations currently in flight
+
+  // request->reply for req/rep and survey, send completion for the others
+  YaUtils::Histogram latency;
+
+  void on_send(size_t bytes) {
+    messages_out.fetch_add(1, std::memory_order_relaxed);
+    bytes_out.fetch_add(bytes, std::memory_order_relaxed);
+  }
+  void on_receive(size_t bytes) {
+    messages_in.fetch_add(1, std::memory_order_relaxed);
+    bytes_in.fetch_add(bytes, std::memory_order_relaxed);
+  }
+  void on_error() { errors.fetch_add(1, std::memory_order_relaxed); }
+  void on_timeout() { timeouts.fetch_add(1, std::memory_order_relaxed); }
+  void on_failure(bool timed_out) {
+    if (timed_out) {
+      on_timeout();
+    } else {
+      on_error();
+    }
+  }
+
+ private:
+  mutable std::mutex m_address_mutex;
+  std::string m_address;
+};
+
+// Tracks an in-flight operation on queue_depth for the current scope
+class InFlight {
+ public:
+  explicit InFlight(SocketStats& stats) : m_stats(stats) {
+    m_stats.queue_depth.fetch_add(1, std::memory_order_relaxed);
+  }
+  ~InFlight() { m_stats.queue_depth.fetch_sub(1, std::memory_order_relaxed); }
+
+  InFlight(const InFlight&) = delete;
+  InFlight& operator=(const InFlight&) = delete;
+
+ private:
+  SocketStats& m_stats;
+};
+
+// Process-wide list of live sockets, used to export metrics
+class StatsRegistry {
+ public:
+  static StatsRegistry& instance();
+
+  // Create stats for a new socket; they stay registered while referenced
+  std::shared_ptr<SocketStats> create(const std::string& module,
+                                      const std::string& address);
+
+  std::vector<std::shared_ptr<SocketStats>> sockets();
+
+  // Prometheus text exposition format (version 0.0.4). Every series is
+  // labelled module, address and socket (the id), so none repeat.
+  std::string to_prometheus();
+
+ private:
+  StatsRegistry() = default;
+  StatsRegistry(const StatsRegistry&) = delete;
+  StatsRegistry& operator=(const StatsRegistry&) = delete;
+
+  std::mutex m_mutex;
+  std::vector<std::weak_ptr<SocketStats>> m_sockets;
+  uint64_t m_next_id = 1;
+};
+
+}  // namespace ya::module
+
+#endif
@@ -0,0 +1,421 @@
+#include "status_feed.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <utility>
+
+#include "http.h"
+
+namespace ya::module {
+
+namespace {
+
+// Idle streams send an SSE comment this often so proxies keep them open
+constexpr auto KEEPALIVE_INTERVAL = std::chrono::seconds(15);
+// How often the writer looks for idle streams, bounds the keep-alive jitter
+constexpr auto KEEPALIVE_CHECK = KEEPALIVE_INTERVAL / 3;
+
+void append_json_string(std::string& out, const std::string& value) {
+  out += '"';
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      default:
+        out += c;
+    }
+  }
+  out += '"';
+}
+
+}  // namespace
+
+std::string to_json(const NodeStatus& status) {
+  std::string out = "{\"id\": ";
+  append_json_string(out, status.id);
+  out += ", \"address\": ";
+  append_json_string(out, status.address);
+  out += ", \"uptime\": " + std::to_string(status.uptime) + ", \"info\": ";
+  append_json_string(out, status.info);
+  out += '}';
+  return out;
+}
+
+namespace {
+
+void append_sse(std::string& out, const char* event, uint64_t seq,
+                const std::string& data) {
+  out += "event: ";
+  out += event;
+  out += "\nid: " + std::to_string(seq) + "\ndata: ";
+  out += data;
+  out += "\n\n";
+}
+
+// Folds a newer event for the same node into the pending one. Returns
+// false when the two cancel out and nothing should be delivered.
+bool coalesce(StatusEvent& pending, const StatusEvent& next) {
+  using TYPE = StatusEvent::TYPE;
+  TYPE type = next.type;
+  if (pending.type == TYPE::JOIN && next.type == TYPE::LEAVE) {
+    return false;  // The consumer never saw the node
+  }
+  if (pending.type == TYPE::JOIN) {
+    type = TYPE::JOIN;  // Still new to the consumer
+  } else if (pending.type == TYPE::LEAVE && next.type == TYPE::JOIN) {
+    type = TYPE::UPDATE;  // The consumer still has the node
+  }
+  pending = next;
+  pending.type = type;
+  return true;
+}
+
+}  // namespace
+
+const char* StatusEvent::name() const {
+  switch (type) {
+    case TYPE::JOIN:
+      return "join";
+    case TYPE::UPDATE:
+      return "update";
+    case TYPE::LEAVE:
+      return "leave";
+  }
+  return "";
+}
+
+std::string StatusEvent::to_json() const { return module::to_json(status); }
+
+StatusQueue::StatusQueue(size_t capacity) : m_capacity(capacity) {}
+
+void StatusQueue::push(const StatusEvent& event) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_closed) {
+      return;
+    }
+    const std::string& key = event.status.address;
+    auto it = m_pending.find(key);
+    if (it != m_pending.end()) {
+      m_coalesced.fetch_add(1, std::memory_order_relaxed);
+      if (!coalesce(it->second, event)) {
+        m_pending.erase(it);  // Its key in m_order goes stale
+      }
+      return;  // Already scheduled for the consumer
+    }
+    if (m_pending.size() >= m_capacity) {
+      // Too far behind, drop everything and let the consumer resync
+      m_dropped.fetch_add(m_pending.size() + 1, std::memory_order_relaxed);
+      m_pending.clear();
+      m_order.clear();
+      m_resync = true;
+    } else {
+      if (m_order.size() > 2 * m_capacity) {
+        std::erase_if(m_order,
+                      [this](const auto& k) { return !m_pending.count(k); });
+      }
+      m_pending.emplace(key, event);
+      m_order.push_back(key);
+    }
+  }
+}
+
+bool StatusQueue::pop(std::vector<StatusEvent>& events, bool& resync) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  resync = std::exchange(m_resync, false);
+  for (const auto& key : m_order) {
+    auto it = m_pending.find(key);
+    if (it != m_pending.end()) {
+      events.push_back(std::move(it->second));
+      m_pending.erase(it);
+    }
+  }
+  m_order.clear();
+  return !m_closed;
+}
+
+void StatusQueue::close() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_closed = true;
+}
+
+struct StatusFeed::Client {
+  Client(size_t capacity, std::shared_ptr<HttpPushStream> stream)
+      : queue(capacity), out(std::move(stream)) {}
+
+  StatusQueue queue;
+  std::shared_ptr<HttpPushStream> out;
+  // Separate so the stream callback can hold it without keeping the client
+  std::shared_ptr<std::atomic<bool>> scheduled =
+      std::make_shared<std::atomic<bool>>(false);
+  std::atomic<bool> started{false};  // Snapshot queued, events may follow
+  std::chrono::steady_clock::time_point last_write =
+      std::chrono::steady_clock::now();  // Writer thread only once started
+};
+
+// Clients waiting for the writer thread, each listed once until flushed
+class StatusFeed::Writer {
+ public:
+  void schedule(std::weak_ptr<Client> client, std::atomic<bool>& scheduled) {
+    if (scheduled.exchange(true)) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_ready.push_back(std::move(client));
+    }
+    m_cv.notify_one();
+  }
+
+  // Returns false once stopped
+  bool wait(std::vector<std::weak_ptr<Client>>& ready,
+            std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait_until(lock, deadline,
+                    [this] { return m_stopped || !m_ready.empty(); });
+    ready.swap(m_ready);
+    return !m_stopped;
+  }
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopped = true;
+    }
+    m_cv.notify_one();
+  }
+
+ private:
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::vector<std::weak_ptr<Client>> m_ready;
+  bool m_stopped = false;
+};
+
+StatusFeed::StatusFeed(size_t queue_capacity)
+    : m_queue_capacity(queue_capacity),
+      m_listeners(
+          std::make_shared<std::vector<std::pair<size_t, Listener>>>()),
+      m_writer(std::make_shared<Writer>()) {}
+
+StatusFeed::~StatusFeed() {
+  disconnect_all();
+  m_writer->stop();
+  if (m_writer_thread.joinable()) {
+    m_writer_thread.join();
+  }
+}
+
+size_t StatusFeed::subscribe(Listener listener) {
+  std::lock_guard<std::mutex> lock(m_listeners_mutex);
+  // Copy on write, publish() iterates a snapshot without holding the lock
+  auto listeners =
+      std::make_shared<std::vector<std::pair<size_t, Listener>>>(*m_listeners);
+  size_t id = m_next_listener++;
+  listeners->emplace_back(id, std::move(listener));
+  m_listeners = std::move(listeners);
+  return id;
+}
+
+void StatusFeed::unsubscribe(size_t id) {
+  std::lock_guard<std::mutex> lock(m_listeners_mutex);
+  auto listeners =
+      std::make_shared<std::vector<std::pair<size_t, Listener>>>(*m_listeners);
+  std::erase_if(*listeners,
+                [id](const auto& entry) { return entry.first == id; });
+  m_listeners = std::move(listeners);
+}
+
+void StatusFeed::publish(StatusEvent event) {
+  event.seq = ++m_seq;
+  m_published.fetch_add(1, std::memory_order_relaxed);
+
+  std::shared_ptr<const std::vector<std::pair<size_t, Listener>>> listeners;
+  {
+    std::lock_guard<std::mutex> lock(m_listeners_mutex);
+    listeners = m_listeners;
+  }
+  for (const auto& [_, listener] : *listeners) {
+    listener(event);
+  }
+
+  std::lock_guard<std::mutex> lock(m_clients_mutex);
+  for (const auto& client : m_clients) {
+    client->queue.push(event);
+    m_writer->schedule(client, *client->scheduled);
+  }
+}
+
+void StatusFeed::set_snapshot(Snapshot snapshot) {
+  std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+  m_snapshot = std::move(snapshot);
+}
+
+std::vector<NodeStatus> StatusFeed::snapshot() const {
+  std::lock_guard<std::mutex> lock(m_snapshot_mutex);
+  return m_snapshot ? m_snapshot() : std::vector<NodeStatus>{};
+}
+
+std::string StatusFeed::snapshot_chunk() const {
+  std::string chunk;
+  uint64_t seq = m_seq;
+  for (const auto& status : snapshot()) {
+    append_sse(chunk, "snapshot", seq, to_json(status));
+  }
+  return chunk;
+}
+
+void StatusFeed::attach(Http& http, const std::string& path) {
+  http.push_stream(
+      "GET", path,
+      [this](const HttpRequest&, std::shared_ptr<HttpPushStream> out) {
+        serve(std::move(out));
+      },
+      "text/event-stream");
+}
+
+void StatusFeed::serve(std::shared_ptr<HttpPushStream> out) {
+  auto client = std::make_shared<Client>(m_queue_capacity, std::move(out));
+  client->out->on_ready([writer = std::weak_ptr<Writer>(m_writer),
+                         weak = std::weak_ptr<Client>(client),
+                         scheduled = client->scheduled]() {
+    if (auto alive = writer.lock()) {
+      alive->schedule(weak, *scheduled);
+    }
+  });
+
+  // Register before the snapshot so no change falls in between; a change
+  // seen twice is harmless, a missed one is not
+  {
+    std::lock_guard<std::mutex> lock(m_clients_mutex);
+    if (!m_writer_thread.joinable()) {
+      m_writer_thread = std::thread([this] { run_writer(); });
+    }
+    m_clients.push_back(client);
+  }
+  client->out->write(snapshot_chunk());
+  client->started = true;
+  m_writer->schedule(client, *client->scheduled);
+}
+
+void StatusFeed::run_writer() {
+  auto next_check = std::chrono::steady_clock::now() + KEEPALIVE_CHECK;
+  std::vector<std::weak_ptr<Client>> ready;
+  while (m_writer->wait(ready, next_check)) {
+    for (const auto& weak : ready) {
+      if (auto client = weak.lock(); client && !flush(*client)) {
+        remove_client(client);
+      }
+    }
+    ready.clear();
+    auto now = std::chrono::steady_clock::now();
+    if (now >= next_check) {
+      keep_alive(now);
+      next_check = now + KEEPALIVE_CHECK;
+    }
+  }
+}
+
+// A client still sending its previous chunk is skipped; the stream's ready
+// callback brings it back, by then with later changes folded into its queue.
+// Returns false once the client is gone.
+bool StatusFeed::flush(Client& client) {
+  client.scheduled->store(false);
+  if (!client.out->open()) {
+    return false;
+  }
+  if (!client.started || client.out->busy()) {
+    return true;
+  }
+
+  std::vector<StatusEvent> events;
+  bool resync = false;
+  if (!client.queue.pop(events, resync)) {
+    client.out->close();
+    return false;
+  }
+  std::string chunk;
+  if (resync) {
+    append_sse(chunk, "resync", m_seq, "{}");
+    chunk += snapshot_chunk();
+  }
+  for (const auto& event : events) {
+    append_sse(chunk, event.name(), event.seq, event.to_json());
+  }
+  if (chunk.empty()) {
+    return true;
+  }
+  client.last_write = std::chrono::steady_clock::now();
+  return client.out->write(chunk);
+}
+
+void StatusFeed::keep_alive(std::chrono::steady_clock::time_point now) {
+  std::vector<std::shared_ptr<Client>> clients;
+  {
+    std::lock_guard<std::mutex> lock(m_clients_mutex);
+    clients = m_clients;
+  }
+  for (const auto& client : clients) {
+    if (!client->out->open()) {
+      remove_client(client);
+    } else if (client->started && !client->out->busy() &&
+               now - client->last_write >= KEEPALIVE_INTERVAL) {
+      client->out->write(": keep-alive\n\n");
+      client->last_write = now;
+    }
+  }
+}
+
+void StatusFeed::remove_client(const std::shared_ptr<Client>& client) {
+  std::lock_guard<std::mutex> lock(m_clients_mutex);
+  if (std::erase(m_clients, client) != 0) {
+    m_retired_coalesced += client->queue.coalesced();
+    m_retired_dropped += client->queue.dropped();
+  }
+}
+
+void StatusFeed::disconnect_all() {
+  std::vector<std::shared_ptr<Client>> clients;
+  {
+    std::lock_guard<std::mutex> lock(m_clients_mutex);
+    clients.swap(m_clients);
+    for (const auto& client : clients) {
+      m_retired_coalesced += client->queue.coalesced();
+      m_retired_dropped += client->queue.dropped();
+    }
+  }
+  for (const auto& client : clients) {
+    client->queue.close();
+    client->out->close();
+  }
+}
+
+StatusFeed::Stats StatusFeed::stats() const {
+  Stats stats;
+  stats.published = m_published;
+  {
+    std::lock_guard<std::mutex> lock(m_listeners_mutex);
+    stats.listeners = m_listeners->size();
+  }
+  std::lock_guard<std::mutex> lock(m_clients_mutex);
+  stats.clients = m_clients.size();
+  stats.coalesced = m_retired_coalesced;
+  stats.dropped = m_retired_dropped;
+  for (const auto& client : m_clients) {
+    stats.coalesced += client->queue.coalesced();
+    stats.dropped += client->queue.dropped();
+  }
+  return stats;
+}
+
+}  // namespace ya::module
@@ -0,0 +1,151 @@
+#ifndef STATUS_FEED_H
+#define STATUS_FEED_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "node_def.h"
+
+namespace ya::module {
+
+class Http;
+class HttpPushStream;
+
+// {"id": ..., "address": ..., "uptime": ..., "info": ...}
+std::string to_json(const NodeStatus& status);
+
+struct StatusEvent {
+  enum class TYPE { JOIN, UPDATE, LEAVE };
+
+  TYPE type = TYPE::UPDATE;
+  NodeStatus status;
+  uint64_t seq = 0;  // Assigned by StatusFeed::publish, increases by one
+
+  const char* name() const;
+  std::string to_json() const;
+};
+
+// Pending events for one slow consumer. At most one event per node is
+// queued: a newer change to the same node is folded into the pending one
+// (JOIN+UPDATE -> JOIN, JOIN+LEAVE -> nothing, ...). When more distinct
+// nodes than the capacity are pending, the queue is dropped and the
+// consumer is told to resync from a snapshot instead.
+class StatusQueue {
+ public:
+  explicit StatusQueue(size_t capacity);
+
+  void push(const StatusEvent& event);
+
+  // Takes the pending events without waiting. Returns false when the
+  // queue was closed; resync is set when events were dropped since the
+  // last call.
+  bool pop(std::vector<StatusEvent>& events, bool& resync);
+
+  void close();
+
+  uint64_t coalesced() const { return m_coalesced; }
+  uint64_t dropped() const { return m_dropped; }
+
+ private:
+  const size_t m_capacity;
+  mutable std::mutex m_mutex;
+  std::deque<std::string> m_order;  // Node keys, may hold stale entries
+  std::unordered_map<std::string, StatusEvent> m_pending;
+  bool m_resync = false;
+  bool m_closed = false;
+  std::atomic<uint64_t> m_coalesced{0};
+  std::atomic<uint64_t> m_dropped{0};
+};
+
+// Fan-out of node membership and status changes: any number of in-process
+// listeners plus Server-Sent Events clients on an Http server. Publishing
+// costs one queue update per SSE client. A single writer thread serves all
+// clients; it wakes for clients with pending events and, every few seconds,
+// to send keep-alives, so an idle client costs its queue and a socket.
+class StatusFeed {
+ public:
+  using Listener = std::function<void(const StatusEvent&)>;
+  using Snapshot = std::function<std::vector<NodeStatus>()>;
+
+  struct Stats {
+    uint64_t published = 0;
+    uint64_t coalesced = 0;  // Folded into a pending event
+    uint64_t dropped = 0;    // Lost to overflow, clients resynced
+    size_t listeners = 0;
+    size_t clients = 0;
+  };
+
+  // Per-client queue capacity in distinct nodes
+  static constexpr size_t DEFAULT_QUEUE_CAPACITY = 1024;
+
+  explicit StatusFeed(size_t queue_capacity = DEFAULT_QUEUE_CAPACITY);
+  ~StatusFeed();
+
+  // Listeners run on the publishing thread and must not block
+  size_t subscribe(Listener listener);
+  void unsubscribe(size_t id);
+
+  void publish(StatusEvent event);
+
+  // Current membership, sent to SSE clients on connect and after a resync
+  void set_snapshot(Snapshot snapshot);
+
+  // Registers GET <path> as a text/event-stream endpoint:
+  //   event: join|update|leave|snapshot|resync
+  //   id: <seq>
+  //   data: {"id": ..., "address": ..., "uptime": ..., "info": ...}
+  void attach(Http& http, const std::string& path = "/events");
+
+  // Streams the feed to out as SSE, the snapshot first and then changes.
+  // attach() calls it for every client.
+  void serve(std::shared_ptr<HttpPushStream> out);
+
+  // Ends all SSE streams, e.g. before stopping the Http server
+  void disconnect_all();
+
+  Stats stats() const;
+
+ private:
+  struct Client;
+  class Writer;
+
+  void run_writer();
+  bool flush(Client& client);
+  void keep_alive(std::chrono::steady_clock::time_point now);
+  void remove_client(const std::shared_ptr<Client>& client);
+  std::vector<NodeStatus> snapshot() const;
+  std::string snapshot_chunk() const;
+
+  const size_t m_queue_capacity;
+  std::atomic<uint64_t> m_seq{0};
+  std::atomic<uint64_t> m_published{0};
+
+  mutable std::mutex m_listeners_mutex;
+  std::shared_ptr<const std::vector<std::pair<size_t, Listener>>> m_listeners;
+  size_t m_next_listener = 1;
+
+  mutable std::mutex m_clients_mutex;
+  std::vector<std::shared_ptr<Client>> m_clients;
+  uint64_t m_retired_coalesced = 0;
+  uint64_t m_retired_dropped = 0;
+
+  // Shared with the stream callbacks, which may outlive the feed
+  std::shared_ptr<Writer> m_writer;
+  std::thread m_writer_thread;  // Started by the first serve()
+
+  mutable std::mutex m_snapshot_mutex;
+  Snapshot m_snapshot;
+};
+
+}  // namespace ya::module
+
+#endif
@@ -4,21 +4,24 @@
 #include <nng/protocol/pubsub0/sub.h>
 
 #include <iostream>
-#include <regex>
 #include <stdexcept>
 #include <string>
 
+#include "endpoint.h"
+#include "msgpool.h"
+#include "node_def.h"
+
 namespace ya::module {
 
 class Subscriber::Impl {
  public:
-  Impl(const std::string& address) : socket_(0) {
-    // Validate address: tcp://host:port or inproc://name
-    if (!std::regex_match(
-            address,
-            std::regex("(tcp://[\\w\\d\\.:]+:\\d+|inproc://[\\w\\d\\.:]+)"))) {
+  Impl(const std::string& address, const TlsOptions& tls,
+       const ReconnectPolicy& reconnect)
+      : socket_(0), tracker_(address, reconnect.on_event) {
+    if (!is_valid_address(address)) {
       throw std::runtime_error("Invalid address format: " + address);
     }
+    stats_ = StatsRegistry::instance().create("subscriber", address);
 
     int rv;
     if ((rv = nng_sub0_open(&socket_)) != 0) {
@@ -31,7 +34,9 @@ class Subscriber::Impl {
                                std::string(nng_strerror(rv)));
     }
     std::cout << "Subscriber connecting to " << address << std::endl;
-    if ((rv = nng_dial(socket_, address.c_str(), nullptr, 0)) != 0) {
+    if ((rv = track_connections(socket_, &tracker_)) != 0 ||
+          (rv = dial_endpoint(socket_, address, tls, nullptr, reconnect)) !=
+              0) {
       nng_close(socket_);
       throw std::runtime_error("Failed to dial " + address + ": " +
                                std::string(nng_strerror(rv)));
@@ -56,22 +61,27 @@ class Subscriber::Impl {
 
   std::string receive() {
     const int max_retries = 5;
-    for (int retry = 0; retry < max_retries; ++retry) {
+    int retry = 0;
+    while (retry < max_retries) {
       nng_msg* msg;
       int rv;
-      std::cout << "Attempting to receive message (retry " << retry + 1 << ")"
-                << std::endl;
       if ((rv = nng_recvmsg(socket_, &msg, 0)) == 0) {
+        stats_->on_receive(nng_msg_len(msg));
         std::string result(static_cast<char*>(nng_msg_body(msg)),
                            nng_msg_len(msg));
-        nng_msg_free(msg);
-        std::cout << "Received message: " << result << std::endl;
+        MessagePool::release(msg);
+        if (compressor_ && !decompress(result)) {
+          stats_->on_error();  // Corrupt frame, dropped
+          continue;
+        }
         return result;
       }
       if (rv == NNG_ETIMEDOUT) {
-        std::cout << "Receive timed out, retrying..." << std::endl;
+        stats_->on_timeout();
+        ++retry;
         continue;
       }
+      stats_->on_error();
       throw std::runtime_error("Failed to receive message: " +
                                std::string(nng_strerror(rv)));
     }
@@ -79,12 +89,55 @@ class Subscriber::Impl {
                              std::to_string(max_retries) + " retries");
   }
 
+  void set_compression(const Compressor::Options& options) {
+    compressor_ = std::make_unique<Compressor>(options);
+  }
+
+  Compressor::Stats compression_stats() const {
+    return compressor_ ? compressor_->stats() : Compressor::Stats{};
+  }
+
+  const SocketStats& stats() const { return *stats_; }
+
+  ConnectionInfo connection() const { return tracker_.info(); }
+
  private:
+  // Frames follow either nothing or a "topic:" prefix. Topics may hold
+  // ':' themselves, so try after each one. A message with no frame header
+  // at all is left as it came; false when something looked like a frame
+  // but nothing decoded, so the caller drops it rather than hand on
+  // compressed bytes as payload.
+  bool decompress(std::string& message) {
+    std::string_view view(message);
+    bool framed = false;
+    size_t start = 0;
+    while (true) {
+      if (Compressor::is_frame(view.substr(start))) {
+        framed = true;
+        try {
+          message = message.substr(0, start) +
+                    compressor_->decode(view.substr(start));
+          return true;
+        } catch (const CommException&) {
+        }
+      }
+      size_t colon = message.find(':', start);
+      if (colon == std::string::npos) {
+        return !framed;
+      }
+      start = colon + 1;
+    }
+  }
+
   nng_socket socket_;
+  std::unique_ptr<Compressor> compressor_;
+  std::shared_ptr<SocketStats> stats_;
+  ConnectionTracker tracker_;  // Notified until ~Impl() closes socket_
 };
 
-Subscriber::Subscriber(const std::string& address)
-    : m_impl(std::make_unique<Impl>(address)) {}
+Subscriber::Subscriber(const std::string& address, const TlsOptions& tls,
+                       const ReconnectPolicy& reconnect)
+    : m_impl(std::make_unique<Impl>(address, tls, reconnect)) {}
 
 Subscriber::~Subscriber() {}
 
@@ -94,4 +147,18 @@ void Subscriber::subscribe(const std::string& topic) {
 
 std::string Subscriber::receive() { return m_impl->receive(); }
 
+void Subscriber::set_compression(const Compressor::Options& options) {
+  m_impl->set_compression(options);
+}
+
+Compressor::Stats Subscriber::compression_stats() const {
+  return m_impl->compression_stats();
+}
+
+const SocketStats& Subscriber::stats() const { return m_impl->stats(); }
+
+ConnectionInfo Subscriber::connection() const {
+  return m_impl->connection();
+}
+
 }  // namespace ya::module
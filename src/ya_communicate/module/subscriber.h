@@ -3,17 +3,35 @@
 
 #include <memory>
 
+#include "compressor.h"
+#include "connection.h"
+#include "stats.h"
+#include "tls.h"
+
 namespace ya::module {
 
 class Subscriber {
  public:
-  Subscriber(const std::string& address);
+  // tls is used when address is tls+tcp://
+  Subscriber(const std::string& address, const TlsOptions& tls = {},
+             const ReconnectPolicy& reconnect = {});
   ~Subscriber();
 
   void subscribe(const std::string& topic);
 
   std::string receive();
 
+  // Decode frames from a compressing publisher. Messages without a frame
+  // are returned unchanged; frames that fail to decode are dropped and
+  // counted in stats().errors.
+  void set_compression(const Compressor::Options& options);
+  Compressor::Stats compression_stats() const;
+
+  const SocketStats& stats() const;
+
+  // Live pipes and reconnect history of this socket
+  ConnectionInfo connection() const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> m_impl;
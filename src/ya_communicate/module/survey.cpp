@@ -4,21 +4,27 @@
 #include <nng/protocol/survey0/respond.h>
 #include <nng/protocol/survey0/survey.h>
 
+#include <chrono>
 #include <cstring>
-#include <regex>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "endpoint.h"
+#include "msgpool.h"
+#include "node_def.h"
+
 namespace ya::module {
 
 class Survey::Impl {
  public:
-  Impl(ROLE role, const std::string& address) : role_(role), socket_(0) {
-    // Validate address format (e.g., tcp://host:port)
-    if (!std::regex_match(address, std::regex("tcp://[\\w\\d\\.:]+:\\d+"))) {
+  Impl(ROLE role, const std::string& address, const TlsOptions& tls,
+       const ReconnectPolicy& reconnect)
+      : role_(role), socket_(0), tracker_(address, reconnect.on_event) {
+    if (!is_valid_address(address)) {
       throw std::runtime_error("Invalid address format: " + address);
     }
+    stats_ = StatsRegistry::instance().create("survey", address);
 
     int rv;
     if (role == ROLE::INITIATOR) {
@@ -34,7 +40,8 @@ class Survey::Impl {
                                  std::string(nng_strerror(rv)));
       }
       // Bind to address
-      if ((rv = nng_listen(socket_, address.c_str(), nullptr, 0)) != 0) {
+      if ((rv = track_connections(socket_, &tracker_)) != 0 ||
+          (rv = listen_endpoint(socket_, address, tls)) != 0) {
         nng_close(socket_);
         throw std::runtime_error("Failed to listen on " + address + ": " +
                                  std::string(nng_strerror(rv)));
@@ -45,7 +52,9 @@ class Survey::Impl {
                                  std::string(nng_strerror(rv)));
       }
       // Connect to initiator
-      if ((rv = nng_dial(socket_, address.c_str(), nullptr, 0)) != 0) {
+      if ((rv = track_connections(socket_, &tracker_)) != 0 ||
+          (rv = dial_endpoint(socket_, address, tls, nullptr, reconnect)) !=
+              0) {
         nng_close(socket_);
         throw std::runtime_error("Failed to dial " + address + ": " +
                                  std::string(nng_strerror(rv)));
@@ -65,24 +74,29 @@ class Survey::Impl {
     }
     nng_msg* msg;
     int rv;
-    if ((rv = nng_msg_alloc(&msg, survey.size())) != 0) {
+    if ((msg = MessagePool::acquire(survey.size())) == nullptr) {
+      stats_->on_error();
       throw std::runtime_error("Failed to allocate survey message: " +
-                               std::string(nng_strerror(rv)));
+                               std::string(nng_strerror(NNG_ENOMEM)));
     }
     memcpy(nng_msg_body(msg), survey.data(), survey.size());
+    survey_start_ = std::chrono::steady_clock::now();
     if ((rv = nng_sendmsg(socket_, msg, 0)) != 0) {
-      nng_msg_free(msg);
+      MessagePool::release(msg);
+      stats_->on_failure(rv == NNG_ETIMEDOUT);
       throw std::runtime_error("Failed to send survey: " +
                                std::string(nng_strerror(rv)));
     }
+    stats_->on_send(survey.size());
   }
 
-  std::vector<std::string> collect_responses() {
+  std::vector<std::string> collect_responses(size_t expected) {
     if (role_ != ROLE::INITIATOR) {
       throw std::runtime_error(
           "Collect responses only allowed for INITIATOR role");
     }
     std::vector<std::string> responses;
+    InFlight in_flight(*stats_);
     while (true) {
       nng_msg* msg;
       int rv = nng_recvmsg(socket_, &msg, 0);
@@ -90,12 +104,18 @@ class Survey::Impl {
         break;  // Survey deadline reached
       }
       if (rv != 0) {
+        stats_->on_error();
         throw std::runtime_error("Failed to receive response: " +
                                  std::string(nng_strerror(rv)));
       }
+      stats_->latency.Record(std::chrono::steady_clock::now() - survey_start_);
+      stats_->on_receive(nng_msg_len(msg));
       responses.emplace_back(static_cast<char*>(nng_msg_body(msg)),
                              nng_msg_len(msg));
-      nng_msg_free(msg);
+      MessagePool::release(msg);
+      if (expected != 0 && responses.size() >= expected) {
+        break;  // Everyone we were waiting for has answered
+      }
     }
     return responses;
   }
@@ -107,11 +127,14 @@ class Survey::Impl {
     nng_msg* msg;
     int rv;
     if ((rv = nng_recvmsg(socket_, &msg, 0)) != 0) {
+      stats_->on_failure(rv == NNG_ETIMEDOUT);
       throw std::runtime_error("Failed to receive survey: " +
                                std::string(nng_strerror(rv)));
     }
+    survey_start_ = std::chrono::steady_clock::now();
+    stats_->on_receive(nng_msg_len(msg));
     std::string result(static_cast<char*>(nng_msg_body(msg)), nng_msg_len(msg));
-    nng_msg_free(msg);
+    MessagePool::release(msg);
     return result;
   }
 
@@ -121,25 +144,37 @@ class Survey::Impl {
     }
     nng_msg* msg;
     int rv;
-    if ((rv = nng_msg_alloc(&msg, response.size())) != 0) {
+    if ((msg = MessagePool::acquire(response.size())) == nullptr) {
+      stats_->on_error();
       throw std::runtime_error("Failed to allocate response message: " +
-                               std::string(nng_strerror(rv)));
+                               std::string(nng_strerror(NNG_ENOMEM)));
     }
     memcpy(nng_msg_body(msg), response.data(), response.size());
     if ((rv = nng_sendmsg(socket_, msg, 0)) != 0) {
-      nng_msg_free(msg);
+      MessagePool::release(msg);
+      stats_->on_failure(rv == NNG_ETIMEDOUT);
       throw std::runtime_error("Failed to send response: " +
                                std::string(nng_strerror(rv)));
     }
+    stats_->latency.Record(std::chrono::steady_clock::now() - survey_start_);
+    stats_->on_send(response.size());
   }
 
+  const SocketStats& stats() const { return *stats_; }
+
+  ConnectionInfo connection() const { return tracker_.info(); }
+
  private:
   ROLE role_;
   nng_socket socket_;
+  std::shared_ptr<SocketStats> stats_;
+  std::chrono::steady_clock::time_point survey_start_;
+  ConnectionTracker tracker_;  // Notified until ~Impl() closes socket_
 };
 
-Survey::Survey(ROLE role, const std::string& address)
-    : m_impl(std::make_unique<Impl>(role, address)) {}
+Survey::Survey(ROLE role, const std::string& address, const TlsOptions& tls,
+               const ReconnectPolicy& reconnect)
+    : m_impl(std::make_unique<Impl>(role, address, tls, reconnect)) {}
 
 Survey::~Survey() {}
 
@@ -147,12 +182,18 @@ void Survey::send_survey(const std::string& survey) {
   m_impl->send_survey(survey);
 }
 
-std::vector<std::string> Survey::collect_responses() {
-  return m_impl->collect_responses();
+std::vector<std::string> Survey::collect_responses(size_t expected) {
+  return m_impl->collect_responses(expected);
 }
 
 std::string Survey::receive_survey() { return m_impl->receive_survey(); }
 
 void Survey::respond(const std::string& response) { m_impl->respond(response); }
 
+const SocketStats& Survey::stats() const { return m_impl->stats(); }
+
+ConnectionInfo Survey::connection() const {
+  return m_impl->connection();
+}
+
 }  // namespace ya::module
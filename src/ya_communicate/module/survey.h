@@ -4,6 +4,10 @@
 #include <memory>
 #include <vector>
 
+#include "connection.h"
+#include "stats.h"
+#include "tls.h"
+
 namespace ya::module {
 
 class Survey {
@@ -11,15 +15,25 @@ class Survey {
   enum class ROLE { INITIATOR, VOTER };
 
  public:
-  Survey(ROLE role, const std::string& address);
+  // tls is used when address is tls+tcp://, reconnect for voters (which
+  // dial the initiator)
+  Survey(ROLE role, const std::string& address, const TlsOptions& tls = {},
+         const ReconnectPolicy& reconnect = {});
   ~Survey();
 
   void send_survey(const std::string& survey);
-  std::vector<std::string> collect_responses();
+  // Blocks until the survey deadline, or until expected responses arrived
+  std::vector<std::string> collect_responses(size_t expected = 0);
 
   std::string receive_survey();
   void respond(const std::string& response);
 
+  // Latency is survey->response for INITIATOR, survey->respond for VOTER
+  const SocketStats& stats() const;
+
+  // Live pipes and reconnect history of this socket
+  ConnectionInfo connection() const;
+
  private:
   class Impl;
   std::unique_ptr<Impl> m_impl;
@@ -0,0 +1,163 @@
+#include "tls.h"
+
+#include <nng/nng.h>
+#include <nng/supplemental/tls/tls.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "node_def.h"
+
+namespace ya::module {
+
+namespace {
+
+std::string read_file(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw CommException("Failed to open " + path);
+  }
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+std::string file_version(const std::string& path) {
+  if (path.empty()) {
+    return "";
+  }
+  std::error_code ec;
+  auto time = std::filesystem::last_write_time(path, ec);
+  return ec ? "?" : std::to_string(time.time_since_epoch().count());
+}
+
+// nng's TLS engines come without CA certificates, so verification falls
+// back to the bundle of the OS
+std::string system_ca_file() {
+  if (const char* env = std::getenv("SSL_CERT_FILE"); env && *env) {
+    return env;
+  }
+  for (const char* path : {"/etc/ssl/certs/ca-certificates.crt",
+                           "/etc/pki/tls/certs/ca-bundle.crt",
+                           "/etc/ssl/ca-bundle.pem", "/etc/ssl/cert.pem"}) {
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(path, ec)) {
+      return path;
+    }
+  }
+  return "";
+}
+
+bool verifies(TLS_MODE mode, const TlsOptions& options) {
+  return mode == TLS_MODE::CLIENT ? !options.insecure_skip_verify
+                                  : options.verify_peer;
+}
+
+}  // namespace
+
+TlsContext::TlsContext(TLS_MODE mode, const TlsOptions& options)
+    : m_mode(mode) {
+  int rv;
+  if ((rv = nng_tls_config_alloc(&m_config, mode == TLS_MODE::SERVER
+                                                ? NNG_TLS_MODE_SERVER
+                                                : NNG_TLS_MODE_CLIENT)) != 0) {
+    throw CommException("Failed to allocate TLS config: " +
+                        std::string(nng_strerror(rv)));
+  }
+  try {
+    if (mode == TLS_MODE::SERVER && !options.has_cert()) {
+      throw CommException("TLS server needs a certificate and key");
+    }
+    if (options.has_cert()) {
+      // nng wants PEM text here, not file names
+      std::string cert = read_file(options.cert_file);
+      std::string key = read_file(options.key_file);
+      if ((rv = nng_tls_config_own_cert(m_config, cert.c_str(), key.c_str(),
+                                        nullptr)) != 0) {
+        throw CommException("Failed to load TLS cert: " +
+                            std::string(nng_strerror(rv)));
+      }
+    }
+    bool verify = verifies(mode, options);
+    std::string ca_file = options.ca_file;
+    if (verify && ca_file.empty()) {
+      ca_file = system_ca_file();
+      if (ca_file.empty()) {
+        throw CommException(
+            "TLS verification needs ca_file, no system CA bundle found "
+            "(insecure_skip_verify turns it off for clients)");
+      }
+    }
+    if (!ca_file.empty() &&
+        (rv = nng_tls_config_ca_file(m_config, ca_file.c_str())) != 0) {
+      throw CommException("Failed to load TLS CA " + ca_file + ": " +
+                          std::string(nng_strerror(rv)));
+    }
+    if (!options.server_name.empty() &&
+        (rv = nng_tls_config_server_name(m_config,
+                                         options.server_name.c_str())) != 0) {
+      throw CommException("Failed to set TLS server name: " +
+                          std::string(nng_strerror(rv)));
+    }
+    if ((rv = nng_tls_config_auth_mode(
+             m_config, verify ? NNG_TLS_AUTH_MODE_REQUIRED
+                              : NNG_TLS_AUTH_MODE_NONE)) != 0) {
+      throw CommException("Failed to set TLS auth mode: " +
+                          std::string(nng_strerror(rv)));
+    }
+  } catch (...) {
+    nng_tls_config_free(m_config);
+    throw;
+  }
+}
+
+TlsContext::~TlsContext() {
+  // Endpoints hold their own references, this only drops ours
+  nng_tls_config_free(m_config);
+}
+
+TlsCache& TlsCache::instance() {
+  static TlsCache cache;
+  return cache;
+}
+
+std::shared_ptr<TlsContext> TlsCache::get(TLS_MODE mode,
+                                          const TlsOptions& options) {
+  std::string key = (mode == TLS_MODE::SERVER ? "S|" : "C|") +
+                    options.cert_file + "|" + options.key_file + "|" +
+                    options.ca_file + "|" + options.server_name + "|" +
+                    (verifies(mode, options) ? "1" : "0");
+  std::string version = file_version(options.cert_file) + "|" +
+                        file_version(options.key_file) + "|" +
+                        file_version(options.ca_file);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_contexts.find(key);
+  if (it != m_contexts.end() && it->second.version == version) {
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return it->second.context;
+  }
+  // Built under the lock so concurrent sockets parse the files only once
+  auto context = std::make_shared<TlsContext>(mode, options);
+  m_misses.fetch_add(1, std::memory_order_relaxed);
+  m_contexts[key] = Entry{version, context};
+  return context;
+}
+
+size_t TlsCache::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_contexts.size();
+}
+
+void TlsCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_contexts.clear();
+}
+
+TlsCache::Stats TlsCache::stats() const {
+  return Stats{m_hits.load(), m_misses.load()};
+}
+
+}  // namespace ya::module
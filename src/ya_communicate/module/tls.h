@@ -0,0 +1,92 @@
+#ifndef TLS_H
+#define TLS_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+typedef struct nng_tls_config nng_tls_config;
+
+namespace ya::module {
+
+enum class TLS_MODE { CLIENT, SERVER };
+
+// What a socket needs to speak tls+tcp://. Only used when the address has
+// the tls+ scheme, so passing options for plain tcp is harmless.
+struct TlsOptions {
+  std::string cert_file;    // PEM certificate, required for servers
+  std::string key_file;     // PEM private key matching cert_file
+  std::string ca_file;      // PEM CA bundle, empty for the system store
+  std::string server_name;  // SNI / expected peer name for clients
+  // Servers ask clients for a certificate. Clients always verify the
+  // server unless insecure_skip_verify is set.
+  bool verify_peer = false;
+  // Clients accept any server certificate, which leaves them open to a
+  // man in the middle. Only for tests and self-signed setups.
+  bool insecure_skip_verify = false;
+
+  bool has_cert() const { return !cert_file.empty() && !key_file.empty(); }
+};
+
+// One configured nng_tls_config. Parsing PEM files and keys is the
+// expensive part of setting up TLS, so contexts are shared through
+// TlsCache instead of being built per socket.
+class TlsContext {
+ public:
+  TlsContext(TLS_MODE mode, const TlsOptions& options);  // Throws CommException
+  ~TlsContext();
+
+  nng_tls_config* native() const { return m_config; }
+  TLS_MODE mode() const { return m_mode; }
+
+  TlsContext(const TlsContext&) = delete;
+  TlsContext& operator=(const TlsContext&) = delete;
+
+ private:
+  TLS_MODE m_mode;
+  nng_tls_config* m_config = nullptr;
+};
+
+// Process-wide contexts keyed by mode, files and verification settings.
+// Every socket with the same settings shares one context, so short-lived
+// connections skip re-reading and re-parsing keys. A cert/key file that
+// changed on disk produces a fresh context.
+class TlsCache {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;  // Contexts built, i.e. PEM files parsed
+  };
+
+  static TlsCache& instance();
+
+  std::shared_ptr<TlsContext> get(TLS_MODE mode, const TlsOptions& options);
+
+  size_t size() const;
+  void clear();  // Sockets already configured keep working
+  Stats stats() const;
+
+ private:
+  TlsCache() = default;
+
+  mutable std::mutex m_mutex;
+  struct Entry {
+    std::string version;  // Modification times of the files used
+    std::shared_ptr<TlsContext> context;
+  };
+  std::map<std::string, Entry> m_contexts;
+  std::atomic<uint64_t> m_hits{0};
+  std::atomic<uint64_t> m_misses{0};
+};
+
+// True for tls+tcp:// and friends
+inline bool is_tls_address(const std::string& address) {
+  return address.rfind("tls+", 0) == 0;
+}
+
+}  // namespace ya::module
+
+#endif
@@ -0,0 +1,147 @@
+#include "zones.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace ya::module {
+
+namespace {
+
+template <typename T>
+bool parse_number(std::string_view text, T& value) {
+  auto [end, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  return ec == std::errc() && end == text.data() + text.size();
+}
+
+}  // namespace
+
+std::string ZoneSummary::encode() const {
+  return region + "," + zone + "," + representative + "," +
+         std::to_string(nodes) + "," + std::to_string(healthy) + "," +
+         std::to_string(version);
+}
+
+std::optional<ZoneSummary> ZoneSummary::decode(std::string_view text) {
+  std::vector<std::string_view> fields;
+  while (true) {
+    size_t comma = text.find(',');
+    fields.push_back(text.substr(0, comma));
+    if (comma == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(comma + 1);
+  }
+  if (fields.size() != 6) {
+    return std::nullopt;
+  }
+
+  ZoneSummary summary;
+  summary.region = fields[0];
+  summary.zone = fields[1];
+  summary.representative = fields[2];
+  if (!parse_number(fields[3], summary.nodes) ||
+      !parse_number(fields[4], summary.healthy) ||
+      !parse_number(fields[5], summary.version)) {
+    return std::nullopt;
+  }
+  return summary;
+}
+
+ZoneDirectory::ZoneDirectory(const std::string& region,
+                             const std::string& zone,
+                             std::chrono::milliseconds ttl)
+    : m_region(region), m_zone(zone), m_ttl(ttl) {}
+
+bool ZoneDirectory::merge(const ZoneSummary& summary, Clock::time_point now) {
+  if (summary.key() == key()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::erase_if(m_zones, [&](const auto& entry) {
+    return now - entry.second.received >= m_ttl;
+  });
+  auto it = m_zones.find(summary.key());
+  if (it != m_zones.end() && it->second.summary.version >= summary.version) {
+    return false;
+  }
+  m_zones[summary.key()] = Entry{summary, now};
+  return true;
+}
+
+size_t ZoneDirectory::merge_all(std::string_view encoded,
+                                Clock::time_point now) {
+  size_t stored = 0;
+  while (!encoded.empty()) {
+    size_t end = encoded.find(';');
+    if (auto summary = ZoneSummary::decode(encoded.substr(0, end))) {
+      stored += merge(*summary, now) ? 1 : 0;
+    }
+    if (end == std::string_view::npos) {
+      break;
+    }
+    encoded.remove_prefix(end + 1);
+  }
+  return stored;
+}
+
+std::string ZoneDirectory::encode(const ZoneSummary& local,
+                                  Clock::time_point now) const {
+  std::string out = local.encode();
+  for (const auto& summary : remote(now)) {
+    out += ";" + summary.encode();
+  }
+  return out;
+}
+
+std::vector<ZoneSummary> ZoneDirectory::remote(Clock::time_point now) const {
+  std::vector<ZoneSummary> result;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& [_, entry] : m_zones) {
+    if (now - entry.received < m_ttl) {
+      result.push_back(entry.summary);
+    }
+  }
+  return result;
+}
+
+std::vector<std::string> ZoneDirectory::representatives(
+    Clock::time_point now) const {
+  std::vector<std::string> urls;
+  for (const auto& summary : remote(now)) {
+    if (!summary.representative.empty()) {
+      urls.push_back(summary.representative);
+    }
+  }
+  return urls;
+}
+
+std::vector<RegionSummary> ZoneDirectory::regions(
+    const ZoneSummary& local, Clock::time_point now) const {
+  std::map<std::string, RegionSummary> regions;
+  auto add = [&regions](const ZoneSummary& summary) {
+    RegionSummary& region = regions[summary.region];
+    region.region = summary.region;
+    ++region.zones;
+    region.nodes += summary.nodes;
+    region.healthy += summary.healthy;
+  };
+  add(local);
+  for (const auto& summary : remote(now)) {
+    add(summary);
+  }
+
+  std::vector<RegionSummary> result;
+  for (auto& [_, region] : regions) {
+    result.push_back(std::move(region));
+  }
+  return result;
+}
+
+std::string ZoneDirectory::elect(
+    const std::vector<std::pair<std::string, std::string>>& members) {
+  auto it = std::min_element(members.begin(), members.end());
+  return it == members.end() ? "" : it->second;
+}
+
+}  // namespace ya::module
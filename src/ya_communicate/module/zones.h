@@ -0,0 +1,99 @@
+#ifndef ZONES_H
+#define ZONES_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ya::module {
+
+// What one zone tells the others about itself. Built by the zone's
+// representative from its full local membership.
+struct ZoneSummary {
+  std::string region;
+  std::string zone;
+  std::string representative;  // Listen url of the node speaking for the zone
+  size_t nodes = 0;
+  size_t healthy = 0;    // Nodes without failed probes
+  uint64_t version = 0;  // Wall clock of the representative in ms, newer wins
+
+  std::string key() const { return region + "/" + zone; }
+
+  // region,zone,representative,nodes,healthy,version
+  std::string encode() const;
+  static std::optional<ZoneSummary> decode(std::string_view text);
+};
+
+// Zones of one region added up
+struct RegionSummary {
+  std::string region;
+  size_t zones = 0;
+  size_t nodes = 0;
+  size_t healthy = 0;
+};
+
+// Summaries of the other zones, as seen from one node.
+//
+// Within a zone every node tracks every other; across zones only one
+// summary per zone is kept and exchanged, so per-node state and WAN
+// traffic grow with the number of zones, not of nodes. Summaries that are
+// not refreshed within ttl are forgotten (the zone is unreachable).
+class ZoneDirectory {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  ZoneDirectory(const std::string& region, const std::string& zone,
+                std::chrono::milliseconds ttl);
+
+  const std::string& region() const { return m_region; }
+  const std::string& zone() const { return m_zone; }
+  std::string key() const { return m_region + "/" + m_zone; }
+
+  // Stores a remote summary unless it is about our own zone or older than
+  // the one held. Returns whether it was stored.
+  bool merge(const ZoneSummary& summary, Clock::time_point now);
+
+  // Merges a list produced by encode(), returns how many were stored
+  size_t merge_all(std::string_view encoded, Clock::time_point now);
+
+  // local followed by every live remote summary, ';' separated, so one
+  // exchange also passes on the zones the sender heard of
+  std::string encode(const ZoneSummary& local, Clock::time_point now) const;
+
+  // Live remote summaries, sorted by key
+  std::vector<ZoneSummary> remote(Clock::time_point now) const;
+
+  // Representatives of the live remote zones
+  std::vector<std::string> representatives(Clock::time_point now) const;
+
+  // local and remote zones added up per region, sorted by region
+  std::vector<RegionSummary> regions(const ZoneSummary& local,
+                                     Clock::time_point now) const;
+
+  // Deterministic representative: the lowest id among live members, so
+  // every member of a zone picks the same one without extra messages.
+  // Takes (id, listen url) pairs and returns the url, empty if none.
+  static std::string elect(
+      const std::vector<std::pair<std::string, std::string>>& members);
+
+ private:
+  struct Entry {
+    ZoneSummary summary;
+    Clock::time_point received;
+  };
+
+  const std::string m_region;
+  const std::string m_zone;
+  const std::chrono::milliseconds m_ttl;
+  mutable std::mutex m_mutex;
+  std::map<std::string, Entry> m_zones;
+};
+
+}  // namespace ya::module
+
+#endif
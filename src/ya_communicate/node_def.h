@@ -2,6 +2,7 @@
 #define NODE_DEF_H
 
 #include <format>
+#include <regex>
 #include <sstream>
 #include <string>
 
@@ -23,6 +24,14 @@ inline std::string NodeStatus::to_string() const {
   return ss.str();
 }
 
+// Accepts tcp://host:port, tls+tcp://host:port, ipc://path and inproc://name
+inline bool is_valid_address(const std::string& address) {
+  static const std::regex pattern(
+      "((tls\\+)?tcp://[\\w\\d\\.:\\-]+:\\d+|ipc://\\S+|inproc://"
+      "[\\w\\d\\.:\\-]+)");
+  return std::regex_match(address, pattern);
+}
+
 class CommException : public std::runtime_error {
  public:
   CommException(const std::string& msg) : std::runtime_error(msg) {}
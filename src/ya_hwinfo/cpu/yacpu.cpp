@@ -1,18 +1,58 @@
 #include "yacpu.h"
 
 #include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <thread>
 
 #include "platform_def.h"
+#include "yautils.h"
 #if defined(YA_WINDOWS)
 #include "hwinfooperator.h"
 #endif
 #if defined(YA_LINUX)
 #include <sys/utsname.h>
+
+#include <filesystem>
 #endif
 
 namespace ya {
 
-YaCPU::YaCPU() { init(); }
+namespace {
+
+#if defined(YA_LINUX)
+std::string read_line(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+// sysfs lists are well-formed; a missing or garbled file reads as no CPUs
+std::vector<int> read_cpu_list(const std::string& path) {
+  try {
+    return YaUtils::CpuList::Parse(read_line(path));
+  } catch (const std::invalid_argument&) {
+    return {};
+  }
+}
+
+int read_int(const std::string& path, int fallback) {
+  try {
+    return std::stoi(read_line(path));
+  } catch (const std::exception&) {
+    return fallback;
+  }
+}
+#endif
+
+}  // namespace
+
+YaCPU::YaCPU() {
+  init();
+  initTopology();
+}
 
 YaCPU::~YaCPU() {}
 
@@ -24,6 +64,8 @@ std::string YaCPU::getManufacturer() { return m_cpu.manufacturer; }
 
 std::string YaCPU::getName() { return m_cpu.name; }
 
+CPU_TOPOLOGY YaCPU::getTopology() { return m_topology; }
+
 void YaCPU::init() {
 #if defined(YA_WINDOWS)
   WmiQuery wmi;
@@ -107,4 +149,58 @@ void YaCPU::init() {
 #endif
 }
 
+void YaCPU::initTopology() {
+  m_topology = CPU_TOPOLOGY{};
+#if defined(YA_LINUX)
+  // /sys/devices/system/cpu and /sys/devices/system/node
+  const std::string cpu_root = "/sys/devices/system/cpu/";
+  std::map<int, int> node_of;
+  int nodes = 0;
+  std::error_code ec;
+  for (const auto& entry :
+       std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+    std::string name = entry.path().filename().string();
+    if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+        name.find_first_not_of("0123456789", 4) != std::string::npos) {
+      continue;
+    }
+    int node = std::stoi(name.substr(4));
+    for (int cpu : read_cpu_list((entry.path() / "cpulist").string())) {
+      node_of[cpu] = node;
+    }
+    ++nodes;
+  }
+
+  std::map<std::pair<int, int>, int> core_index;  // (package, core_id)
+  std::set<int> packages;
+  for (int cpu : read_cpu_list(cpu_root + "online")) {
+    std::string topology =
+        cpu_root + "cpu" + std::to_string(cpu) + "/topology/";
+    CPU_TOPOLOGY::LOGICAL logical;
+    logical.id = cpu;
+    logical.package = read_int(topology + "physical_package_id", 0);
+    int core_id = read_int(topology + "core_id", cpu);
+    auto [it, _] = core_index.emplace(std::make_pair(logical.package, core_id),
+                                      static_cast<int>(core_index.size()));
+    logical.core = it->second;
+    logical.numa_node = node_of.count(cpu) ? node_of[cpu] : 0;
+    packages.insert(logical.package);
+    m_topology.logical.push_back(logical);
+  }
+  m_topology.packages = static_cast<int>(packages.size());
+  m_topology.cores = static_cast<int>(core_index.size());
+  m_topology.numa_nodes = nodes > 0 ? nodes : 1;
+#endif
+  if (m_topology.logical.empty()) {
+    // Unknown layout, report one core per logical CPU
+    int count = static_cast<int>(std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < count; ++cpu) {
+      m_topology.logical.push_back(CPU_TOPOLOGY::LOGICAL{cpu, cpu, 0, 0});
+    }
+    m_topology.packages = 1;
+    m_topology.cores = count;
+    m_topology.numa_nodes = 1;
+  }
+}
+
 }  // namespace ya
@@ -14,12 +14,15 @@ class YaCPU {
   std::string getArchitecture();
   std::string getManufacturer();
   std::string getName();
+  CPU_TOPOLOGY getTopology();
 
  private:
   void init();
+  void initTopology();
 
  private:
   CPU m_cpu;
+  CPU_TOPOLOGY m_topology;
 };
 
 }  // namespace ya
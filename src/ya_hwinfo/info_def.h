@@ -2,6 +2,7 @@
 #define INFO_DEF_H
 
 #include <string>
+#include <vector>
 
 namespace ya {
 
@@ -19,6 +20,20 @@ struct CPU {
   std::string name;
 };
 
+struct CPU_TOPOLOGY {
+  struct LOGICAL {
+    int id = 0;         // Logical CPU number, as used for affinity
+    int core = 0;       // Physical core, unique across packages
+    int package = 0;    // Socket
+    int numa_node = 0;
+  };
+
+  std::vector<LOGICAL> logical;  // Online logical CPUs, ordered by id
+  int packages = 0;
+  int cores = 0;  // Physical cores
+  int numa_nodes = 0;
+};
+
 struct DISK {
   std::string serial_number;
   std::string manufacturer;
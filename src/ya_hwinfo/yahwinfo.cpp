@@ -33,6 +33,10 @@ class YaHwinfo::Impl {
     };
     return cpu;
   }
+  CPU_TOPOLOGY getCPUTopology() {
+    YaCPU ya_cpu;
+    return ya_cpu.getTopology();
+  }
   std::vector<GPU> getGPU() {
     YaGPU ya_gpu;
     return ya_gpu.getGPU();
@@ -80,6 +84,8 @@ BIOS YaHwinfo::getBIOS() { return m_impl->getBIOS(); }
 
 CPU YaHwinfo::getCPU() { return m_impl->getCPU(); }
 
+CPU_TOPOLOGY YaHwinfo::getCPUTopology() { return m_impl->getCPUTopology(); }
+
 std::vector<GPU> YaHwinfo::getGPU() { return m_impl->getGPU(); }
 
 std::vector<MEMORY> YaHwinfo::getMEMORY() { return m_impl->getMEMORY(); }
@@ -14,6 +14,7 @@ class YaHwinfo {
   ~YaHwinfo();
   BIOS getBIOS();
   CPU getCPU();
+  CPU_TOPOLOGY getCPUTopology();
   std::vector<GPU> getGPU();
   std::vector<MEMORY> getMEMORY();
   OS getOS();
@@ -2,6 +2,7 @@
 #define I_SQL_DRIVER_H
 
 #include <map>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,23 @@ class ISqlDriver {
   virtual bool remove(const std::string& table, const std::string& where) = 0;
   virtual std::vector<std::map<std::string, std::string>> query(
       const std::string& sql) = 0;
+
+  using PmrRow = std::pmr::map<std::pmr::string, std::pmr::string>;
+
+  // query() with the rows, names and values allocated from resource, e.g.
+  // a per-request YaUtils::Arena. Drivers that do not build rows in place
+  // copy the result of query().
+  virtual std::pmr::vector<PmrRow> query(const std::string& sql,
+                                         std::pmr::memory_resource* resource) {
+    std::pmr::vector<PmrRow> rows(resource);
+    for (const auto& row : query(sql)) {
+      auto& copy = rows.emplace_back();
+      for (const auto& [name, value] : row) {
+        copy.emplace(name, value);
+      }
+    }
+    return rows;
+  }
 };
 
 }  // namespace ya
@@ -18,6 +18,7 @@ class MongodbDriver : public ISqlDriver {
               const std::map<std::string, std::string> &data,
               const std::string &where);
   bool remove(const std::string &table, const std::string &where);
+  using ISqlDriver::query;  // Keeps the memory_resource overload visible
   std::vector<std::map<std::string, std::string> > query(
       const std::string &sql);
 };
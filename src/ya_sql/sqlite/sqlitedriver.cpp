@@ -122,32 +122,43 @@ bool SQLiteDriver::remove(const std::string &table, const std::string &where) {
 std::vector<std::map<std::string, std::string>> SQLiteDriver::query(
     const std::string &sql) {
   std::vector<std::map<std::string, std::string>> results;
-  if (!db) return results;
+  read_rows(sql, results);
+  return results;
+}
+
+std::pmr::vector<ISqlDriver::PmrRow> SQLiteDriver::query(
+    const std::string &sql, std::pmr::memory_resource *resource) {
+  std::pmr::vector<PmrRow> results(resource);
+  read_rows(sql, results);
+  return results;
+}
+
+template <typename Rows>
+void SQLiteDriver::read_rows(const std::string &sql, Rows &results) {
+  if (!db) return;
 
   sqlite3_stmt *stmt;
   if (sqlite3_prepare_v2(static_cast<sqlite3 *>(db), sql.c_str(), -1, &stmt,
                          nullptr) != SQLITE_OK) {  // Cast void* to sqlite3*
-    return results;
+    return;
   }
 
   int col_count = sqlite3_column_count(stmt);
-  std::vector<std::string> col_names(col_count);
-  for (int i = 0; i < col_count; i++) {
-    col_names[i] = sqlite3_column_name(stmt, i);
-  }
-
   while (sqlite3_step(stmt) == SQLITE_ROW) {
-    std::map<std::string, std::string> row;
+    // Built in place, so pmr rows take the vector's resource
+    auto &row = results.emplace_back();
     for (int i = 0; i < col_count; i++) {
       const char *value =
           reinterpret_cast<const char *>(sqlite3_column_text(stmt, i));
-      row[col_names[i]] = value ? value : "";
+      auto [it, inserted] =
+          row.emplace(sqlite3_column_name(stmt, i), value ? value : "");
+      if (!inserted) {
+        it->second = value ? value : "";
+      }
     }
-    results.push_back(row);
   }
 
   sqlite3_finalize(stmt);
-  return results;
 }
 
 }  // namespace ya
@@ -20,8 +20,14 @@ class SQLiteDriver : public ISqlDriver {
   bool remove(const std::string& table, const std::string& where) override;
   std::vector<std::map<std::string, std::string>> query(
       const std::string& sql) override;
+  std::pmr::vector<PmrRow> query(
+      const std::string& sql, std::pmr::memory_resource* resource) override;
 
  private:
+  // Appends one name to value map per result row
+  template <typename Rows>
+  void read_rows(const std::string& sql, Rows& results);
+
   void* db;  // sqlite3*
 };
 
@@ -45,4 +45,12 @@ std::vector<std::map<std::string, std::string>> YaSql::query(const std::string&
     return {};
 }
 
+std::pmr::vector<ISqlDriver::PmrRow> YaSql::query(
+    const std::string& sql, std::pmr::memory_resource* resource) {
+  if (m_driver) {
+    return m_driver->query(sql, resource);
+  }
+  return std::pmr::vector<ISqlDriver::PmrRow>(resource);
+}
+
 }  // namespace ya
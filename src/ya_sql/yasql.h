@@ -21,6 +21,9 @@ class YaSql {
               const std::string& where);
   bool remove(const std::string& table, const std::string& where);
   std::vector<std::map<std::string, std::string>> query(const std::string& sql);
+  // Rows allocated from resource; see ISqlDriver
+  std::pmr::vector<ISqlDriver::PmrRow> query(
+      const std::string& sql, std::pmr::memory_resource* resource);
 
  private:
   std::unique_ptr<ISqlDriver> m_driver;
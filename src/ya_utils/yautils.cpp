@@ -1,24 +1,151 @@
 #include "yautils.h"
 
 #include <openssl/dsa.h>
+#include <openssl/ec.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
+#include <openssl/kdf.h>
 #include <openssl/pem.h>
 #include <openssl/rsa.h>
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <filesystem>
+#include <fstream>
 #include <map>
+#include <mutex>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
 #include "platform_def.h"
 
+#if defined(YA_UNIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(YA_UTILS_HAS_TSC) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define YA_UTILS_CRC32C_SSE42
+#include <nmmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define YA_UTILS_TARGET_SSE42
+#else
+#define YA_UTILS_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define YA_UTILS_CRC32C_ARM
+#include <arm_acle.h>
+#endif
+
 namespace ya {
 
+namespace {
+
+struct NamedTimers {
+  std::mutex mutex;
+  std::map<std::string, std::chrono::steady_clock::time_point, std::less<>>
+      timers;
+};
+
+NamedTimers& named_timers() {
+  static NamedTimers timers;
+  return timers;
+}
+
+#if defined(YA_UTILS_HAS_TSC)
+// Invariant TSC (CPUID 80000007h EDX bit 8) ticks at a constant rate on all
+// cores and through sleep states; RDTSCP is CPUID 80000001h EDX bit 27
+bool cpu_has_tsc() {
+  unsigned int regs[4] = {};
+#if defined(_MSC_VER)
+  __cpuid(reinterpret_cast<int*>(regs), 0x80000000);
+  unsigned int max_leaf = regs[0];
+  auto query = [&regs](unsigned int leaf) {
+    __cpuid(reinterpret_cast<int*>(regs), leaf);
+  };
+#else
+  unsigned int max_leaf = __get_cpuid_max(0x80000000, nullptr);
+  auto query = [&regs](unsigned int leaf) {
+    __get_cpuid(leaf, &regs[0], &regs[1], &regs[2], &regs[3]);
+  };
+#endif
+  if (max_leaf < 0x80000007) {
+    return false;
+  }
+  query(0x80000001);
+  bool rdtscp = regs[3] & (1u << 27);
+  query(0x80000007);
+  bool invariant = regs[3] & (1u << 8);
+  return rdtscp && invariant;
+}
+#endif
+
+// Lowers or raises an atomic to value, for min and max
+template <typename Compare>
+void store_if(std::atomic<uint64_t>& target, uint64_t value, Compare better) {
+  uint64_t current = target.load(std::memory_order_relaxed);
+  while (better(value, current) &&
+         !target.compare_exchange_weak(current, value,
+                                       std::memory_order_relaxed)) {
+  }
+}
+
+std::string escape_json(std::string_view text) {
+  std::string out;
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+std::string escape_label(std::string_view text) {
+  std::string out;
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+std::string format_double(double value) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.1f", value);
+  return buf;
+}
+
+std::atomic<size_t> g_next_probe_id{0};
+
+}  // namespace
+
 std::string YaUtils::Exe::m_exe_name = "";
-std::map<std::string, std::chrono::steady_clock::time_point>
-    YaUtils::Timer::m_timers = {};
 
 std::string YaUtils::Exe::GetExeDir() {
   std::string path = std::filesystem::current_path().string();
@@ -42,8 +169,42 @@ void YaUtils::Timer::Sleep(unsigned int ms) {
   std::this_thread::sleep_for(std::chrono::milliseconds(ms));
 }
 
+bool YaUtils::Timer::UsesTsc() {
+#if defined(YA_UTILS_HAS_TSC)
+  static const bool tsc = cpu_has_tsc();
+  return tsc;
+#else
+  return false;
+#endif
+}
+
+// The TSC rate is measured against steady_clock once, busy waiting 10 ms
+// on the first conversion
+double YaUtils::Timer::TicksToNs(uint64_t ticks) {
+  static const double ns_per_tick = [] {
+    if (!UsesTsc()) {
+      return 1.0;
+    }
+    using std::chrono::steady_clock;
+    auto begin = steady_clock::now();
+    uint64_t first = Ticks();
+    auto end = begin;
+    while (end - begin < std::chrono::milliseconds(10)) {
+      end = steady_clock::now();
+    }
+    uint64_t last = Ticks();
+    auto ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+    return static_cast<double>(ns.count()) / static_cast<double>(last - first);
+  }();
+  return static_cast<double>(ticks) * ns_per_tick;
+}
+
 void YaUtils::Timer::StartTimer(const std::string& timer_id) {
-  m_timers[timer_id] = std::chrono::steady_clock::now();
+  auto now = std::chrono::steady_clock::now();
+  NamedTimers& named = named_timers();
+  std::lock_guard<std::mutex> lock(named.mutex);
+  named.timers[timer_id] = now;
 }
 
 double YaUtils::Timer::GetElapsedTime_ms(const std::string& timer_id) {
@@ -56,15 +217,309 @@ double YaUtils::Timer::GetElapsedTime_s(const std::string& timer_id) {
 
 double YaUtils::Timer::GetElapsedTime_μs(const std::string& timer_id) {
   auto now = std::chrono::steady_clock::now();
-  auto it = m_timers.find(timer_id);
-  if (it == m_timers.end()) {
-    return 0.0;
+  NamedTimers& named = named_timers();
+  std::chrono::steady_clock::time_point start;
+  {
+    std::lock_guard<std::mutex> lock(named.mutex);
+    auto it = named.timers.find(timer_id);
+    if (it == named.timers.end()) {
+      return 0.0;
+    }
+    start = it->second;
   }
   auto duration =
-      std::chrono::duration_cast<std::chrono::microseconds>(now - it->second);
+      std::chrono::duration_cast<std::chrono::microseconds>(now - start);
   return static_cast<double>(duration.count());
 }
 
+YaUtils::Histogram::Histogram(const Histogram& other) { *this = other; }
+
+YaUtils::Histogram& YaUtils::Histogram::operator=(const Histogram& other) {
+  if (this != &other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+      m_counts[i].store(other.m_counts[i].load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    }
+    m_count.store(other.Count(), std::memory_order_relaxed);
+    m_sum.store(other.m_sum.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+    m_min.store(other.m_min.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+    m_max.store(other.Max(), std::memory_order_relaxed);
+  }
+  return *this;
+}
+
+void YaUtils::Histogram::Record(uint64_t value_ns) {
+  value_ns = std::min(value_ns, MAX_VALUE);
+  m_counts[BucketOf(value_ns)].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(value_ns, std::memory_order_relaxed);
+  store_if(m_min, value_ns, std::less<>());
+  store_if(m_max, value_ns, std::greater<>());
+}
+
+void YaUtils::Histogram::Record(std::chrono::nanoseconds elapsed) {
+  Record(static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0)));
+}
+
+void YaUtils::Histogram::Merge(const Histogram& other) {
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    uint64_t count = other.m_counts[i].load(std::memory_order_relaxed);
+    if (count != 0) {
+      m_counts[i].fetch_add(count, std::memory_order_relaxed);
+    }
+  }
+  m_count.fetch_add(other.Count(), std::memory_order_relaxed);
+  m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+  store_if(m_min, other.m_min.load(std::memory_order_relaxed),
+           std::less<>());
+  store_if(m_max, other.Max(), std::greater<>());
+}
+
+void YaUtils::Histogram::Reset() {
+  for (auto& count : m_counts) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  m_count.store(0, std::memory_order_relaxed);
+  m_sum.store(0, std::memory_order_relaxed);
+  m_min.store(UINT64_MAX, std::memory_order_relaxed);
+  m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t YaUtils::Histogram::Min() const {
+  return Count() == 0 ? 0 : m_min.load(std::memory_order_relaxed);
+}
+
+double YaUtils::Histogram::Mean() const {
+  uint64_t count = Count();
+  return count == 0 ? 0.0
+                    : static_cast<double>(
+                          m_sum.load(std::memory_order_relaxed)) /
+                          static_cast<double>(count);
+}
+
+uint64_t YaUtils::Histogram::Percentile(double percentile) const {
+  // Totals from the buckets themselves, in case of concurrent Record()
+  uint64_t total = 0;
+  for (const auto& count : m_counts) {
+    total += count.load(std::memory_order_relaxed);
+  }
+  if (total == 0) {
+    return 0;
+  }
+  percentile = std::clamp(percentile, 0.0, 100.0);
+  auto target = std::max<uint64_t>(
+      1, static_cast<uint64_t>(
+             std::ceil(percentile / 100.0 * static_cast<double>(total))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    seen += m_counts[i].load(std::memory_order_relaxed);
+    if (seen >= target) {
+      return std::clamp(BucketTop(i), Min(), Max());
+    }
+  }
+  return Max();
+}
+
+// Values below SUB_BUCKETS get a bucket each; above, the top SUB_BITS + 1
+// bits pick the bucket within the value's power of two
+size_t YaUtils::Histogram::BucketOf(uint64_t value) {
+  value = std::min(value, MAX_VALUE);
+  if (value < SUB_BUCKETS) {
+    return value;
+  }
+  int shift = std::bit_width(value) - SUB_BITS - 1;
+  return shift * SUB_BUCKETS + (value >> shift);
+}
+
+uint64_t YaUtils::Histogram::BucketTop(size_t bucket) {
+  if (bucket < 2 * SUB_BUCKETS) {
+    return bucket;
+  }
+  int shift = static_cast<int>(bucket / SUB_BUCKETS) - 1;
+  uint64_t sub = bucket % SUB_BUCKETS + SUB_BUCKETS;
+  return ((sub + 1) << shift) - 1;
+}
+
+struct YaUtils::Profiler::Probe::Slot {
+  Histogram histogram;
+  std::atomic<bool> in_use{true};
+};
+
+YaUtils::Profiler::Probe::Probe(std::string_view name)
+    : m_name(name), m_id(g_next_probe_id.fetch_add(1)) {}
+
+void YaUtils::Profiler::Probe::Record(uint64_t value_ns) {
+  LocalHistogram().Record(value_ns);
+}
+
+YaUtils::Histogram& YaUtils::Profiler::Probe::LocalHistogram() {
+  // Slots of the thread by probe id; freed for reuse when the thread exits
+  struct Table {
+    std::vector<std::shared_ptr<Slot>> slots;
+    ~Table() {
+      for (auto& slot : slots) {
+        if (slot) {
+          slot->in_use.store(false, std::memory_order_release);
+        }
+      }
+    }
+  };
+  thread_local Table table;
+
+  if (m_id < table.slots.size() && table.slots[m_id]) {
+    return table.slots[m_id]->histogram;
+  }
+
+  std::shared_ptr<Slot> slot;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& free : m_slots) {
+      if (!free->in_use.exchange(true, std::memory_order_acquire)) {
+        slot = free;
+        break;
+      }
+    }
+    if (!slot) {
+      slot = std::make_shared<Slot>();
+      m_slots.push_back(slot);
+    }
+  }
+  if (table.slots.size() <= m_id) {
+    table.slots.resize(m_id + 1);
+  }
+  table.slots[m_id] = slot;
+  return slot->histogram;
+}
+
+YaUtils::Histogram YaUtils::Profiler::Probe::Collect() const {
+  Histogram merged;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& slot : m_slots) {
+    merged.Merge(slot->histogram);
+  }
+  return merged;
+}
+
+void YaUtils::Profiler::Probe::Reset() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& slot : m_slots) {
+    slot->histogram.Reset();
+  }
+}
+
+YaUtils::Profiler::~Profiler() { StopReporter(); }
+
+YaUtils::Profiler& YaUtils::Profiler::Instance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+YaUtils::Profiler::Probe& YaUtils::Profiler::GetProbe(std::string_view name) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_probes.find(name);
+  if (it == m_probes.end()) {
+    it = m_probes.emplace(std::string(name), std::make_unique<Probe>(name))
+             .first;
+  }
+  return *it->second;
+}
+
+std::vector<YaUtils::Profiler::Snapshot> YaUtils::Profiler::Collect() const {
+  std::vector<Snapshot> snapshots;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& [name, probe] : m_probes) {
+    Histogram histogram = probe->Collect();
+    Snapshot snapshot;
+    snapshot.name = name;
+    snapshot.count = histogram.Count();
+    snapshot.mean_ns = histogram.Mean();
+    snapshot.min_ns = histogram.Min();
+    snapshot.max_ns = histogram.Max();
+    snapshot.p50_ns = histogram.Percentile(50);
+    snapshot.p90_ns = histogram.Percentile(90);
+    snapshot.p99_ns = histogram.Percentile(99);
+    snapshot.p999_ns = histogram.Percentile(99.9);
+    snapshots.push_back(std::move(snapshot));
+  }
+  return snapshots;
+}
+
+void YaUtils::Profiler::Reset() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& [_, probe] : m_probes) {
+    probe->Reset();
+  }
+}
+
+std::string YaUtils::Profiler::DumpJson() const {
+  std::string out = "{\"probes\":[";
+  bool first = true;
+  for (const auto& snapshot : Collect()) {
+    out += first ? "" : ",";
+    first = false;
+    out += "{\"name\":\"" + escape_json(snapshot.name) + "\"";
+    out += ",\"count\":" + std::to_string(snapshot.count);
+    out += ",\"mean_ns\":" + format_double(snapshot.mean_ns);
+    out += ",\"min_ns\":" + std::to_string(snapshot.min_ns);
+    out += ",\"max_ns\":" + std::to_string(snapshot.max_ns);
+    out += ",\"p50_ns\":" + std::to_string(snapshot.p50_ns);
+    out += ",\"p90_ns\":" + std::to_string(snapshot.p90_ns);
+    out += ",\"p99_ns\":" + std::to_string(snapshot.p99_ns);
+    out += ",\"p999_ns\":" + std::to_string(snapshot.p999_ns) + "}";
+  }
+  return out + "]}";
+}
+
+std::string YaUtils::Profiler::DumpPrometheus(std::string_view metric) const {
+  std::string name(metric);
+  std::string out = "# TYPE " + name + " summary\n";
+  for (const auto& snapshot : Collect()) {
+    std::string label = "probe=\"" + escape_label(snapshot.name) + "\"";
+    auto quantile = [&](const char* q, uint64_t value) {
+      out += name + "{" + label + ",quantile=\"" + q + "\"} " +
+             std::to_string(value) + "\n";
+    };
+    quantile("0.5", snapshot.p50_ns);
+    quantile("0.9", snapshot.p90_ns);
+    quantile("0.99", snapshot.p99_ns);
+    quantile("0.999", snapshot.p999_ns);
+    out += name + "_sum{" + label + "} " +
+           format_double(snapshot.mean_ns * snapshot.count) + "\n";
+    out += name + "_count{" + label + "} " + std::to_string(snapshot.count) +
+           "\n";
+  }
+  return out;
+}
+
+void YaUtils::Profiler::StartReporter(std::chrono::milliseconds interval,
+                                      Reporter reporter) {
+  StopReporter();
+  m_reporter_stop = false;
+  m_reporter = std::thread([this, interval, reporter = std::move(reporter)] {
+    std::unique_lock<std::mutex> lock(m_reporter_mutex);
+    while (!m_reporter_cv.wait_for(lock, interval,
+                                   [this] { return m_reporter_stop; })) {
+      lock.unlock();
+      reporter(Collect());
+      lock.lock();
+    }
+  });
+}
+
+void YaUtils::Profiler::StopReporter() {
+  {
+    std::lock_guard<std::mutex> lock(m_reporter_mutex);
+    m_reporter_stop = true;
+  }
+  m_reporter_cv.notify_all();
+  if (m_reporter.joinable()) {
+    m_reporter.join();
+  }
+}
+
 YaUtils::Platform::PLATFORM YaUtils::Platform::GetPlatform() {
 #if defined(YA_WINDOWS)
   return PLATFORM::WINDOWS;
@@ -77,6 +532,242 @@ YaUtils::Platform::PLATFORM YaUtils::Platform::GetPlatform() {
 #endif
 }
 
+std::vector<int> YaUtils::CpuList::Parse(const std::string& list) {
+  std::vector<int> cpus;
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t comma = std::min(list.find(',', start), list.size());
+    std::string range = list.substr(start, comma - start);
+    start = comma + 1;
+    if (range.empty()) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    size_t used = 0;
+    int first = 0;
+    int last = 0;
+    try {
+      first = std::stoi(range.substr(0, dash), &used);
+      last = first;
+      if (used != (dash == std::string::npos ? range.size() : dash)) {
+        throw std::invalid_argument(range);
+      }
+      if (dash != std::string::npos) {
+        std::string end = range.substr(dash + 1);
+        last = std::stoi(end, &used);
+        if (used != end.size() || last < first) {
+          throw std::invalid_argument(range);
+        }
+      }
+    } catch (const std::logic_error&) {
+      throw std::invalid_argument("Bad CPU list: " + list);
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+std::string YaUtils::CpuList::Format(const std::vector<int>& cpus) {
+  std::vector<int> sorted = cpus;
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  std::string out;
+  for (size_t i = 0; i < sorted.size();) {
+    size_t j = i;
+    while (j + 1 < sorted.size() && sorted[j + 1] == sorted[j] + 1) {
+      ++j;
+    }
+    if (!out.empty()) {
+      out += ',';
+    }
+    out += std::to_string(sorted[i]);
+    if (j > i) {
+      out += '-' + std::to_string(sorted[j]);
+    }
+    i = j + 1;
+  }
+  return out;
+}
+
+namespace {
+
+// Below these, spreading a batch over threads costs more than it saves
+constexpr size_t PARALLEL_MIN_BYTES = 256 << 10;
+constexpr size_t PARALLEL_MIN_VERIFIES = 8;
+
+// EVP_sha256() and EVP_md5() are looked up again on every init under
+// OpenSSL 3; fetch them once
+const EVP_MD* md_sha256() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  static EVP_MD* fetched = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+  if (fetched) {
+    return fetched;
+  }
+#endif
+  return EVP_sha256();
+}
+
+const EVP_MD* md_md5() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  static EVP_MD* fetched = EVP_MD_fetch(nullptr, "MD5", nullptr);
+  if (fetched) {
+    return fetched;
+  }
+#endif
+  return EVP_md5();
+}
+
+}  // namespace
+
+class YaUtils::Key::Impl {
+ public:
+  Impl(EVP_PKEY* pkey, bool is_private) : pkey(pkey), is_private(is_private) {}
+  ~Impl() { EVP_PKEY_free(pkey); }
+  Impl(const Impl&) = delete;
+  Impl& operator=(const Impl&) = delete;
+
+  EVP_PKEY* const pkey;
+  const bool is_private;
+};
+
+YaUtils::Key::Key(std::shared_ptr<const Impl> impl) : m_impl(std::move(impl)) {}
+
+std::optional<YaUtils::Key> YaUtils::Key::LoadPublic(const CryptoBuffer& pem) {
+  BIO* bio = BIO_new_mem_buf(pem.data(), static_cast<int>(pem.size()));
+  EVP_PKEY* pkey =
+      bio ? PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr) : nullptr;
+  BIO_free(bio);
+  if (!pkey) {
+    return std::nullopt;
+  }
+  return Key(std::make_shared<const Impl>(pkey, false));
+}
+
+std::optional<YaUtils::Key> YaUtils::Key::LoadPrivate(const CryptoBuffer& pem) {
+  BIO* bio = BIO_new_mem_buf(pem.data(), static_cast<int>(pem.size()));
+  EVP_PKEY* pkey =
+      bio ? PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr) : nullptr;
+  BIO_free(bio);
+  if (!pkey) {
+    return std::nullopt;
+  }
+  return Key(std::make_shared<const Impl>(pkey, true));
+}
+
+YaUtils::Key::TYPE YaUtils::Key::GetType() const {
+  switch (EVP_PKEY_base_id(m_impl->pkey)) {
+    case EVP_PKEY_RSA:
+      return TYPE::RSA;
+    case EVP_PKEY_DSA:
+      return TYPE::DSA;
+    case EVP_PKEY_EC:
+      return TYPE::EC;
+    case EVP_PKEY_ED25519:
+      return TYPE::ED25519;
+    case EVP_PKEY_X25519:
+      return TYPE::X25519;
+    default:
+      return TYPE::OTHER;
+  }
+}
+
+bool YaUtils::Key::IsPrivate() const { return m_impl->is_private; }
+
+std::string YaUtils::Key::Fingerprint() const {
+  unsigned char* der = nullptr;
+  int der_len = i2d_PUBKEY(m_impl->pkey, &der);
+  if (der_len <= 0) {
+    return "";
+  }
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_len = 0;
+  bool ok = EVP_Digest(der, der_len, digest, &digest_len, EVP_sha256(),
+                       nullptr) == 1;
+  OPENSSL_free(der);
+  if (!ok) {
+    return "";
+  }
+
+  static constexpr char HEX[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(digest_len * 2);
+  for (unsigned int i = 0; i < digest_len; ++i) {
+    hex += HEX[digest[i] >> 4];
+    hex += HEX[digest[i] & 0xf];
+  }
+  return hex;
+}
+
+YaUtils::KeyCache::KeyCache(size_t capacity)
+    : m_capacity(std::max<size_t>(capacity, 1)) {}
+
+std::optional<YaUtils::Key> YaUtils::KeyCache::GetPublic(
+    const CryptoBuffer& pem) {
+  return Get(pem, false);
+}
+
+std::optional<YaUtils::Key> YaUtils::KeyCache::GetPrivate(
+    const CryptoBuffer& pem) {
+  return Get(pem, true);
+}
+
+std::optional<YaUtils::Key> YaUtils::KeyCache::Get(const CryptoBuffer& pem,
+                                                   bool is_private) {
+  std::string id(1, is_private ? 'S' : 'P');
+  id.append(pem.begin(), pem.end());
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(id);
+    if (it != m_index.end()) {
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      ++m_stats.hits;
+      return it->second->second;
+    }
+    ++m_stats.misses;
+  }
+
+  // Parse outside the lock; a racing thread may parse the same key too
+  auto key = is_private ? Key::LoadPrivate(pem) : Key::LoadPublic(pem);
+  if (!key) {
+    return std::nullopt;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_index.find(id);
+  if (it != m_index.end()) {
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->second;
+  }
+  m_entries.emplace_front(std::move(id), *key);
+  m_index.emplace(m_entries.front().first, m_entries.begin());
+  while (m_entries.size() > m_capacity) {
+    m_index.erase(m_entries.back().first);
+    m_entries.pop_back();
+    ++m_stats.evictions;
+  }
+  return key;
+}
+
+size_t YaUtils::KeyCache::Size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+YaUtils::KeyCache::Stats YaUtils::KeyCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void YaUtils::KeyCache::Clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_index.clear();
+  m_entries.clear();
+}
+
 class YaUtils::Crypto::Impl {
  public:
   Impl() {
@@ -92,101 +783,156 @@ class YaUtils::Crypto::Impl {
   bool Cipher_Encrypt(std::string_view plaintext, CryptoBuffer& ciphertext,
                       std::string_view key, std::string_view iv,
                       const EVP_CIPHER* cipher) {
-    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
-    if (!ctx) return false;
-
-    if (!EVP_EncryptInit_ex(
+    EVP_CIPHER_CTX* ctx = Thread_Context();
+    if (!ctx ||
+        !EVP_EncryptInit_ex(
             ctx, cipher, nullptr,
             reinterpret_cast<const unsigned char*>(key.data()),
             reinterpret_cast<const unsigned char*>(iv.data()))) {
-      EVP_CIPHER_CTX_free(ctx);
       return false;
     }
 
-    std::vector<unsigned char> buffer(plaintext.size() +
-                                      EVP_CIPHER_block_size(cipher));
+    // Straight into the caller's buffer, reusing its capacity
+    ciphertext.resize(plaintext.size() + EVP_CIPHER_block_size(cipher));
     int len = 0, ciphertext_len = 0;
     if (!EVP_EncryptUpdate(
-            ctx, buffer.data(), &len,
+            ctx, ciphertext.data(), &len,
             reinterpret_cast<const unsigned char*>(plaintext.data()),
             plaintext.size())) {
-      EVP_CIPHER_CTX_free(ctx);
+      ciphertext.clear();
       return false;
     }
     ciphertext_len = len;
 
-    if (!EVP_EncryptFinal_ex(ctx, buffer.data() + len, &len)) {
-      EVP_CIPHER_CTX_free(ctx);
+    if (!EVP_EncryptFinal_ex(ctx, ciphertext.data() + len, &len)) {
+      ciphertext.clear();
       return false;
     }
     ciphertext_len += len;
-    buffer.resize(ciphertext_len);
-    ciphertext = std::move(buffer);
-
-    EVP_CIPHER_CTX_free(ctx);
+    ciphertext.resize(ciphertext_len);
     return true;
   }
 
   bool Cipher_Decrypt(const CryptoBuffer& ciphertext, std::string& plaintext,
                       std::string_view key, std::string_view iv,
                       const EVP_CIPHER* cipher) {
-    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
-    if (!ctx) return false;
-
-    if (!EVP_DecryptInit_ex(
+    EVP_CIPHER_CTX* ctx = Thread_Context();
+    if (!ctx ||
+        !EVP_DecryptInit_ex(
             ctx, cipher, nullptr,
             reinterpret_cast<const unsigned char*>(key.data()),
             reinterpret_cast<const unsigned char*>(iv.data()))) {
-      EVP_CIPHER_CTX_free(ctx);
       return false;
     }
 
-    std::vector<unsigned char> buffer(ciphertext.size());
+    plaintext.resize(ciphertext.size() + EVP_CIPHER_block_size(cipher));
+    auto* out = reinterpret_cast<unsigned char*>(plaintext.data());
     int len = 0, plaintext_len = 0;
-    if (!EVP_DecryptUpdate(ctx, buffer.data(), &len, ciphertext.data(),
+    if (!EVP_DecryptUpdate(ctx, out, &len, ciphertext.data(),
                            ciphertext.size())) {
-      EVP_CIPHER_CTX_free(ctx);
+      plaintext.clear();
       return false;
     }
     plaintext_len = len;
 
-    if (!EVP_DecryptFinal_ex(ctx, buffer.data() + len, &len)) {
-      EVP_CIPHER_CTX_free(ctx);
+    if (!EVP_DecryptFinal_ex(ctx, out + len, &len)) {
+      plaintext.clear();
       return false;
     }
     plaintext_len += len;
-    buffer.resize(plaintext_len);
-    plaintext.assign(buffer.begin(), buffer.end());
+    plaintext.resize(plaintext_len);
+    return true;
+  }
+
+  bool Aead_Encrypt(std::string_view plaintext, CryptoBuffer& ciphertext,
+                    std::string_view key, std::string_view iv,
+                    std::string_view aad, Cipher& cipher) {
+    ciphertext.resize(plaintext.size() + Cipher::TAG_SIZE);
+    std::span<unsigned char> out(ciphertext);
+    std::optional<size_t> written, last;
+    if (!cipher.EncryptInit(key, iv) || !cipher.SetAad(aad) ||
+        !(written = cipher.Update(plaintext, out)) ||
+        !(last = cipher.Final(out.subspan(*written))) ||
+        !cipher.GetTag(out.subspan(*written + *last, Cipher::TAG_SIZE))) {
+      ciphertext.clear();
+      return false;
+    }
+    return true;
+  }
 
-    EVP_CIPHER_CTX_free(ctx);
+  bool Aead_Decrypt(const CryptoBuffer& ciphertext, std::string& plaintext,
+                    std::string_view key, std::string_view iv,
+                    std::string_view aad, Cipher& cipher) {
+    if (ciphertext.size() < Cipher::TAG_SIZE) {
+      return false;
+    }
+    std::span<const unsigned char> in(ciphertext);
+    auto body = in.first(in.size() - Cipher::TAG_SIZE);
+    plaintext.resize(body.size());
+    std::span<unsigned char> out(
+        reinterpret_cast<unsigned char*>(plaintext.data()), plaintext.size());
+    std::optional<size_t> written;
+    if (!cipher.DecryptInit(key, iv) || !cipher.SetAad(aad) ||
+        !(written = cipher.Update(body, out)) ||
+        !cipher.SetTag(in.last(Cipher::TAG_SIZE)) ||
+        !cipher.Final(out.subspan(*written))) {
+      plaintext.clear();
+      return false;
+    }
     return true;
   }
 
   bool Digest_Hash(std::string_view data, CryptoBuffer& digest,
                    const EVP_MD* md) {
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    if (!ctx) return false;
-
-    if (!EVP_DigestInit_ex(ctx, md, nullptr)) {
-      EVP_MD_CTX_free(ctx);
+    EVP_MD_CTX* ctx = Thread_Digest_Context();
+    if (!ctx || !EVP_DigestInit_ex(ctx, md, nullptr) ||
+        !EVP_DigestUpdate(ctx, data.data(), data.size())) {
+      digest.clear();
       return false;
     }
+    return Digest_Final(ctx, digest);
+  }
 
-    if (!EVP_DigestUpdate(ctx, data.data(), data.size())) {
-      EVP_MD_CTX_free(ctx);
+  bool File_Hash(const std::string& path, CryptoBuffer& digest,
+                 const EVP_MD* md) {
+    EVP_MD_CTX* ctx = Thread_Digest_Context();
+    if (!ctx || !EVP_DigestInit_ex(ctx, md, nullptr)) {
       return false;
     }
-
-    digest.resize(EVP_MD_size(md));
-    unsigned int len = 0;
-    if (!EVP_DigestFinal_ex(ctx, digest.data(), &len)) {
-      EVP_MD_CTX_free(ctx);
+#if defined(YA_UNIX)
+    // Map regular files: no copies through a read buffer, and the kernel
+    // reads ahead while we hash
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
       return false;
     }
-    digest.resize(len);
-
-    EVP_MD_CTX_free(ctx);
-    return true;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      size_t size = static_cast<size_t>(st.st_size);
+      void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED) {
+        madvise(map, size, MADV_SEQUENTIAL);
+        bool ok = EVP_DigestUpdate(ctx, map, size) == 1;
+        munmap(map, size);
+        close(fd);
+        return ok && Digest_Final(ctx, digest);
+      }
+    }
+    close(fd);
+#endif
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      return false;
+    }
+    std::vector<char> chunk(1 << 20);
+    while (file) {
+      file.read(chunk.data(), chunk.size());
+      if (file.gcount() > 0 &&
+          !EVP_DigestUpdate(ctx, chunk.data(), file.gcount())) {
+        return false;
+      }
+    }
+    return !file.bad() && Digest_Final(ctx, digest);
   }
 
   bool Generate_KeyPair_RSA(CryptoBuffer& pub, CryptoBuffer& pri) {
@@ -231,19 +977,42 @@ class YaUtils::Crypto::Impl {
     return true;
   }
 
-  std::optional<CryptoBuffer> RSA_Encrypt(const CryptoBuffer& pub,
-                                          std::string_view plaintext) {
-    BIO* bio = BIO_new_mem_buf(pub.data(), pub.size());
-    EVP_PKEY* key = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
-    if (!key) {
-      BIO_free(bio);
-      return std::nullopt;
+  // Keys without parameters to choose (Ed25519, X25519), or an EC curve
+  bool Generate_KeyPair(int type, int curve, CryptoBuffer& pub,
+                        CryptoBuffer& pri) {
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_id(type, nullptr);
+    EVP_PKEY* pkey = nullptr;
+    bool ok =
+        ctx && EVP_PKEY_keygen_init(ctx) > 0 &&
+        (curve == NID_undef ||
+         (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx, curve) > 0 &&
+          EVP_PKEY_CTX_set_ec_param_enc(ctx, OPENSSL_EC_NAMED_CURVE) > 0)) &&
+        EVP_PKEY_keygen(ctx, &pkey) > 0;
+    EVP_PKEY_CTX_free(ctx);
+    if (!ok) {
+      return false;
+    }
+
+    BIO* pub_bio = BIO_new(BIO_s_mem());
+    BIO* pri_bio = BIO_new(BIO_s_mem());
+    ok = pub_bio && pri_bio && PEM_write_bio_PUBKEY(pub_bio, pkey) &&
+         PEM_write_bio_PrivateKey(pri_bio, pkey, nullptr, nullptr, 0, nullptr,
+                                  nullptr);
+    if (ok) {
+      pub = Read_BIO(pub_bio);
+      pri = Read_BIO(pri_bio);
     }
+    EVP_PKEY_free(pkey);
+    BIO_free(pub_bio);
+    BIO_free(pri_bio);
+    return ok;
+  }
 
+  std::optional<CryptoBuffer> RSA_Encrypt(EVP_PKEY* key,
+                                          std::string_view plaintext) {
     EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new(key, nullptr);
     if (!ctx || EVP_PKEY_encrypt_init(ctx) <= 0) {
-      EVP_PKEY_free(key);
-      BIO_free(bio);
+      EVP_PKEY_CTX_free(ctx);
       return std::nullopt;
     }
 
@@ -253,8 +1022,6 @@ class YaUtils::Crypto::Impl {
             reinterpret_cast<const unsigned char*>(plaintext.data()),
             plaintext.size()) <= 0) {
       EVP_PKEY_CTX_free(ctx);
-      EVP_PKEY_free(key);
-      BIO_free(bio);
       return std::nullopt;
     }
 
@@ -264,31 +1031,19 @@ class YaUtils::Crypto::Impl {
             reinterpret_cast<const unsigned char*>(plaintext.data()),
             plaintext.size()) <= 0) {
       EVP_PKEY_CTX_free(ctx);
-      EVP_PKEY_free(key);
-      BIO_free(bio);
       return std::nullopt;
     }
     ciphertext.resize(outlen);
 
     EVP_PKEY_CTX_free(ctx);
-    EVP_PKEY_free(key);
-    BIO_free(bio);
     return ciphertext;
   }
 
-  std::optional<std::string> RSA_Decrypt(const CryptoBuffer& pri,
+  std::optional<std::string> RSA_Decrypt(EVP_PKEY* key,
                                          const CryptoBuffer& ciphertext) {
-    BIO* bio = BIO_new_mem_buf(pri.data(), pri.size());
-    EVP_PKEY* key = PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr);
-    if (!key) {
-      BIO_free(bio);
-      return std::nullopt;
-    }
-
     EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new(key, nullptr);
     if (!ctx || EVP_PKEY_decrypt_init(ctx) <= 0) {
-      EVP_PKEY_free(key);
-      BIO_free(bio);
+      EVP_PKEY_CTX_free(ctx);
       return std::nullopt;
     }
 
@@ -296,25 +1051,19 @@ class YaUtils::Crypto::Impl {
     if (EVP_PKEY_decrypt(ctx, nullptr, &outlen, ciphertext.data(),
                          ciphertext.size()) <= 0) {
       EVP_PKEY_CTX_free(ctx);
-      EVP_PKEY_free(key);
-      BIO_free(bio);
       return std::nullopt;
     }
 
-    CryptoBuffer buffer(outlen);
-    if (EVP_PKEY_decrypt(ctx, buffer.data(), &outlen, ciphertext.data(),
+    std::string plaintext(outlen, '\0');
+    auto* out = reinterpret_cast<unsigned char*>(plaintext.data());
+    if (EVP_PKEY_decrypt(ctx, out, &outlen, ciphertext.data(),
                          ciphertext.size()) <= 0) {
       EVP_PKEY_CTX_free(ctx);
-      EVP_PKEY_free(key);
-      BIO_free(bio);
       return std::nullopt;
     }
-    buffer.resize(outlen);
-    std::string plaintext(buffer.begin(), buffer.end());
+    plaintext.resize(outlen);
 
     EVP_PKEY_CTX_free(ctx);
-    EVP_PKEY_free(key);
-    BIO_free(bio);
     return plaintext;
   }
 
@@ -360,88 +1109,124 @@ class YaUtils::Crypto::Impl {
     return true;
   }
 
-  std::optional<CryptoBuffer> DSA_Sign(const CryptoBuffer& pri,
-                                       std::string_view data) {
-    BIO* bio = BIO_new_mem_buf(pri.data(), pri.size());
-    EVP_PKEY* key = PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr);
-    if (!key) {
-      BIO_free(bio);
+  std::optional<CryptoBuffer> Sign(EVP_PKEY* key, std::string_view data) {
+    EVP_MD_CTX* ctx = Thread_Digest_Context();
+    CryptoBuffer signature(EVP_PKEY_size(key));
+    size_t sig_len = signature.size();
+    if (!ctx ||
+        !EVP_DigestSignInit(ctx, nullptr, Sign_Md(key), nullptr, key) ||
+        !EVP_DigestSign(ctx, signature.data(), &sig_len,
+                        reinterpret_cast<const unsigned char*>(data.data()),
+                        data.size())) {
       return std::nullopt;
     }
+    signature.resize(sig_len);
+    return signature;
+  }
+
+  bool Verify(EVP_PKEY* key, std::string_view data,
+              const CryptoBuffer& signature) {
+    EVP_MD_CTX* ctx = Thread_Digest_Context();
+    return ctx &&
+           EVP_DigestVerifyInit(ctx, nullptr, Sign_Md(key), nullptr, key) &&
+           EVP_DigestVerify(ctx, signature.data(), signature.size(),
+                            reinterpret_cast<const unsigned char*>(data.data()),
+                            data.size()) == 1;
+  }
 
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    if (!ctx || !EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, key)) {
-      EVP_MD_CTX_free(ctx);
-      EVP_PKEY_free(key);
-      BIO_free(bio);
+  std::optional<CryptoBuffer> Derive(EVP_PKEY* key, EVP_PKEY* peer) {
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new(key, nullptr);
+    size_t len = 0;
+    if (!ctx || EVP_PKEY_derive_init(ctx) <= 0 ||
+        EVP_PKEY_derive_set_peer(ctx, peer) <= 0 ||
+        EVP_PKEY_derive(ctx, nullptr, &len) <= 0) {
+      EVP_PKEY_CTX_free(ctx);
       return std::nullopt;
     }
 
-    if (!EVP_DigestSignUpdate(ctx, data.data(), data.size())) {
-      EVP_MD_CTX_free(ctx);
-      EVP_PKEY_free(key);
-      BIO_free(bio);
+    CryptoBuffer secret(len);
+    if (EVP_PKEY_derive(ctx, secret.data(), &len) <= 0) {
+      EVP_PKEY_CTX_free(ctx);
       return std::nullopt;
     }
+    secret.resize(len);
+
+    EVP_PKEY_CTX_free(ctx);
+    return secret;
+  }
 
-    size_t sig_len = 0;
-    if (!EVP_DigestSignFinal(ctx, nullptr, &sig_len)) {
-      EVP_MD_CTX_free(ctx);
-      EVP_PKEY_free(key);
-      BIO_free(bio);
+  std::optional<CryptoBuffer> HKDF(std::span<const unsigned char> secret,
+                                   std::string_view salt,
+                                   std::string_view info, size_t length) {
+    if (secret.empty() || length == 0) {
       return std::nullopt;
     }
-
-    CryptoBuffer signature(sig_len);
-    if (!EVP_DigestSignFinal(ctx, signature.data(), &sig_len)) {
-      EVP_MD_CTX_free(ctx);
-      EVP_PKEY_free(key);
-      BIO_free(bio);
+    // An empty salt or info is left unset, which HKDF treats the same
+    auto bytes = [](std::string_view text) {
+      return reinterpret_cast<const unsigned char*>(text.data());
+    };
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, nullptr);
+    CryptoBuffer key(length);
+    bool ok =
+        ctx && EVP_PKEY_derive_init(ctx) > 0 &&
+        EVP_PKEY_CTX_set_hkdf_md(ctx, EVP_sha256()) > 0 &&
+        EVP_PKEY_CTX_set1_hkdf_key(ctx, secret.data(), secret.size()) > 0 &&
+        (salt.empty() ||
+         EVP_PKEY_CTX_set1_hkdf_salt(ctx, bytes(salt), salt.size()) > 0) &&
+        (info.empty() ||
+         EVP_PKEY_CTX_add1_hkdf_info(ctx, bytes(info), info.size()) > 0) &&
+        EVP_PKEY_derive(ctx, key.data(), &length) > 0;
+    EVP_PKEY_CTX_free(ctx);
+    if (!ok) {
       return std::nullopt;
     }
-    signature.resize(sig_len);
-
-    EVP_MD_CTX_free(ctx);
-    EVP_PKEY_free(key);
-    BIO_free(bio);
-    return signature;
+    return key;
   }
 
-  bool DSA_Verify(const CryptoBuffer& pub, std::string_view data,
-                  const CryptoBuffer& signature) {
-    BIO* bio = BIO_new_mem_buf(pub.data(), pub.size());
-    EVP_PKEY* key = PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr);
-    if (!key) {
-      BIO_free(bio);
-      return false;
+ private:
+  // One context per thread, reset between calls instead of reallocated
+  static EVP_CIPHER_CTX* Thread_Context() {
+    struct Holder {
+      EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+      ~Holder() { EVP_CIPHER_CTX_free(ctx); }
+    };
+    thread_local Holder holder;
+    if (holder.ctx) {
+      EVP_CIPHER_CTX_reset(holder.ctx);
     }
+    return holder.ctx;
+  }
 
-    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
-    if (!ctx ||
-        !EVP_DigestVerifyInit(ctx, nullptr, EVP_sha256(), nullptr, key)) {
-      EVP_MD_CTX_free(ctx);
-      EVP_PKEY_free(key);
-      BIO_free(bio);
-      return false;
-    }
+  // Ed25519 and Ed448 hash internally and take no digest
+  static const EVP_MD* Sign_Md(EVP_PKEY* key) {
+    int type = EVP_PKEY_base_id(key);
+    return type == EVP_PKEY_ED25519 || type == EVP_PKEY_ED448 ? nullptr
+                                                              : md_sha256();
+  }
 
-    if (!EVP_DigestVerifyUpdate(ctx, data.data(), data.size())) {
-      EVP_MD_CTX_free(ctx);
-      EVP_PKEY_free(key);
-      BIO_free(bio);
+  static bool Digest_Final(EVP_MD_CTX* ctx, CryptoBuffer& digest) {
+    digest.resize(EVP_MAX_MD_SIZE);
+    unsigned int len = 0;
+    if (!EVP_DigestFinal_ex(ctx, digest.data(), &len)) {
+      digest.clear();
       return false;
     }
+    digest.resize(len);
+    return true;
+  }
 
-    bool result =
-        EVP_DigestVerifyFinal(ctx, signature.data(), signature.size()) == 1;
-
-    EVP_MD_CTX_free(ctx);
-    EVP_PKEY_free(key);
-    BIO_free(bio);
-    return result;
+  static EVP_MD_CTX* Thread_Digest_Context() {
+    struct Holder {
+      EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+      ~Holder() { EVP_MD_CTX_free(ctx); }
+    };
+    thread_local Holder holder;
+    if (holder.ctx) {
+      EVP_MD_CTX_reset(holder.ctx);
+    }
+    return holder.ctx;
   }
 
- private:
   CryptoBuffer Read_BIO(BIO* bio) {
     CryptoBuffer buf;
     char tmp[256];
@@ -483,12 +1268,57 @@ bool YaUtils::Crypto::DES_Decrypt(const CryptoBuffer& ciphertext,
   return m_impl->Cipher_Decrypt(ciphertext, plaintext, key, iv, EVP_des_cbc());
 }
 
+bool YaUtils::Crypto::AES_GCM_Encrypt(std::string_view plaintext,
+                                      std::string_view key,
+                                      std::string_view iv,
+                                      std::string_view aad,
+                                      CryptoBuffer& ciphertext) {
+  thread_local Cipher cipher(Cipher::ALGO::AES_256_GCM);
+  return m_impl->Aead_Encrypt(plaintext, ciphertext, key, iv, aad, cipher);
+}
+
+bool YaUtils::Crypto::AES_GCM_Decrypt(const CryptoBuffer& ciphertext,
+                                      std::string_view key,
+                                      std::string_view iv,
+                                      std::string_view aad,
+                                      std::string& plaintext) {
+  thread_local Cipher cipher(Cipher::ALGO::AES_256_GCM);
+  return m_impl->Aead_Decrypt(ciphertext, plaintext, key, iv, aad, cipher);
+}
+
+bool YaUtils::Crypto::ChaCha20_Poly1305_Encrypt(std::string_view plaintext,
+                                                std::string_view key,
+                                                std::string_view iv,
+                                                std::string_view aad,
+                                                CryptoBuffer& ciphertext) {
+  thread_local Cipher cipher(Cipher::ALGO::CHACHA20_POLY1305);
+  return m_impl->Aead_Encrypt(plaintext, ciphertext, key, iv, aad, cipher);
+}
+
+bool YaUtils::Crypto::ChaCha20_Poly1305_Decrypt(const CryptoBuffer& ciphertext,
+                                                std::string_view key,
+                                                std::string_view iv,
+                                                std::string_view aad,
+                                                std::string& plaintext) {
+  thread_local Cipher cipher(Cipher::ALGO::CHACHA20_POLY1305);
+  return m_impl->Aead_Decrypt(ciphertext, plaintext, key, iv, aad, cipher);
+}
+
 bool YaUtils::Crypto::MD5_Hash(std::string_view data, CryptoBuffer& digest) {
-  return m_impl->Digest_Hash(data, digest, EVP_md5());
+  return m_impl->Digest_Hash(data, digest, md_md5());
 }
 
 bool YaUtils::Crypto::SHA256_Hash(std::string_view data, CryptoBuffer& digest) {
-  return m_impl->Digest_Hash(data, digest, EVP_sha256());
+  return m_impl->Digest_Hash(data, digest, md_sha256());
+}
+
+std::optional<YaUtils::CryptoBuffer> YaUtils::Crypto::SHA256_File(
+    const std::string& path) {
+  CryptoBuffer digest;
+  if (!m_impl->File_Hash(path, digest, md_sha256())) {
+    return std::nullopt;
+  }
+  return digest;
 }
 
 bool YaUtils::Crypto::Generate_RSA_Key(CryptoBuffer& public_key,
@@ -498,12 +1328,14 @@ bool YaUtils::Crypto::Generate_RSA_Key(CryptoBuffer& public_key,
 
 std::optional<YaUtils::CryptoBuffer> YaUtils::Crypto::RSA_Encrypt(
     const CryptoBuffer& public_key, std::string_view plaintext) {
-  return m_impl->RSA_Encrypt(public_key, plaintext);
+  auto key = Load_Key(public_key, false);
+  return key ? RSA_Encrypt(*key, plaintext) : std::nullopt;
 }
 
 std::optional<std::string> YaUtils::Crypto::RSA_Decrypt(
     const CryptoBuffer& private_key, const CryptoBuffer& ciphertext) {
-  return m_impl->RSA_Decrypt(private_key, ciphertext);
+  auto key = Load_Key(private_key, true);
+  return key ? RSA_Decrypt(*key, ciphertext) : std::nullopt;
 }
 
 bool YaUtils::Crypto::Generate_DSA_Key(CryptoBuffer& public_key,
@@ -513,12 +1345,1256 @@ bool YaUtils::Crypto::Generate_DSA_Key(CryptoBuffer& public_key,
 
 std::optional<YaUtils::CryptoBuffer> YaUtils::Crypto::DSA_Sign(
     const CryptoBuffer& private_key, std::string_view data) {
-  return m_impl->DSA_Sign(private_key, data);
+  auto key = Load_Key(private_key, true);
+  return key ? Sign(*key, data) : std::nullopt;
 }
 
 bool YaUtils::Crypto::DSA_Verify(const CryptoBuffer& public_key,
                                  std::string_view data,
                                  const CryptoBuffer& signature) {
-  return m_impl->DSA_Verify(public_key, data, signature);
+  auto key = Load_Key(public_key, false);
+  return key && Verify(*key, data, signature);
+}
+
+bool YaUtils::Crypto::Generate_Ed25519_Key(CryptoBuffer& public_key,
+                                           CryptoBuffer& private_key) {
+  return m_impl->Generate_KeyPair(EVP_PKEY_ED25519, NID_undef, public_key,
+                                  private_key);
+}
+
+std::optional<YaUtils::CryptoBuffer> YaUtils::Crypto::Ed25519_Sign(
+    const CryptoBuffer& private_key, std::string_view data) {
+  auto key = Load_Key(private_key, true, Key::TYPE::ED25519);
+  return key ? Sign(*key, data) : std::nullopt;
+}
+
+bool YaUtils::Crypto::Ed25519_Verify(const CryptoBuffer& public_key,
+                                     std::string_view data,
+                                     const CryptoBuffer& signature) {
+  auto key = Load_Key(public_key, false, Key::TYPE::ED25519);
+  return key && Verify(*key, data, signature);
+}
+
+bool YaUtils::Crypto::Generate_ECDSA_Key(CryptoBuffer& public_key,
+                                         CryptoBuffer& private_key) {
+  return m_impl->Generate_KeyPair(EVP_PKEY_EC, NID_X9_62_prime256v1,
+                                  public_key, private_key);
+}
+
+std::optional<YaUtils::CryptoBuffer> YaUtils::Crypto::ECDSA_Sign(
+    const CryptoBuffer& private_key, std::string_view data) {
+  auto key = Load_Key(private_key, true, Key::TYPE::EC);
+  return key ? Sign(*key, data) : std::nullopt;
+}
+
+bool YaUtils::Crypto::ECDSA_Verify(const CryptoBuffer& public_key,
+                                   std::string_view data,
+                                   const CryptoBuffer& signature) {
+  auto key = Load_Key(public_key, false, Key::TYPE::EC);
+  return key && Verify(*key, data, signature);
+}
+
+bool YaUtils::Crypto::Generate_X25519_Key(CryptoBuffer& public_key,
+                                          CryptoBuffer& private_key) {
+  return m_impl->Generate_KeyPair(EVP_PKEY_X25519, NID_undef, public_key,
+                                  private_key);
+}
+
+std::optional<YaUtils::CryptoBuffer> YaUtils::Crypto::X25519_Derive(
+    const CryptoBuffer& private_key, const CryptoBuffer& peer_public_key) {
+  auto key = Load_Key(private_key, true, Key::TYPE::X25519);
+  auto peer = Load_Key(peer_public_key, false, Key::TYPE::X25519);
+  return key && peer ? Derive(*key, *peer) : std::nullopt;
+}
+
+std::optional<YaUtils::CryptoBuffer> YaUtils::Crypto::HKDF_SHA256(
+    std::span<const unsigned char> secret, std::string_view salt,
+    std::string_view info, size_t length) {
+  return m_impl->HKDF(secret, salt, info, length);
+}
+
+std::optional<YaUtils::CryptoBuffer> YaUtils::Crypto::RSA_Encrypt(
+    const Key& public_key, std::string_view plaintext) {
+  return m_impl->RSA_Encrypt(public_key.m_impl->pkey, plaintext);
+}
+
+std::optional<std::string> YaUtils::Crypto::RSA_Decrypt(
+    const Key& private_key, const CryptoBuffer& ciphertext) {
+  if (!private_key.IsPrivate()) {
+    return std::nullopt;
+  }
+  return m_impl->RSA_Decrypt(private_key.m_impl->pkey, ciphertext);
+}
+
+std::optional<YaUtils::CryptoBuffer> YaUtils::Crypto::Sign(
+    const Key& private_key, std::string_view data) {
+  if (!private_key.IsPrivate()) {
+    return std::nullopt;
+  }
+  return m_impl->Sign(private_key.m_impl->pkey, data);
+}
+
+bool YaUtils::Crypto::Verify(const Key& public_key, std::string_view data,
+                             const CryptoBuffer& signature) {
+  return m_impl->Verify(public_key.m_impl->pkey, data, signature);
+}
+
+std::vector<YaUtils::CryptoBuffer> YaUtils::Crypto::SHA256_Hash_Batch(
+    std::span<const std::string_view> inputs, size_t threads) {
+  size_t bytes = 0;
+  for (auto input : inputs) {
+    bytes += input.size();
+  }
+  std::vector<CryptoBuffer> digests(inputs.size());
+  ThreadPool::Shared().ParallelFor(
+      inputs.size(),
+      [&](size_t i) {
+        m_impl->Digest_Hash(inputs[i], digests[i], md_sha256());
+      },
+      bytes < PARALLEL_MIN_BYTES ? 1 : threads);
+  return digests;
+}
+
+std::vector<std::optional<YaUtils::CryptoBuffer>>
+YaUtils::Crypto::SHA256_File_Batch(std::span<const std::string> paths,
+                                   size_t threads) {
+  std::vector<std::optional<CryptoBuffer>> digests(paths.size());
+  ThreadPool::Shared().ParallelFor(
+      paths.size(),
+      [&](size_t i) {
+        CryptoBuffer digest;
+        if (m_impl->File_Hash(paths[i], digest, md_sha256())) {
+          digests[i] = std::move(digest);
+        }
+      },
+      threads);
+  return digests;
+}
+
+std::vector<bool> YaUtils::Crypto::Verify_Batch(
+    std::span<const Key> keys, std::span<const std::string_view> data,
+    std::span<const CryptoBuffer> signatures, size_t threads) {
+  // Threads write whole bytes; vector<bool> packs bits
+  std::vector<char> valid(data.size(), 0);
+  if (signatures.size() == data.size() &&
+      (keys.size() == 1 || keys.size() == data.size())) {
+    ThreadPool::Shared().ParallelFor(
+        data.size(),
+        [&](size_t i) {
+          const Key& key = keys[keys.size() == 1 ? 0 : i];
+          valid[i] = m_impl->Verify(key.m_impl->pkey, data[i], signatures[i]);
+        },
+        data.size() < PARALLEL_MIN_VERIFIES ? 1 : threads);
+  }
+  return std::vector<bool>(valid.begin(), valid.end());
+}
+
+std::optional<YaUtils::CryptoBuffer> YaUtils::Crypto::Derive(
+    const Key& private_key, const Key& peer_public_key) {
+  if (!private_key.IsPrivate()) {
+    return std::nullopt;
+  }
+  return m_impl->Derive(private_key.m_impl->pkey, peer_public_key.m_impl->pkey);
+}
+
+void YaUtils::Crypto::SetKeyCache(std::shared_ptr<KeyCache> cache) {
+  m_key_cache = std::move(cache);
+}
+
+std::optional<YaUtils::Key> YaUtils::Crypto::Load_Key(const CryptoBuffer& pem,
+                                                      bool is_private) {
+  if (m_key_cache) {
+    return is_private ? m_key_cache->GetPrivate(pem)
+                      : m_key_cache->GetPublic(pem);
+  }
+  return is_private ? Key::LoadPrivate(pem) : Key::LoadPublic(pem);
+}
+
+std::optional<YaUtils::Key> YaUtils::Crypto::Load_Key(const CryptoBuffer& pem,
+                                                      bool is_private,
+                                                      Key::TYPE type) {
+  auto key = Load_Key(pem, is_private);
+  if (!key || key->GetType() != type) {
+    return std::nullopt;
+  }
+  return key;
+}
+
+class YaUtils::Cipher::Impl {
+ public:
+  explicit Impl(ALGO algo) : algo(algo), ctx(EVP_CIPHER_CTX_new()) {
+    if (!ctx) {
+      throw std::runtime_error("Failed to allocate cipher context");
+    }
+    switch (algo) {
+      case ALGO::AES_256_CBC:
+        cipher = EVP_aes_256_cbc();
+        break;
+      case ALGO::AES_256_CTR:
+        cipher = EVP_aes_256_ctr();
+        break;
+      case ALGO::AES_256_GCM:
+        cipher = EVP_aes_256_gcm();
+        break;
+      case ALGO::CHACHA20_POLY1305:
+        cipher = EVP_chacha20_poly1305();
+        break;
+    }
+  }
+
+  ~Impl() { EVP_CIPHER_CTX_free(ctx); }
+
+  bool Init(std::string_view key, std::string_view iv, bool encrypting) {
+    if (key.size() != static_cast<size_t>(EVP_CIPHER_key_length(cipher)) ||
+        iv.size() != static_cast<size_t>(EVP_CIPHER_iv_length(cipher))) {
+      return false;
+    }
+    // Reinitializing keeps the context's allocations
+    encrypt = encrypting;
+    ready = EVP_CipherInit_ex(
+                ctx, cipher, nullptr,
+                reinterpret_cast<const unsigned char*>(key.data()),
+                reinterpret_cast<const unsigned char*>(iv.data()),
+                encrypt ? 1 : 0) == 1;
+    return ready;
+  }
+
+  bool IsAead() const {
+    return algo == ALGO::AES_256_GCM || algo == ALGO::CHACHA20_POLY1305;
+  }
+
+  const ALGO algo;
+  const EVP_CIPHER* cipher = nullptr;
+  EVP_CIPHER_CTX* ctx;
+  bool encrypt = true;
+  bool ready = false;  // Between Init and Final
+};
+
+YaUtils::Cipher::Cipher(ALGO algo) : m_impl(std::make_unique<Impl>(algo)) {}
+
+YaUtils::Cipher::~Cipher() = default;
+
+YaUtils::Cipher::Cipher(Cipher&& other) noexcept = default;
+
+YaUtils::Cipher& YaUtils::Cipher::operator=(Cipher&& other) noexcept =
+    default;
+
+YaUtils::Cipher::ALGO YaUtils::Cipher::GetAlgo() const { return m_impl->algo; }
+
+size_t YaUtils::Cipher::KeySize() const {
+  return EVP_CIPHER_key_length(m_impl->cipher);
+}
+
+size_t YaUtils::Cipher::IvSize() const {
+  return EVP_CIPHER_iv_length(m_impl->cipher);
 }
+
+size_t YaUtils::Cipher::BlockSize() const {
+  return EVP_CIPHER_block_size(m_impl->cipher);
+}
+
+bool YaUtils::Cipher::IsAead() const { return m_impl->IsAead(); }
+
+bool YaUtils::Cipher::EncryptInit(std::string_view key, std::string_view iv) {
+  return m_impl->Init(key, iv, true);
+}
+
+bool YaUtils::Cipher::DecryptInit(std::string_view key, std::string_view iv) {
+  return m_impl->Init(key, iv, false);
+}
+
+bool YaUtils::Cipher::Restart(std::string_view iv) {
+  if (iv.size() != IvSize()) {
+    return false;
+  }
+  m_impl->ready =
+      EVP_CipherInit_ex(m_impl->ctx, nullptr, nullptr, nullptr,
+                        reinterpret_cast<const unsigned char*>(iv.data()),
+                        m_impl->encrypt ? 1 : 0) == 1;
+  return m_impl->ready;
+}
+
+bool YaUtils::Cipher::SetAad(std::string_view aad) {
+  if (!m_impl->ready || !m_impl->IsAead()) {
+    return false;
+  }
+  int len = 0;
+  return aad.empty() ||
+         EVP_CipherUpdate(m_impl->ctx, nullptr, &len,
+                          reinterpret_cast<const unsigned char*>(aad.data()),
+                          aad.size()) == 1;
+}
+
+std::optional<size_t> YaUtils::Cipher::Update(
+    std::span<const unsigned char> input, std::span<unsigned char> output) {
+  size_t block = BlockSize();
+  size_t room = block == 1 ? input.size() : input.size() + block;
+  if (!m_impl->ready || output.size() < room) {
+    return std::nullopt;
+  }
+  // EVP lengths are int; larger inputs go in pieces
+  constexpr size_t CHUNK = size_t{1} << 30;
+  size_t written = 0;
+  while (!input.empty()) {
+    size_t take = std::min(input.size(), CHUNK);
+    int len = 0;
+    if (EVP_CipherUpdate(m_impl->ctx, output.data() + written, &len,
+                         input.data(), static_cast<int>(take)) != 1) {
+      m_impl->ready = false;
+      return std::nullopt;
+    }
+    written += len;
+    input = input.subspan(take);
+  }
+  return written;
+}
+
+std::optional<size_t> YaUtils::Cipher::Update(std::string_view input,
+                                              std::span<unsigned char> output) {
+  return Update(std::span<const unsigned char>(
+                    reinterpret_cast<const unsigned char*>(input.data()),
+                    input.size()),
+                output);
+}
+
+std::optional<size_t> YaUtils::Cipher::Final(std::span<unsigned char> output) {
+  if (!m_impl->ready) {
+    return std::nullopt;
+  }
+  // CBC may write a whole block; stream modes write nothing
+  unsigned char block[EVP_MAX_BLOCK_LENGTH];
+  int len = 0;
+  bool ok = EVP_CipherFinal_ex(m_impl->ctx, block, &len) == 1;
+  m_impl->ready = false;
+  if (!ok || static_cast<size_t>(len) > output.size()) {
+    return std::nullopt;
+  }
+  std::copy(block, block + len, output.begin());
+  return static_cast<size_t>(len);
+}
+
+bool YaUtils::Cipher::GetTag(std::span<unsigned char> tag) {
+  return m_impl->IsAead() && m_impl->encrypt && tag.size() == TAG_SIZE &&
+         EVP_CIPHER_CTX_ctrl(m_impl->ctx, EVP_CTRL_AEAD_GET_TAG, TAG_SIZE,
+                             tag.data()) == 1;
+}
+
+bool YaUtils::Cipher::SetTag(std::span<const unsigned char> tag) {
+  return m_impl->IsAead() && !m_impl->encrypt && tag.size() == TAG_SIZE &&
+         EVP_CIPHER_CTX_ctrl(
+             m_impl->ctx, EVP_CTRL_AEAD_SET_TAG, TAG_SIZE,
+             const_cast<unsigned char*>(tag.data())) == 1;
+}
+
+class YaUtils::Digest::Impl {
+ public:
+  explicit Impl(ALGO algo)
+      : ctx(EVP_MD_CTX_new()),
+        md(algo == ALGO::MD5 ? md_md5() : md_sha256()) {
+    if (!ctx) {
+      throw std::runtime_error("Failed to allocate digest context");
+    }
+    ready = EVP_DigestInit_ex(ctx, md, nullptr) == 1;
+  }
+
+  ~Impl() { EVP_MD_CTX_free(ctx); }
+
+  EVP_MD_CTX* ctx;
+  const EVP_MD* md;
+  bool ready = false;
+};
+
+YaUtils::Digest::Digest(ALGO algo) : m_impl(std::make_unique<Impl>(algo)) {}
+
+YaUtils::Digest::~Digest() = default;
+
+YaUtils::Digest::Digest(Digest&& other) noexcept = default;
+
+YaUtils::Digest& YaUtils::Digest::operator=(Digest&& other) noexcept =
+    default;
+
+size_t YaUtils::Digest::Size() const { return EVP_MD_size(m_impl->md); }
+
+bool YaUtils::Digest::Update(std::string_view data) {
+  return m_impl->ready &&
+         EVP_DigestUpdate(m_impl->ctx, data.data(), data.size()) == 1;
+}
+
+bool YaUtils::Digest::Update(std::span<const unsigned char> data) {
+  return m_impl->ready &&
+         EVP_DigestUpdate(m_impl->ctx, data.data(), data.size()) == 1;
+}
+
+std::optional<YaUtils::CryptoBuffer> YaUtils::Digest::Final() {
+  if (!m_impl->ready) {
+    return std::nullopt;
+  }
+  CryptoBuffer digest(EVP_MAX_MD_SIZE);
+  unsigned int len = 0;
+  bool ok = EVP_DigestFinal_ex(m_impl->ctx, digest.data(), &len) == 1;
+  Reset();
+  if (!ok) {
+    return std::nullopt;
+  }
+  digest.resize(len);
+  return digest;
+}
+
+bool YaUtils::Digest::Reset() {
+  m_impl->ready = EVP_DigestInit_ex(m_impl->ctx, m_impl->md, nullptr) == 1;
+  return m_impl->ready;
+}
+
+namespace {
+
+constexpr size_t HASH_STRIPE = 64;
+
+// wyhash's secrets: odd, with balanced bits
+constexpr uint64_t HASH_SECRET[4] = {0xa0761d6478bd642fULL,
+                                     0xe7037ed1a0b428dbULL,
+                                     0x8ebc6af09c88c6e3ULL,
+                                     0x589965cc75374cc3ULL};
+
+// Little-endian on every platform, so hashes match everywhere
+inline uint64_t read64(const unsigned char* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  if constexpr (std::endian::native == std::endian::big) {
+    uint64_t swapped = 0;
+    for (int i = 0; i < 8; ++i, v >>= 8) {
+      swapped = (swapped << 8) | (v & 0xff);
+    }
+    v = swapped;
+  }
+  return v;
+}
+
+// Both halves of the 128-bit product, folded
+inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+  return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#else
+  uint64_t ha = a >> 32, hb = b >> 32, la = a & 0xffffffff, lb = b & 0xffffffff;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32);
+  uint64_t c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+  return lo ^ hi;
+#endif
+}
+
+inline uint64_t hash_seed(uint64_t seed) {
+  return hash_mix(seed ^ HASH_SECRET[0], HASH_SECRET[1]);
+}
+
+inline void hash_stripe(uint64_t lanes[4], const unsigned char* p) {
+  for (int i = 0; i < 4; ++i) {
+    lanes[i] = hash_mix(read64(p + 16 * i) ^ HASH_SECRET[i],
+                        read64(p + 16 * i + 8) ^ lanes[i]);
+  }
+}
+
+// Folds in the bytes after the last stripe and the total length
+inline uint64_t hash_finish(uint64_t h, const unsigned char* tail, size_t n,
+                            uint64_t length, uint64_t a, uint64_t b) {
+  for (; n >= 16; tail += 16, n -= 16) {
+    h = hash_mix(read64(tail) ^ a, read64(tail + 8) ^ h);
+  }
+  if (n > 0) {
+    unsigned char last[16] = {};
+    std::memcpy(last, tail, n);
+    h = hash_mix(read64(last) ^ a, read64(last + 8) ^ h);
+  }
+  return hash_mix(h ^ b, length ^ a);
+}
+
+inline uint64_t hash_fold64(uint64_t seed, const uint64_t lanes[4],
+                            const unsigned char* tail, size_t n,
+                            uint64_t length) {
+  return hash_finish(seed ^ lanes[0] ^ lanes[1] ^ lanes[2] ^ lanes[3], tail,
+                     n, length, HASH_SECRET[1], HASH_SECRET[2]);
+}
+
+inline YaUtils::Hash::Value128 hash_fold128(uint64_t seed,
+                                            const uint64_t lanes[4],
+                                            const unsigned char* tail,
+                                            size_t n, uint64_t length) {
+  return {hash_finish(seed ^ lanes[0] ^ lanes[1], tail, n, length,
+                      HASH_SECRET[1], HASH_SECRET[2]),
+          hash_finish(seed ^ lanes[2] ^ lanes[3], tail, n, length,
+                      HASH_SECRET[3], HASH_SECRET[0])};
+}
+
+// Runs over data's whole stripes; returns the bytes left over
+inline size_t hash_stripes(uint64_t seed, uint64_t lanes[4],
+                           const unsigned char* data, size_t size) {
+  for (int i = 0; i < 4; ++i) {
+    lanes[i] = seed ^ HASH_SECRET[i];
+  }
+  size_t whole = size - size % HASH_STRIPE;
+  for (size_t i = 0; i < whole; i += HASH_STRIPE) {
+    hash_stripe(lanes, data + i);
+  }
+  return size - whole;
+}
+
+// CRC32C, reflected polynomial 0x82f63b78, sliced eight bytes at a time
+constexpr auto CRC32C_TABLE = [] {
+  std::array<std::array<uint32_t, 256>, 8> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1)));
+    }
+    table[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; ++i) {
+    for (size_t k = 1; k < 8; ++k) {
+      table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+    }
+  }
+  return table;
+}();
+
+uint32_t crc32c_table(uint32_t crc, const unsigned char* p, size_t n) {
+  const auto& t = CRC32C_TABLE;
+  for (; n >= 8; p += 8, n -= 8) {
+    uint64_t v = read64(p) ^ crc;
+    crc = t[7][v & 0xff] ^ t[6][(v >> 8) & 0xff] ^ t[5][(v >> 16) & 0xff] ^
+          t[4][(v >> 24) & 0xff] ^ t[3][(v >> 32) & 0xff] ^
+          t[2][(v >> 40) & 0xff] ^ t[1][(v >> 48) & 0xff] ^ t[0][v >> 56];
+  }
+  for (; n > 0; ++p, --n) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xff];
+  }
+  return crc;
+}
+
+#if defined(YA_UTILS_CRC32C_SSE42)
+YA_UTILS_TARGET_SSE42
+uint32_t crc32c_sse42(uint32_t crc, const unsigned char* p, size_t n) {
+  uint64_t crc64 = crc;
+  for (; n >= 8; p += 8, n -= 8) {
+    crc64 = _mm_crc32_u64(crc64, read64(p));
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; n > 0; ++p, --n) {
+    crc = _mm_crc32_u8(crc, *p);
+  }
+  return crc;
+}
+
+bool has_sse42() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int regs[4];
+  __cpuid(regs, 1);
+  return (regs[2] >> 20) & 1;
+#else
+  return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#elif defined(YA_UTILS_CRC32C_ARM)
+uint32_t crc32c_arm(uint32_t crc, const unsigned char* p, size_t n) {
+  for (; n >= 8; p += 8, n -= 8) {
+    crc = __crc32cd(crc, read64(p));
+  }
+  for (; n > 0; ++p, --n) {
+    crc = __crc32cb(crc, *p);
+  }
+  return crc;
+}
+#endif
+
+using Crc32cFunc = uint32_t (*)(uint32_t, const unsigned char*, size_t);
+
+Crc32cFunc crc32c_func() {
+  static const Crc32cFunc func = []() -> Crc32cFunc {
+#if defined(YA_UTILS_CRC32C_SSE42)
+    if (has_sse42()) {
+      return crc32c_sse42;
+    }
+#elif defined(YA_UTILS_CRC32C_ARM)
+    return crc32c_arm;
+#endif
+    return crc32c_table;
+  }();
+  return func;
+}
+
+const unsigned char* bytes_of(std::string_view data) {
+  return reinterpret_cast<const unsigned char*>(data.data());
+}
+
+}  // namespace
+
+uint64_t YaUtils::Hash::Hash64(std::string_view data, uint64_t seed) {
+  seed = hash_seed(seed);
+  uint64_t lanes[4];
+  size_t tail = hash_stripes(seed, lanes, bytes_of(data), data.size());
+  return hash_fold64(seed, lanes, bytes_of(data) + data.size() - tail, tail,
+                     data.size());
+}
+
+YaUtils::Hash::Value128 YaUtils::Hash::Hash128(std::string_view data,
+                                               uint64_t seed) {
+  seed = hash_seed(seed);
+  uint64_t lanes[4];
+  size_t tail = hash_stripes(seed, lanes, bytes_of(data), data.size());
+  return hash_fold128(seed, lanes, bytes_of(data) + data.size() - tail, tail,
+                      data.size());
+}
+
+uint32_t YaUtils::Hash::Crc32c(std::string_view data, uint32_t crc) {
+  return ~crc32c_func()(~crc, bytes_of(data), data.size());
+}
+
+bool YaUtils::Hash::HasCrc32cInstructions() {
+  return crc32c_func() != crc32c_table;
+}
+
+YaUtils::Hash::Hash(uint64_t seed) : m_seed(hash_seed(seed)) { Reset(); }
+
+void YaUtils::Hash::Update(std::string_view data) {
+  const unsigned char* p = bytes_of(data);
+  size_t n = data.size();
+  m_length += n;
+  if (m_buffered > 0) {
+    size_t take = std::min(n, STRIPE - m_buffered);
+    std::memcpy(m_buffer + m_buffered, p, take);
+    m_buffered += take;
+    p += take;
+    n -= take;
+    if (m_buffered < STRIPE) {
+      return;
+    }
+    hash_stripe(m_lanes, m_buffer);
+    m_buffered = 0;
+  }
+  for (; n >= STRIPE; p += STRIPE, n -= STRIPE) {
+    hash_stripe(m_lanes, p);
+  }
+  std::memcpy(m_buffer, p, n);
+  m_buffered = n;
+}
+
+uint64_t YaUtils::Hash::Digest64() const {
+  return hash_fold64(m_seed, m_lanes, m_buffer, m_buffered, m_length);
+}
+
+YaUtils::Hash::Value128 YaUtils::Hash::Digest128() const {
+  return hash_fold128(m_seed, m_lanes, m_buffer, m_buffered, m_length);
+}
+
+void YaUtils::Hash::Reset() {
+  for (int i = 0; i < 4; ++i) {
+    m_lanes[i] = m_seed ^ HASH_SECRET[i];
+  }
+  m_length = 0;
+  m_buffered = 0;
+}
+
+namespace {
+
+// Chase-Lev work-stealing deque (Le et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models"). Only the owner pushes and pops,
+// at the bottom; any thread steals from the top. Full arrays are replaced
+// by ones twice the size; old ones stay until the deque goes, as a thief
+// may still be reading them.
+template <typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(size_t capacity = 256) {
+    m_arrays.push_back(std::make_unique<Array>(capacity));
+    m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+  }
+
+  void Push(T* item) {
+    int64_t b = m_bottom.load(std::memory_order_relaxed);
+    int64_t t = m_top.load(std::memory_order_acquire);
+    Array* a = m_array.load(std::memory_order_relaxed);
+    if (b - t >= static_cast<int64_t>(a->size)) {
+      a = Grow(a, t, b);
+    }
+    a->Put(b, item);
+    // A release store rather than the paper's fence, which ThreadSanitizer
+    // cannot follow; the same instructions on x86
+    m_bottom.store(b + 1, std::memory_order_release);
+  }
+
+  T* Pop() {
+    int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    Array* a = m_array.load(std::memory_order_relaxed);
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_relaxed);
+    if (t > b) {
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* item = a->Get(b);
+    if (t == b) {
+      // The last item: race the thieves for it
+      if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  T* Steal() {
+    int64_t t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = m_bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+    T* item = m_array.load(std::memory_order_acquire)->Get(t);
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+      return nullptr;  // Lost to the owner or another thief
+    }
+    return item;
+  }
+
+  bool Empty() const {
+    return m_bottom.load(std::memory_order_relaxed) <=
+           m_top.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Array {
+    explicit Array(size_t size)
+        : size(size), items(std::make_unique<std::atomic<T*>[]>(size)) {}
+
+    T* Get(int64_t i) const {
+      return items[i & (size - 1)].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t i, T* item) {
+      items[i & (size - 1)].store(item, std::memory_order_relaxed);
+    }
+
+    const size_t size;  // A power of two
+    std::unique_ptr<std::atomic<T*>[]> items;
+  };
+
+  Array* Grow(Array* old, int64_t top, int64_t bottom) {
+    auto grown = std::make_unique<Array>(old->size * 2);
+    for (int64_t i = top; i < bottom; ++i) {
+      grown->Put(i, old->Get(i));
+    }
+    m_arrays.push_back(std::move(grown));
+    m_array.store(m_arrays.back().get(), std::memory_order_release);
+    return m_arrays.back().get();
+  }
+
+  alignas(64) std::atomic<int64_t> m_top{0};
+  alignas(64) std::atomic<int64_t> m_bottom{0};
+  std::atomic<Array*> m_array;
+  std::vector<std::unique_ptr<Array>> m_arrays;  // Owner only
+};
+
+}  // namespace
+
+class YaUtils::ThreadPool::Impl {
+ public:
+  static constexpr size_t PRIORITIES = 3;
+
+  struct Worker {
+    WorkStealingDeque<Task> deque;
+    std::thread thread;
+  };
+
+  // The pool and worker the current thread belongs to, if any
+  struct Current {
+    Impl* impl = nullptr;
+    size_t index = 0;
+  };
+  static thread_local Current current;
+
+  explicit Impl(size_t count) {
+    if (count == 0) {
+      count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < count; ++i) {
+      workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < count; ++i) {
+      workers[i]->thread = std::thread([this, i] { Run(i); });
+    }
+  }
+
+  bool Enqueue(std::unique_ptr<Task> task, PRIORITY priority) {
+    bool inside = current.impl == this;
+    if (stopping.load() || (!accepting.load() && !inside)) {
+      return false;
+    }
+    pending.fetch_add(1);
+    if (inside && priority == PRIORITY::NORMAL) {
+      workers[current.index]->deque.Push(task.release());
+    } else {
+      auto p = static_cast<size_t>(priority);
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      queues[p].push_back(task.release());
+      queued[p].fetch_add(1);
+    }
+    epoch.fetch_add(1);
+    if (sleeping.load() > 0) {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      sleep_cv.notify_one();
+    }
+    return true;
+  }
+
+  void WaitIdle() {
+    std::unique_lock<std::mutex> lock(idle_mutex);
+    idle_cv.wait(lock, [this] { return pending.load() == 0; });
+  }
+
+  void Shutdown(bool drain) {
+    std::lock_guard<std::mutex> once(shutdown_mutex);
+    if (shut_down) {
+      return;
+    }
+    shut_down = true;
+    accepting = false;
+    if (drain) {
+      WaitIdle();
+    }
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      stopping = true;
+    }
+    sleep_cv.notify_all();
+    for (auto& worker : workers) {
+      worker->thread.join();
+    }
+    // Whatever is left fails its Future
+    for (auto& worker : workers) {
+      while (Task* task = worker->deque.Pop()) {
+        delete task;
+      }
+    }
+    for (auto& queue : queues) {
+      for (Task* task : queue) {
+        delete task;
+      }
+      queue.clear();
+    }
+    {
+      std::lock_guard<std::mutex> lock(idle_mutex);
+      pending = 0;
+    }
+    idle_cv.notify_all();
+  }
+
+  std::vector<std::unique_ptr<Worker>> workers;
+
+ private:
+  void Run(size_t index) {
+    current = {this, index};
+    while (!stopping) {
+      uint64_t seen = epoch.load();
+      if (Task* task = Find(index)) {
+        Execute(task);
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      if (stopping) {
+        break;
+      }
+      sleeping.fetch_add(1);
+      sleep_cv.wait(lock, [&] { return stopping || epoch.load() != seen; });
+      sleeping.fetch_sub(1);
+    }
+    current = {};
+  }
+
+  Task* Find(size_t index) {
+    if (Task* task = Dequeue(PRIORITY::HIGH)) {
+      return task;
+    }
+    if (Task* task = workers[index]->deque.Pop()) {
+      return task;
+    }
+    if (Task* task = Dequeue(PRIORITY::NORMAL)) {
+      return task;
+    }
+    for (size_t i = 1; i < workers.size(); ++i) {
+      auto& victim = workers[(index + i) % workers.size()]->deque;
+      if (Task* task = victim.Empty() ? nullptr : victim.Steal()) {
+        return task;
+      }
+    }
+    return Dequeue(PRIORITY::LOW);
+  }
+
+  Task* Dequeue(PRIORITY priority) {
+    auto p = static_cast<size_t>(priority);
+    if (queued[p].load(std::memory_order_relaxed) == 0) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if (queues[p].empty()) {
+      return nullptr;
+    }
+    Task* task = queues[p].front();
+    queues[p].pop_front();
+    queued[p].fetch_sub(1);
+    return task;
+  }
+
+  void Execute(Task* task) {
+    try {
+      task->Run();
+    } catch (...) {
+      // Post() tasks have nowhere to report to
+    }
+    delete task;
+    if (pending.fetch_sub(1) == 1) {
+      std::lock_guard<std::mutex> lock(idle_mutex);
+      idle_cv.notify_all();
+    }
+  }
+
+  std::mutex queue_mutex;
+  std::deque<Task*> queues[PRIORITIES];
+  std::atomic<size_t> queued[PRIORITIES] = {};
+
+  // Workers sleep until epoch moves, which every Enqueue does
+  std::mutex sleep_mutex;
+  std::condition_variable sleep_cv;
+  std::atomic<uint64_t> epoch{0};
+  std::atomic<size_t> sleeping{0};
+
+  std::atomic<size_t> pending{0};  // Enqueued and not yet finished
+  std::mutex idle_mutex;
+  std::condition_variable idle_cv;
+
+  std::mutex shutdown_mutex;
+  bool shut_down = false;
+  std::atomic<bool> accepting{true};
+  std::atomic<bool> stopping{false};
+};
+
+thread_local YaUtils::ThreadPool::Impl::Current
+    YaUtils::ThreadPool::Impl::current;
+
+YaUtils::ThreadPool::ThreadPool(size_t workers)
+    : m_impl(std::make_unique<Impl>(workers)) {}
+
+YaUtils::ThreadPool::~ThreadPool() { Shutdown(true); }
+
+YaUtils::ThreadPool& YaUtils::ThreadPool::Shared() {
+  static ThreadPool pool;
+  return pool;
+}
+
+size_t YaUtils::ThreadPool::Size() const { return m_impl->workers.size(); }
+
+bool YaUtils::ThreadPool::Enqueue(std::unique_ptr<Task> task,
+                                  PRIORITY priority) {
+  return m_impl->Enqueue(std::move(task), priority);
+}
+
+void YaUtils::ThreadPool::ParallelFor(size_t count,
+                                      const std::function<void(size_t)>& fn,
+                                      size_t max_threads) {
+  if (count == 0) {
+    return;
+  }
+  // Helpers that start after the last item find nothing left and never
+  // touch fn, so the state they share outlives this call safely
+  struct Loop {
+    size_t count;
+    const std::function<void(size_t)>* fn;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;
+  };
+  auto loop = std::make_shared<Loop>();
+  loop->count = count;
+  loop->fn = &fn;
+  auto work = [](Loop& loop) {
+    size_t i;
+    while ((i = loop.next.fetch_add(1)) < loop.count) {
+      try {
+        (*loop.fn)(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        if (!loop.error) {
+          loop.error = std::current_exception();
+        }
+      }
+      if (loop.done.fetch_add(1) + 1 == loop.count) {
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        loop.cv.notify_all();
+      }
+    }
+  };
+
+  size_t helpers = max_threads == 0 ? Size() : max_threads - 1;
+  helpers = std::min(helpers, count - 1);
+  for (size_t i = 0; i < helpers; ++i) {
+    if (!Post([loop, work] { work(*loop); })) {
+      break;
+    }
+  }
+  work(*loop);
+
+  std::unique_lock<std::mutex> lock(loop->mutex);
+  loop->cv.wait(lock, [&] { return loop->done.load() == count; });
+  if (loop->error) {
+    std::rethrow_exception(loop->error);
+  }
+}
+
+void YaUtils::ThreadPool::WaitIdle() { m_impl->WaitIdle(); }
+
+void YaUtils::ThreadPool::Shutdown(bool drain) { m_impl->Shutdown(drain); }
+
+namespace {
+
+// Smallest first chunk, so tiny sizes do not cost a chunk per allocation
+constexpr size_t MIN_CHUNK_SIZE = 256;
+
+}  // namespace
+
+YaUtils::Arena::Arena(size_t chunk_size, std::pmr::memory_resource* upstream)
+    : m_upstream(upstream),
+      m_next_size(std::clamp(chunk_size, MIN_CHUNK_SIZE, MAX_CHUNK_SIZE)) {}
+
+YaUtils::Arena::Arena(std::span<std::byte> buffer,
+                      std::pmr::memory_resource* upstream)
+    : Arena(buffer.size() * 2, upstream) {
+  m_buffer = buffer;
+  m_current = buffer.data();
+  m_end = buffer.data() + buffer.size();
+}
+
+YaUtils::Arena::~Arena() { Release(); }
+
+void YaUtils::Arena::Reset() {
+  Chunk* keep = m_spare;
+  while (m_chunks) {
+    Chunk* chunk = m_chunks;
+    m_chunks = chunk->next;
+    if (!keep || chunk->size > keep->size) {
+      std::swap(keep, chunk);
+    }
+    if (chunk) {
+      Free(chunk);
+    }
+  }
+  m_spare = keep;
+  m_current = m_buffer.data();
+  m_end = m_buffer.data() + m_buffer.size();
+  m_stats.bytes_allocated = 0;
+  ++m_stats.resets;
+}
+
+void YaUtils::Arena::Release() {
+  Reset();
+  if (m_spare) {
+    Free(m_spare);
+    m_spare = nullptr;
+  }
+}
+
+void* YaUtils::Arena::do_allocate(size_t bytes, size_t alignment) {
+  void* p = m_current;
+  size_t space = m_end - m_current;
+  if (!std::align(alignment, bytes, p, space)) {
+    Grow(bytes, alignment);
+    p = m_current;
+    space = m_end - m_current;
+    std::align(alignment, bytes, p, space);
+  }
+  m_current = static_cast<std::byte*>(p) + bytes;
+  ++m_stats.allocations;
+  m_stats.bytes_allocated += bytes;
+  m_stats.peak_allocated =
+      std::max(m_stats.peak_allocated, m_stats.bytes_allocated);
+  return p;
+}
+
+void YaUtils::Arena::Grow(size_t bytes, size_t alignment) {
+  size_t needed = sizeof(Chunk) + bytes + alignment;
+  if (m_spare && m_spare->size >= needed) {
+    Use(std::exchange(m_spare, nullptr));
+    return;
+  }
+  size_t size = std::max(m_next_size, needed);
+  void* memory = m_upstream->allocate(size, alignof(std::max_align_t));
+  ++m_stats.chunks;
+  m_stats.bytes_reserved += size;
+  m_next_size = std::min(m_next_size * 2, MAX_CHUNK_SIZE);
+  Use(new (memory) Chunk{nullptr, size});
+}
+
+void YaUtils::Arena::Use(Chunk* chunk) {
+  chunk->next = m_chunks;
+  m_chunks = chunk;
+  m_current = reinterpret_cast<std::byte*>(chunk + 1);
+  m_end = reinterpret_cast<std::byte*>(chunk) + chunk->size;
+}
+
+void YaUtils::Arena::Free(Chunk* chunk) {
+  m_stats.bytes_reserved -= chunk->size;
+  m_upstream->deallocate(chunk, chunk->size, alignof(std::max_align_t));
+}
+
+namespace {
+
+using ObjectPool = YaUtils::ObjectPool;
+
+constexpr size_t POOL_CLASS_COUNT =
+    ObjectPool::MAX_POOLED_SIZE / ObjectPool::ALIGNMENT;
+// Upper bound on cached bytes per size class and thread
+constexpr size_t POOL_CLASS_BUDGET = 64 * 1024;
+constexpr size_t POOL_MAX_CACHED_PER_CLASS = 1024;
+
+// Size class of a size up to MAX_POOLED_SIZE, and the block size it gets
+constexpr size_t pool_class(size_t size) {
+  return (std::max<size_t>(size, 1) - 1) / ObjectPool::ALIGNMENT;
+}
+
+constexpr size_t pool_class_size(size_t index) {
+  return (index + 1) * ObjectPool::ALIGNMENT;
+}
+
+constexpr size_t pool_class_limit(size_t index) {
+  return std::min(POOL_CLASS_BUDGET / pool_class_size(index),
+                  POOL_MAX_CACHED_PER_CLASS);
+}
+
+struct PoolCounters {
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> recycled{0};
+  std::atomic<uint64_t> dropped{0};
+};
+
+// Counters of live thread caches, plus totals folded in from exited threads
+std::mutex g_pool_mutex;
+std::vector<PoolCounters*> g_pool_counters;
+ObjectPool::Stats g_pool_retired;
+
+// Cleared as a thread's cache is destroyed, so blocks freed later by other
+// thread_local destructors skip the cache
+thread_local bool t_pool_alive = true;
+
+void pool_bump(std::atomic<uint64_t>& counter) {
+  // Only the owning thread writes, so a plain load/store pair suffices
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+
+struct PoolCache {
+  std::array<std::vector<void*>, POOL_CLASS_COUNT> lists;
+  PoolCounters counters;
+
+  PoolCache() {
+    std::lock_guard<std::mutex> lock(g_pool_mutex);
+    g_pool_counters.push_back(&counters);
+  }
+
+  ~PoolCache() {
+    t_pool_alive = false;
+    for (auto& list : lists) {
+      for (void* block : list) {
+        ::operator delete(block);
+      }
+    }
+    std::lock_guard<std::mutex> lock(g_pool_mutex);
+    g_pool_retired.hits += counters.hits.load(std::memory_order_relaxed);
+    g_pool_retired.misses += counters.misses.load(std::memory_order_relaxed);
+    g_pool_retired.recycled +=
+        counters.recycled.load(std::memory_order_relaxed);
+    g_pool_retired.dropped += counters.dropped.load(std::memory_order_relaxed);
+    std::erase(g_pool_counters, &counters);
+  }
+};
+
+PoolCache& pool_cache() {
+  thread_local PoolCache cache;
+  return cache;
+}
+
+}  // namespace
+
+double YaUtils::ObjectPool::Stats::HitRate() const {
+  uint64_t total = hits + misses;
+  return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+}
+
+void* YaUtils::ObjectPool::Allocate(size_t size) {
+  if (size > MAX_POOLED_SIZE || !t_pool_alive) {
+    return ::operator new(size);
+  }
+  auto& cache = pool_cache();
+  size_t index = pool_class(size);
+  auto& list = cache.lists[index];
+  if (!list.empty()) {
+    void* block = list.back();
+    list.pop_back();
+    pool_bump(cache.counters.hits);
+    return block;
+  }
+  pool_bump(cache.counters.misses);
+  return ::operator new(pool_class_size(index));
+}
+
+void YaUtils::ObjectPool::Deallocate(void* block, size_t size) {
+  if (!block) {
+    return;
+  }
+  if (size > MAX_POOLED_SIZE || !t_pool_alive) {
+    ::operator delete(block);
+    return;
+  }
+  auto& cache = pool_cache();
+  size_t index = pool_class(size);
+  auto& list = cache.lists[index];
+  if (list.size() >= pool_class_limit(index)) {
+    pool_bump(cache.counters.dropped);
+    ::operator delete(block);
+    return;
+  }
+  if (list.capacity() == 0) {
+    list.reserve(pool_class_limit(index));
+  }
+  pool_bump(cache.counters.recycled);
+  list.push_back(block);
+}
+
+YaUtils::ObjectPool::Stats YaUtils::ObjectPool::GetStats() {
+  std::lock_guard<std::mutex> lock(g_pool_mutex);
+  Stats total = g_pool_retired;
+  for (const PoolCounters* counters : g_pool_counters) {
+    total.hits += counters->hits.load(std::memory_order_relaxed);
+    total.misses += counters->misses.load(std::memory_order_relaxed);
+    total.recycled += counters->recycled.load(std::memory_order_relaxed);
+    total.dropped += counters->dropped.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+void YaUtils::ObjectPool::ResetStats() {
+  std::lock_guard<std::mutex> lock(g_pool_mutex);
+  g_pool_retired = Stats{};
+  for (PoolCounters* counters : g_pool_counters) {
+    counters->hits.store(0, std::memory_order_relaxed);
+    counters->misses.store(0, std::memory_order_relaxed);
+    counters->recycled.store(0, std::memory_order_relaxed);
+    counters->dropped.store(0, std::memory_order_relaxed);
+  }
+}
+
 }  // namespace ya
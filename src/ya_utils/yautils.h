@@ -1,9 +1,43 @@
 #ifndef YA_UTILS_H
 #define YA_UTILS_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <list>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(YA_UTILS_TSC) && (defined(__x86_64__) || defined(_M_X64))
+#define YA_UTILS_HAS_TSC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
 
 namespace ya {
 
@@ -22,10 +56,31 @@ class YaUtils {
     static std::string m_exe_name;
   };
 
+  // A Timer object measures from its construction (or Restart) and costs a
+  // few ns per reading: no lookups, no locks, no allocation. Ticks come from
+  // the invariant TSC when built with YA_UTILS_TSC on x86-64 and the CPU
+  // has one, from steady_clock (in ns) otherwise; TicksToNs() converts
+  // either way.
+  //
+  // The static named timers are kept for existing callers. They are
+  // thread-safe but take a lock and a map lookup per call, so keep them
+  // off hot paths.
   class Timer {
    public:
-    Timer() = default;
+    Timer() : m_start(Ticks()) {}
     ~Timer() = default;
+
+    void Restart() { m_start = Ticks(); }
+    uint64_t GetElapsedTicks() const { return Ticks() - m_start; }
+    double GetElapsed_ns() const { return TicksToNs(GetElapsedTicks()); }
+    double GetElapsed_μs() const { return GetElapsed_ns() / 1'000.0; }
+    double GetElapsed_ms() const { return GetElapsed_ns() / 1'000'000.0; }
+    double GetElapsed_s() const { return GetElapsed_ns() / 1'000'000'000.0; }
+
+    static uint64_t Ticks();
+    static double TicksToNs(uint64_t ticks);
+    static bool UsesTsc();
+
     static void StartTimer(const std::string& timer_id = "0");
     static double GetElapsedTime_ms(const std::string& timer_id = "0");
     static double GetElapsedTime_s(const std::string& timer_id = "0");
@@ -33,8 +88,179 @@ class YaUtils {
     static void Sleep(unsigned int ms);
 
    private:
-    static std::map<std::string, std::chrono::steady_clock::time_point>
-        m_timers;
+    uint64_t m_start;
+  };
+
+  // Adds the ticks spent until the end of the scope to a counter:
+  //   static std::atomic<uint64_t> parse_ticks;
+  //   { YaUtils::ScopedTimer t(parse_ticks); parse(); }
+  class ScopedTimer {
+   public:
+    explicit ScopedTimer(uint64_t& ticks)
+        : m_ticks(&ticks), m_start(Timer::Ticks()) {}
+    explicit ScopedTimer(std::atomic<uint64_t>& ticks)
+        : m_atomic_ticks(&ticks), m_start(Timer::Ticks()) {}
+    ~ScopedTimer() {
+      uint64_t elapsed = Timer::Ticks() - m_start;
+      if (m_ticks) {
+        *m_ticks += elapsed;
+      } else {
+        m_atomic_ticks->fetch_add(elapsed, std::memory_order_relaxed);
+      }
+    }
+
+    // Prevent copying
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+   private:
+    uint64_t* m_ticks = nullptr;
+    std::atomic<uint64_t>* m_atomic_ticks = nullptr;
+    const uint64_t m_start;
+  };
+
+  // Latency histogram in ns, HDR style: 32 linear sub-buckets per power of
+  // two, so any value is kept within about 3%, in fixed memory and with an
+  // O(1) Record(). Values above MAX_VALUE (about 36 minutes) are clamped.
+  // Record() is thread-safe; it is cheapest when each thread has its own
+  // histogram, which is what Profiler arranges.
+  class Histogram {
+   public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BITS;
+    static constexpr int MAX_EXPONENT = 36;
+    static constexpr size_t BUCKETS = (MAX_EXPONENT + 1) * SUB_BUCKETS;
+    static constexpr uint64_t MAX_VALUE =
+        (uint64_t{1} << (MAX_EXPONENT + SUB_BITS)) - 1;
+
+    Histogram() = default;
+    Histogram(const Histogram& other);
+    Histogram& operator=(const Histogram& other);
+
+    void Record(uint64_t value_ns);
+    void Record(std::chrono::nanoseconds elapsed);  // Negative reads as 0
+    void Merge(const Histogram& other);
+    void Reset();
+
+    uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t Min() const;  // 0 when empty
+    uint64_t Max() const { return m_max.load(std::memory_order_relaxed); }
+    uint64_t Sum() const { return m_sum.load(std::memory_order_relaxed); }
+    double Mean() const;
+    // Smallest value at or above percentile (0-100) of the samples, as the
+    // top of its bucket; 0 when empty
+    uint64_t Percentile(double percentile) const;
+
+    static size_t BucketOf(uint64_t value);
+    static uint64_t BucketTop(size_t bucket);
+
+   private:
+    std::array<std::atomic<uint64_t>, BUCKETS> m_counts{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_min{UINT64_MAX};
+    std::atomic<uint64_t> m_max{0};
+  };
+
+  // Named latency probes for hot paths. Each thread records into its own
+  // histogram per probe, found through a thread-local table, so recording
+  // takes no lock and shares no cache line; Collect() merges them. A
+  // thread's histograms are handed to later threads when it exits, so a
+  // thread pool does not grow them without bound.
+  //
+  // Look a probe up once and keep the reference, or use YA_PROFILE_SCOPE,
+  // which does so:
+  //   void Handle(const Message& msg) {
+  //     YA_PROFILE_SCOPE("rpc.handle");
+  //     ...
+  //   }
+  class Profiler {
+   public:
+    struct Snapshot {
+      std::string name;
+      uint64_t count = 0;
+      double mean_ns = 0;
+      uint64_t min_ns = 0;
+      uint64_t max_ns = 0;
+      uint64_t p50_ns = 0;
+      uint64_t p90_ns = 0;
+      uint64_t p99_ns = 0;
+      uint64_t p999_ns = 0;
+    };
+
+    using Reporter = std::function<void(const std::vector<Snapshot>&)>;
+
+    class Probe {
+     public:
+      void Record(uint64_t value_ns);
+      const std::string& GetName() const { return m_name; }
+      Histogram Collect() const;  // All threads merged
+      void Reset();
+
+      explicit Probe(std::string_view name);
+      // Prevent copying
+      Probe(const Probe&) = delete;
+      Probe& operator=(const Probe&) = delete;
+
+     private:
+      struct Slot;
+      Histogram& LocalHistogram();
+
+      const std::string m_name;
+      const size_t m_id;  // Index into every thread's table
+      mutable std::mutex m_mutex;
+      std::vector<std::shared_ptr<Slot>> m_slots;
+    };
+
+    // Times a scope into a probe
+    class Zone {
+     public:
+      explicit Zone(Probe& probe) : m_probe(probe) {}
+      ~Zone() { m_probe.Record(Timer::TicksToNs(m_timer.GetElapsedTicks())); }
+
+      // Prevent copying
+      Zone(const Zone&) = delete;
+      Zone& operator=(const Zone&) = delete;
+
+     private:
+      Probe& m_probe;
+      Timer m_timer;
+    };
+
+    Profiler() = default;
+    ~Profiler();
+
+    // The process-wide registry YA_PROFILE_SCOPE records into
+    static Profiler& Instance();
+
+    // Creates the probe on first use; the reference stays valid for the
+    // life of the profiler
+    Probe& GetProbe(std::string_view name);
+
+    std::vector<Snapshot> Collect() const;  // By name
+    void Reset();
+
+    std::string DumpJson() const;
+    // Prometheus text format, one summary per probe
+    std::string DumpPrometheus(std::string_view metric = "ya_latency_ns") const;
+
+    // Calls reporter with Collect() every interval from a background
+    // thread, e.g. to log or push the dump. Replaces a running reporter.
+    void StartReporter(std::chrono::milliseconds interval, Reporter reporter);
+    void StopReporter();
+
+    // Prevent copying
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+   private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::unique_ptr<Probe>, std::less<>> m_probes;
+
+    std::mutex m_reporter_mutex;
+    std::condition_variable m_reporter_cv;
+    bool m_reporter_stop = false;
+    std::thread m_reporter;
   };
 
   class Platform {
@@ -47,8 +273,74 @@ class YaUtils {
     static PLATFORM GetPlatform();
   };
 
+  // CPU lists as sysfs and taskset write them, e.g. "0-3,8,10-11"
+  class CpuList {
+   public:
+    // Sorted and without duplicates; throws std::invalid_argument on
+    // anything but comma-separated numbers and ascending ranges
+    static std::vector<int> Parse(const std::string& list);
+    static std::string Format(const std::vector<int>& cpus);
+  };
+
   using CryptoBuffer = std::vector<unsigned char>;
 
+  class Crypto;
+
+  // A parsed public or private key (an EVP_PKEY). Parsing PEM costs more
+  // than signing or verifying a small message, so load a key once and pass
+  // the handle. Copies share the key; it is never modified, so a handle
+  // can be used from any number of threads.
+  class Key {
+   public:
+    enum class TYPE { RSA, DSA, EC, ED25519, X25519, OTHER };
+
+    static std::optional<Key> LoadPublic(const CryptoBuffer& pem);
+    static std::optional<Key> LoadPrivate(const CryptoBuffer& pem);
+
+    TYPE GetType() const;
+    bool IsPrivate() const;
+    // Hex SHA-256 of the public key (DER), equal for both halves of a pair
+    std::string Fingerprint() const;
+
+   private:
+    friend class Crypto;
+    class Impl;
+    explicit Key(std::shared_ptr<const Impl> impl);
+    std::shared_ptr<const Impl> m_impl;
+  };
+
+  // Thread-safe LRU of parsed keys by their PEM text, for callers that
+  // only have the PEM at hand. Crypto uses one when given it.
+  class KeyCache {
+   public:
+    struct Stats {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t evictions = 0;
+    };
+
+    explicit KeyCache(size_t capacity = 64);
+
+    // Parsed key for pem, parsing it on a miss; nullopt if it does not parse
+    std::optional<Key> GetPublic(const CryptoBuffer& pem);
+    std::optional<Key> GetPrivate(const CryptoBuffer& pem);
+
+    size_t Size() const;
+    Stats GetStats() const;
+    void Clear();
+
+   private:
+    std::optional<Key> Get(const CryptoBuffer& pem, bool is_private);
+
+    using Entry = std::pair<std::string, Key>;  // Kind and PEM, key
+
+    const size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_entries;  // Most recently used first
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> m_index;
+    Stats m_stats;
+  };
+
   class Crypto {
    public:
     Crypto();
@@ -66,9 +358,28 @@ class YaUtils {
     bool DES_Decrypt(const CryptoBuffer& ciphertext, std::string_view key,
                      std::string_view iv, std::string& plaintext);
 
+    // AEAD, 32-byte key and 12-byte IV (never reuse one with the same key);
+    // the 16-byte tag is appended to the ciphertext
+    bool AES_GCM_Encrypt(std::string_view plaintext, std::string_view key,
+                         std::string_view iv, std::string_view aad,
+                         CryptoBuffer& ciphertext);
+    bool AES_GCM_Decrypt(const CryptoBuffer& ciphertext, std::string_view key,
+                         std::string_view iv, std::string_view aad,
+                         std::string& plaintext);
+    bool ChaCha20_Poly1305_Encrypt(std::string_view plaintext,
+                                   std::string_view key, std::string_view iv,
+                                   std::string_view aad,
+                                   CryptoBuffer& ciphertext);
+    bool ChaCha20_Poly1305_Decrypt(const CryptoBuffer& ciphertext,
+                                   std::string_view key, std::string_view iv,
+                                   std::string_view aad,
+                                   std::string& plaintext);
+
     // Hash
     bool MD5_Hash(std::string_view data, CryptoBuffer& digest);
     bool SHA256_Hash(std::string_view data, CryptoBuffer& digest);
+    // Streams the file through SHA-256, mapped into memory where possible
+    std::optional<CryptoBuffer> SHA256_File(const std::string& path);
 
     // RSA
     bool Generate_RSA_Key(CryptoBuffer& public_key, CryptoBuffer& private_key);
@@ -84,12 +395,1036 @@ class YaUtils {
     bool DSA_Verify(const CryptoBuffer& public_key, std::string_view data,
                     const CryptoBuffer& signature);
 
+    // Ed25519 and ECDSA P-256: keys generate in well under a millisecond
+    // and sign many times faster than RSA, with short keys and signatures.
+    // ECDSA signs the SHA-256 of data (DER encoded signature); Ed25519
+    // signs data itself (64 bytes).
+    bool Generate_Ed25519_Key(CryptoBuffer& public_key,
+                              CryptoBuffer& private_key);
+    std::optional<CryptoBuffer> Ed25519_Sign(const CryptoBuffer& private_key,
+                                             std::string_view data);
+    bool Ed25519_Verify(const CryptoBuffer& public_key, std::string_view data,
+                        const CryptoBuffer& signature);
+    bool Generate_ECDSA_Key(CryptoBuffer& public_key,
+                            CryptoBuffer& private_key);
+    std::optional<CryptoBuffer> ECDSA_Sign(const CryptoBuffer& private_key,
+                                           std::string_view data);
+    bool ECDSA_Verify(const CryptoBuffer& public_key, std::string_view data,
+                      const CryptoBuffer& signature);
+
+    // X25519: each side derives the same 32-byte secret from its private
+    // key and the peer's public key. Pass it through HKDF before use.
+    bool Generate_X25519_Key(CryptoBuffer& public_key,
+                             CryptoBuffer& private_key);
+    std::optional<CryptoBuffer> X25519_Derive(
+        const CryptoBuffer& private_key, const CryptoBuffer& peer_public_key);
+
+    // HKDF with SHA-256 (RFC 5869); length is at most 255 * 32 bytes
+    std::optional<CryptoBuffer> HKDF_SHA256(
+        std::span<const unsigned char> secret, std::string_view salt,
+        std::string_view info, size_t length);
+
+    // With parsed keys: no PEM parsing per call. Sign/Verify work with any
+    // signing key, hashing with SHA-256 except for Ed25519 (DSA_Sign and
+    // DSA_Verify are these). Derive does X25519 or ECDH.
+    std::optional<CryptoBuffer> RSA_Encrypt(const Key& public_key,
+                                            std::string_view plaintext);
+    std::optional<std::string> RSA_Decrypt(const Key& private_key,
+                                           const CryptoBuffer& ciphertext);
+    std::optional<CryptoBuffer> Sign(const Key& private_key,
+                                     std::string_view data);
+    bool Verify(const Key& public_key, std::string_view data,
+                const CryptoBuffer& signature);
+    std::optional<CryptoBuffer> Derive(const Key& private_key,
+                                       const Key& peer_public_key);
+
+    // Batches, spread over ThreadPool::Shared() with up to threads threads
+    // (0: every worker and the caller); small batches stay on the calling
+    // thread. Results
+    // are in input order: an empty digest or nullopt for an input that
+    // failed. keys holds one key for all messages or one per message.
+    std::vector<CryptoBuffer> SHA256_Hash_Batch(
+        std::span<const std::string_view> inputs, size_t threads = 0);
+    std::vector<std::optional<CryptoBuffer>> SHA256_File_Batch(
+        std::span<const std::string> paths, size_t threads = 0);
+    std::vector<bool> Verify_Batch(std::span<const Key> keys,
+                                   std::span<const std::string_view> data,
+                                   std::span<const CryptoBuffer> signatures,
+                                   size_t threads = 0);
+
+    // PEM keys passed to the calls above are looked up in cache instead of
+    // parsed every time; nullptr (the default) parses every time. Set it
+    // before sharing the Crypto between threads.
+    void SetKeyCache(std::shared_ptr<KeyCache> cache);
+
    private:
+    std::optional<Key> Load_Key(const CryptoBuffer& pem, bool is_private);
+    std::optional<Key> Load_Key(const CryptoBuffer& pem, bool is_private,
+                                Key::TYPE type);
+
     class Impl;
     std::unique_ptr<Impl> m_impl;
+    std::shared_ptr<KeyCache> m_key_cache;
   };
+
+  // Streaming encryption into caller buffers over one EVP context, kept
+  // from message to message so only the first Init pays for allocation:
+  //   Cipher cipher(Cipher::ALGO::AES_256_GCM);
+  //   cipher.EncryptInit(key, iv);
+  //   for (chunk : file) out += *cipher.Update(chunk, buffer);
+  //   cipher.Final(buffer); cipher.GetTag(tag);
+  // Update() needs room for the input plus BlockSize() (just the input for
+  // the stream and AEAD modes, so they can work in place). Not
+  // thread-safe; use one Cipher per thread.
+  class Cipher {
+   public:
+    enum class ALGO {
+      AES_256_CBC,
+      AES_256_CTR,
+      AES_256_GCM,
+      CHACHA20_POLY1305
+    };
+    static constexpr size_t TAG_SIZE = 16;
+
+    explicit Cipher(ALGO algo);
+    ~Cipher();
+    Cipher(Cipher&& other) noexcept;
+    Cipher& operator=(Cipher&& other) noexcept;
+
+    ALGO GetAlgo() const;
+    size_t KeySize() const;
+    size_t IvSize() const;
+    size_t BlockSize() const;  // 1 for stream and AEAD modes
+    bool IsAead() const;
+
+    // Starts a message; key and iv must be KeySize() and IvSize() long
+    bool EncryptInit(std::string_view key, std::string_view iv);
+    bool DecryptInit(std::string_view key, std::string_view iv);
+    // Next message with the same key and direction, without redoing the
+    // key schedule
+    bool Restart(std::string_view iv);
+
+    // AEAD only: authenticated, unencrypted data, before any Update()
+    bool SetAad(std::string_view aad);
+
+    // Returns the bytes written to output, nullopt on error
+    std::optional<size_t> Update(std::span<const unsigned char> input,
+                                 std::span<unsigned char> output);
+    std::optional<size_t> Update(std::string_view input,
+                                 std::span<unsigned char> output);
+    // Writes at most BlockSize() bytes. AEAD decryption needs SetTag()
+    // first and fails here if the data or tag were tampered with.
+    std::optional<size_t> Final(std::span<unsigned char> output);
+
+    // AEAD tag, TAG_SIZE bytes: read after encrypting, set before Final()
+    // when decrypting
+    bool GetTag(std::span<unsigned char> tag);
+    bool SetTag(std::span<const unsigned char> tag);
+
+    // Prevent copying
+    Cipher(const Cipher&) = delete;
+    Cipher& operator=(const Cipher&) = delete;
+
+   private:
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+  };
+
+  // Incremental hash over one reused context, for data that arrives in
+  // pieces. Final() returns the digest and starts over. Not thread-safe;
+  // use one Digest per thread.
+  class Digest {
+   public:
+    enum class ALGO { MD5, SHA256 };
+
+    explicit Digest(ALGO algo);
+    ~Digest();
+    Digest(Digest&& other) noexcept;
+    Digest& operator=(Digest&& other) noexcept;
+
+    size_t Size() const;  // Digest length in bytes
+
+    bool Update(std::string_view data);
+    bool Update(std::span<const unsigned char> data);
+    std::optional<CryptoBuffer> Final();
+    bool Reset();
+
+    // Prevent copying
+    Digest(const Digest&) = delete;
+    Digest& operator=(const Digest&) = delete;
+
+   private:
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+  };
+
+  // Fast non-cryptographic hashing, for hash tables, cache keys, consistent
+  // hashing and checksums where MD5/SHA-256 strength is not needed.
+  //
+  // Hash64/Hash128 are wyhash-style multiply-mix hashes over 64-byte
+  // stripes, about an order of magnitude faster than SHA-256. Crc32c is the
+  // Castagnoli CRC (iSCSI, ext4), on the SSE4.2 or ARMv8 CRC instructions
+  // when the CPU has them, chosen at run time. All values are the same on
+  // every platform, so they may go on the wire or to disk.
+  class Hash {
+   public:
+    struct Value128 {
+      uint64_t low = 0;
+      uint64_t high = 0;
+      bool operator==(const Value128&) const = default;
+    };
+
+    static uint64_t Hash64(std::string_view data, uint64_t seed = 0);
+    static Value128 Hash128(std::string_view data, uint64_t seed = 0);
+    // Pass the previous result as crc to continue over more data
+    static uint32_t Crc32c(std::string_view data, uint32_t crc = 0);
+    static bool HasCrc32cInstructions();
+
+    // Streaming: after any split of the data into Update() calls, the
+    // digests equal Hash64/Hash128 of the whole
+    explicit Hash(uint64_t seed = 0);
+    void Update(std::string_view data);
+    uint64_t Digest64() const;
+    Value128 Digest128() const;
+    void Reset();
+
+   private:
+    static constexpr size_t STRIPE = 64;
+
+    uint64_t m_seed;
+    uint64_t m_lanes[4];
+    uint64_t m_length = 0;
+    unsigned char m_buffer[STRIPE];
+    size_t m_buffered = 0;
+  };
+
+  // Work-stealing thread pool, so subsystems can share one core-sized set
+  // of threads instead of each spawning their own.
+  //
+  // Each worker owns a Chase-Lev deque: tasks a worker submits go to its
+  // own deque (newest first, while their data is still in cache) and idle
+  // workers steal the oldest from the others. Tasks from other threads go
+  // through shared queues, one per priority: workers take HIGH tasks before
+  // anything else and LOW ones only when there is nothing else to do.
+  //
+  //   auto answer = pool.Submit([] { return 6 * 7; });
+  //   auto next = answer.Then([](int x) { return x + 1; });
+  //   next.Get();  // 43
+  //
+  // A coroutine returning Future<T> can co_await Schedule() to move onto a
+  // worker and co_await other Futures without blocking a thread. Blocking
+  // in Get() from inside a task ties up a worker; prefer Then or co_await.
+  class ThreadPool {
+   public:
+    enum class PRIORITY { HIGH, NORMAL, LOW };
+
+    template <typename T>
+    class Future;
+
+    explicit ThreadPool(size_t workers = 0);  // 0: one per core
+    ~ThreadPool();                            // Shutdown(true)
+
+    // Process-wide pool with one worker per core
+    static ThreadPool& Shared();
+
+    size_t Size() const;
+
+    // Runs f on a worker; false once shut down. Exceptions thrown by f are
+    // dropped; use Submit to see them.
+    template <typename F>
+    bool Post(F&& f, PRIORITY priority = PRIORITY::NORMAL);
+
+    // Runs f on a worker; the Future gets its result or exception, or an
+    // error if the pool shuts down first
+    template <typename F>
+    auto Submit(F&& f, PRIORITY priority = PRIORITY::NORMAL)
+        -> Future<std::invoke_result_t<std::decay_t<F>>>;
+
+    // Calls fn(i) for every i < count and returns when all calls have,
+    // rethrowing the first exception. The caller takes items too, so it
+    // works from inside a task; at most max_threads threads take part
+    // (0: every worker and the caller).
+    void ParallelFor(size_t count, const std::function<void(size_t)>& fn,
+                     size_t max_threads = 0);
+
+    // Blocks until every task submitted so far has run. Not from a task.
+    void WaitIdle();
+
+    // Refuses new tasks from outside the pool and joins the workers. With
+    // drain, queued tasks (and the tasks they submit) run first; without,
+    // they are dropped and their Futures fail.
+    void Shutdown(bool drain = true);
+
+    struct ScheduleAwaiter {
+      ThreadPool* pool;
+      PRIORITY priority;
+      bool await_ready() const noexcept { return false; }
+      // Carries on in place if the pool no longer takes tasks
+      bool await_suspend(std::coroutine_handle<> handle) {
+        return pool->Post([handle] { handle.resume(); }, priority);
+      }
+      void await_resume() const noexcept {}
+    };
+
+    // co_await pool.Schedule() continues the coroutine on a worker
+    ScheduleAwaiter Schedule(PRIORITY priority = PRIORITY::NORMAL) {
+      return {this, priority};
+    }
+
+    // Prevent copying
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+   private:
+    class Task {
+     public:
+      virtual ~Task() = default;
+      virtual void Run() = 0;
+    };
+
+    template <typename F>
+    class FunctionTask;
+    template <typename F, typename T>
+    class PromiseTask;
+    template <typename T>
+    struct State;
+    template <typename T>
+    struct PromiseBase;
+    template <typename T>
+    struct ValuePromise;
+    struct VoidPromise;
+
+    template <typename F, typename T>
+    using ThenResult =
+        typename std::conditional_t<std::is_void_v<T>, std::invoke_result<F>,
+                                    std::invoke_result<F, T>>::type;
+
+    // Takes ownership of task; a refused task is destroyed unrun
+    bool Enqueue(std::unique_ptr<Task> task, PRIORITY priority);
+
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+  };
+
+  // Cache line size on the CPUs we target; data this far apart is not
+  // fought over by cores writing either side
+  static constexpr size_t CACHE_LINE = 64;
+
+  // Lock-free queues for handing items between threads (nng callbacks to
+  // workers, stage to stage) without a lock or a syscall on the way.
+  //
+  //   SpscRing   bounded, one producer thread and one consumer thread
+  //   MpscQueue  unbounded and intrusive, any producers, one consumer
+  //   MpmcQueue  bounded (Vyukov), any producers and consumers
+  //
+  // The bounded queues round their capacity up to a power of two and do
+  // not allocate after construction: TryPush fails when full and TryPop
+  // when empty, so the caller picks whether to spin, yield or drop. The
+  // producer and consumer ends live on separate cache lines. The batch
+  // calls move up to items.size() items for one round of synchronization
+  // and return how many they moved.
+  template <typename T>
+  class SpscRing;
+  template <typename T>
+  class MpmcQueue;
+
+  // Base of the items of an MpscQueue, which links them through next
+  struct MpscNode {
+    std::atomic<MpscNode*> next{nullptr};
+  };
+
+  template <typename T>
+  class MpscQueue;
+
+  // Monotonic arena for memory that dies together, such as everything one
+  // request allocates: allocation bumps a pointer and deallocation does
+  // nothing until Reset() drops it all at once.
+  //
+  //   YaUtils::Arena arena;
+  //   std::pmr::vector<std::pmr::string> names(&arena);
+  //   ...
+  //   arena.Reset();  // Between requests, once names is gone
+  //
+  // Chunks come from upstream, doubling from chunk_size up to
+  // MAX_CHUNK_SIZE, after an optional caller buffer (e.g. on the stack).
+  // Unlike std::pmr::monotonic_buffer_resource, Reset() keeps the largest
+  // chunk, so a long-running loop stops calling upstream once warm. Not
+  // thread safe: one arena per request or thread.
+  class Arena : public std::pmr::memory_resource {
+   public:
+    struct Stats {
+      uint64_t allocations = 0;      // Since construction
+      uint64_t bytes_allocated = 0;  // Requested since the last Reset
+      uint64_t peak_allocated = 0;   // Largest bytes_allocated seen
+      uint64_t bytes_reserved = 0;   // Taken from upstream and held now
+      uint64_t chunks = 0;           // Upstream allocations, in total
+      uint64_t resets = 0;
+    };
+
+    static constexpr size_t MAX_CHUNK_SIZE = 1024 * 1024;
+
+    explicit Arena(size_t chunk_size = 4096,
+                   std::pmr::memory_resource* upstream =
+                       std::pmr::new_delete_resource());
+    // Serves from buffer first; buffer must outlive the arena
+    explicit Arena(std::span<std::byte> buffer,
+                   std::pmr::memory_resource* upstream =
+                       std::pmr::new_delete_resource());
+    ~Arena() override;
+
+    // Invalidates every allocation; keeps the largest chunk for reuse
+    void Reset();
+    // Invalidates every allocation and returns all chunks to upstream
+    void Release();
+
+    const Stats& GetStats() const { return m_stats; }
+    std::pmr::memory_resource* Upstream() const { return m_upstream; }
+
+    // Prevent copying
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+   private:
+    struct Chunk {
+      Chunk* next;
+      size_t size;  // Including this header
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+
+    void Grow(size_t bytes, size_t alignment);
+    void Use(Chunk* chunk);
+    void Free(Chunk* chunk);
+
+    std::pmr::memory_resource* m_upstream;
+    std::span<std::byte> m_buffer;
+    size_t m_next_size;
+    Chunk* m_chunks = nullptr;  // In use, newest first
+    Chunk* m_spare = nullptr;   // Kept by Reset, used before upstream
+    std::byte* m_current = nullptr;
+    std::byte* m_end = nullptr;
+    Stats m_stats;
+  };
+
+  // Thread-local cache of fixed-size blocks for small objects created and
+  // destroyed at a high rate (messages, tasks, nodes).
+  //
+  // Blocks come in size classes of ALIGNMENT bytes up to MAX_POOLED_SIZE.
+  // A freed block goes to the freeing thread's cache for its class and is
+  // handed out by the next allocation of that class on that thread, with
+  // no lock; caches are bounded and freed when their thread exits. Larger
+  // sizes go straight to operator new.
+  //
+  //   auto node = YaUtils::ObjectPool::Make<Node>(args...);
+  class ObjectPool {
+   public:
+    struct Stats {
+      uint64_t hits = 0;      // Allocate() served from cache
+      uint64_t misses = 0;    // Allocate() fell back to operator new
+      uint64_t recycled = 0;  // Deallocate() kept the block
+      uint64_t dropped = 0;   // Deallocate() freed it (cache full, too big)
+
+      double HitRate() const;
+    };
+
+    static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+    static constexpr size_t MAX_POOLED_SIZE = 512;
+
+    // size must be the same in both calls
+    static void* Allocate(size_t size);
+    static void Deallocate(void* block, size_t size);
+
+    template <typename T>
+    struct Deleter {
+      void operator()(T* object) const {
+        object->~T();
+        Deallocate(object, sizeof(T));
+      }
+    };
+    template <typename T>
+    using Ptr = std::unique_ptr<T, Deleter<T>>;
+
+    template <typename T, typename... Args>
+    static Ptr<T> Make(Args&&... args) {
+      static_assert(alignof(T) <= ALIGNMENT);
+      void* block = Allocate(sizeof(T));
+      try {
+        return Ptr<T>(new (block) T(std::forward<Args>(args)...));
+      } catch (...) {
+        Deallocate(block, sizeof(T));
+        throw;
+      }
+    }
+
+    // Process-wide totals across all threads
+    static Stats GetStats();
+    static void ResetStats();
+  };
+};
+
+inline uint64_t YaUtils::Timer::Ticks() {
+#if defined(YA_UTILS_HAS_TSC)
+  static const bool tsc = UsesTsc();
+  if (tsc) {
+    unsigned int aux;
+    return __rdtscp(&aux);
+  }
+#endif
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+template <typename F>
+class YaUtils::ThreadPool::FunctionTask : public Task {
+ public:
+  explicit FunctionTask(F f) : m_f(std::move(f)) {}
+  void Run() override { m_f(); }
+
+ private:
+  F m_f;
+};
+
+// Shared result of a Future: the value or exception, and what to run once
+// it is there
+template <typename T>
+struct YaUtils::ThreadPool::State {
+  using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+  using Continuation = std::pair<PRIORITY, std::unique_ptr<Task>>;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  std::optional<Value> value;
+  std::exception_ptr error;
+  ThreadPool* pool = nullptr;  // Runs continuations; inline when null
+  std::vector<Continuation> continuations;
+
+  template <typename... Args>
+  void SetValue(Args&&... args) {
+    Complete([&] { value.emplace(std::forward<Args>(args)...); });
+  }
+
+  void SetError(std::exception_ptr e) {
+    Complete([&] { error = std::move(e); });
+  }
+
+  void OnDone(PRIORITY priority, std::unique_ptr<Task> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!done) {
+        continuations.emplace_back(priority, std::move(task));
+        return;
+      }
+    }
+    Dispatch(priority, std::move(task));
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return done; });
+  }
+
+ private:
+  template <typename Set>
+  void Complete(Set set) {
+    std::vector<Continuation> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (done) {
+        return;
+      }
+      set();
+      done = true;
+      ready.swap(continuations);
+    }
+    cv.notify_all();
+    for (auto& [priority, task] : ready) {
+      Dispatch(priority, std::move(task));
+    }
+  }
+
+  void Dispatch(PRIORITY priority, std::unique_ptr<Task> task) {
+    if (pool) {
+      pool->Enqueue(std::move(task), priority);
+    } else {
+      task->Run();
+    }
+  }
+};
+
+// Runs f into state; dropped unrun, it fails the state instead
+template <typename F, typename T>
+class YaUtils::ThreadPool::PromiseTask : public Task {
+ public:
+  PromiseTask(F f, std::shared_ptr<State<T>> state)
+      : m_f(std::move(f)), m_state(std::move(state)) {}
+
+  ~PromiseTask() override {
+    if (m_state) {
+      m_state->SetError(std::make_exception_ptr(
+          std::runtime_error("ThreadPool dropped the task")));
+    }
+  }
+
+  void Run() override {
+    auto state = std::move(m_state);
+    try {
+      if constexpr (std::is_void_v<T>) {
+        m_f();
+        state->SetValue();
+      } else {
+        state->SetValue(m_f());
+      }
+    } catch (...) {
+      state->SetError(std::current_exception());
+    }
+  }
+
+ private:
+  F m_f;
+  std::shared_ptr<State<T>> m_state;
+};
+
+// One-shot result of a task or coroutine, like std::future with Then()
+template <typename T>
+class YaUtils::ThreadPool::Future {
+ public:
+  using promise_type =
+      std::conditional_t<std::is_void_v<T>, VoidPromise, ValuePromise<T>>;
+
+  Future() = default;
+  explicit Future(std::shared_ptr<State<T>> state)
+      : m_state(std::move(state)) {}
+
+  bool Valid() const { return m_state != nullptr; }
+
+  bool Ready() const {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->done;
+  }
+
+  void Wait() const { m_state->Wait(); }
+
+  // Waits, then returns the value or rethrows; the Future is used up
+  T Get() {
+    auto state = std::move(m_state);
+    state->Wait();
+    if (state->error) {
+      std::rethrow_exception(state->error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+      return std::move(*state->value);
+    }
+  }
+
+  // Runs f with the value once it is there, on the pool that produced it
+  // (inline for coroutines); an exception skips f and passes through. The
+  // Future is used up.
+  template <typename F>
+  auto Then(F&& f, PRIORITY priority = PRIORITY::NORMAL)
+      -> Future<ThenResult<std::decay_t<F>, T>> {
+    using R = ThenResult<std::decay_t<F>, T>;
+    auto next = std::make_shared<State<R>>();
+    next->pool = m_state->pool;
+    auto run = [from = m_state, f = std::forward<F>(f)]() mutable -> R {
+      if (from->error) {
+        std::rethrow_exception(from->error);
+      }
+      if constexpr (std::is_void_v<T>) {
+        return f();
+      } else {
+        return f(std::move(*from->value));
+      }
+    };
+    auto state = std::move(m_state);
+    state->OnDone(priority,
+                  std::make_unique<PromiseTask<decltype(run), R>>(
+                      std::move(run), next));
+    return Future<R>(std::move(next));
+  }
+
+  bool await_ready() const { return Ready(); }
+  void await_suspend(std::coroutine_handle<> handle) {
+    auto resume = [handle] { handle.resume(); };
+    m_state->OnDone(PRIORITY::NORMAL,
+                    std::make_unique<FunctionTask<decltype(resume)>>(resume));
+  }
+  T await_resume() { return Get(); }
+
+ private:
+  std::shared_ptr<State<T>> m_state;
+};
+
+// Coroutines returning Future<T> run on the caller until they suspend and
+// fill in the Future as they finish
+template <typename T>
+struct YaUtils::ThreadPool::PromiseBase {
+  std::shared_ptr<State<T>> state = std::make_shared<State<T>>();
+
+  Future<T> get_return_object() { return Future<T>(state); }
+  std::suspend_never initial_suspend() noexcept { return {}; }
+  std::suspend_never final_suspend() noexcept { return {}; }
+  void unhandled_exception() { state->SetError(std::current_exception()); }
+};
+
+template <typename T>
+struct YaUtils::ThreadPool::ValuePromise : PromiseBase<T> {
+  void return_value(T value) { this->state->SetValue(std::move(value)); }
+};
+
+struct YaUtils::ThreadPool::VoidPromise : PromiseBase<void> {
+  void return_void() { state->SetValue(); }
+};
+
+template <typename F>
+bool YaUtils::ThreadPool::Post(F&& f, PRIORITY priority) {
+  using Task = FunctionTask<std::decay_t<F>>;
+  return Enqueue(std::make_unique<Task>(std::forward<F>(f)), priority);
+}
+
+template <typename F>
+auto YaUtils::ThreadPool::Submit(F&& f, PRIORITY priority)
+    -> Future<std::invoke_result_t<std::decay_t<F>>> {
+  using R = std::invoke_result_t<std::decay_t<F>>;
+  auto state = std::make_shared<State<R>>();
+  state->pool = this;
+  Enqueue(std::make_unique<PromiseTask<std::decay_t<F>, R>>(
+              std::forward<F>(f), state),
+          priority);
+  return Future<R>(std::move(state));
+}
+
+template <typename T>
+class YaUtils::SpscRing {
+ public:
+  explicit SpscRing(size_t capacity)
+      : m_mask(std::bit_ceil(std::max<size_t>(capacity, 1)) - 1),
+        m_slots(std::make_unique<Slot[]>(m_mask + 1)) {}
+  ~SpscRing() {
+    for (size_t i = m_head.load(); i != m_tail.load(); ++i) {
+      Item(i)->~T();
+    }
+  }
+
+  size_t Capacity() const { return m_mask + 1; }
+  // Exact on either end, a recent value anywhere else
+  size_t SizeApprox() const {
+    size_t head = m_head.load(std::memory_order_acquire);
+    return m_tail.load(std::memory_order_acquire) - head;
+  }
+
+  // Producer thread only
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_cached_head > m_mask) {
+      m_cached_head = m_head.load(std::memory_order_acquire);
+      if (tail - m_cached_head > m_mask) {
+        return false;
+      }
+    }
+    new (Item(tail)) T(std::forward<Args>(args)...);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+  bool TryPush(const T& value) { return TryEmplace(value); }
+  bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+  // Moves from the first n items
+  size_t TryPushBatch(std::span<T> items) {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (Capacity() - (tail - m_cached_head) < items.size()) {
+      m_cached_head = m_head.load(std::memory_order_acquire);
+    }
+    size_t count = std::min(Capacity() - (tail - m_cached_head), items.size());
+    for (size_t i = 0; i < count; ++i) {
+      new (Item(tail + i)) T(std::move(items[i]));
+    }
+    m_tail.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  // Consumer thread only
+  std::optional<T> TryPop() {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_cached_tail) {
+      m_cached_tail = m_tail.load(std::memory_order_acquire);
+      if (head == m_cached_tail) {
+        return std::nullopt;
+      }
+    }
+    std::optional<T> value(std::move(*Item(head)));
+    Item(head)->~T();
+    m_head.store(head + 1, std::memory_order_release);
+    return value;
+  }
+  // Move-assigns to the first n of out
+  size_t TryPopBatch(std::span<T> out) {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (m_cached_tail - head < out.size()) {
+      m_cached_tail = m_tail.load(std::memory_order_acquire);
+    }
+    size_t count = std::min(m_cached_tail - head, out.size());
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = std::move(*Item(head + i));
+      Item(head + i)->~T();
+    }
+    m_head.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  // Prevent copying
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+ private:
+  struct Slot {
+    alignas(T) unsigned char bytes[sizeof(T)];
+  };
+
+  T* Item(size_t index) {
+    return std::launder(reinterpret_cast<T*>(m_slots[index & m_mask].bytes));
+  }
+
+  // Indexes run freely and are masked on use. Each end keeps its last view
+  // of the other and only reloads it when that view says full or empty.
+  alignas(CACHE_LINE) std::atomic<size_t> m_head{0};  // Next to pop
+  size_t m_cached_tail = 0;
+  alignas(CACHE_LINE) std::atomic<size_t> m_tail{0};  // Next to push
+  size_t m_cached_head = 0;
+  alignas(CACHE_LINE) const size_t m_mask;
+  std::unique_ptr<Slot[]> m_slots;
+};
+
+// Vyukov's intrusive queue: a push is one exchange and never waits. T
+// derives from MpscNode; the queue does not own the items, and an item
+// must not be pushed again before it is popped.
+template <typename T>
+class YaUtils::MpscQueue {
+  static_assert(std::is_base_of_v<MpscNode, T>);
+
+ public:
+  MpscQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+  // Any thread
+  void Push(T* item) { PushChain(item, item); }
+  // Publishes all items with one exchange, in order
+  void PushBatch(std::span<T* const> items) {
+    if (items.empty()) {
+      return;
+    }
+    for (size_t i = 0; i + 1 < items.size(); ++i) {
+      items[i]->next.store(items[i + 1], std::memory_order_relaxed);
+    }
+    PushChain(items.front(), items.back());
+  }
+
+  // Consumer thread only. nullptr when empty, and also for the moment a
+  // producer is halfway through a push; the item shows up on a later call.
+  T* Pop() {
+    MpscNode* tail = m_tail;
+    MpscNode* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &m_stub) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      m_tail = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next == nullptr) {
+      if (tail != m_head.load(std::memory_order_acquire)) {
+        return nullptr;
+      }
+      // The last item: put the stub behind it so it can be unlinked
+      PushChain(&m_stub, &m_stub);
+      next = tail->next.load(std::memory_order_acquire);
+      if (next == nullptr) {
+        return nullptr;
+      }
+    }
+    m_tail = next;
+    return static_cast<T*>(tail);
+  }
+  size_t PopBatch(std::span<T*> out) {
+    size_t count = 0;
+    while (count < out.size() && (out[count] = Pop()) != nullptr) {
+      ++count;
+    }
+    return count;
+  }
+  bool EmptyApprox() const {
+    return m_head.load(std::memory_order_acquire) == &m_stub;
+  }
+
+  // Prevent copying
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+ private:
+  void PushChain(MpscNode* first, MpscNode* last) {
+    last->next.store(nullptr, std::memory_order_relaxed);
+    MpscNode* prev = m_head.exchange(last, std::memory_order_acq_rel);
+    prev->next.store(first, std::memory_order_release);
+  }
+
+  alignas(CACHE_LINE) std::atomic<MpscNode*> m_head;  // Pushed last
+  alignas(CACHE_LINE) MpscNode* m_tail;               // Popped next
+  MpscNode m_stub;
+};
+
+// Vyukov's bounded queue: every cell carries a sequence number saying
+// which lap of the ring may fill or empty it next, so producers and
+// consumers only contend on their own position counter.
+template <typename T>
+class YaUtils::MpmcQueue {
+ public:
+  explicit MpmcQueue(size_t capacity)
+      : m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+        m_cells(std::make_unique<Cell[]>(m_mask + 1)) {
+    for (size_t i = 0; i <= m_mask; ++i) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  ~MpmcQueue() {
+    for (size_t i = m_dequeue.load(); i != m_enqueue.load(); ++i) {
+      Item(i)->~T();
+    }
+  }
+
+  size_t Capacity() const { return m_mask + 1; }
+  size_t SizeApprox() const {
+    size_t dequeue = m_dequeue.load(std::memory_order_acquire);
+    size_t enqueue = m_enqueue.load(std::memory_order_acquire);
+    return enqueue > dequeue ? enqueue - dequeue : 0;
+  }
+
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    size_t position;
+    if (Claim(m_enqueue, 1, 0, position) == 0) {
+      return false;
+    }
+    new (Item(position)) T(std::forward<Args>(args)...);
+    Publish(position, position + 1);
+    return true;
+  }
+  bool TryPush(const T& value) { return TryEmplace(value); }
+  bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+  // Moves from the first n items
+  size_t TryPushBatch(std::span<T> items) {
+    size_t position;
+    size_t count = Claim(m_enqueue, items.size(), 0, position);
+    for (size_t i = 0; i < count; ++i) {
+      new (Item(position + i)) T(std::move(items[i]));
+      Publish(position + i, position + i + 1);
+    }
+    return count;
+  }
+
+  std::optional<T> TryPop() {
+    size_t position;
+    if (Claim(m_dequeue, 1, 1, position) == 0) {
+      return std::nullopt;
+    }
+    std::optional<T> value(std::move(*Item(position)));
+    Item(position)->~T();
+    Publish(position, position + Capacity());
+    return value;
+  }
+  // Move-assigns to the first n of out
+  size_t TryPopBatch(std::span<T> out) {
+    size_t position;
+    size_t count = Claim(m_dequeue, out.size(), 1, position);
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = std::move(*Item(position + i));
+      Item(position + i)->~T();
+      Publish(position + i, position + i + Capacity());
+    }
+    return count;
+  }
+
+  // Prevent copying
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    alignas(T) unsigned char bytes[sizeof(T)];
+  };
+
+  T* Item(size_t position) {
+    return std::launder(
+        reinterpret_cast<T*>(m_cells[position & m_mask].bytes));
+  }
+  void Publish(size_t position, size_t sequence) {
+    m_cells[position & m_mask].sequence.store(sequence,
+                                              std::memory_order_release);
+  }
+
+  // Takes up to n cells in a row from counter, those whose sequence reads
+  // their position + lag (0 to fill, 1 to empty), with one CAS. Cells that
+  // read right stay so until counter passes them, which only we can do.
+  size_t Claim(std::atomic<size_t>& counter, size_t n, size_t lag,
+               size_t& position) {
+    if (n == 0) {
+      return 0;
+    }
+    position = counter.load(std::memory_order_relaxed);
+    while (true) {
+      size_t sequence = m_cells[position & m_mask].sequence.load(
+          std::memory_order_acquire);
+      auto behind = static_cast<std::ptrdiff_t>(sequence - (position + lag));
+      if (behind < 0) {
+        return 0;  // Full, or empty
+      }
+      if (behind > 0) {
+        position = counter.load(std::memory_order_relaxed);
+        continue;
+      }
+      size_t count = 1;
+      while (count < n &&
+             m_cells[(position + count) & m_mask].sequence.load(
+                 std::memory_order_acquire) == position + count + lag) {
+        ++count;
+      }
+      if (counter.compare_exchange_weak(position, position + count,
+                                        std::memory_order_relaxed)) {
+        return count;
+      }
+    }
+  }
+
+  alignas(CACHE_LINE) std::atomic<size_t> m_enqueue{0};
+  alignas(CACHE_LINE) std::atomic<size_t> m_dequeue{0};
+  alignas(CACHE_LINE) const size_t m_mask;
+  std::unique_ptr<Cell[]> m_cells;
 };
 
 }  // namespace ya
 
+// Scoped latency zones, compiled away unless built with YA_UTILS_PROFILE
+// (ENABLE_YA_UTILS_PROFILE). name must be a string literal or otherwise
+// fixed per call site, as the probe is looked up only once.
+#define YA_PROFILE_CONCAT_(a, b) a##b
+#define YA_PROFILE_CONCAT(a, b) YA_PROFILE_CONCAT_(a, b)
+
+#if defined(YA_UTILS_PROFILE)
+#define YA_PROFILE_SCOPE(name)                                            \
+  static ::ya::YaUtils::Profiler::Probe& YA_PROFILE_CONCAT(               \
+      ya_profile_probe_, __LINE__) =                                      \
+      ::ya::YaUtils::Profiler::Instance().GetProbe(name);                 \
+  ::ya::YaUtils::Profiler::Zone YA_PROFILE_CONCAT(ya_profile_zone_,       \
+                                                  __LINE__)(              \
+      YA_PROFILE_CONCAT(ya_profile_probe_, __LINE__))
+#else
+#define YA_PROFILE_SCOPE(name) static_cast<void>(0)
+#endif
+
 #endif  // !YA_UTILS_H
@@ -0,0 +1,127 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ya_communicate/module/compressor.h"
+#include "ya_communicate/module/stats.h"
+#include "ya_communicate/module/tls.h"
+
+namespace ya::bench {
+
+struct Config {
+  std::vector<std::string> patterns = {"reqrep", "reconnect", "rpc",
+                                       "pubsub",  "pipeline",  "bus",
+                                       "survey"};
+  std::vector<std::string> transports = {"inproc", "ipc", "tcp"};
+  std::vector<size_t> sizes = {16, 256, 4096, 65536, 1048576};
+  int subscribers = 4;  // pub/sub fan-out
+  int voters = 2;       // survey respondents
+  int connections = 4;  // concurrent keep-alive HTTP clients
+  int duration_ms = 1000;
+  bool pool = true;
+  module::Compressor::ALGO compression = module::Compressor::ALGO::NONE;
+  double bandwidth_mbps = 0;  // Emulated link limit in MB/s, 0 = unlimited
+  std::string output;         // JSON file, stdout when empty
+  module::TlsOptions tls;     // Certificate for the "tls" transport
+  bool tls_cache = true;      // Share parsed TLS contexts between sockets
+  std::string affinity = "off";  // off, auto (topology) or manual
+  std::string io_cpus;           // CPU lists for manual affinity
+  std::string app_cpus;
+};
+
+// One benchmark case: a pattern over a transport at a message size
+struct Case {
+  std::string pattern;
+  std::string transport;
+  size_t size;
+  const Config* config;
+};
+
+struct Result {
+  std::string pattern;
+  std::string transport;
+  size_t size = 0;
+  int fanout = 1;
+  uint64_t sent = 0;
+  uint64_t received = 0;
+  double seconds = 0;
+
+  // One-way (or round trip for req/rep and survey) latency in ns
+  uint64_t p50 = 0;
+  uint64_t p99 = 0;
+  uint64_t p999 = 0;
+  uint64_t max = 0;
+
+  // Optional extras, reported when non-zero
+  double compression_ratio = 0;
+  double encode_ns_per_msg = 0;
+  uint64_t pool_hits = 0;
+  uint64_t pool_misses = 0;
+};
+
+inline uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Payload layout: [kind:1][send time ns:8][filler]
+constexpr char KIND_DATA = 'D';
+constexpr char KIND_STOP = 'S';
+constexpr size_t MIN_PAYLOAD = 1 + sizeof(uint64_t);
+
+inline std::string make_payload(size_t size) {
+  std::string payload(std::max(size, MIN_PAYLOAD), 'x');
+  payload[0] = KIND_DATA;
+  return payload;
+}
+
+inline void stamp(std::string& payload) {
+  uint64_t ns = now_ns();
+  std::memcpy(payload.data() + 1, &ns, sizeof(ns));
+}
+
+inline uint64_t stamp_of(const std::string& payload) {
+  uint64_t ns = 0;
+  if (payload.size() >= MIN_PAYLOAD) {
+    std::memcpy(&ns, payload.data() + 1, sizeof(ns));
+  }
+  return ns;
+}
+
+inline bool is_stop(const std::string& payload) {
+  return !payload.empty() && payload[0] == KIND_STOP;
+}
+
+inline std::string stop_payload() { return std::string(MIN_PAYLOAD, KIND_STOP); }
+
+inline void summarize(const YaUtils::Histogram& latency, Result& result) {
+  result.p50 = latency.Percentile(50);
+  result.p99 = latency.Percentile(99);
+  result.p999 = latency.Percentile(99.9);
+  result.max = latency.Max();
+}
+
+// Unique address for the transport, e.g. tcp://127.0.0.1:26001 or
+// tls+tcp://127.0.0.1:26002 for "tls"
+std::string make_address(const std::string& transport,
+                         const std::string& name);
+
+Result run_reqrep(const Case& c);
+Result run_reconnect(const Case& c);  // New connection per request
+Result run_rpc(const Case& c);
+Result run_pubsub(const Case& c);
+Result run_pipeline(const Case& c);
+Result run_bus(const Case& c);
+Result run_survey(const Case& c);
+Result run_http(const Case& c);  // tcp only
+
+}  // namespace ya::bench
+
+#endif
@@ -0,0 +1,116 @@
+#include <nng/nng.h>
+#include <nng/supplemental/http/http.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "bench_harness.h"
+#include "ya_communicate/module/http.h"
+
+namespace ya::bench {
+
+using namespace ya::module;
+
+namespace {
+
+// One keep-alive client connection issuing requests back to back
+void http_client(nng_url* url, std::chrono::steady_clock::time_point deadline,
+                 YaUtils::Histogram& latency, std::atomic<uint64_t>& completed,
+                 std::atomic<uint64_t>& failed) {
+  nng_http_client* client = nullptr;
+  nng_aio* aio = nullptr;
+  nng_http_conn* conn = nullptr;
+  if (nng_http_client_alloc(&client, url) != 0 ||
+      nng_aio_alloc(&aio, nullptr, nullptr) != 0) {
+    ++failed;
+    if (client != nullptr) nng_http_client_free(client);
+    return;
+  }
+  nng_http_client_connect(client, aio);
+  nng_aio_wait(aio);
+  if (nng_aio_result(aio) == 0) {
+    conn = static_cast<nng_http_conn*>(nng_aio_get_output(aio, 0));
+  }
+
+  while (conn != nullptr && std::chrono::steady_clock::now() < deadline) {
+    nng_http_req* req = nullptr;
+    nng_http_res* res = nullptr;
+    if (nng_http_req_alloc(&req, url) != 0 ||
+        nng_http_res_alloc(&res) != 0) {
+      if (req != nullptr) nng_http_req_free(req);
+      ++failed;
+      break;
+    }
+    uint64_t start = now_ns();
+    nng_http_conn_transact(conn, req, res, aio);
+    nng_aio_wait(aio);
+    bool ok = nng_aio_result(aio) == 0 &&
+              nng_http_res_get_status(res) == NNG_HTTP_STATUS_OK;
+    latency.Record(now_ns() - start);
+    nng_http_req_free(req);
+    nng_http_res_free(res);
+    if (!ok) {
+      ++failed;
+      break;
+    }
+    completed.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  if (conn != nullptr) nng_http_conn_close(conn);
+  nng_aio_free(aio);
+  nng_http_client_free(client);
+}
+
+}  // namespace
+
+// Requests/s against a module::Http route serving a size-byte body
+Result run_http(const Case& c) {
+  Result result;
+  YaUtils::Histogram latency;
+  result.fanout = c.config->connections;
+
+  // make_address hands out a fresh tcp port, reuse it for http
+  std::string tcp = make_address("tcp", "http");
+  int port = std::stoi(tcp.substr(tcp.rfind(':') + 1));
+  std::string body(c.size, 'x');
+
+  Http http;
+  http.route("GET", "/bench/:id", [&body](const HttpRequest&,
+                                          HttpResponse& res) {
+    res.content_type = "application/octet-stream";
+    res.set_body_ref(body);
+  });
+  http.start(port);
+
+  std::string target = "http://127.0.0.1:" + std::to_string(port) + "/bench/1";
+  nng_url* url = nullptr;
+  if (nng_url_parse(&url, target.c_str()) != 0) {
+    throw std::runtime_error("Failed to parse " + target);
+  }
+
+  std::atomic<uint64_t> completed = 0;
+  std::atomic<uint64_t> failed = 0;
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(c.config->duration_ms);
+  uint64_t start = now_ns();
+  std::vector<std::thread> clients;
+  for (int i = 0; i < result.fanout; ++i) {
+    clients.emplace_back(http_client, url, deadline, std::ref(latency),
+                         std::ref(completed), std::ref(failed));
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  result.seconds = (now_ns() - start) / 1e9;
+  nng_url_free(url);
+  http.stop();
+
+  result.received = completed;
+  result.sent = completed + failed;
+  summarize(latency, result);
+  return result;
+}
+
+}  // namespace ya::bench
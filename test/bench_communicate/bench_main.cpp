@@ -0,0 +1,324 @@
+// Throughput/latency benchmark for the communicate modules.
+//
+//   bench_communicate --pattern=pipeline,pubsub --transport=inproc,tcp
+//                     --sizes=16,4096,1048576 --duration-ms=2000
+//                     --pool=off --compression=lz4 --bandwidth-mbps=100
+//                     --output=result.json
+//   bench_communicate --pattern=reconnect --transport=tcp,tls
+//                     --tls-cert=cert.pem --tls-key=key.pem --tls-cache=off
+//   bench_communicate --pattern=reqrep --affinity=auto
+//
+// Every case is run for a fixed wall-clock duration and reported as one JSON
+// object, so runs can be diffed across commits.
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "bench_harness.h"
+#include "ya_communicate/module/msgpool.h"
+#include "ya_communicate/module/runtime.h"
+
+namespace ya::bench {
+
+std::string make_address(const std::string& transport,
+                         const std::string& name) {
+  static std::atomic<int> sequence = 0;
+  int id = sequence++;
+  if (transport == "inproc") {
+    return "inproc://bench-" + name + "-" + std::to_string(id);
+  }
+  if (transport == "ipc") {
+    return "ipc:///tmp/ya-bench-" + std::to_string(getpid()) + "-" + name +
+           "-" + std::to_string(id);
+  }
+  if (transport == "tcp") {
+    return "tcp://127.0.0.1:" + std::to_string(26000 + id);
+  }
+  if (transport == "tls") {
+    return "tls+tcp://127.0.0.1:" + std::to_string(26000 + id);
+  }
+  throw std::invalid_argument("Unknown transport: " + transport);
+}
+
+}  // namespace ya::bench
+
+namespace {
+
+using namespace ya::bench;
+using ya::module::Compressor;
+using ya::module::MessagePool;
+using ya::module::Runtime;
+
+std::vector<std::string> split(const std::string& value) {
+  std::vector<std::string> items;
+  std::stringstream stream(value);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+// Accepts plain bytes or a K/M suffix, e.g. 64K
+size_t parse_size(const std::string& value) {
+  size_t pos = 0;
+  size_t size = std::stoull(value, &pos);
+  if (pos < value.size()) {
+    switch (value[pos]) {
+      case 'k':
+      case 'K':
+        size <<= 10;
+        break;
+      case 'm':
+      case 'M':
+        size <<= 20;
+        break;
+      default:
+        throw std::invalid_argument("Bad size: " + value);
+    }
+  }
+  return size;
+}
+
+Compressor::ALGO parse_algo(const std::string& value) {
+  if (value == "none") return Compressor::ALGO::NONE;
+  if (value == "lz4") return Compressor::ALGO::LZ4;
+  if (value == "zstd") return Compressor::ALGO::ZSTD;
+  throw std::invalid_argument("Unknown compression: " + value);
+}
+
+const char* algo_name(Compressor::ALGO algo) {
+  switch (algo) {
+    case Compressor::ALGO::LZ4:
+      return "lz4";
+    case Compressor::ALGO::ZSTD:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+void usage() {
+  std::cerr
+      << "Usage: bench_communicate [options]\n"
+         "  --pattern=LIST        reqrep,reconnect,rpc,pubsub,pipeline,bus,"
+         "survey,http\n"
+         "  --transport=LIST      inproc,ipc,tcp,tls\n"
+         "  --sizes=LIST          message sizes, e.g. 16,4K,1M\n"
+         "  --subscribers=N       pub/sub fan-out (default 4)\n"
+         "  --voters=N            survey respondents (default 2)\n"
+         "  --connections=N       keep-alive HTTP clients (default 4)\n"
+         "  --duration-ms=N       time per case (default 1000)\n"
+         "  --pool=on|off         thread-local message pool (default on)\n"
+         "  --compression=ALGO    none|lz4|zstd for pipeline and pub/sub\n"
+         "  --bandwidth-mbps=N    pace senders to N MB/s of wire bytes\n"
+         "  --tls-cert=FILE       PEM certificate for the tls transport\n"
+         "  --tls-key=FILE        PEM private key for the tls transport\n"
+         "  --tls-ca=FILE         CA clients verify against (default: cert)\n"
+         "  --tls-cache=on|off    share parsed TLS contexts (default on)\n"
+         "  --affinity=MODE       off|auto: pin nng and benchmark threads\n"
+         "  --io-cpus=LIST        CPUs for nng threads, e.g. 60-63\n"
+         "  --app-cpus=LIST       CPUs for benchmark threads, e.g. 0-59\n"
+         "  --output=FILE         write JSON to FILE instead of stdout\n";
+}
+
+Config parse_args(int argc, char** argv) {
+  Config config;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      usage();
+      std::exit(0);
+    }
+    auto eq = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+      throw std::invalid_argument("Bad argument: " + arg);
+    }
+    std::string key = arg.substr(2, eq - 2);
+    std::string value = arg.substr(eq + 1);
+    if (key == "pattern") {
+      config.patterns = split(value);
+    } else if (key == "transport") {
+      config.transports = split(value);
+    } else if (key == "sizes") {
+      config.sizes.clear();
+      for (const auto& size : split(value)) {
+        config.sizes.push_back(parse_size(size));
+      }
+    } else if (key == "subscribers") {
+      config.subscribers = std::stoi(value);
+    } else if (key == "voters") {
+      config.voters = std::stoi(value);
+    } else if (key == "connections") {
+      config.connections = std::stoi(value);
+    } else if (key == "duration-ms") {
+      config.duration_ms = std::stoi(value);
+    } else if (key == "pool") {
+      config.pool = value != "off";
+    } else if (key == "compression") {
+      config.compression = parse_algo(value);
+    } else if (key == "bandwidth-mbps") {
+      config.bandwidth_mbps = std::stod(value);
+    } else if (key == "tls-cert") {
+      config.tls.cert_file = value;
+    } else if (key == "tls-key") {
+      config.tls.key_file = value;
+    } else if (key == "tls-ca") {
+      config.tls.ca_file = value;
+    } else if (key == "tls-cache") {
+      config.tls_cache = value != "off";
+    } else if (key == "affinity") {
+      config.affinity = value;
+    } else if (key == "io-cpus") {
+      config.io_cpus = value;
+      config.affinity = "manual";
+    } else if (key == "app-cpus") {
+      config.app_cpus = value;
+      config.affinity = "manual";
+    } else if (key == "output") {
+      config.output = value;
+    } else {
+      throw std::invalid_argument("Unknown option: --" + key);
+    }
+  }
+  if (config.tls.ca_file.empty()) {
+    config.tls.ca_file = config.tls.cert_file;  // Self-signed bench cert
+  }
+  return config;
+}
+
+Result run_case(const Case& c) {
+  if (c.pattern == "reqrep") return run_reqrep(c);
+  if (c.pattern == "reconnect") return run_reconnect(c);
+  if (c.pattern == "rpc") return run_rpc(c);
+  if (c.pattern == "pubsub") return run_pubsub(c);
+  if (c.pattern == "pipeline") return run_pipeline(c);
+  if (c.pattern == "bus") return run_bus(c);
+  if (c.pattern == "survey") return run_survey(c);
+  if (c.pattern == "http") return run_http(c);
+  throw std::invalid_argument("Unknown pattern: " + c.pattern);
+}
+
+void write_result(std::ostream& out, const Result& r) {
+  double seconds = r.seconds > 0 ? r.seconds : 1;
+  double msgs_per_sec = r.received / seconds;
+  char buffer[1024];
+  std::snprintf(
+      buffer, sizeof(buffer),
+      "    {\"pattern\": \"%s\", \"transport\": \"%s\", \"size\": %zu, "
+      "\"fanout\": %d, \"sent\": %llu, \"received\": %llu, "
+      "\"seconds\": %.3f, \"msgs_per_sec\": %.1f, \"mb_per_sec\": %.3f, "
+      "\"latency_us\": {\"p50\": %.2f, \"p99\": %.2f, \"p999\": %.2f, "
+      "\"max\": %.2f}, "
+      "\"pool\": {\"hits\": %llu, \"misses\": %llu}, "
+      "\"compression\": {\"ratio\": %.3f, \"encode_ns_per_msg\": %.1f}}",
+      r.pattern.c_str(), r.transport.c_str(), r.size, r.fanout,
+      static_cast<unsigned long long>(r.sent),
+      static_cast<unsigned long long>(r.received), r.seconds, msgs_per_sec,
+      msgs_per_sec * r.size / 1e6, r.p50 / 1e3, r.p99 / 1e3, r.p999 / 1e3,
+      r.max / 1e3, static_cast<unsigned long long>(r.pool_hits),
+      static_cast<unsigned long long>(r.pool_misses), r.compression_ratio,
+      r.encode_ns_per_msg);
+  out << buffer;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Config config;
+  try {
+    config = parse_args(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    usage();
+    return 1;
+  }
+  MessagePool::set_enabled(config.pool);
+
+  // Before any socket exists, nng reads its thread counts only once
+  if (config.affinity != "off") {
+    try {
+      auto options = Runtime::recommended();
+      if (config.affinity == "manual") {
+        options.io_cpus = Runtime::parse_cpu_list(config.io_cpus);
+        options.app_cpus = Runtime::parse_cpu_list(config.app_cpus);
+        options.task_threads = static_cast<int>(options.io_cpus.size());
+      }
+      Runtime::instance().configure(options);
+      // Benchmark threads are started from here and inherit the mask
+      Runtime::instance().pin_current_thread();
+      std::cerr << "io cpus: " << Runtime::format_cpu_list(options.io_cpus)
+                << ", app cpus: " << Runtime::format_cpu_list(options.app_cpus)
+                << "\n";
+    } catch (const std::exception& e) {
+      std::cerr << "Bad affinity: " << e.what() << "\n";
+      return 1;
+    }
+  }
+
+  std::vector<Result> results;
+  for (const auto& pattern : config.patterns) {
+    for (const auto& transport : config.transports) {
+      if (pattern == "http" && transport != "tcp") {
+        continue;  // HTTP only runs over tcp
+      }
+      if (transport == "tls" && !config.tls.has_cert()) {
+        std::cerr << "Skipping " << pattern
+                  << "/tls, needs --tls-cert and --tls-key\n";
+        continue;
+      }
+      for (size_t size : config.sizes) {
+        Case c{pattern, transport, size, &config};
+        std::cerr << pattern << "/" << transport << "/" << size << "... ";
+        MessagePool::reset_stats();
+        try {
+          Result result = run_case(c);
+          result.pattern = pattern;
+          result.transport = transport;
+          result.size = size;
+          // Misses are the message allocations the pool could not avoid,
+          // with the pool off every message is an allocation
+          auto pool = MessagePool::stats();
+          result.pool_hits = pool.hits;
+          result.pool_misses = pool.misses;
+          std::cerr << static_cast<uint64_t>(result.received / result.seconds)
+                    << " msg/s\n";
+          results.push_back(std::move(result));
+        } catch (const std::exception& e) {
+          std::cerr << "failed: " << e.what() << "\n";
+        }
+      }
+    }
+  }
+
+  std::ofstream file;
+  if (!config.output.empty()) {
+    file.open(config.output);
+    if (!file) {
+      std::cerr << "Cannot open " << config.output << "\n";
+      return 1;
+    }
+  }
+  std::ostream& out = config.output.empty() ? std::cout : file;
+  out << "{\n  \"config\": {\"duration_ms\": " << config.duration_ms
+      << ", \"pool\": " << (config.pool ? "true" : "false")
+      << ", \"compression\": \"" << algo_name(config.compression)
+      << "\", \"bandwidth_mbps\": " << config.bandwidth_mbps
+      << ", \"tls_cache\": " << (config.tls_cache ? "true" : "false")
+      << ", \"affinity\": \"" << config.affinity << "\"},\n"
+      << "  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    write_result(out, results[i]);
+    out << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+  return results.empty() ? 1 : 0;
+}
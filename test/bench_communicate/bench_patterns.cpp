@@ -0,0 +1,404 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "bench_harness.h"
+#include "ya_communicate/module/bus.h"
+#include "ya_communicate/module/pipeline.h"
+#include "ya_communicate/module/publisher.h"
+#include "ya_communicate/module/requester.h"
+#include "ya_communicate/module/responder.h"
+#include "ya_communicate/module/rpc.h"
+#include "ya_communicate/module/subscriber.h"
+#include "ya_communicate/module/survey.h"
+
+namespace ya::bench {
+
+using namespace ya::module;
+
+namespace {
+
+// Dialers connect asynchronously, give them time to attach before sending
+constexpr auto SETTLE_TIME = std::chrono::milliseconds(100);
+constexpr auto STOP_INTERVAL = std::chrono::milliseconds(10);
+
+std::chrono::steady_clock::time_point deadline_of(const Case& c) {
+  return std::chrono::steady_clock::now() +
+         std::chrono::milliseconds(c.config->duration_ms);
+}
+
+void record_latency(YaUtils::Histogram& latency, const std::string& payload) {
+  uint64_t sent_at = stamp_of(payload);
+  uint64_t now = now_ns();
+  if (sent_at != 0 && now >= sent_at) {
+    latency.Record(now - sent_at);
+  }
+}
+
+// Token bucket on wire bytes, emulating a link of bandwidth_mbps MB/s
+class Pacer {
+ public:
+  explicit Pacer(double mbps) : bytes_per_ns_(mbps * 1e6 / 1e9) {}
+
+  void consume(uint64_t total_wire_bytes) {
+    if (bytes_per_ns_ <= 0) {
+      return;
+    }
+    uint64_t due =
+        start_ + static_cast<uint64_t>(total_wire_bytes / bytes_per_ns_);
+    uint64_t now = now_ns();
+    if (due > now) {
+      std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+    }
+  }
+
+ private:
+  double bytes_per_ns_;
+  uint64_t start_ = now_ns();
+};
+
+// Bytes that actually went out: compressed size when compression is on
+uint64_t wire_bytes(const Compressor::Stats& stats, uint64_t raw_total) {
+  return stats.encoded != 0 ? stats.wire_bytes : raw_total;
+}
+
+void collect_compression(const Compressor::Stats& stats, Result& result) {
+  if (stats.encoded == 0) {
+    return;
+  }
+  result.compression_ratio = stats.ratio();
+  result.encode_ns_per_msg =
+      static_cast<double>(stats.encode_ns) / static_cast<double>(stats.encoded);
+}
+
+}  // namespace
+
+Result run_reqrep(const Case& c) {
+  Result result;
+  YaUtils::Histogram latency;
+  std::string address = make_address(c.transport, "reqrep");
+  Reponder server(address, c.config->tls);
+  std::thread server_thread([&server]() {
+    while (true) {
+      std::string request = server.receive();
+      server.send(request);
+      if (is_stop(request)) {
+        break;
+      }
+    }
+  });
+
+  Requester client(address, c.config->tls);
+  std::string payload = make_payload(c.size);
+  auto deadline = deadline_of(c);
+  uint64_t start = now_ns();
+  while (std::chrono::steady_clock::now() < deadline) {
+    stamp(payload);
+    record_latency(latency, client.request(payload));
+    ++result.sent;
+  }
+  result.seconds = (now_ns() - start) / 1e9;
+  result.received = result.sent;
+  client.request(stop_payload());
+  server_thread.join();
+  summarize(latency, result);
+  return result;
+}
+
+// Like reqrep, but every request dials a fresh connection, so latency is
+// dominated by connection setup (and the TLS handshake over tls+tcp)
+Result run_reconnect(const Case& c) {
+  Result result;
+  YaUtils::Histogram latency;
+  std::string address = make_address(c.transport, "reconnect");
+  Reponder server(address, c.config->tls);
+  std::thread server_thread([&server]() {
+    while (true) {
+      std::string request = server.receive();
+      server.send(request);
+      if (is_stop(request)) {
+        break;
+      }
+    }
+  });
+
+  std::string payload = make_payload(c.size);
+  auto deadline = deadline_of(c);
+  uint64_t start = now_ns();
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (!c.config->tls_cache) {
+      TlsCache::instance().clear();  // Pay for PEM parsing every time
+    }
+    stamp(payload);
+    Requester client(address, c.config->tls);
+    record_latency(latency, client.request(payload));
+    ++result.sent;
+  }
+  result.seconds = (now_ns() - start) / 1e9;
+  result.received = result.sent;
+  Requester(address, c.config->tls).request(stop_payload());
+  server_thread.join();
+  summarize(latency, result);
+  return result;
+}
+
+namespace {
+
+struct Echo {
+  struct Message {
+    std::string payload;
+    YA_RPC_FIELDS(payload)
+  };
+  static constexpr uint32_t ID = 1;
+  using Request = Message;
+  using Response = Message;
+};
+
+}  // namespace
+
+// Same round trip as reqrep, through the typed RPC layer
+Result run_rpc(const Case& c) {
+  Result result;
+  YaUtils::Histogram latency;
+  std::string address = make_address(c.transport, "rpc");
+  RpcServer server(address, c.config->tls);
+  server.add<Echo>([](const Echo::Message& request) { return request; });
+  server.start();
+
+  RpcClient client(address, c.config->tls);
+  Echo::Message message{make_payload(c.size)};
+  auto deadline = deadline_of(c);
+  uint64_t start = now_ns();
+  while (std::chrono::steady_clock::now() < deadline) {
+    stamp(message.payload);
+    record_latency(latency, client.call<Echo>(message).payload);
+    ++result.sent;
+  }
+  result.seconds = (now_ns() - start) / 1e9;
+  result.received = result.sent;
+  summarize(latency, result);
+  return result;
+}
+
+Result run_pubsub(const Case& c) {
+  Result result;
+  YaUtils::Histogram latency;
+  result.fanout = c.config->subscribers;
+  std::string address = make_address(c.transport, "pubsub");
+  Publisher publisher(address, c.config->tls);
+
+  Compressor::Options options;
+  options.algo = c.config->compression;
+  bool compress = options.algo != Compressor::ALGO::NONE;
+  if (compress) {
+    publisher.set_compression(options);
+  }
+  std::vector<std::unique_ptr<Subscriber>> subscribers;
+  for (int i = 0; i < result.fanout; ++i) {
+    auto subscriber = std::make_unique<Subscriber>(address, c.config->tls);
+    subscriber->subscribe("");
+    if (compress) {
+      subscriber->set_compression(options);
+    }
+    subscribers.push_back(std::move(subscriber));
+  }
+  std::this_thread::sleep_for(SETTLE_TIME);
+
+  std::atomic<uint64_t> received = 0;
+  std::atomic<int> finished = 0;
+  std::vector<std::thread> threads;
+  for (auto& subscriber : subscribers) {
+    threads.emplace_back([&, s = subscriber.get()]() {
+      try {
+        while (true) {
+          std::string message = s->receive();
+          if (is_stop(message)) {
+            break;
+          }
+          record_latency(latency, message);
+          received.fetch_add(1, std::memory_order_relaxed);
+        }
+      } catch (const std::exception&) {
+        // Receive gave up, nothing more is coming
+      }
+      ++finished;
+    });
+  }
+
+  std::string payload = make_payload(c.size);
+  Pacer pacer(c.config->bandwidth_mbps);
+  auto deadline = deadline_of(c);
+  uint64_t start = now_ns();
+  while (std::chrono::steady_clock::now() < deadline) {
+    stamp(payload);
+    publisher.publish("", payload);
+    ++result.sent;
+    pacer.consume(wire_bytes(publisher.compression_stats(),
+                             result.sent * payload.size()));
+  }
+  // Pub/sub is best effort, keep announcing the end until everyone heard it
+  while (finished < result.fanout) {
+    publisher.publish("", stop_payload());
+    std::this_thread::sleep_for(STOP_INTERVAL);
+  }
+  result.seconds = (now_ns() - start) / 1e9;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  result.received = received;
+  collect_compression(publisher.compression_stats(), result);
+  summarize(latency, result);
+  return result;
+}
+
+Result run_pipeline(const Case& c) {
+  Result result;
+  YaUtils::Histogram latency;
+  std::string address = make_address(c.transport, "pipeline");
+  Pipeline puller(Pipeline::ROLE::PULLER, address, c.config->tls);
+  Pipeline pusher(Pipeline::ROLE::PUSHER, address, c.config->tls);
+  if (c.config->compression != Compressor::ALGO::NONE) {
+    Compressor::Options options;
+    options.algo = c.config->compression;
+    pusher.set_compression(options);
+    puller.set_compression(options);
+  }
+
+  std::thread receiver([&]() {
+    while (true) {
+      std::string message = puller.receive();
+      if (is_stop(message)) {
+        break;
+      }
+      record_latency(latency, message);
+      ++result.received;
+    }
+  });
+
+  std::string payload = make_payload(c.size);
+  Pacer pacer(c.config->bandwidth_mbps);
+  auto deadline = deadline_of(c);
+  uint64_t start = now_ns();
+  while (std::chrono::steady_clock::now() < deadline) {
+    stamp(payload);
+    pusher.send(payload);
+    ++result.sent;
+    pacer.consume(
+        wire_bytes(pusher.compression_stats(), result.sent * payload.size()));
+  }
+  // Push/pull is reliable, one marker behind the data is enough
+  pusher.send(stop_payload());
+  receiver.join();
+  result.seconds = (now_ns() - start) / 1e9;
+
+  collect_compression(pusher.compression_stats(), result);
+  summarize(latency, result);
+  return result;
+}
+
+Result run_bus(const Case& c) {
+  Result result;
+  YaUtils::Histogram latency;
+  std::string address = make_address(c.transport, "bus");
+  Bus sender(address, c.config->tls);
+  Bus receiver(make_address(c.transport, "bus"), c.config->tls);
+  receiver.connect(address);
+  std::this_thread::sleep_for(SETTLE_TIME);
+
+  std::atomic<bool> finished = false;
+  std::thread thread([&]() {
+    try {
+      while (true) {
+        std::string message = receiver.receive();
+        if (is_stop(message)) {
+          break;
+        }
+        record_latency(latency, message);
+        ++result.received;
+      }
+    } catch (const std::exception&) {
+      // Receive gave up, nothing more is coming
+    }
+    finished = true;
+  });
+
+  std::string payload = make_payload(c.size);
+  auto deadline = deadline_of(c);
+  uint64_t start = now_ns();
+  while (std::chrono::steady_clock::now() < deadline) {
+    stamp(payload);
+    sender.send(payload);
+    ++result.sent;
+  }
+  while (!finished) {
+    sender.send(stop_payload());
+    std::this_thread::sleep_for(STOP_INTERVAL);
+  }
+  result.seconds = (now_ns() - start) / 1e9;
+  thread.join();
+
+  summarize(latency, result);
+  return result;
+}
+
+Result run_survey(const Case& c) {
+  Result result;
+  YaUtils::Histogram latency;
+  result.fanout = c.config->voters;
+  std::string address = make_address(c.transport, "survey");
+  Survey initiator(Survey::ROLE::INITIATOR, address, c.config->tls);
+
+  std::vector<std::unique_ptr<Survey>> voters;
+  for (int i = 0; i < result.fanout; ++i) {
+    voters.push_back(std::make_unique<Survey>(Survey::ROLE::VOTER, address,
+                                                    c.config->tls));
+  }
+  std::this_thread::sleep_for(SETTLE_TIME);
+
+  std::atomic<int> finished = 0;
+  std::vector<std::thread> threads;
+  for (auto& voter : voters) {
+    threads.emplace_back([&finished, v = voter.get()]() {
+      try {
+        while (true) {
+          std::string survey = v->receive_survey();
+          if (is_stop(survey)) {
+            break;
+          }
+          v->respond(survey);
+        }
+      } catch (const std::exception&) {
+        // Receive gave up, nothing more is coming
+      }
+      ++finished;
+    });
+  }
+
+  std::string payload = make_payload(c.size);
+  auto deadline = deadline_of(c);
+  uint64_t start = now_ns();
+  while (std::chrono::steady_clock::now() < deadline) {
+    stamp(payload);
+    initiator.send_survey(payload);
+    ++result.sent;
+    for (const auto& response : initiator.collect_responses(result.fanout)) {
+      record_latency(latency, response);
+      ++result.received;
+    }
+  }
+  result.seconds = (now_ns() - start) / 1e9;
+  while (finished < result.fanout) {
+    initiator.send_survey(stop_payload());
+    std::this_thread::sleep_for(STOP_INTERVAL);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  summarize(latency, result);
+  return result;
+}
+
+}  // namespace ya::bench
@@ -0,0 +1,75 @@
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "bench_harness.h"
+#include "yautils.h"
+
+namespace ya::bench {
+
+namespace {
+
+// Strings one simulated request builds and drops
+constexpr size_t REQUEST_STRINGS = 64;
+constexpr size_t LIVE_OBJECTS = 16;
+
+Result named(Result result, const char* name, size_t size) {
+  result.name = name;
+  result.size = size;
+  return result;
+}
+
+size_t build_request(std::pmr::memory_resource* resource, size_t size) {
+  std::pmr::vector<std::pmr::string> strings(resource);
+  for (size_t i = 0; i < REQUEST_STRINGS; ++i) {
+    strings.emplace_back(size, static_cast<char>('a' + i % 26));
+  }
+  return strings.back().size();
+}
+
+struct Message {
+  uint64_t id = 0;
+  char payload[120];
+};
+
+}  // namespace
+
+// A request's strings from the heap, a fresh monotonic_buffer_resource and
+// a reused Arena; then pooled against heap allocation of small objects.
+// ops count requests or objects.
+std::vector<Result> run_alloc(const Config& config) {
+  std::vector<Result> results;
+  size_t sink = 0;
+  for (size_t size : config.sizes) {
+    results.push_back(named(run_for(config, [&] {
+      sink += build_request(std::pmr::new_delete_resource(), size);
+    }), "request-heap", size));
+    results.push_back(named(run_for(config, [&] {
+      std::pmr::monotonic_buffer_resource resource;
+      sink += build_request(&resource, size);
+    }), "request-monotonic", size));
+    YaUtils::Arena arena;
+    results.push_back(named(run_for(config, [&] {
+      sink += build_request(&arena, size);
+      arena.Reset();
+    }), "request-arena", size));
+  }
+
+  // Each object lives for LIVE_OBJECTS ops, as queued messages would
+  std::vector<std::unique_ptr<Message>> heap(LIVE_OBJECTS);
+  results.push_back(named(run_for(config, [&] {
+    auto& slot = heap[sink++ % LIVE_OBJECTS];
+    slot = std::make_unique<Message>();
+    slot->id = sink;
+  }), "object-heap", sizeof(Message)));
+  std::vector<YaUtils::ObjectPool::Ptr<Message>> pooled(LIVE_OBJECTS);
+  results.push_back(named(run_for(config, [&] {
+    auto& slot = pooled[sink++ % LIVE_OBJECTS];
+    slot = YaUtils::ObjectPool::Make<Message>();
+    slot->id = sink;
+  }), "object-pool", sizeof(Message)));
+  return results;
+}
+
+}  // namespace ya::bench
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "bench_harness.h"
+#include "yautils.h"
+
+namespace ya::bench {
+
+namespace {
+
+constexpr size_t VERIFY_BATCH = 64;
+
+// 1, 2, 4, ... up to the core count, which is always included
+std::vector<size_t> thread_counts() {
+  size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<size_t> counts;
+  for (size_t n = 1; n < cores; n *= 2) {
+    counts.push_back(n);
+  }
+  counts.push_back(cores);
+  return counts;
+}
+
+// Batches large enough to be worth spreading, small enough for short runs
+size_t batch_length(size_t size) {
+  return std::clamp<size_t>((1 << 20) / std::max<size_t>(size, 1), 8, 1024);
+}
+
+Result per_input(Result result, const char* name, size_t size,
+                 size_t threads, size_t batch) {
+  result.name = name;
+  result.size = size;
+  result.threads = static_cast<int>(threads);
+  result.ops *= batch;
+  return result;
+}
+
+}  // namespace
+
+// Hash and verify batches at growing thread counts; ops count inputs
+std::vector<Result> run_batch(const Config& config) {
+  YaUtils::Crypto crypto;
+  YaUtils::CryptoBuffer public_pem, private_pem;
+  if (!crypto.Generate_RSA_Key(public_pem, private_pem)) {
+    throw std::runtime_error("RSA key generation failed");
+  }
+  std::vector<YaUtils::Key> keys{*YaUtils::Key::LoadPublic(public_pem)};
+  auto signer = *YaUtils::Key::LoadPrivate(private_pem);
+
+  std::vector<Result> results;
+  for (size_t size : config.sizes) {
+    size_t batch = batch_length(size);
+    std::vector<std::string> buffers(batch, std::string(size, 'x'));
+    std::vector<std::string_view> inputs(buffers.begin(), buffers.end());
+
+    YaUtils::CryptoBuffer digest;
+    results.push_back(per_input(run_for(config, [&] {
+      for (auto input : inputs) {
+        crypto.SHA256_Hash(input, digest);
+      }
+    }), "sha256", size, 1, batch));
+
+    for (size_t threads : thread_counts()) {
+      results.push_back(per_input(run_for(config, [&] {
+        crypto.SHA256_Hash_Batch(inputs, threads);
+      }), "sha256-batch", size, threads, batch));
+    }
+    // Verification costs about the same at any size; one pass suffices
+    if (size != config.sizes.front()) {
+      continue;
+    }
+    batch = VERIFY_BATCH;
+    inputs.resize(batch, inputs[0]);
+    std::vector<YaUtils::CryptoBuffer> signatures(
+        batch, crypto.Sign(signer, inputs[0]).value());
+    for (size_t threads : thread_counts()) {
+      size_t verified = 0;
+      results.push_back(per_input(run_for(config, [&] {
+        auto valid = crypto.Verify_Batch(keys, inputs, signatures, threads);
+        verified += std::count(valid.begin(), valid.end(), true);
+      }), "rsa-verify-batch", size, threads, batch));
+      if (verified == 0) {
+        throw std::runtime_error("RSA verify failed");
+      }
+    }
+  }
+  return results;
+}
+
+}  // namespace ya::bench
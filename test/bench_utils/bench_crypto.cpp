@@ -0,0 +1,83 @@
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#include "bench_harness.h"
+#include "yautils.h"
+
+namespace ya::bench {
+
+namespace {
+
+using Cipher = YaUtils::Cipher;
+
+const char* algo_name(Cipher::ALGO algo) {
+  switch (algo) {
+    case Cipher::ALGO::AES_256_CBC:
+      return "aes-256-cbc";
+    case Cipher::ALGO::AES_256_CTR:
+      return "aes-256-ctr";
+    case Cipher::ALGO::AES_256_GCM:
+      return "aes-256-gcm";
+    case Cipher::ALGO::CHACHA20_POLY1305:
+      return "chacha20-poly1305";
+  }
+  return "unknown";
+}
+
+// One message per op on a reused context, into a reused buffer
+Result run_stream(const Config& config, Cipher::ALGO algo, size_t size) {
+  Cipher cipher(algo);
+  std::string key(cipher.KeySize(), 'K');
+  std::string iv(cipher.IvSize(), 'I');
+  std::string input(size, 'x');
+  YaUtils::CryptoBuffer output(size + cipher.BlockSize());
+  unsigned char tag[Cipher::TAG_SIZE];
+  if (!cipher.EncryptInit(key, iv)) {
+    throw std::runtime_error("Cipher init failed");
+  }
+
+  Result result = run_for(config, [&] {
+    cipher.Restart(iv);
+    size_t written = cipher.Update(input, output).value_or(0);
+    cipher.Final(std::span<unsigned char>(output).subspan(written));
+    if (cipher.IsAead()) {
+      cipher.GetTag(tag);
+    }
+  });
+  result.name = algo_name(algo);
+  result.size = size;
+  return result;
+}
+
+// The whole-buffer API, for comparison
+Result run_oneshot(const Config& config, size_t size) {
+  YaUtils::Crypto crypto;
+  std::string key(32, 'K');
+  std::string iv(16, 'I');
+  std::string input(size, 'x');
+  YaUtils::CryptoBuffer output;
+  Result result = run_for(config, [&] {
+    crypto.AES_Encrypt(input, key, iv, output);
+  });
+  result.name = "aes-256-cbc-oneshot";
+  result.size = size;
+  return result;
+}
+
+}  // namespace
+
+std::vector<Result> run_crypto(const Config& config) {
+  std::vector<Result> results;
+  for (size_t size : config.sizes) {
+    for (auto algo : {Cipher::ALGO::AES_256_CBC, Cipher::ALGO::AES_256_CTR,
+                      Cipher::ALGO::AES_256_GCM,
+                      Cipher::ALGO::CHACHA20_POLY1305}) {
+      results.push_back(run_stream(config, algo, size));
+    }
+    results.push_back(run_oneshot(config, size));
+  }
+  return results;
+}
+
+}  // namespace ya::bench
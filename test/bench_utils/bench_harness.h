@@ -0,0 +1,59 @@
+#ifndef BENCH_UTILS_HARNESS_H
+#define BENCH_UTILS_HARNESS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ya::bench {
+
+struct Config {
+  std::vector<std::string> suites = {"crypto", "keys", "batch", "hash",
+                                     "pool", "queue", "alloc"};
+  std::vector<size_t> sizes = {64, 1024, 16384, 1048576};
+  int duration_ms = 1000;
+  std::string output;  // JSON file, stdout when empty
+};
+
+// One benchmark case: an operation of a suite at an input size
+struct Result {
+  std::string suite;
+  std::string name;
+  size_t size = 0;
+  int threads = 1;
+  uint64_t ops = 0;
+  double seconds = 0;
+};
+
+// Calls op() in batches until duration_ms passes; returns ops and seconds.
+// op is expected to touch its output so the compiler keeps it.
+template <typename Op>
+Result run_for(const Config& config, Op&& op) {
+  using clock = std::chrono::steady_clock;
+  auto begin = clock::now();
+  auto deadline = begin + std::chrono::milliseconds(config.duration_ms);
+  Result result;
+  auto now = begin;
+  do {
+    for (int i = 0; i < 64; ++i) {
+      op();
+    }
+    result.ops += 64;
+    now = clock::now();
+  } while (now < deadline);
+  result.seconds = std::chrono::duration<double>(now - begin).count();
+  return result;
+}
+
+std::vector<Result> run_crypto(const Config& config);
+std::vector<Result> run_keys(const Config& config);
+std::vector<Result> run_batch(const Config& config);
+std::vector<Result> run_hash(const Config& config);
+std::vector<Result> run_pool(const Config& config);
+std::vector<Result> run_queue(const Config& config);
+std::vector<Result> run_alloc(const Config& config);
+
+}  // namespace ya::bench
+
+#endif
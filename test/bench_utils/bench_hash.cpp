@@ -0,0 +1,57 @@
+#include <functional>
+#include <string>
+
+#include "bench_harness.h"
+#include "yautils.h"
+
+namespace ya::bench {
+
+namespace {
+
+Result named(Result result, const char* name, size_t size) {
+  result.name = name;
+  result.size = size;
+  return result;
+}
+
+}  // namespace
+
+// The non-cryptographic hashes against std::hash and the OpenSSL digests
+std::vector<Result> run_hash(const Config& config) {
+  using Hash = YaUtils::Hash;
+  YaUtils::Crypto crypto;
+  std::vector<Result> results;
+  for (size_t size : config.sizes) {
+    std::string input(size, 'x');
+    uint64_t sink = 0;
+    results.push_back(named(run_for(config, [&] {
+      sink += Hash::Hash64(input, sink);
+    }), "hash64", size));
+    results.push_back(named(run_for(config, [&] {
+      sink += Hash::Hash128(input, sink).high;
+    }), "hash128", size));
+    results.push_back(named(run_for(config, [&] {
+      Hash hash(sink);
+      hash.Update(input);
+      sink += hash.Digest64();
+    }), "hash64-stream", size));
+    results.push_back(named(run_for(config, [&] {
+      sink += Hash::Crc32c(input, static_cast<uint32_t>(sink));
+    }), Hash::HasCrc32cInstructions() ? "crc32c-hw" : "crc32c-table", size));
+    results.push_back(named(run_for(config, [&] {
+      input[0] = static_cast<char>(sink);
+      sink += std::hash<std::string_view>{}(input);
+    }), "std-hash", size));
+
+    YaUtils::CryptoBuffer digest;
+    results.push_back(named(run_for(config, [&] {
+      crypto.MD5_Hash(input, digest);
+    }), "md5", size));
+    results.push_back(named(run_for(config, [&] {
+      crypto.SHA256_Hash(input, digest);
+    }), "sha256", size));
+  }
+  return results;
+}
+
+}  // namespace ya::bench
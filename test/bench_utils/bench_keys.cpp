@@ -0,0 +1,97 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "bench_harness.h"
+#include "yautils.h"
+
+namespace ya::bench {
+
+namespace {
+
+struct KeyPair {
+  YaUtils::CryptoBuffer public_pem;
+  YaUtils::CryptoBuffer private_pem;
+  YaUtils::Key public_key;
+  YaUtils::Key private_key;
+};
+
+using Generate = bool (YaUtils::Crypto::*)(YaUtils::CryptoBuffer&,
+                                           YaUtils::CryptoBuffer&);
+
+struct Algo {
+  std::string name;
+  Generate generate;
+};
+
+KeyPair make_pair(YaUtils::Crypto& crypto, const Algo& algo) {
+  YaUtils::CryptoBuffer public_pem, private_pem;
+  if (!(crypto.*algo.generate)(public_pem, private_pem)) {
+    throw std::runtime_error(algo.name + " key generation failed");
+  }
+  auto public_key = YaUtils::Key::LoadPublic(public_pem);
+  auto private_key = YaUtils::Key::LoadPrivate(private_pem);
+  if (!public_key || !private_key) {
+    throw std::runtime_error(algo.name + " key load failed");
+  }
+  return {public_pem, private_pem, *public_key, *private_key};
+}
+
+Result named(Result result, const std::string& name, size_t size) {
+  result.name = name;
+  result.size = size;
+  return result;
+}
+
+}  // namespace
+
+// Per algorithm: verify with the key parsed per call, looked up in a
+// KeyCache, and passed as a handle; sign with a handle; generate a pair
+std::vector<Result> run_keys(const Config& config) {
+  YaUtils::Crypto crypto;
+  YaUtils::Crypto cached;
+  cached.SetKeyCache(std::make_shared<YaUtils::KeyCache>());
+  const Algo algos[] = {
+      {"rsa", &YaUtils::Crypto::Generate_RSA_Key},
+      {"ecdsa", &YaUtils::Crypto::Generate_ECDSA_Key},
+      {"ed25519", &YaUtils::Crypto::Generate_Ed25519_Key},
+  };
+
+  std::vector<Result> results;
+  for (const auto& algo : algos) {
+    KeyPair pair = make_pair(crypto, algo);
+    for (size_t size : config.sizes) {
+      std::string data(size, 'x');
+      auto signature = crypto.Sign(pair.private_key, data);
+      if (!signature) {
+        throw std::runtime_error(algo.name + " sign failed");
+      }
+      bool ok = true;
+      results.push_back(named(run_for(config, [&] {
+        ok &= crypto.DSA_Verify(pair.public_pem, data, *signature);
+      }), algo.name + "-verify-pem", size));
+      results.push_back(named(run_for(config, [&] {
+        ok &= cached.DSA_Verify(pair.public_pem, data, *signature);
+      }), algo.name + "-verify-cache", size));
+      results.push_back(named(run_for(config, [&] {
+        ok &= crypto.Verify(pair.public_key, data, *signature);
+      }), algo.name + "-verify-key", size));
+      results.push_back(named(run_for(config, [&] {
+        ok &= crypto.Sign(pair.private_key, data).has_value();
+      }), algo.name + "-sign-key", size));
+      if (!ok) {
+        throw std::runtime_error(algo.name + " verify failed");
+      }
+    }
+    // RSA generation takes far too long for run_for's batches of 64
+    if (algo.name != "rsa") {
+      YaUtils::CryptoBuffer public_pem, private_pem;
+      results.push_back(named(run_for(config, [&] {
+        (crypto.*algo.generate)(public_pem, private_pem);
+      }), algo.name + "-generate", 0));
+    }
+  }
+  return results;
+}
+
+}  // namespace ya::bench
@@ -0,0 +1,170 @@
+// Throughput benchmark for the ya_utils building blocks.
+//
+//   bench_utils --suite=crypto --sizes=64,16K,1M --duration-ms=2000
+//               --output=result.json
+//
+// Every case runs for a fixed wall-clock duration, on one thread unless its
+// threads field says otherwise, and is reported as one JSON object, so runs
+// can be diffed across commits.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "bench_harness.h"
+
+namespace {
+
+using namespace ya::bench;
+
+std::vector<std::string> split(const std::string& value) {
+  std::vector<std::string> items;
+  std::stringstream stream(value);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+// Accepts plain bytes or a K/M suffix, e.g. 64K
+size_t parse_size(const std::string& value) {
+  size_t pos = 0;
+  size_t size = std::stoull(value, &pos);
+  if (pos < value.size()) {
+    switch (value[pos]) {
+      case 'k':
+      case 'K':
+        size <<= 10;
+        break;
+      case 'm':
+      case 'M':
+        size <<= 20;
+        break;
+      default:
+        throw std::invalid_argument("Bad size: " + value);
+    }
+  }
+  return size;
+}
+
+void usage() {
+  std::cerr << "Usage: bench_utils [options]\n"
+               "  --suite=LIST          crypto,keys,batch,hash,pool,queue,\n"
+               "                        alloc\n"
+               "  --sizes=LIST          input sizes, e.g. 64,16K,1M\n"
+               "  --duration-ms=N       time per case (default 1000)\n"
+               "  --output=FILE         write JSON to FILE instead of stdout\n";
+}
+
+Config parse_args(int argc, char** argv) {
+  Config config;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      usage();
+      std::exit(0);
+    }
+    auto eq = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+      throw std::invalid_argument("Bad argument: " + arg);
+    }
+    std::string key = arg.substr(2, eq - 2);
+    std::string value = arg.substr(eq + 1);
+    if (key == "suite") {
+      config.suites = split(value);
+    } else if (key == "sizes") {
+      config.sizes.clear();
+      for (const auto& size : split(value)) {
+        config.sizes.push_back(parse_size(size));
+      }
+    } else if (key == "duration-ms") {
+      config.duration_ms = std::stoi(value);
+    } else if (key == "output") {
+      config.output = value;
+    } else {
+      throw std::invalid_argument("Unknown option: --" + key);
+    }
+  }
+  return config;
+}
+
+std::vector<Result> run_suite(const std::string& suite,
+                              const Config& config) {
+  if (suite == "crypto") return run_crypto(config);
+  if (suite == "keys") return run_keys(config);
+  if (suite == "batch") return run_batch(config);
+  if (suite == "hash") return run_hash(config);
+  if (suite == "pool") return run_pool(config);
+  if (suite == "queue") return run_queue(config);
+  if (suite == "alloc") return run_alloc(config);
+  throw std::invalid_argument("Unknown suite: " + suite);
+}
+
+void write_result(std::ostream& out, const Result& r) {
+  double seconds = r.seconds > 0 ? r.seconds : 1;
+  double ops_per_sec = r.ops / seconds;
+  char buffer[512];
+  std::snprintf(buffer, sizeof(buffer),
+                "    {\"suite\": \"%s\", \"case\": \"%s\", \"size\": %zu, "
+                "\"threads\": %d, \"ops\": %llu, \"seconds\": %.3f, "
+                "\"ops_per_sec\": %.1f, \"ns_per_op\": %.1f, "
+                "\"gb_per_sec\": %.3f}",
+                r.suite.c_str(), r.name.c_str(), r.size, r.threads,
+                static_cast<unsigned long long>(r.ops), r.seconds,
+                ops_per_sec, 1e9 / std::max(ops_per_sec, 1e-9),
+                ops_per_sec * r.size / 1e9);
+  out << buffer;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Config config;
+  try {
+    config = parse_args(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    usage();
+    return 1;
+  }
+
+  std::vector<Result> results;
+  for (const auto& suite : config.suites) {
+    try {
+      for (auto& result : run_suite(suite, config)) {
+        result.suite = suite;
+        std::cerr << suite << "/" << result.name << "/" << result.size
+                  << ": " << result.ops * result.size / result.seconds / 1e9
+                  << " GB/s\n";
+        results.push_back(std::move(result));
+      }
+    } catch (const std::exception& e) {
+      std::cerr << suite << " failed: " << e.what() << "\n";
+    }
+  }
+
+  std::ofstream file;
+  if (!config.output.empty()) {
+    file.open(config.output);
+    if (!file) {
+      std::cerr << "Cannot open " << config.output << "\n";
+      return 1;
+    }
+  }
+  std::ostream& out = config.output.empty() ? std::cout : file;
+  out << "{\n  \"config\": {\"duration_ms\": " << config.duration_ms
+      << "},\n  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    write_result(out, results[i]);
+    out << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+  return results.empty() ? 1 : 0;
+}
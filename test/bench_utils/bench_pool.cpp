@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "bench_harness.h"
+#include "yautils.h"
+
+namespace ya::bench {
+
+namespace {
+
+// Upper bound on the tasks of one burst, so 64 bursts stay short
+constexpr size_t MAX_BURST = 1024;
+
+Result named(Result result, const char* name, size_t size, size_t threads) {
+  result.name = name;
+  result.size = size;
+  result.threads = static_cast<int>(threads);
+  return result;
+}
+
+}  // namespace
+
+// Task overhead of the ThreadPool: a round trip, a burst of small tasks and
+// a ParallelFor over size items
+std::vector<Result> run_pool(const Config& config) {
+  YaUtils::ThreadPool pool;
+  std::vector<Result> results;
+  std::atomic<uint64_t> sink{0};
+  results.push_back(named(run_for(config, [&] {
+    sink += pool.Submit([&] { return sink.load(); }).Get();
+  }), "submit-get", 1, pool.Size()));
+
+  for (size_t size : config.sizes) {
+    size_t burst = std::min(size, MAX_BURST);
+    results.push_back(named(run_for(config, [&] {
+      for (size_t i = 0; i < burst; ++i) {
+        pool.Post([&] { sink.fetch_add(1, std::memory_order_relaxed); });
+      }
+      pool.WaitIdle();
+    }), "post-burst", burst, pool.Size()));
+
+    std::vector<uint64_t> values(size, 1);
+    results.push_back(named(run_for(config, [&] {
+      pool.ParallelFor(size, [&](size_t i) { values[i] += sink; });
+    }), "parallel-for", size, pool.Size()));
+  }
+  return results;
+}
+
+}  // namespace ya::bench
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+
+#include "bench_harness.h"
+#include "yautils.h"
+
+namespace ya::bench {
+
+namespace {
+
+constexpr size_t CAPACITY = 1024;
+constexpr size_t BATCHES[] = {1, 32};
+
+// 1, 2, 4, ... up to the core count, which is always included
+std::vector<size_t> thread_counts() {
+  size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<size_t> counts;
+  for (size_t n = 1; n < cores; n *= 2) {
+    counts.push_back(n);
+  }
+  counts.push_back(cores);
+  return counts;
+}
+
+// Producers call produce(p, values) and consumers consume(out) for
+// duration_ms; both return how many items they moved. ops count the items
+// that made it through.
+template <typename Produce, typename Consume>
+Result handoff(const Config& config, const char* name, size_t batch,
+               size_t producers, size_t consumers, Produce produce,
+               Consume consume) {
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> moved{0};
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      std::vector<uint64_t> values(batch, p);
+      while (!stop.load(std::memory_order_relaxed)) {
+        if (produce(p, std::span<uint64_t>(values)) == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (size_t c = 0; c < consumers; ++c) {
+    threads.emplace_back([&] {
+      std::vector<uint64_t> out(batch);
+      uint64_t count = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        size_t popped = consume(std::span<uint64_t>(out));
+        if (popped == 0) {
+          std::this_thread::yield();
+        }
+        count += popped;
+      }
+      moved += count;
+    });
+  }
+  auto begin = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(config.duration_ms));
+  stop = true;
+  auto end = std::chrono::steady_clock::now();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Result result;
+  result.name = name;
+  if (batch > 1) {
+    result.name += "-batch" + std::to_string(batch);
+  }
+  result.size = sizeof(uint64_t);
+  result.threads = static_cast<int>(producers + consumers);
+  result.ops = moved;
+  result.seconds = std::chrono::duration<double>(end - begin).count();
+  return result;
+}
+
+// Baseline the lock-free queues should beat
+class MutexQueue {
+ public:
+  size_t Push(std::span<uint64_t> values) {
+    std::lock_guard lock(m_mutex);
+    size_t count = std::min(values.size(), CAPACITY - m_items.size());
+    m_items.insert(m_items.end(), values.begin(), values.begin() + count);
+    return count;
+  }
+  size_t Pop(std::span<uint64_t> out) {
+    std::lock_guard lock(m_mutex);
+    size_t count = std::min(out.size(), m_items.size());
+    std::copy_n(m_items.begin(), count, out.begin());
+    m_items.erase(m_items.begin(), m_items.begin() + count);
+    return count;
+  }
+
+ private:
+  std::mutex m_mutex;
+  std::deque<uint64_t> m_items;
+};
+
+struct Node : YaUtils::MpscNode {
+  std::atomic<bool> queued{false};
+  uint64_t value = 0;
+};
+
+}  // namespace
+
+// Items through each queue, one or a batch per call, at growing thread
+// counts; sizes do not apply, size is that of an item
+std::vector<Result> run_queue(const Config& config) {
+  std::vector<Result> results;
+  for (size_t batch : BATCHES) {
+    YaUtils::SpscRing<uint64_t> ring(CAPACITY);
+    results.push_back(handoff(
+        config, "spsc-ring", batch, 1, 1,
+        [&](size_t, std::span<uint64_t> values) {
+          return ring.TryPushBatch(values);
+        },
+        [&](std::span<uint64_t> out) { return ring.TryPopBatch(out); }));
+
+    for (size_t threads : thread_counts()) {
+      // Each producer cycles through its own nodes, skipping queued ones
+      YaUtils::MpscQueue<Node> mpsc;
+      std::vector<std::vector<Node>> nodes(threads);
+      std::vector<size_t> next(threads);
+      for (auto& own : nodes) {
+        own = std::vector<Node>(CAPACITY);
+      }
+      results.push_back(handoff(
+          config, "mpsc-queue", batch, threads, 1,
+          [&](size_t p, std::span<uint64_t> values) {
+            Node* chain[BATCHES[1]];
+            size_t count = 0;
+            for (uint64_t value : values) {
+              Node& node = nodes[p][next[p]];
+              if (node.queued.load(std::memory_order_acquire)) {
+                break;
+              }
+              next[p] = (next[p] + 1) % CAPACITY;
+              node.queued.store(true, std::memory_order_relaxed);
+              node.value = value;
+              chain[count++] = &node;
+            }
+            mpsc.PushBatch(std::span<Node* const>(chain, count));
+            return count;
+          },
+          [&](std::span<uint64_t> out) {
+            size_t count = 0;
+            for (; count < out.size(); ++count) {
+              Node* node = mpsc.Pop();
+              if (node == nullptr) {
+                break;
+              }
+              out[count] = node->value;
+              node->queued.store(false, std::memory_order_release);
+            }
+            return count;
+          }));
+
+      YaUtils::MpmcQueue<uint64_t> mpmc(CAPACITY);
+      results.push_back(handoff(
+          config, "mpmc-queue", batch, threads, threads,
+          [&](size_t, std::span<uint64_t> values) {
+            return mpmc.TryPushBatch(values);
+          },
+          [&](std::span<uint64_t> out) { return mpmc.TryPopBatch(out); }));
+
+      MutexQueue locked;
+      results.push_back(handoff(
+          config, "mutex-deque", batch, threads, threads,
+          [&](size_t, std::span<uint64_t> values) {
+            return locked.Push(values);
+          },
+          [&](std::span<uint64_t> out) { return locked.Pop(out); }));
+    }
+  }
+  return results;
+}
+
+}  // namespace ya::bench
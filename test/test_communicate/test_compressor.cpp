@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ya_communicate/module/compressor.h"
+#include "ya_communicate/module/pipeline.h"
+#include "ya_communicate/module/publisher.h"
+#include "ya_communicate/module/subscriber.h"
+#include "ya_communicate/node_def.h"
+
+namespace ya::module {
+
+namespace {
+
+std::string telemetry(int i) {
+  return "{\"node\":\"node-" + std::to_string(i % 8) +
+         "\",\"cpu\":0.42,\"mem\":1234567,\"status\":\"healthy\","
+         "\"tags\":[\"region-a\",\"rack-7\",\"tier-1\"],\"seq\":" +
+         std::to_string(i) + "}";
+}
+
+std::string repetitive(size_t size) {
+  std::string s;
+  while (s.size() < size) {
+    s += telemetry(static_cast<int>(s.size()));
+  }
+  s.resize(size);
+  return s;
+}
+
+}  // namespace
+
+TEST(CompressorTest, NoneRoundTrip) {
+  Compressor compressor(Compressor::Options{});
+  std::string payload = repetitive(4096);
+  std::string frame = compressor.encode(payload);
+  EXPECT_TRUE(Compressor::is_frame(frame));
+  EXPECT_EQ(frame.size(), payload.size() + Compressor::HEADER_SIZE);
+  EXPECT_EQ(compressor.decode(frame), payload);
+}
+
+TEST(CompressorTest, BelowThresholdSentRaw) {
+  if (!Compressor::is_supported(Compressor::ALGO::LZ4)) {
+    GTEST_SKIP() << "LZ4 not compiled in";
+  }
+  Compressor::Options options;
+  options.algo = Compressor::ALGO::LZ4;
+  options.threshold = 1024;
+  Compressor compressor(options);
+
+  std::string payload = repetitive(512);
+  std::string frame = compressor.encode(payload);
+  EXPECT_EQ(frame.size(), payload.size() + Compressor::HEADER_SIZE);
+  EXPECT_EQ(compressor.stats().compressed, 0u);
+  EXPECT_EQ(compressor.decode(frame), payload);
+}
+
+TEST(CompressorTest, LZ4RoundTrip) {
+  if (!Compressor::is_supported(Compressor::ALGO::LZ4)) {
+    GTEST_SKIP() << "LZ4 not compiled in";
+  }
+  Compressor::Options options;
+  options.algo = Compressor::ALGO::LZ4;
+  Compressor compressor(options);
+
+  std::string payload = repetitive(64 * 1024);
+  std::string frame = compressor.encode(payload);
+  EXPECT_LT(frame.size(), payload.size());
+  EXPECT_EQ(compressor.decode(frame), payload);
+  EXPECT_GT(compressor.stats().ratio(), 2.0);
+}
+
+TEST(CompressorTest, ZstdDictionaryRoundTrip) {
+  if (!Compressor::is_supported(Compressor::ALGO::ZSTD)) {
+    GTEST_SKIP() << "zstd not compiled in";
+  }
+  std::vector<std::string> samples;
+  for (int i = 0; i < 2000; ++i) {
+    samples.push_back(telemetry(i));
+  }
+
+  Compressor::Options options;
+  options.algo = Compressor::ALGO::ZSTD;
+  options.threshold = 64;
+  options.level = 3;
+  options.dictionary = Compressor::train_dictionary(samples, 4096);
+  Compressor sender(options);
+  Compressor receiver(options);
+
+  std::string payload = telemetry(12345);
+  std::string frame = sender.encode(payload);
+  EXPECT_LT(frame.size(), payload.size());
+  EXPECT_EQ(receiver.decode(frame), payload);
+}
+
+TEST(CompressorTest, CorruptFrameThrows) {
+  Compressor compressor(Compressor::Options{});
+  EXPECT_THROW(compressor.decode("not a frame"), CommException);
+
+  std::string frame = compressor.encode("payload");
+  frame.pop_back();
+  EXPECT_THROW(compressor.decode(frame), CommException);
+}
+
+TEST(CompressorTest, PipelineTransparent) {
+  std::string address = "tcp://127.0.0.1:5590";
+  Pipeline puller(Pipeline::ROLE::PULLER, address);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  Pipeline pusher(Pipeline::ROLE::PUSHER, address);
+
+  Compressor::Options options;
+  options.algo = Compressor::is_supported(Compressor::ALGO::LZ4)
+                     ? Compressor::ALGO::LZ4
+                     : Compressor::ALGO::NONE;
+  pusher.set_compression(options);
+  puller.set_compression(options);
+
+  std::string payload = repetitive(16 * 1024);
+  std::thread receiver([&]() { EXPECT_EQ(puller.receive(), payload); });
+  pusher.send(payload);
+  receiver.join();
+
+  auto stats = pusher.compression_stats();
+  EXPECT_EQ(stats.encoded, 1u);
+  EXPECT_EQ(stats.raw_bytes, payload.size());
+  EXPECT_EQ(puller.compression_stats().decoded, 1u);
+}
+
+TEST(CompressorTest, PubSubTopicsAndRawFrames) {
+  std::string address = "tcp://127.0.0.1:5591";
+  Publisher publisher(address);
+  Subscriber subscriber(address);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  subscriber.subscribe("");
+
+  Compressor::Options options;
+  options.threshold = 0;
+  subscriber.set_compression(options);
+
+  // A frame that does not decode is dropped, never passed on as payload
+  std::string corrupt = "\xC5Y\x01junk that is not a frame";
+  publisher.publish("raw", corrupt);
+  publisher.publish("raw", "plain");
+  EXPECT_EQ(subscriber.receive(), "raw:plain");
+  EXPECT_EQ(subscriber.stats().errors, 1u);
+
+  // Topics may contain ':'
+  publisher.set_compression(options);
+  publisher.publish("node:status", "healthy");
+  EXPECT_EQ(subscriber.receive(), "node:status:healthy");
+  EXPECT_EQ(subscriber.compression_stats().decoded, 1u);
+}
+
+}  // namespace ya::module
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "ya_communicate/module/connection.h"
+#include "ya_communicate/module/requester.h"
+#include "ya_communicate/module/responder.h"
+#include "ya_communicate/node_def.h"
+
+namespace ya::module {
+
+TEST(ReconnectPolicyTest, JitterStaysInRange) {
+  ReconnectPolicy policy;
+  policy.jitter = 0.25;
+  bool varied = false;
+  auto first = policy.jittered(std::chrono::milliseconds(1000));
+  for (int i = 0; i < 200; ++i) {
+    auto value = policy.jittered(std::chrono::milliseconds(1000));
+    EXPECT_GE(value.count(), 750);
+    EXPECT_LE(value.count(), 1250);
+    varied |= value != first;
+  }
+  EXPECT_TRUE(varied);
+
+  policy.jitter = 0;
+  EXPECT_EQ(policy.jittered(std::chrono::milliseconds(1000)).count(), 1000);
+  EXPECT_EQ(ReconnectPolicy{}.jittered(std::chrono::milliseconds(0)).count(),
+            0);
+}
+
+TEST(ConnectionTrackerTest, FollowsPipes) {
+  std::vector<ConnectionEvent> events;
+  ConnectionTracker tracker("tcp://127.0.0.1:1", [&](const ConnectionEvent& e) {
+    events.push_back(e);
+  });
+  EXPECT_EQ(tracker.info().state, CONNECTION_STATE::CONNECTING);
+
+  tracker.on_pipe(true, 7);
+  tracker.on_pipe(true, 8);
+  tracker.on_pipe(false, 7);
+  EXPECT_EQ(tracker.info().state, CONNECTION_STATE::CONNECTED);
+  EXPECT_EQ(tracker.info().pipes, 1u);
+
+  tracker.on_pipe(false, 8);
+  auto info = tracker.info();
+  EXPECT_EQ(info.state, CONNECTION_STATE::RECONNECTING);
+  EXPECT_EQ(info.connects, 2u);
+  EXPECT_EQ(info.disconnects, 2u);
+
+  ASSERT_EQ(events.size(), 4u);
+  EXPECT_EQ(events[0].type, ConnectionEvent::TYPE::CONNECTED);
+  EXPECT_EQ(events[0].pipe, 7u);
+  EXPECT_EQ(events[3].type, ConnectionEvent::TYPE::DISCONNECTED);
+  EXPECT_EQ(events[3].pipes, 0u);
+  EXPECT_EQ(events[3].address, "tcp://127.0.0.1:1");
+}
+
+TEST(ConnectionTest, BlockingDialNeedsPeer) {
+  EXPECT_THROW(Requester("tcp://127.0.0.1:19300"), CommException);
+}
+
+TEST(ConnectionTest, NonBlockingDialWaitsForServer) {
+  const std::string url = "tcp://127.0.0.1:19301";
+  std::atomic<int> connected = 0;
+  ReconnectPolicy policy;
+  policy.wait_for_peer = false;
+  policy.min_interval = std::chrono::milliseconds(20);
+  policy.max_interval = std::chrono::milliseconds(100);
+  policy.on_event = [&](const ConnectionEvent& event) {
+    if (event.type == ConnectionEvent::TYPE::CONNECTED) {
+      ++connected;
+    }
+  };
+
+  Requester client(url, {}, policy);
+  EXPECT_EQ(client.connection().state, CONNECTION_STATE::CONNECTING);
+
+  // Server comes up after the client, the request goes out once it does
+  std::thread server_thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    Reponder server(url);
+    server.send(server.receive() + " pong");
+  });
+  client.set_timeout(std::chrono::seconds(5));
+  EXPECT_EQ(client.request("ping"), "ping pong");
+  server_thread.join();
+
+  EXPECT_EQ(connected, 1);
+  EXPECT_EQ(client.connection().connects, 1u);
+}
+
+}  // namespace ya::module
@@ -27,3 +27,52 @@ TEST(TestModuleHttp, Api) {
   std::string res_nodes = exec("curl -s http://127.0.0.1:18000/nodes");
   std::cout << "/nodes: " << res_nodes << std::endl;
 }
+
+TEST(TestModuleHttp, Routes) {
+  ya::module::Http http;
+  static const std::string cached = "{\"cached\": true}";
+  http.route("GET", "/nodes/:id",
+             [](const ya::module::HttpRequest& req,
+                ya::module::HttpResponse& res) {
+               res.set_body("{\"id\": \"" + std::string(req.param("id")) +
+                            "\"}");
+             });
+  http.route("POST", "/echo",
+             [](const ya::module::HttpRequest& req,
+                ya::module::HttpResponse& res) {
+               res.content_type = "text/plain";
+               res.set_body(std::string(req.body));
+             });
+  http.route("GET", "/cached",
+             [](const ya::module::HttpRequest&, ya::module::HttpResponse& res) {
+               res.set_body_ref(cached);
+             });
+  http.stream("GET", "/count",
+              [](const ya::module::HttpRequest&, ya::module::HttpStream& out) {
+                for (int i = 0; i < 3; ++i) {
+                  out.write(std::to_string(i) + "\n");
+                }
+              },
+              "text/plain");
+  http.start(18001);
+  EXPECT_TRUE(http.running());
+
+  EXPECT_EQ(exec("curl -s http://127.0.0.1:18001/nodes/n1"), "{\"id\": \"n1\"}");
+  EXPECT_EQ(exec("curl -s -d hello http://127.0.0.1:18001/echo"), "hello");
+  EXPECT_EQ(exec("curl -s http://127.0.0.1:18001/cached"), cached);
+  EXPECT_EQ(exec("curl -s http://127.0.0.1:18001/count"), "0\n1\n2\n");
+  EXPECT_EQ(exec("curl -s -o /dev/null -w '%{http_code}' "
+                 "http://127.0.0.1:18001/missing"),
+            "404");
+  EXPECT_EQ(exec("curl -s -o /dev/null -w '%{http_code}' -X DELETE "
+                 "http://127.0.0.1:18001/echo"),
+            "405");
+  // Both requests share one keep-alive connection
+  std::string verbose = exec(
+      "curl -sv http://127.0.0.1:18001/status http://127.0.0.1:18001/status "
+      "2>&1");
+  EXPECT_NE(verbose.find("Re-using existing connection"), std::string::npos);
+
+  http.stop();
+  EXPECT_FALSE(http.running());
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <thread>
+
+#include "ya_communicate/module/lanes.h"
+
+namespace ya::module {
+
+namespace {
+
+constexpr auto NO_WAIT = std::chrono::milliseconds(0);
+
+}  // namespace
+
+TEST(LanesTest, ControlOvertakesData) {
+  LaneScheduler lanes;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(lanes.push(LANE::DATA, "a", "bulk"));
+  }
+  ASSERT_TRUE(lanes.push(LANE::CONTROL, "b", "ping"));
+
+  auto item = lanes.pop(NO_WAIT);
+  ASSERT_TRUE(item);
+  EXPECT_EQ(item->lane, LANE::CONTROL);
+  EXPECT_EQ(item->flow, "b");
+  EXPECT_EQ(item->message, "ping");
+  EXPECT_EQ(lanes.pop(NO_WAIT)->lane, LANE::DATA);
+}
+
+TEST(LanesTest, DataIsFairInBytes) {
+  LaneScheduler::Options options;
+  options.quantum = 1000;
+  LaneScheduler lanes(options);
+  // "big" queues 1000 byte messages, "small" 100 byte ones
+  for (int i = 0; i < 50; ++i) {
+    ASSERT_TRUE(lanes.push(LANE::DATA, "big", std::string(1000, 'b')));
+  }
+  for (int i = 0; i < 500; ++i) {
+    ASSERT_TRUE(lanes.push(LANE::DATA, "small", std::string(100, 's')));
+  }
+
+  std::map<std::string, size_t> bytes;
+  for (int i = 0; i < 110; ++i) {
+    auto item = lanes.pop(NO_WAIT);
+    ASSERT_TRUE(item);
+    bytes[item->flow] += item->message.size();
+  }
+  // Ten rounds of one big and ten small messages
+  EXPECT_EQ(bytes["big"], 10000u);
+  EXPECT_EQ(bytes["small"], 10000u);
+}
+
+TEST(LanesTest, OversizedMessagesStillGo) {
+  LaneScheduler::Options options;
+  options.quantum = 10;
+  LaneScheduler lanes(options);
+  ASSERT_TRUE(lanes.push(LANE::DATA, "a", std::string(95, 'x')));
+  auto item = lanes.pop(NO_WAIT);
+  ASSERT_TRUE(item);
+  EXPECT_EQ(item->message.size(), 95u);
+}
+
+TEST(LanesTest, BoundedPerFlow) {
+  LaneScheduler::Options options;
+  options.flow_capacity = 2;
+  options.control_capacity = 1;
+  LaneScheduler lanes(options);
+  EXPECT_TRUE(lanes.push(LANE::DATA, "a", "1"));
+  EXPECT_TRUE(lanes.push(LANE::DATA, "a", "2"));
+  EXPECT_FALSE(lanes.push(LANE::DATA, "a", "3"));
+  EXPECT_TRUE(lanes.push(LANE::DATA, "b", "1"));  // Other flows unaffected
+  EXPECT_TRUE(lanes.push(LANE::CONTROL, "a", "c"));
+  EXPECT_FALSE(lanes.push(LANE::CONTROL, "a", "c"));
+
+  auto stats = lanes.stats();
+  EXPECT_EQ(stats.rejected, 2u);
+  EXPECT_EQ(stats.data_queued, 3u);
+  EXPECT_EQ(stats.control_queued, 1u);
+  EXPECT_EQ(stats.flows, 2u);
+}
+
+TEST(LanesTest, DropFlow) {
+  LaneScheduler lanes;
+  lanes.push(LANE::DATA, "a", "1");
+  lanes.push(LANE::DATA, "a", "2");
+  lanes.push(LANE::DATA, "b", "1");
+  EXPECT_EQ(lanes.drop_flow("a"), 2u);
+  EXPECT_EQ(lanes.drop_flow("a"), 0u);
+
+  auto item = lanes.pop(NO_WAIT);
+  ASSERT_TRUE(item);
+  EXPECT_EQ(item->flow, "b");
+  EXPECT_FALSE(lanes.pop(NO_WAIT));
+}
+
+TEST(LanesTest, CloseWakesPop) {
+  LaneScheduler lanes;
+  std::thread closer([&lanes] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    lanes.close();
+  });
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(lanes.pop(std::chrono::seconds(10)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  closer.join();
+  EXPECT_FALSE(lanes.push(LANE::DATA, "a", "late"));
+}
+
+}  // namespace ya::module
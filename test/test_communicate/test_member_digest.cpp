@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "ya_communicate/arch/member_digest.h"
+
+namespace ya::arch {
+
+namespace {
+
+std::vector<MemberDigest::Entry> make_entries(size_t count) {
+  std::vector<MemberDigest::Entry> entries;
+  for (size_t i = 0; i < count; ++i) {
+    std::string id = "node-" + std::to_string(i);
+    entries.push_back({id, "tcp://" + id + ":1", "tcp://" + id + ":2"});
+  }
+  return entries;
+}
+
+}  // namespace
+
+TEST(MemberDigestTest, OrderDoesNotMatter) {
+  auto entries = make_entries(100);
+  MemberDigest a(entries);
+  std::reverse(entries.begin(), entries.end());
+  MemberDigest b(entries);
+  EXPECT_EQ(a.root(), b.root());
+  EXPECT_TRUE(a.diff(b.buckets()).empty());
+}
+
+TEST(MemberDigestTest, DiffFindsChangedBuckets) {
+  auto entries = make_entries(100);
+  MemberDigest full(entries);
+  auto missing = entries[42];
+  entries.erase(entries.begin() + 42);
+  MemberDigest partial(entries);
+
+  EXPECT_NE(full.root(), partial.root());
+  auto differ = full.diff(partial.buckets());
+  ASSERT_EQ(differ.size(), 1u);
+  EXPECT_EQ(differ[0], MemberDigest::bucket_of(missing.address));
+
+  auto sent = MemberDigest::decode_entries(full.encode_entries(differ));
+  EXPECT_LT(sent.size(), 100u);
+  EXPECT_TRUE(std::any_of(sent.begin(), sent.end(), [&](const auto& entry) {
+    return entry.address == missing.address;
+  }));
+}
+
+TEST(MemberDigestTest, DataUrlChangesHash) {
+  auto entries = make_entries(10);
+  MemberDigest before(entries);
+  entries[3].data_url = "tcp://elsewhere:2";
+  MemberDigest after(entries);
+  EXPECT_EQ(after.diff(before.buckets()).size(), 1u);
+}
+
+TEST(MemberDigestTest, WireRoundTrip) {
+  MemberDigest digest(make_entries(20));
+  EXPECT_EQ(MemberDigest::decode_hash(MemberDigest::encode_hash(digest.root())),
+            digest.root());
+  EXPECT_EQ(
+      MemberDigest::decode_buckets(MemberDigest::encode_buckets(
+          digest.buckets())),
+      digest.buckets());
+  EXPECT_EQ(MemberDigest::decode_indexes(
+                MemberDigest::encode_indexes({0, 5, 31})),
+            (std::vector<size_t>{0, 5, 31}));
+
+  std::vector<size_t> all(MemberDigest::BUCKETS);
+  for (size_t i = 0; i < all.size(); ++i) {
+    all[i] = i;
+  }
+  auto entries = MemberDigest::decode_entries(digest.encode_entries(all));
+  EXPECT_EQ(entries.size(), 20u);
+  EXPECT_EQ(MemberDigest(entries).root(), digest.root());
+}
+
+TEST(MemberDigestTest, RejectsMalformed) {
+  EXPECT_FALSE(MemberDigest::decode_hash("xyz"));
+  EXPECT_FALSE(MemberDigest::decode_buckets("1,2,3"));
+  EXPECT_TRUE(MemberDigest::decode_indexes("32,-1,a").empty());
+  EXPECT_TRUE(MemberDigest::decode_entries("id-only;,addr,").empty());
+  auto entries = MemberDigest::decode_entries("a,tcp://a:1,");
+  ASSERT_EQ(entries.size(), 1u);
+  EXPECT_EQ(entries[0].data_url, "");
+}
+
+}  // namespace ya::arch
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <nng/nng.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "ya_communicate/module/msgpool.h"
+
+namespace ya::module {
+
+class MessagePoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    MessagePool::set_enabled(true);
+    MessagePool::reset_stats();
+  }
+};
+
+TEST_F(MessagePoolTest, AcquireSetsLength) {
+  nng_msg* msg = MessagePool::acquire(100);
+  ASSERT_NE(msg, nullptr);
+  EXPECT_EQ(nng_msg_len(msg), 100u);
+  EXPECT_EQ(nng_msg_header_len(msg), 0u);
+  MessagePool::release(msg);
+}
+
+TEST_F(MessagePoolTest, ReleasedMessageIsReused) {
+  nng_msg* first = MessagePool::acquire(3000);
+  ASSERT_NE(first, nullptr);
+  MessagePool::release(first);
+
+  // Same size class (4 KiB), so the body comes back from the cache
+  nng_msg* second = MessagePool::acquire(2500);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(nng_msg_len(second), 2500u);
+  MessagePool::release(second);
+
+  auto stats = MessagePool::stats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.recycled, 2u);
+  EXPECT_DOUBLE_EQ(stats.hit_rate(), 0.5);
+}
+
+TEST_F(MessagePoolTest, OversizedBypassesPool) {
+  nng_msg* msg = MessagePool::acquire(MessagePool::MAX_POOLED_SIZE + 1);
+  ASSERT_NE(msg, nullptr);
+  EXPECT_EQ(nng_msg_len(msg), MessagePool::MAX_POOLED_SIZE + 1);
+  MessagePool::release(msg);
+
+  auto stats = MessagePool::stats();
+  EXPECT_EQ(stats.hits + stats.misses, 0u);
+}
+
+TEST_F(MessagePoolTest, SteadyStateHitRate) {
+  for (int i = 0; i < 1000; ++i) {
+    nng_msg* msg = MessagePool::acquire(64 + i % 900);
+    ASSERT_NE(msg, nullptr);
+    std::memset(nng_msg_body(msg), 'x', nng_msg_len(msg));
+    MessagePool::release(msg);
+  }
+  EXPECT_GT(MessagePool::stats().hit_rate(), 0.99);
+}
+
+TEST_F(MessagePoolTest, PerThreadCaches) {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([]() {
+      for (int i = 0; i < 100; ++i) {
+        MessagePool::release(MessagePool::acquire(512));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // One miss per thread, counters folded in as the threads exit
+  auto stats = MessagePool::stats();
+  EXPECT_EQ(stats.misses, 4u);
+  EXPECT_EQ(stats.hits, 396u);
+}
+
+TEST_F(MessagePoolTest, DisabledFallsBackToAlloc) {
+  MessagePool::set_enabled(false);
+  nng_msg* msg = MessagePool::acquire(100);
+  ASSERT_NE(msg, nullptr);
+  MessagePool::release(msg);
+  MessagePool::set_enabled(true);
+
+  auto stats = MessagePool::stats();
+  EXPECT_EQ(stats.hits + stats.misses + stats.recycled, 0u);
+}
+
+}  // namespace ya::module
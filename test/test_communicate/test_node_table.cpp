@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "ya_communicate/arch/node_table.h"
+#include "ya_communicate/arch/simulator.h"
+
+namespace ya::arch {
+
+namespace {
+
+std::shared_ptr<const NodeTable> make_table() {
+  NodeTable::Builder builder;
+  builder.add(NodeStatus{"c", "tcp://c:1", 3, "healthy"}, "tcp://c:2");
+  builder.add(NodeStatus{"a", "tcp://a:1", 1, "healthy"});
+  builder.add(NodeStatus{"b", "tcp://b:1", 2, "discovered"}, "tcp://b:2");
+  return builder.build(7);
+}
+
+MembershipOptions make_options(size_t index) {
+  MembershipOptions options;
+  options.id = "node-" + std::to_string(index);
+  options.address = "sim://" + options.id;
+  return options;
+}
+
+}  // namespace
+
+TEST(NodeTableTest, Empty) {
+  auto table = NodeTable::empty();
+  EXPECT_TRUE(table->is_empty());
+  EXPECT_EQ(table->version(), 0u);
+  EXPECT_EQ(table->find("tcp://a:1"), nullptr);
+  EXPECT_EQ(table, NodeTable::empty());
+}
+
+TEST(NodeTableTest, SortedByAddress) {
+  auto table = make_table();
+  ASSERT_EQ(table->size(), 3u);
+  EXPECT_EQ(table->version(), 7u);
+  EXPECT_EQ((*table)[0].address, "tcp://a:1");
+  EXPECT_EQ((*table)[1].address, "tcp://b:1");
+  EXPECT_EQ((*table)[2].address, "tcp://c:1");
+}
+
+TEST(NodeTableTest, Find) {
+  auto table = make_table();
+  const auto* entry = table->find("tcp://b:1");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->id, "b");
+  EXPECT_EQ(entry->data_url, "tcp://b:2");
+  EXPECT_EQ(entry->info, "discovered");
+  EXPECT_EQ(entry->uptime, 2);
+  EXPECT_EQ(table->find("tcp://a:1")->data_url, "");
+  EXPECT_EQ(table->find("tcp://d:1"), nullptr);
+
+  NodeStatus status = entry->status();
+  EXPECT_EQ(status.id, "b");
+  EXPECT_EQ(status.address, "tcp://b:1");
+}
+
+TEST(NodeTableTest, SnapshotOnlyChangesWithMembers) {
+  Simulator simulator;
+  for (size_t i = 0; i < 3; ++i) {
+    simulator.add_node(make_options(i));
+  }
+  Membership& node = simulator.node(0);
+  auto before = node.snapshot();
+  EXPECT_TRUE(before->is_empty());
+
+  simulator.run_for(std::chrono::seconds(1));
+  auto joined = node.snapshot();
+  ASSERT_EQ(joined->size(), 2u);
+  EXPECT_GT(joined->version(), before->version());
+  EXPECT_NE(joined->find("sim://node-1"), nullptr);
+
+  // Heartbeats alone do not rebuild the table
+  simulator.run_for(std::chrono::seconds(1));
+  EXPECT_EQ(node.snapshot(), joined);
+
+  // An old snapshot stays intact after members leave
+  simulator.partition(1, 1);
+  simulator.partition(2, 1);
+  simulator.run_for(std::chrono::minutes(1));
+  EXPECT_TRUE(node.snapshot()->is_empty());
+  ASSERT_EQ(joined->size(), 2u);
+  EXPECT_EQ(joined->find("sim://node-2")->id, "node-2");
+}
+
+TEST(NodeTableTest, ConcurrentReaders) {
+  Simulator simulator;
+  for (size_t i = 0; i < 20; ++i) {
+    simulator.add_node(make_options(i));
+  }
+  Membership& node = simulator.node(0);
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      uint64_t version = 0;
+      while (!stop) {
+        auto table = node.snapshot();
+        EXPECT_GE(table->version(), version);
+        version = table->version();
+        for (const auto& entry : *table) {
+          EXPECT_EQ(table->find(entry.address), &entry);
+        }
+      }
+    });
+  }
+  simulator.run_for(std::chrono::seconds(10));
+  stop = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(node.snapshot()->size(), 19u);
+}
+
+}  // namespace ya::arch
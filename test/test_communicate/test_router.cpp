@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "ya_communicate/module/router.h"
+
+namespace ya::module {
+
+class HttpRouterTest : public ::testing::Test {
+ protected:
+  // Each route answers with its own pattern so matches can be told apart
+  void add(const std::string& method, const std::string& pattern) {
+    router.add(method, pattern,
+               HttpRoute{[pattern](const HttpRequest&, HttpResponse& res) {
+                           res.set_body(pattern);
+                         },
+                         {},
+                         {}});
+  }
+
+  std::string lookup(std::string_view method, std::string_view path) {
+    const HttpRoute* route = nullptr;
+    if (router.find(method, path, route, params) !=
+        HttpRouter::MATCH::FOUND) {
+      return "";
+    }
+    HttpRequest request;
+    HttpResponse response;
+    route->handler(request, response);
+    return response.body;
+  }
+
+  std::string param(std::string_view name) {
+    for (const auto& [key, value] : params) {
+      if (key == name) {
+        return std::string(value);
+      }
+    }
+    return "";
+  }
+
+  HttpRouter router;
+  HttpRouter::Params params;
+};
+
+TEST_F(HttpRouterTest, StaticRoutesShareCompressedPrefixes) {
+  add("GET", "/status");
+  add("GET", "/stats");
+  add("GET", "/st");
+  add("GET", "/nodes");
+
+  EXPECT_EQ(lookup("GET", "/status"), "/status");
+  EXPECT_EQ(lookup("GET", "/stats"), "/stats");
+  EXPECT_EQ(lookup("GET", "/st"), "/st");
+  EXPECT_EQ(lookup("GET", "/nodes"), "/nodes");
+  EXPECT_EQ(lookup("GET", "/sta"), "");
+  EXPECT_EQ(lookup("GET", "/nodes/"), "");
+  EXPECT_EQ(router.size(), 4u);
+}
+
+TEST_F(HttpRouterTest, PathParameters) {
+  add("GET", "/nodes/:id");
+  add("GET", "/nodes/:id/peers/:peer");
+
+  EXPECT_EQ(lookup("GET", "/nodes/n1"), "/nodes/:id");
+  EXPECT_EQ(param("id"), "n1");
+
+  EXPECT_EQ(lookup("GET", "/nodes/n1/peers/n2"), "/nodes/:id/peers/:peer");
+  EXPECT_EQ(param("id"), "n1");
+  EXPECT_EQ(param("peer"), "n2");
+
+  EXPECT_EQ(lookup("GET", "/nodes/"), "");
+  EXPECT_EQ(lookup("GET", "/nodes/n1/peers"), "");
+}
+
+TEST_F(HttpRouterTest, StaticBeatsParameterBeatsWildcard) {
+  add("GET", "/files/index");
+  add("GET", "/files/:name");
+  add("GET", "/files/*path");
+
+  EXPECT_EQ(lookup("GET", "/files/index"), "/files/index");
+  EXPECT_EQ(lookup("GET", "/files/readme"), "/files/:name");
+  EXPECT_EQ(lookup("GET", "/files/docs/a.txt"), "/files/*path");
+  EXPECT_EQ(param("path"), "docs/a.txt");
+}
+
+TEST_F(HttpRouterTest, BacktracksOutOfDeadEnds) {
+  add("GET", "/api/:version/items");
+  add("GET", "/api/v1/users");
+
+  // The static "v1" branch has no "/items", so the parameter must win
+  EXPECT_EQ(lookup("GET", "/api/v1/items"), "/api/:version/items");
+  EXPECT_EQ(param("version"), "v1");
+  EXPECT_EQ(lookup("GET", "/api/v1/users"), "/api/v1/users");
+}
+
+TEST_F(HttpRouterTest, MethodsAndHeadFallback) {
+  add("GET", "/nodes/:id");
+  add("DELETE", "/nodes/:id");
+
+  const HttpRoute* route = nullptr;
+  EXPECT_EQ(router.find("PUT", "/nodes/n1", route, params),
+            HttpRouter::MATCH::METHOD_NOT_ALLOWED);
+  EXPECT_EQ(router.allowed("/nodes/n1"), "GET, DELETE");
+  EXPECT_EQ(lookup("HEAD", "/nodes/n1"), "/nodes/:id");
+  EXPECT_EQ(router.find("GET", "/missing", route, params),
+            HttpRouter::MATCH::NOT_FOUND);
+}
+
+TEST_F(HttpRouterTest, RejectsBadPatterns) {
+  add("GET", "/nodes/:id");
+  EXPECT_THROW(add("GET", "/nodes/:id"), std::invalid_argument);
+  EXPECT_THROW(add("GET", "/nodes/:name/x"), std::invalid_argument);
+  EXPECT_THROW(add("GET", "nodes"), std::invalid_argument);
+  EXPECT_THROW(add("GET", "/a:b"), std::invalid_argument);
+  EXPECT_THROW(add("GET", "/files/*path/more"), std::invalid_argument);
+  EXPECT_THROW(add("GET", "/x/:"), std::invalid_argument);
+}
+
+TEST(HttpResponseTest, BodyByReference) {
+  static const std::string document = "{\"cached\": true}";
+  HttpResponse response;
+  response.set_body_ref(document);
+  EXPECT_TRUE(response.by_ref);
+  EXPECT_EQ(response.body_ref.data(), document.data());
+
+  response.set_body("copy");
+  EXPECT_FALSE(response.by_ref);
+  EXPECT_EQ(response.body, "copy");
+}
+
+}  // namespace ya::module
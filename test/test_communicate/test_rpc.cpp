@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ya_communicate/module/rpc.h"
+
+namespace ya::module {
+
+namespace {
+
+enum class COLOR : uint8_t { RED, GREEN };
+
+struct Point {
+  int32_t x = 0;
+  int32_t y = 0;
+  YA_RPC_FIELDS(x, y)
+};
+
+struct Shape {
+  std::string name;
+  COLOR color = COLOR::RED;
+  bool filled = false;
+  double scale = 1.0;
+  std::vector<Point> points;
+  std::array<uint16_t, 2> tags{};
+  YA_RPC_FIELDS(name, color, filled, scale, points, tags)
+};
+
+struct AddRequest {
+  int64_t a = 0;
+  int64_t b = 0;
+  YA_RPC_FIELDS(a, b)
+};
+
+struct AddResponse {
+  int64_t sum = 0;
+  YA_RPC_FIELDS(sum)
+};
+
+struct Add {
+  static constexpr uint32_t ID = 1;
+  using Request = AddRequest;
+  using Response = AddResponse;
+};
+
+struct Fail {
+  static constexpr uint32_t ID = 2;
+  using Request = AddRequest;
+  using Response = AddResponse;
+};
+
+struct Missing {
+  static constexpr uint32_t ID = 99;
+  using Request = AddRequest;
+  using Response = AddResponse;
+};
+
+template <typename T>
+std::string encode(const T& value) {
+  std::string out(rpc_size(value), '\0');
+  char* end = rpc_encode(value, out.data());
+  EXPECT_EQ(end, out.data() + out.size());
+  return out;
+}
+
+}  // namespace
+
+TEST(RpcCodecTest, RoundTripsNestedStruct) {
+  Shape shape;
+  shape.name = "triangle";
+  shape.color = COLOR::GREEN;
+  shape.filled = true;
+  shape.scale = 2.5;
+  shape.points = {{0, 0}, {3, 0}, {0, -4}};
+  shape.tags = {7, 65535};
+
+  std::string bytes = encode(shape);
+  EXPECT_EQ(bytes.size(), 4 + 8 + 1 + 1 + 8 + 4 + 3 * 8 + 2 * 2);
+
+  Shape decoded;
+  std::string_view in = bytes;
+  ASSERT_TRUE(rpc_decode(in, decoded));
+  EXPECT_TRUE(in.empty());
+  EXPECT_EQ(decoded.name, "triangle");
+  EXPECT_EQ(decoded.color, COLOR::GREEN);
+  EXPECT_TRUE(decoded.filled);
+  EXPECT_EQ(decoded.scale, 2.5);
+  ASSERT_EQ(decoded.points.size(), 3u);
+  EXPECT_EQ(decoded.points[2].y, -4);
+  EXPECT_EQ(decoded.tags[1], 65535);
+}
+
+TEST(RpcCodecTest, LittleEndianIntegers) {
+  std::string bytes = encode(uint32_t{0x01020304});
+  EXPECT_EQ(bytes, std::string("\x04\x03\x02\x01", 4));
+}
+
+TEST(RpcCodecTest, RejectsTruncatedInput) {
+  Shape shape;
+  shape.name = "square";
+  shape.points = {{1, 1}, {2, 2}};
+  std::string bytes = encode(shape);
+
+  for (size_t size = 0; size < bytes.size(); ++size) {
+    Shape decoded;
+    std::string_view in(bytes.data(), size);
+    EXPECT_FALSE(rpc_decode(in, decoded)) << "size " << size;
+  }
+}
+
+TEST(RpcCodecTest, RejectsBogusLengths) {
+  // Claims four billion elements in a five byte message
+  std::string bytes("\xff\xff\xff\xff\x00", 5);
+  std::vector<uint8_t> values;
+  std::string_view in = bytes;
+  EXPECT_FALSE(rpc_decode(in, values));
+
+  std::string text;
+  in = bytes;
+  EXPECT_FALSE(rpc_decode(in, text));
+}
+
+TEST(RpcMethodTableTest, FindsRegisteredIds) {
+  RpcMethodTable table;
+  for (uint32_t id = 0; id < 100; ++id) {
+    table.add(id * 16, [id](std::string_view, RpcReply&) {
+      return id % 2 ? RPC_STATUS::OK : RPC_STATUS::BAD_REQUEST;
+    });
+  }
+  EXPECT_EQ(table.size(), 100u);
+  for (uint32_t id = 0; id < 100; ++id) {
+    const RpcRawHandler* handler = table.find(id * 16);
+    ASSERT_NE(handler, nullptr);
+  }
+  EXPECT_EQ(table.find(1), nullptr);
+  EXPECT_EQ(table.find(100 * 16), nullptr);
+  EXPECT_THROW(
+      table.add(32, [](std::string_view, RpcReply&) { return RPC_STATUS::OK; }),
+      std::invalid_argument);
+}
+
+TEST(RpcMethodTableTest, EmptyTable) {
+  RpcMethodTable table;
+  EXPECT_EQ(table.find(0), nullptr);
+}
+
+TEST(RpcTest, CallsTypedMethods) {
+  const std::string url = "tcp://127.0.0.1:19200";
+  RpcServer server(url);
+  server.add<Add>([](const AddRequest& r) { return AddResponse{r.a + r.b}; });
+  server.add<Fail>([](const AddRequest&) -> AddResponse {
+    throw std::runtime_error("nope");
+  });
+  EXPECT_THROW(server.add<Add>([](const AddRequest&) { return AddResponse{}; }),
+               std::invalid_argument);
+  server.start();
+  EXPECT_THROW(
+      server.add<Missing>([](const AddRequest&) { return AddResponse{}; }),
+      std::logic_error);
+
+  RpcClient client(url);
+  client.set_timeout(std::chrono::seconds(5));
+  EXPECT_EQ(client.call<Add>({40, 2}).sum, 42);
+
+  try {
+    client.call<Fail>({});
+    FAIL() << "Expected RpcError";
+  } catch (const RpcError& e) {
+    EXPECT_EQ(e.status(), RPC_STATUS::HANDLER_ERROR);
+    EXPECT_STREQ(e.what(), "nope");
+  }
+  try {
+    client.call<Missing>({});
+    FAIL() << "Expected RpcError";
+  } catch (const RpcError& e) {
+    EXPECT_EQ(e.status(), RPC_STATUS::UNKNOWN_METHOD);
+  }
+  server.stop();
+}
+
+TEST(RpcTest, ConcurrentCallers) {
+  const std::string url = "tcp://127.0.0.1:19201";
+  RpcServer server(url, {}, 4);
+  server.add<Add>([](const AddRequest& r) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    return AddResponse{r.a + r.b};
+  });
+  server.start();
+
+  RpcClient client(url);
+  client.set_timeout(std::chrono::seconds(5));
+  std::atomic<int> correct = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < 20; ++i) {
+        if (client.call<Add>({t, i}).sum == t + i) {
+          ++correct;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(correct, 80);
+  EXPECT_EQ(server.stats().messages_in.load(), 80u);
+}
+
+}  // namespace ya::module
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ya_communicate/module/runtime.h"
+
+namespace ya::module {
+
+TEST(RuntimeTest, ParsesCpuLists) {
+  EXPECT_EQ(Runtime::parse_cpu_list("0-3,8,10-11"),
+            (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(Runtime::parse_cpu_list("5,1,1-2"), (std::vector<int>{1, 2, 5}));
+  EXPECT_TRUE(Runtime::parse_cpu_list("").empty());
+  EXPECT_THROW(Runtime::parse_cpu_list("1-x"), std::invalid_argument);
+  EXPECT_THROW(Runtime::parse_cpu_list("3-1"), std::invalid_argument);
+  EXPECT_THROW(Runtime::parse_cpu_list("2a"), std::invalid_argument);
+}
+
+TEST(RuntimeTest, FormatsCpuLists) {
+  EXPECT_EQ(Runtime::format_cpu_list({0, 1, 2, 3, 8, 10, 11}), "0-3,8,10-11");
+  EXPECT_EQ(Runtime::format_cpu_list({4}), "4");
+  EXPECT_EQ(Runtime::format_cpu_list({}), "");
+}
+
+TEST(RuntimeTest, RecommendedSetsAreDisjoint) {
+  RuntimeOptions options = Runtime::recommended();
+  for (int cpu : options.io_cpus) {
+    EXPECT_EQ(std::count(options.app_cpus.begin(), options.app_cpus.end(), cpu),
+              0);
+  }
+  EXPECT_EQ(options.io_cpus.empty(), options.app_cpus.empty());
+  EXPECT_EQ(options.task_threads, static_cast<int>(options.io_cpus.size()));
+}
+
+TEST(RuntimeTest, RejectsUnknownCpus) {
+  RuntimeOptions options;
+  options.app_cpus = {1 << 20};
+  EXPECT_THROW(Runtime::instance().configure(options), std::runtime_error);
+}
+
+#if defined(__linux__)
+TEST(RuntimeTest, PinsAndReportsThreads) {
+  EXPECT_FALSE(Runtime::pin_current_thread({}));
+  ASSERT_TRUE(Runtime::pin_current_thread({0}));
+
+  auto threads = Runtime::placement();
+  ASSERT_FALSE(threads.empty());
+  bool found = std::any_of(threads.begin(), threads.end(), [](const auto& t) {
+    return t.cpus == std::vector<int>{0};
+  });
+  EXPECT_TRUE(found);
+  EXPECT_NE(Runtime::report().find("cpus=0"), std::string::npos);
+}
+#endif
+
+}  // namespace ya::module
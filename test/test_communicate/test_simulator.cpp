@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+
+#include <format>
+#include <iostream>
+
+#include "ya_communicate/arch/simulator.h"
+
+namespace ya::arch {
+
+namespace {
+
+MembershipOptions make_options(size_t index, const std::string& zone = "a") {
+  MembershipOptions options;
+  options.id = "node-" + std::to_string(index);
+  options.address = "sim://" + options.id;
+  options.region = "sim";
+  options.zone = zone;
+  return options;
+}
+
+// Every node knows all other nodes of its zone
+bool converged(Simulator& simulator, size_t zone_size) {
+  for (size_t i = 0; i < simulator.size(); ++i) {
+    if (simulator.node(i).addresses().size() != zone_size - 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t total_leaves(Simulator& simulator) {
+  uint64_t leaves = 0;
+  for (size_t i = 0; i < simulator.size(); ++i) {
+    leaves += simulator.node(i).stats().leaves;
+  }
+  return leaves;
+}
+
+}  // namespace
+
+TEST(SimulatorTest, ConvergesWithinOneAnnouncement) {
+  Simulator simulator;
+  for (size_t i = 0; i < 200; ++i) {
+    simulator.add_node(make_options(i));
+  }
+  ASSERT_TRUE(simulator.run_until([&] { return converged(simulator, 200); },
+                                  std::chrono::seconds(30)));
+  EXPECT_LE(simulator.elapsed(), std::chrono::milliseconds(1000));
+  EXPECT_EQ(total_leaves(simulator), 0u);
+}
+
+TEST(SimulatorTest, RunsAreDeterministic) {
+  auto run = [] {
+    SimOptions options;
+    options.seed = 42;
+    options.latency = std::chrono::milliseconds(5);
+    options.jitter = std::chrono::milliseconds(20);
+    options.loss = 0.1;
+    Simulator simulator(options);
+    for (size_t i = 0; i < 100; ++i) {
+      simulator.add_node(make_options(i));
+    }
+    simulator.run_until([&] { return converged(simulator, 100); },
+                        std::chrono::seconds(60));
+    auto elapsed = simulator.elapsed();
+    simulator.run_for(std::chrono::seconds(30));
+    return std::make_tuple(elapsed, simulator.stats().sent,
+                           simulator.stats().delivered,
+                           simulator.stats().dropped,
+                           simulator.node(7).stats().requests);
+  };
+  EXPECT_EQ(run(), run());
+}
+
+TEST(SimulatorTest, NoFalseEvictionsUnderLoss) {
+  SimOptions options;
+  options.loss = 0.05;
+  options.jitter = std::chrono::milliseconds(50);
+  Simulator simulator(options);
+  for (size_t i = 0; i < 100; ++i) {
+    simulator.add_node(make_options(i));
+  }
+  simulator.run_for(std::chrono::minutes(2));
+  EXPECT_TRUE(converged(simulator, 100));
+  EXPECT_EQ(total_leaves(simulator), 0u);
+}
+
+TEST(SimulatorTest, PartitionEvictsAndHealRejoins) {
+  Simulator simulator;
+  for (size_t i = 0; i < 40; ++i) {
+    simulator.add_node(make_options(i));
+  }
+  ASSERT_TRUE(simulator.run_until([&] { return converged(simulator, 40); },
+                                  std::chrono::seconds(30)));
+
+  for (size_t i = 20; i < 40; ++i) {
+    simulator.partition(i, 1);
+  }
+  auto split = simulator.elapsed();
+  ASSERT_TRUE(simulator.run_until([&] { return converged(simulator, 20); },
+                                  std::chrono::minutes(2)));
+  // Silent for a probe interval, then three failed probes
+  auto detection = simulator.elapsed() - split;
+  EXPECT_GE(detection, std::chrono::seconds(15));
+  EXPECT_LE(detection, std::chrono::seconds(25));
+
+  simulator.heal();
+  EXPECT_TRUE(simulator.run_until([&] { return converged(simulator, 40); },
+                                  std::chrono::seconds(30)));
+}
+
+// Node 1 probes too rarely to notice node 2 is gone and keeps offering it
+// in anti-entropy; node 0 drops it once and does not take it back
+TEST(SimulatorTest, StaleViewDoesNotRejoinEvicted) {
+  Simulator simulator;
+  for (size_t i = 0; i < 3; ++i) {
+    MembershipOptions options = make_options(i);
+    if (i == 1) {
+      options.probe_interval = std::chrono::minutes(10);
+    }
+    simulator.add_node(options);
+  }
+  ASSERT_TRUE(simulator.run_until([&] { return converged(simulator, 3); },
+                                  std::chrono::seconds(30)));
+
+  simulator.partition(2, 1);
+  simulator.run_for(std::chrono::minutes(2));
+  EXPECT_EQ(simulator.node(0).addresses(),
+            std::vector<std::string>{"sim://node-1"});
+  EXPECT_EQ(simulator.node(0).stats().joins, 2u);
+  EXPECT_EQ(simulator.node(0).stats().leaves, 1u);
+  EXPECT_GT(simulator.node(0).stats().synced, 0u);
+  EXPECT_EQ(simulator.node(1).addresses().size(), 2u);
+}
+
+// Announcements every 30 s: a late node learns the others from the first
+// anti-entropy round the announcement of its join sets off
+TEST(SimulatorTest, LateJoinerSyncsFullView) {
+  Simulator simulator;
+  for (size_t i = 0; i <= 50; ++i) {
+    MembershipOptions options = make_options(i);
+    options.announce_interval = std::chrono::seconds(30);
+    if (i < 50) {
+      simulator.add_node(options);
+    } else {
+      simulator.run_for(std::chrono::seconds(5));
+      ASSERT_TRUE(converged(simulator, 50));
+      simulator.add_node(options);
+    }
+  }
+  auto joined = simulator.elapsed();
+  ASSERT_TRUE(simulator.run_until([&] { return converged(simulator, 51); },
+                                  std::chrono::seconds(30)));
+  EXPECT_LE(simulator.elapsed() - joined, std::chrono::seconds(2));
+  EXPECT_EQ(simulator.node(50).stats().synced, 50u);
+  EXPECT_EQ(total_leaves(simulator), 0u);
+}
+
+// Once views agree a sync is a root hash and a one-word reply
+TEST(SimulatorTest, SyncTrafficFollowsDivergence) {
+  Simulator simulator;
+  for (size_t i = 0; i < 100; ++i) {
+    MembershipOptions options = make_options(i);
+    options.announce_interval = std::chrono::minutes(10);
+    options.probe_interval = std::chrono::minutes(10);
+    options.sync_interval = std::chrono::seconds(1);
+    simulator.add_node(options);
+  }
+  ASSERT_TRUE(simulator.run_until([&] { return converged(simulator, 100); },
+                                  std::chrono::seconds(30)));
+  simulator.run_for(std::chrono::seconds(5));
+
+  auto sent = simulator.stats().sent;
+  auto bytes = simulator.stats().bytes;
+  simulator.run_for(std::chrono::seconds(10));
+  // 100 nodes, 10 rounds each, a request and a reply per round
+  EXPECT_EQ(simulator.stats().sent - sent, 2000u);
+  EXPECT_LE(simulator.stats().bytes - bytes, 2000u * 40);
+}
+
+// 1000 nodes in 10 zones of 100. Every node only tracks its zone; every
+// zone learns of all others through a single seed.
+TEST(SimulatorTest, ThousandNodesInZones) {
+  SimOptions options;
+  options.latency = std::chrono::milliseconds(2);
+  options.jitter = std::chrono::milliseconds(3);
+  Simulator simulator(options);
+  for (size_t i = 0; i < 1000; ++i) {
+    simulator.add_node(make_options(i, "z" + std::to_string(i % 10)));
+    simulator.node(i).add_zone_seed("sim://node-0");
+  }
+
+  auto done = [&] {
+    if (!converged(simulator, 100)) {
+      return false;
+    }
+    for (size_t i = 0; i < simulator.size(); ++i) {
+      if (simulator.node(i).zones().size() != 10) {
+        return false;
+      }
+    }
+    return true;
+  };
+  ASSERT_TRUE(simulator.run_until(done, std::chrono::minutes(1)));
+  EXPECT_LE(simulator.elapsed(), std::chrono::seconds(15));
+
+  uint64_t requests = 0;
+  for (size_t i = 0; i < simulator.size(); ++i) {
+    requests += simulator.node(i).stats().requests;
+  }
+  std::cout << std::format(
+                   "1000 nodes converged in {} ms of virtual time: {} "
+                   "messages, {} requests",
+                   simulator.elapsed().count(), simulator.stats().sent,
+                   requests)
+            << std::endl;
+  EXPECT_EQ(simulator.node(0).regions().size(), 1u);
+  EXPECT_EQ(simulator.node(0).regions()[0].nodes, 1000u);
+}
+
+}  // namespace ya::arch
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#include "ya_communicate/module/pipeline.h"
+#include "ya_communicate/module/stats.h"
+
+namespace ya::module {
+
+TEST(StatsRegistryTest, PrometheusExport) {
+  auto stats = StatsRegistry::instance().create("test", "inproc://stats");
+  stats->on_send(10);
+  stats->on_receive(20);
+  stats->on_timeout();
+  stats->latency.Record(uint64_t{1500});
+
+  std::string labels = "module=\"test\",address=\"inproc://stats\",socket=\"" +
+                       std::to_string(stats->id) + "\"";
+  std::string text = StatsRegistry::instance().to_prometheus();
+  EXPECT_NE(text.find("# TYPE ya_socket_messages_total counter"),
+            std::string::npos);
+  EXPECT_NE(text.find("ya_socket_bytes_total{" + labels +
+                      ",direction=\"out\"} 10"),
+            std::string::npos);
+  EXPECT_NE(text.find("ya_socket_timeouts_total{" + labels + "} 1"),
+            std::string::npos);
+  EXPECT_NE(text.find("ya_socket_latency_seconds{" + labels +
+                      ",quantile=\"0.99\"} 1.5e-06"),
+            std::string::npos);
+  EXPECT_NE(text.find("ya_socket_latency_seconds_sum{" + labels + "} 1.5e-06"),
+            std::string::npos);
+
+  stats.reset();
+  text = StatsRegistry::instance().to_prometheus();
+  EXPECT_EQ(text.find("inproc://stats"), std::string::npos);
+}
+
+TEST(StatsRegistryTest, SocketsWithSameAddressGetOwnSeries) {
+  auto first = StatsRegistry::instance().create("test", "inproc://shared");
+  auto second = StatsRegistry::instance().create("test", "inproc://shared");
+  EXPECT_NE(first->id, second->id);
+  first->on_error();
+
+  std::string text = StatsRegistry::instance().to_prometheus();
+  std::string prefix =
+      "ya_socket_errors_total{module=\"test\",address=\"inproc://shared\","
+      "socket=\"";
+  EXPECT_NE(text.find(prefix + std::to_string(first->id) + "\"} 1"),
+            std::string::npos);
+  EXPECT_NE(text.find(prefix + std::to_string(second->id) + "\"} 0"),
+            std::string::npos);
+}
+
+TEST(StatsRegistryTest, AddressSetLaterKeepsCounters) {
+  auto stats = StatsRegistry::instance().create("test", "");
+  stats->on_error();
+  stats->set_address("inproc://late");
+
+  EXPECT_EQ(stats->address(), "inproc://late");
+  std::string text = StatsRegistry::instance().to_prometheus();
+  EXPECT_NE(text.find("ya_socket_errors_total{module=\"test\",address=\""
+                      "inproc://late\",socket=\"" +
+                      std::to_string(stats->id) + "\"} 1"),
+            std::string::npos);
+}
+
+TEST(SocketStatsTest, PipelineCounters) {
+  std::string address = "tcp://127.0.0.1:5591";
+  Pipeline puller(Pipeline::ROLE::PULLER, address);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  Pipeline pusher(Pipeline::ROLE::PUSHER, address);
+
+  std::thread receiver([&]() {
+    for (int i = 0; i < 3; ++i) {
+      puller.receive();
+    }
+  });
+  for (int i = 0; i < 3; ++i) {
+    pusher.send("hello");
+  }
+  receiver.join();
+
+  EXPECT_EQ(pusher.stats().messages_out.load(), 3u);
+  EXPECT_EQ(pusher.stats().bytes_out.load(), 15u);
+  EXPECT_EQ(pusher.stats().latency.Count(), 3u);
+  EXPECT_EQ(puller.stats().messages_in.load(), 3u);
+  EXPECT_EQ(puller.stats().queue_depth.load(), 0);
+}
+
+}  // namespace ya::module
@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "ya_communicate/module/router.h"
+#include "ya_communicate/module/status_feed.h"
+
+namespace ya::module {
+
+namespace {
+
+StatusEvent make_event(StatusEvent::TYPE type, const std::string& address,
+                       const std::string& info = "") {
+  return StatusEvent{type, NodeStatus{"id-" + address, address, 0, info}};
+}
+
+std::vector<StatusEvent> drain(StatusQueue& queue, bool* resync = nullptr) {
+  std::vector<StatusEvent> events;
+  bool flag = false;
+  queue.pop(events, flag);
+  if (resync != nullptr) {
+    *resync = flag;
+  }
+  return events;
+}
+
+// Keeps what is written; hold() makes the stream busy until complete()
+class FakeStream : public HttpPushStream {
+ public:
+  bool write(std::string_view chunk) override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_closed) {
+      return false;
+    }
+    m_chunks.emplace_back(chunk);
+    m_busy = m_hold;
+    return true;
+  }
+
+  bool open() const override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_closed;
+  }
+
+  bool busy() const override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_busy;
+  }
+
+  void on_ready(std::function<void()> callback) override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ready = std::move(callback);
+  }
+
+  void close() override {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+  }
+
+  void hold() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hold = true;
+  }
+
+  // The pending write went out
+  void complete() {
+    std::function<void()> ready;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_hold = false;
+      m_busy = false;
+      ready = m_ready;
+    }
+    ready();
+  }
+
+  // Client went away
+  void drop() {
+    close();
+    complete();
+  }
+
+  std::vector<std::string> chunks() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_chunks;
+  }
+
+  // Everything written so far
+  std::string text() const {
+    std::string all;
+    for (const auto& chunk : chunks()) {
+      all += chunk;
+    }
+    return all;
+  }
+
+ private:
+  mutable std::mutex m_mutex;
+  std::vector<std::string> m_chunks;
+  std::function<void()> m_ready;
+  bool m_hold = false;
+  bool m_busy = false;
+  bool m_closed = false;
+};
+
+// The writer thread delivers asynchronously
+bool eventually(const std::function<bool()>& condition) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+size_t count(const std::string& text, const std::string& what) {
+  size_t n = 0;
+  for (size_t at = text.find(what); at != std::string::npos;
+       at = text.find(what, at + what.size())) {
+    ++n;
+  }
+  return n;
+}
+
+}  // namespace
+
+TEST(StatusQueueTest, KeepsOrderAcrossNodes) {
+  StatusQueue queue(16);
+  queue.push(make_event(StatusEvent::TYPE::JOIN, "a"));
+  queue.push(make_event(StatusEvent::TYPE::JOIN, "b"));
+  queue.push(make_event(StatusEvent::TYPE::UPDATE, "c"));
+
+  auto events = drain(queue);
+  ASSERT_EQ(events.size(), 3u);
+  EXPECT_EQ(events[0].status.address, "a");
+  EXPECT_EQ(events[1].status.address, "b");
+  EXPECT_EQ(events[2].status.address, "c");
+  EXPECT_TRUE(drain(queue).empty());
+}
+
+TEST(StatusQueueTest, CoalescesPerNode) {
+  StatusQueue queue(16);
+  queue.push(make_event(StatusEvent::TYPE::JOIN, "a", "v1"));
+  queue.push(make_event(StatusEvent::TYPE::UPDATE, "a", "v2"));
+  queue.push(make_event(StatusEvent::TYPE::UPDATE, "b", "v1"));
+  queue.push(make_event(StatusEvent::TYPE::LEAVE, "b"));
+
+  auto events = drain(queue);
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].type, StatusEvent::TYPE::JOIN);  // Still new
+  EXPECT_EQ(events[0].status.info, "v2");
+  EXPECT_EQ(events[1].type, StatusEvent::TYPE::LEAVE);
+  EXPECT_EQ(queue.coalesced(), 2u);
+}
+
+TEST(StatusQueueTest, JoinThenLeaveCancels) {
+  StatusQueue queue(16);
+  queue.push(make_event(StatusEvent::TYPE::JOIN, "a"));
+  queue.push(make_event(StatusEvent::TYPE::LEAVE, "a"));
+  EXPECT_TRUE(drain(queue).empty());
+
+  // Rejoining afterwards is delivered once
+  queue.push(make_event(StatusEvent::TYPE::JOIN, "a"));
+  queue.push(make_event(StatusEvent::TYPE::LEAVE, "a"));
+  queue.push(make_event(StatusEvent::TYPE::JOIN, "a"));
+  auto events = drain(queue);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].type, StatusEvent::TYPE::JOIN);
+}
+
+TEST(StatusQueueTest, OverflowAsksForResync) {
+  StatusQueue queue(4);
+  for (int i = 0; i < 5; ++i) {
+    queue.push(make_event(StatusEvent::TYPE::JOIN, std::to_string(i)));
+  }
+  bool resync = false;
+  EXPECT_TRUE(drain(queue, &resync).empty());
+  EXPECT_TRUE(resync);
+  EXPECT_EQ(queue.dropped(), 5u);
+
+  queue.push(make_event(StatusEvent::TYPE::JOIN, "x"));
+  EXPECT_EQ(drain(queue, &resync).size(), 1u);
+  EXPECT_FALSE(resync);
+}
+
+TEST(StatusQueueTest, CloseEndsQueue) {
+  StatusQueue queue(4);
+  queue.close();
+  queue.push(make_event(StatusEvent::TYPE::JOIN, "a"));
+  std::vector<StatusEvent> events;
+  bool resync = false;
+  EXPECT_FALSE(queue.pop(events, resync));
+  EXPECT_TRUE(events.empty());
+}
+
+TEST(StatusFeedTest, MultipleListeners) {
+  StatusFeed feed;
+  std::vector<uint64_t> first;
+  std::vector<std::string> second;
+  size_t a = feed.subscribe(
+      [&](const StatusEvent& event) { first.push_back(event.seq); });
+  feed.subscribe([&](const StatusEvent& event) {
+    second.push_back(event.status.address);
+  });
+
+  feed.publish(make_event(StatusEvent::TYPE::JOIN, "a"));
+  feed.unsubscribe(a);
+  feed.publish(make_event(StatusEvent::TYPE::UPDATE, "a"));
+
+  EXPECT_EQ(first, std::vector<uint64_t>{1});
+  EXPECT_EQ(second, (std::vector<std::string>{"a", "a"}));
+
+  auto stats = feed.stats();
+  EXPECT_EQ(stats.published, 2u);
+  EXPECT_EQ(stats.listeners, 1u);
+}
+
+TEST(StatusFeedTest, ListenerMayUnsubscribeItself) {
+  StatusFeed feed;
+  int calls = 0;
+  size_t id = 0;
+  id = feed.subscribe([&](const StatusEvent&) {
+    ++calls;
+    feed.unsubscribe(id);
+  });
+  feed.publish(make_event(StatusEvent::TYPE::JOIN, "a"));
+  feed.publish(make_event(StatusEvent::TYPE::JOIN, "b"));
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(StatusFeedTest, StreamsSnapshotThenChanges) {
+  StatusFeed feed;
+  feed.set_snapshot(
+      [] { return std::vector<NodeStatus>{{"id-a", "a", 0, ""}}; });
+  auto out = std::make_shared<FakeStream>();
+  feed.serve(out);
+  EXPECT_EQ(feed.stats().clients, 1u);
+
+  feed.publish(make_event(StatusEvent::TYPE::JOIN, "b"));
+  ASSERT_TRUE(eventually([&] { return count(out->text(), "event:") == 2; }));
+  std::string text = out->text();
+  EXPECT_EQ(text.find("event: snapshot"), 0u);
+  EXPECT_NE(text.find("event: join\nid: 1\n"), std::string::npos);
+  EXPECT_NE(text.find("\"address\": \"b\""), std::string::npos);
+}
+
+TEST(StatusFeedTest, BusyClientGetsCoalescedChanges) {
+  StatusFeed feed;
+  auto out = std::make_shared<FakeStream>();
+  feed.serve(out);
+  feed.publish(make_event(StatusEvent::TYPE::UPDATE, "a", "1"));
+  ASSERT_TRUE(eventually([&] { return count(out->text(), "event:") == 1; }));
+
+  // While the first write is in flight, later changes wait in the queue
+  out->hold();
+  feed.publish(make_event(StatusEvent::TYPE::UPDATE, "a", "2"));
+  ASSERT_TRUE(eventually([&] { return count(out->text(), "event:") == 2; }));
+  ASSERT_TRUE(out->busy());
+  feed.publish(make_event(StatusEvent::TYPE::UPDATE, "a", "3"));
+  feed.publish(make_event(StatusEvent::TYPE::UPDATE, "a", "4"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(count(out->text(), "event:"), 2u);
+
+  out->complete();
+  ASSERT_TRUE(eventually([&] { return count(out->text(), "event:") == 3; }));
+  std::string last = out->chunks().back();
+  EXPECT_NE(last.find("\"info\": \"4\""), std::string::npos);
+  EXPECT_EQ(feed.stats().coalesced, 1u);
+}
+
+TEST(StatusFeedTest, IdleClientsAreNotWritten) {
+  StatusFeed feed;
+  std::vector<std::shared_ptr<FakeStream>> outs;
+  for (int i = 0; i < 100; ++i) {
+    outs.push_back(std::make_shared<FakeStream>());
+    feed.serve(outs.back());
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  for (const auto& out : outs) {
+    EXPECT_EQ(out->text(), "");
+  }
+  EXPECT_EQ(feed.stats().clients, 100u);
+}
+
+TEST(StatusFeedTest, GoneClientIsRemoved) {
+  StatusFeed feed;
+  auto out = std::make_shared<FakeStream>();
+  feed.serve(out);
+  out->drop();
+  ASSERT_TRUE(eventually([&] { return feed.stats().clients == 0; }));
+}
+
+TEST(StatusFeedTest, DisconnectClosesStreams) {
+  auto out = std::make_shared<FakeStream>();
+  {
+    StatusFeed feed;
+    feed.serve(out);
+    feed.disconnect_all();
+    EXPECT_EQ(feed.stats().clients, 0u);
+  }
+  EXPECT_FALSE(out->open());
+  out->complete();  // A late callback finds the feed gone
+}
+
+TEST(StatusFeedTest, JsonEscapes) {
+  NodeStatus status{"n\"1", "tcp://127.0.0.1:5555", 7, "a\\b"};
+  EXPECT_EQ(to_json(status),
+            "{\"id\": \"n\\\"1\", \"address\": \"tcp://127.0.0.1:5555\", "
+            "\"uptime\": 7, \"info\": \"a\\\\b\"}");
+}
+
+}  // namespace ya::module
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ya_communicate/arch/p2p.h"
+#include "ya_communicate/module/responder.h"
+#include "ya_communicate/module/zones.h"
+
+namespace ya::module {
+
+namespace {
+
+constexpr auto TTL = std::chrono::seconds(15);
+
+ZoneSummary make_summary(const std::string& region, const std::string& zone,
+                         uint64_t version, size_t nodes = 3) {
+  return ZoneSummary{region, zone,  "tcp://127.0.0.1:1000", nodes,
+                     nodes,  version};
+}
+
+}  // namespace
+
+TEST(ZonesTest, SummaryRoundTrip) {
+  ZoneSummary summary{"eu", "fra-1", "tls+tcp://10.0.0.1:5555", 12, 11,
+                      1700000000123};
+  auto decoded = ZoneSummary::decode(summary.encode());
+  ASSERT_TRUE(decoded);
+  EXPECT_EQ(decoded->key(), "eu/fra-1");
+  EXPECT_EQ(decoded->representative, summary.representative);
+  EXPECT_EQ(decoded->nodes, 12u);
+  EXPECT_EQ(decoded->healthy, 11u);
+  EXPECT_EQ(decoded->version, summary.version);
+
+  EXPECT_FALSE(ZoneSummary::decode("eu,fra-1,url,1,1"));
+  EXPECT_FALSE(ZoneSummary::decode("eu,fra-1,url,x,1,1"));
+}
+
+TEST(ZonesTest, KeepsNewestAndIgnoresOwnZone) {
+  ZoneDirectory directory("eu", "fra-1", TTL);
+  auto now = ZoneDirectory::Clock::now();
+  EXPECT_FALSE(directory.merge(make_summary("eu", "fra-1", 5), now));
+  EXPECT_TRUE(directory.merge(make_summary("us", "iad-1", 5, 3), now));
+  EXPECT_FALSE(directory.merge(make_summary("us", "iad-1", 4, 7), now));
+  EXPECT_TRUE(directory.merge(make_summary("us", "iad-1", 6, 9), now));
+
+  auto remote = directory.remote(now);
+  ASSERT_EQ(remote.size(), 1u);
+  EXPECT_EQ(remote[0].nodes, 9u);
+}
+
+TEST(ZonesTest, ForgetsSilentZones) {
+  ZoneDirectory directory("eu", "fra-1", TTL);
+  auto now = ZoneDirectory::Clock::now();
+  directory.merge(make_summary("us", "iad-1", 1), now);
+  directory.merge(make_summary("us", "sfo-1", 1), now + TTL / 2);
+
+  auto later = now + TTL;
+  auto remote = directory.remote(later);
+  ASSERT_EQ(remote.size(), 1u);
+  EXPECT_EQ(remote[0].zone, "sfo-1");
+}
+
+TEST(ZonesTest, ExchangePassesOnOtherZones) {
+  auto now = ZoneDirectory::Clock::now();
+  ZoneDirectory a("eu", "fra-1", TTL);
+  ZoneDirectory b("us", "iad-1", TTL);
+  a.merge(make_summary("ap", "sin-1", 1), now);
+
+  // b hears from a about a's zone and about sin-1
+  EXPECT_EQ(b.merge_all(a.encode(make_summary("eu", "fra-1", 1), now), now),
+            2u);
+  EXPECT_EQ(b.remote(now).size(), 2u);
+  EXPECT_EQ(b.merge_all("garbage;;eu,fra-1", now), 0u);
+}
+
+TEST(ZonesTest, AggregatesRegions) {
+  auto now = ZoneDirectory::Clock::now();
+  ZoneDirectory directory("eu", "fra-1", TTL);
+  directory.merge(make_summary("eu", "ams-1", 1, 4), now);
+  directory.merge(make_summary("us", "iad-1", 1, 5), now);
+
+  auto regions = directory.regions(make_summary("eu", "fra-1", 1, 3), now);
+  ASSERT_EQ(regions.size(), 2u);
+  EXPECT_EQ(regions[0].region, "eu");
+  EXPECT_EQ(regions[0].zones, 2u);
+  EXPECT_EQ(regions[0].nodes, 7u);
+  EXPECT_EQ(regions[1].region, "us");
+  EXPECT_EQ(regions[1].nodes, 5u);
+}
+
+TEST(ZonesTest, ElectsLowestId) {
+  EXPECT_EQ(ZoneDirectory::elect({{"node-b", "url-b"},
+                                  {"node-a", "url-a"},
+                                  {"node-c", "url-c"}}),
+            "url-a");
+  EXPECT_EQ(ZoneDirectory::elect({}), "");
+}
+
+// Three single-node zones in two regions over loopback: the seeds only
+// point at the first zone, the others are learned through it.
+TEST(ZonesTest, RepresentativesExchangeOverLoopback) {
+  arch::P2P fra("fra", "tcp://127.0.0.1:27101", "tcp://127.0.0.1:27201");
+  arch::P2P ams("ams", "tcp://127.0.0.1:27102", "tcp://127.0.0.1:27202");
+  arch::P2P iad("iad", "tcp://127.0.0.1:27103", "tcp://127.0.0.1:27203");
+  fra.set_zone("eu", "fra-1");
+  ams.set_zone("eu", "ams-1");
+  iad.set_zone("us", "iad-1");
+  ams.add_zone_seed("tcp://127.0.0.1:27101");
+  iad.add_zone_seed("tcp://127.0.0.1:27101");
+
+  fra.start();
+  ams.start();
+  iad.start();
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+  while (std::chrono::steady_clock::now() < deadline &&
+         (fra.get_zones().size() < 3 || ams.get_zones().size() < 3 ||
+          iad.get_zones().size() < 3)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  EXPECT_TRUE(fra.is_zone_representative());
+  EXPECT_EQ(fra.get_zones().size(), 3u);
+  EXPECT_EQ(ams.get_zones().size(), 3u);
+  EXPECT_EQ(iad.get_zones().size(), 3u);
+
+  auto regions = iad.get_regions();
+  ASSERT_EQ(regions.size(), 2u);
+  EXPECT_EQ(regions[0].region, "eu");
+  EXPECT_EQ(regions[0].zones, 2u);
+  EXPECT_EQ(regions[1].nodes, 1u);
+
+  // Membership stays per zone
+  EXPECT_TRUE(fra.get_known_nodes().empty());
+
+  iad.stop();
+  ams.stop();
+  fra.stop();
+}
+
+// Seeds that take requests but never answer each hold a request for the
+// peer timeout (2 s); they must not hold up the exchange with the live one
+TEST(ZonesTest, SilentSeedsDoNotDelayExchange) {
+  std::vector<std::unique_ptr<Reponder>> silent;
+  arch::P2P fra("fra", "tcp://127.0.0.1:27111", "tcp://127.0.0.1:27211");
+  arch::P2P iad("iad", "tcp://127.0.0.1:27112", "tcp://127.0.0.1:27212");
+  fra.set_zone("eu", "fra-1");
+  iad.set_zone("us", "iad-1");
+  for (int port = 27121; port <= 27123; ++port) {
+    std::string url = "tcp://127.0.0.1:" + std::to_string(port);
+    silent.push_back(std::make_unique<Reponder>(url));
+    iad.add_zone_seed(url);
+  }
+  iad.add_zone_seed("tcp://127.0.0.1:27111");
+
+  fra.start();
+  auto start = std::chrono::steady_clock::now();
+  iad.start();
+  while (std::chrono::steady_clock::now() - start < std::chrono::seconds(10) &&
+         iad.get_zones().size() < 2) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  EXPECT_EQ(iad.get_zones().size(), 2u);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+  iad.stop();
+  fra.stop();
+}
+
+}  // namespace ya::module
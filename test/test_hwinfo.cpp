@@ -33,6 +33,22 @@ TEST(HwinfoTest, CPU) {
             << std::endl;
 }
 
+TEST(HwinfoTest, CPUTopology) {
+  ya::YaHwinfo info;
+  auto topology = info.getCPUTopology();
+  std::cout << std::format(
+                   "CPU topology:\n"
+                   "logical:       {}\n"
+                   "cores:         {}\n"
+                   "packages:      {}\n"
+                   "numa_nodes:    {}\n",
+                   topology.logical.size(), topology.cores, topology.packages,
+                   topology.numa_nodes)
+            << std::endl;
+  EXPECT_FALSE(topology.logical.empty());
+  EXPECT_LE(topology.cores, static_cast<int>(topology.logical.size()));
+}
+
 TEST(HwinfoTest, DISK) {
   ya::YaHwinfo info;
   auto disk = info.getDISK();
@@ -106,6 +106,22 @@ TEST_F(YaSqlTest, QueryMultipleRows) {
   EXPECT_EQ(results[1]["name"], "Frank");
 }
 
+TEST_F(YaSqlTest, QueryIntoResource) {
+  std::map<std::string, std::string> data1 = {{"name", "Grace"}, {"age", "41"}};
+  std::map<std::string, std::string> data2 = {{"name", "Heidi"}, {"age", "29"}};
+  ASSERT_TRUE(driver.insert("users", data1));
+  ASSERT_TRUE(driver.insert("users", data2));
+
+  std::pmr::monotonic_buffer_resource resource;
+  auto results = driver.query("SELECT * FROM users ORDER BY name", &resource);
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].at("name"), "Grace");
+  EXPECT_EQ(results[1].at("age"), "29");
+  EXPECT_EQ(results.get_allocator().resource(), &resource);
+  EXPECT_EQ(results[0].get_allocator().resource(), &resource);
+  EXPECT_EQ(results[0].at("name").get_allocator().resource(), &resource);
+}
+
 // Mock-based test for delegation
 TEST(YaSqlMockTest, DelegatesToDriver) {
   ya::YaSql driver;
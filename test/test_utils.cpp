@@ -1,7 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <filesystem>
 #include <format>
+#include <fstream>
 #include <iostream>
+#include <set>
+#include <thread>
 
 #include "yautils.h"
 
@@ -57,6 +65,224 @@ TEST(TimerTest, SleepAccuracy) {
   EXPECT_LE(elapsed_ms, 1100);
 }
 
+TEST(TimerTest, InstanceAccuracy) {
+  ya::YaUtils::Timer timer;
+  ya::YaUtils::Timer::Sleep(100);
+  double elapsed_ms = timer.GetElapsed_ms();
+  std::cout << std::format("Elapsed: {} ms, TSC: {}", elapsed_ms,
+                           ya::YaUtils::Timer::UsesTsc())
+            << std::endl;
+  EXPECT_GE(elapsed_ms, 95);
+  EXPECT_LE(elapsed_ms, 150);
+
+  timer.Restart();
+  EXPECT_LT(timer.GetElapsed_ms(), 50);
+}
+
+TEST(TimerTest, TicksMatchSteadyClock) {
+  auto begin = std::chrono::steady_clock::now();
+  uint64_t first = ya::YaUtils::Timer::Ticks();
+  ya::YaUtils::Timer::Sleep(200);
+  uint64_t last = ya::YaUtils::Timer::Ticks();
+  auto end = std::chrono::steady_clock::now();
+
+  double expected =
+      std::chrono::duration<double, std::nano>(end - begin).count();
+  double measured = ya::YaUtils::Timer::TicksToNs(last - first);
+  EXPECT_NEAR(measured, expected, expected * 0.02);
+}
+
+TEST(TimerTest, ScopedTimerAccumulates) {
+  uint64_t ticks = 0;
+  std::atomic<uint64_t> shared_ticks{0};
+  for (int i = 0; i < 3; ++i) {
+    ya::YaUtils::ScopedTimer timer(ticks);
+    ya::YaUtils::ScopedTimer shared_timer(shared_ticks);
+    ya::YaUtils::Timer::Sleep(20);
+  }
+  EXPECT_GE(ya::YaUtils::Timer::TicksToNs(ticks), 55'000'000.0);
+  EXPECT_LE(shared_ticks.load(), ticks);  // Started later, ended sooner
+}
+
+TEST(TimerTest, NamedTimersAcrossThreads) {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([t] {
+      std::string id = "worker-" + std::to_string(t);
+      for (int i = 0; i < 1000; ++i) {
+        ya::YaUtils::Timer::StartTimer(id);
+        EXPECT_GE(ya::YaUtils::Timer::GetElapsedTime_μs(id), 0.0);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(ya::YaUtils::Timer::GetElapsedTime_ms("never-started"), 0.0);
+}
+
+TEST(TimerTest, ReadingCost) {
+  constexpr int ROUNDS = 1'000'000;
+  ya::YaUtils::Timer total;
+  uint64_t sink = 0;
+  for (int i = 0; i < ROUNDS; ++i) {
+    sink += ya::YaUtils::Timer::Ticks();
+  }
+  double per_read = total.GetElapsed_ns() / ROUNDS;
+  std::cout << std::format("Ticks(): {} ns per call", per_read) << std::endl;
+  EXPECT_NE(sink, 0u);
+  EXPECT_LT(per_read, 200.0);
+}
+
+TEST(HistogramTest, BucketsKeepPrecision) {
+  using Histogram = ya::YaUtils::Histogram;
+  for (uint64_t value : {uint64_t{0}, uint64_t{1}, uint64_t{31}, uint64_t{63},
+                         uint64_t{64}, uint64_t{1000}, uint64_t{123456789},
+                         Histogram::MAX_VALUE}) {
+    size_t bucket = Histogram::BucketOf(value);
+    ASSERT_LT(bucket, Histogram::BUCKETS);
+    uint64_t top = Histogram::BucketTop(bucket);
+    EXPECT_GE(top, value);
+    EXPECT_LE(static_cast<double>(top - value), value / 32.0 + 1);
+    if (bucket > 0) {
+      EXPECT_LT(Histogram::BucketTop(bucket - 1), value);
+    }
+  }
+  EXPECT_EQ(Histogram::BucketOf(Histogram::MAX_VALUE + 1),
+            Histogram::BUCKETS - 1);
+}
+
+TEST(HistogramTest, Percentiles) {
+  ya::YaUtils::Histogram histogram;
+  EXPECT_EQ(histogram.Percentile(50), 0u);
+  for (uint64_t i = 1; i <= 10'000; ++i) {
+    histogram.Record(i * 1000);
+  }
+  EXPECT_EQ(histogram.Count(), 10'000u);
+  EXPECT_EQ(histogram.Min(), 1000u);
+  EXPECT_EQ(histogram.Max(), 10'000'000u);
+  EXPECT_NEAR(histogram.Mean(), 5'000'500.0, 1.0);
+  EXPECT_NEAR(histogram.Percentile(50), 5'000'000.0, 5'000'000.0 * 0.04);
+  EXPECT_NEAR(histogram.Percentile(99), 9'900'000.0, 9'900'000.0 * 0.04);
+  EXPECT_EQ(histogram.Percentile(100), 10'000'000u);
+
+  ya::YaUtils::Histogram other;
+  other.Record(5);
+  other.Merge(histogram);
+  EXPECT_EQ(other.Count(), 10'001u);
+  EXPECT_EQ(other.Min(), 5u);
+  other.Reset();
+  EXPECT_EQ(other.Count(), 0u);
+}
+
+TEST(HistogramTest, SumAndDurations) {
+  ya::YaUtils::Histogram histogram;
+  histogram.Record(std::chrono::microseconds(3));
+  histogram.Record(std::chrono::nanoseconds(-5));
+  histogram.Record(UINT64_MAX);
+  EXPECT_EQ(histogram.Count(), 3u);
+  EXPECT_EQ(histogram.Min(), 0u);
+  EXPECT_EQ(histogram.Max(), ya::YaUtils::Histogram::MAX_VALUE);
+  EXPECT_EQ(histogram.Sum(), 3000u + ya::YaUtils::Histogram::MAX_VALUE);
+}
+
+TEST(ProfilerTest, ThreadsMerge) {
+  ya::YaUtils::Profiler profiler;
+  auto& probe = profiler.GetProbe("work");
+  EXPECT_EQ(&probe, &profiler.GetProbe("work"));
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&probe, t] {
+      for (uint64_t i = 0; i < 10'000; ++i) {
+        probe.Record(100 * (t + 1));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // A later thread reuses a histogram instead of adding one
+  std::thread([&probe] { probe.Record(100); }).join();
+
+  auto histogram = probe.Collect();
+  EXPECT_EQ(histogram.Count(), 80'001u);
+  EXPECT_EQ(histogram.Min(), 100u);
+  EXPECT_EQ(histogram.Max(), 800u);
+
+  auto snapshots = profiler.Collect();
+  ASSERT_EQ(snapshots.size(), 1u);
+  EXPECT_EQ(snapshots[0].name, "work");
+  EXPECT_EQ(snapshots[0].count, 80'001u);
+
+  profiler.Reset();
+  EXPECT_EQ(probe.Collect().Count(), 0u);
+}
+
+TEST(ProfilerTest, Dumps) {
+  ya::YaUtils::Profiler profiler;
+  profiler.GetProbe("sql.query").Record(2000);
+  profiler.GetProbe("say \"hi\"").Record(10);
+
+  std::string json = profiler.DumpJson();
+  std::cout << json << std::endl;
+  EXPECT_NE(json.find("{\"name\":\"sql.query\",\"count\":1,"),
+            std::string::npos);
+  EXPECT_NE(json.find("say \\\"hi\\\""), std::string::npos);
+
+  std::string text = profiler.DumpPrometheus();
+  std::cout << text << std::endl;
+  EXPECT_EQ(text.rfind("# TYPE ya_latency_ns summary\n", 0), 0u);
+  EXPECT_NE(text.find("ya_latency_ns{probe=\"sql.query\",quantile=\"0.99\"} "
+                      "2000\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("ya_latency_ns_count{probe=\"sql.query\"} 1\n"),
+            std::string::npos);
+}
+
+TEST(ProfilerTest, Reporter) {
+  ya::YaUtils::Profiler profiler;
+  profiler.GetProbe("tick").Record(1);
+  std::atomic<int> reports{0};
+  profiler.StartReporter(std::chrono::milliseconds(10),
+                         [&](const auto& snapshots) {
+                           EXPECT_EQ(snapshots.size(), 1u);
+                           ++reports;
+                         });
+  ya::YaUtils::Timer::Sleep(100);
+  profiler.StopReporter();
+  int seen = reports;
+  EXPECT_GE(seen, 3);
+  ya::YaUtils::Timer::Sleep(30);
+  EXPECT_EQ(reports, seen);
+}
+
+TEST(ProfilerTest, ScopeMacro) {
+  for (int i = 0; i < 3; ++i) {
+    YA_PROFILE_SCOPE("test.scope");
+    ya::YaUtils::Timer::Sleep(1);
+  }
+#if defined(YA_UTILS_PROFILE)
+  auto histogram =
+      ya::YaUtils::Profiler::Instance().GetProbe("test.scope").Collect();
+  EXPECT_EQ(histogram.Count(), 3u);
+  EXPECT_GE(histogram.Min(), 1'000'000u);
+#endif
+}
+
+TEST(ProfilerTest, RecordingCost) {
+  constexpr int ROUNDS = 1'000'000;
+  auto& probe = ya::YaUtils::Profiler::Instance().GetProbe("test.cost");
+  ya::YaUtils::Timer total;
+  for (int i = 0; i < ROUNDS; ++i) {
+    probe.Record(i);
+  }
+  double per_record = total.GetElapsed_ns() / ROUNDS;
+  std::cout << std::format("Record(): {} ns per call", per_record)
+            << std::endl;
+  EXPECT_LT(per_record, 500.0);
+}
+
 TEST(PlatformTest, Macro) {
   auto platform = ya::YaUtils::Platform::GetPlatform();
   switch (platform) {
@@ -75,6 +301,19 @@ TEST(PlatformTest, Macro) {
   }
 }
 
+TEST(CpuListTest, ParseAndFormat) {
+  using CpuList = ya::YaUtils::CpuList;
+  EXPECT_EQ(CpuList::Parse("0-3,8,10-11"),
+            (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(CpuList::Parse("5,1-2,2"), (std::vector<int>{1, 2, 5}));
+  EXPECT_TRUE(CpuList::Parse("").empty());
+  for (const char* bad : {"a", "1-", "3-1", "-1", "1x", "1-2-3"}) {
+    EXPECT_THROW(CpuList::Parse(bad), std::invalid_argument) << bad;
+  }
+  EXPECT_EQ(CpuList::Format({11, 0, 1, 2, 3, 8, 10, 3}), "0-3,8,10-11");
+  EXPECT_EQ(CpuList::Format({}), "");
+}
+
 // Test fixture for Crypto class
 class CryptoTest : public ::testing::Test {
  protected:
@@ -260,3 +499,1119 @@ TEST_F(CryptoTest, DSA_Verify_WrongKey) {
   ya::YaUtils::CryptoBuffer wrong_key(100, 'X');  // Invalid public key
   EXPECT_FALSE(crypto.DSA_Verify(wrong_key, plaintext, *signature));
 }
+
+// Streaming cipher Tests
+class CipherTest : public ::testing::Test {
+ protected:
+  using Cipher = ya::YaUtils::Cipher;
+
+  // Encrypts in uneven chunks, then decrypts in others
+  std::string RoundTrip(Cipher::ALGO algo, const std::string& data,
+                        size_t encrypt_chunk, size_t decrypt_chunk) {
+    Cipher cipher(algo);
+    std::string iv(cipher.IvSize(), 'I');
+    ya::YaUtils::CryptoBuffer ciphertext(data.size() + cipher.BlockSize());
+    std::span<unsigned char> out(ciphertext);
+    EXPECT_TRUE(cipher.EncryptInit(key, iv));
+    size_t written = 0;
+    for (size_t i = 0; i < data.size(); i += encrypt_chunk) {
+      auto n = cipher.Update(std::string_view(data).substr(i, encrypt_chunk),
+                             out.subspan(written));
+      EXPECT_TRUE(n.has_value());
+      written += n.value_or(0);
+    }
+    written += cipher.Final(out.subspan(written)).value_or(0);
+    ciphertext.resize(written);
+    unsigned char tag[Cipher::TAG_SIZE];
+    EXPECT_EQ(cipher.GetTag(tag), cipher.IsAead());
+
+    std::string plaintext(ciphertext.size() + cipher.BlockSize(), '\0');
+    std::span<unsigned char> back(
+        reinterpret_cast<unsigned char*>(plaintext.data()), plaintext.size());
+    EXPECT_TRUE(cipher.DecryptInit(key, iv));
+    written = 0;
+    for (size_t i = 0; i < ciphertext.size(); i += decrypt_chunk) {
+      auto in = std::span<const unsigned char>(ciphertext).subspan(
+          i, std::min(decrypt_chunk, ciphertext.size() - i));
+      written += cipher.Update(in, back.subspan(written)).value_or(0);
+    }
+    if (cipher.IsAead()) {
+      EXPECT_TRUE(cipher.SetTag(tag));
+    }
+    auto last = cipher.Final(back.subspan(written));
+    EXPECT_TRUE(last.has_value());
+    plaintext.resize(written + last.value_or(0));
+    return plaintext;
+  }
+
+  std::string key = std::string(32, 'K');
+  std::string data = std::string(100'000, 'x') + "tail";
+};
+
+TEST_F(CipherTest, StreamingRoundTrip) {
+  for (auto algo : {Cipher::ALGO::AES_256_CBC, Cipher::ALGO::AES_256_CTR,
+                    Cipher::ALGO::AES_256_GCM,
+                    Cipher::ALGO::CHACHA20_POLY1305}) {
+    EXPECT_EQ(RoundTrip(algo, data, 4096, 777), data);
+    EXPECT_EQ(RoundTrip(algo, data, 1, data.size()).size(), data.size());
+  }
+}
+
+TEST_F(CipherTest, MatchesOneShotCbc) {
+  ya::YaUtils::Crypto crypto;
+  std::string iv(16, 'I');
+  ya::YaUtils::CryptoBuffer expected;
+  ASSERT_TRUE(crypto.AES_Encrypt(data, key, iv, expected));
+
+  Cipher cipher(Cipher::ALGO::AES_256_CBC);
+  ya::YaUtils::CryptoBuffer out(data.size() + cipher.BlockSize());
+  ASSERT_TRUE(cipher.EncryptInit(key, iv));
+  size_t written = *cipher.Update(data, out);
+  written += *cipher.Final(std::span<unsigned char>(out).subspan(written));
+  out.resize(written);
+  EXPECT_EQ(out, expected);
+}
+
+TEST_F(CipherTest, AeadInPlaceAndRestart) {
+  Cipher cipher(Cipher::ALGO::AES_256_GCM);
+  ya::YaUtils::CryptoBuffer buffer(data.begin(), data.end());
+  unsigned char first_tag[Cipher::TAG_SIZE];
+  ASSERT_TRUE(cipher.EncryptInit(key, std::string(12, '1')));
+  ASSERT_TRUE(cipher.SetAad("header"));
+  ASSERT_EQ(cipher.Update(buffer, buffer), data.size());
+  ASSERT_EQ(cipher.Final({}), 0u);
+  ASSERT_TRUE(cipher.GetTag(first_tag));
+  EXPECT_NE(std::string(buffer.begin(), buffer.end()), data);
+
+  // A second message under the same key only changes the IV
+  ya::YaUtils::CryptoBuffer second(data.begin(), data.end());
+  unsigned char second_tag[Cipher::TAG_SIZE];
+  ASSERT_TRUE(cipher.Restart(std::string(12, '2')));
+  ASSERT_EQ(cipher.Update(second, second), data.size());
+  ASSERT_TRUE(cipher.Final({}));
+  ASSERT_TRUE(cipher.GetTag(second_tag));
+  EXPECT_NE(second, buffer);
+
+  ASSERT_TRUE(cipher.DecryptInit(key, std::string(12, '1')));
+  ASSERT_TRUE(cipher.SetAad("header"));
+  ASSERT_EQ(cipher.Update(buffer, buffer), data.size());
+  ASSERT_TRUE(cipher.SetTag(first_tag));
+  ASSERT_TRUE(cipher.Final({}));
+  EXPECT_EQ(std::string(buffer.begin(), buffer.end()), data);
+}
+
+TEST_F(CipherTest, AeadRejectsTampering) {
+  ya::YaUtils::Crypto crypto;
+  std::string iv(12, 'N');
+  for (bool chacha : {false, true}) {
+    ya::YaUtils::CryptoBuffer sealed;
+    auto seal = [&](std::string_view aad) {
+      return chacha ? crypto.ChaCha20_Poly1305_Encrypt(data, key, iv, aad,
+                                                       sealed)
+                    : crypto.AES_GCM_Encrypt(data, key, iv, aad, sealed);
+    };
+    auto open = [&](const ya::YaUtils::CryptoBuffer& in, std::string_view aad,
+                    std::string& out) {
+      return chacha
+                 ? crypto.ChaCha20_Poly1305_Decrypt(in, key, iv, aad, out)
+                 : crypto.AES_GCM_Decrypt(in, key, iv, aad, out);
+    };
+    ASSERT_TRUE(seal("aad"));
+    EXPECT_EQ(sealed.size(), data.size() + Cipher::TAG_SIZE);
+
+    std::string plaintext;
+    ASSERT_TRUE(open(sealed, "aad", plaintext));
+    EXPECT_EQ(plaintext, data);
+
+    EXPECT_FALSE(open(sealed, "other", plaintext));
+    EXPECT_TRUE(plaintext.empty());
+    auto flipped = sealed;
+    flipped[10] ^= 1;
+    EXPECT_FALSE(open(flipped, "aad", plaintext));
+    flipped = sealed;
+    flipped.back() ^= 1;
+    EXPECT_FALSE(open(flipped, "aad", plaintext));
+  }
+}
+
+TEST_F(CipherTest, RejectsBadArguments) {
+  Cipher cipher(Cipher::ALGO::AES_256_CBC);
+  EXPECT_FALSE(cipher.EncryptInit("short", std::string(16, 'I')));
+  EXPECT_FALSE(cipher.EncryptInit(key, "short"));
+  unsigned char out[8];
+  EXPECT_FALSE(cipher.Update(data, out).has_value());  // Not initialized
+
+  ASSERT_TRUE(cipher.EncryptInit(key, std::string(16, 'I')));
+  EXPECT_FALSE(cipher.SetAad("aad"));                  // Not AEAD
+  EXPECT_FALSE(cipher.Update("0123456789", out).has_value());  // No room
+  unsigned char tag[Cipher::TAG_SIZE];
+  EXPECT_FALSE(cipher.GetTag(tag));
+}
+
+class KeyTest : public ::testing::Test {
+ protected:
+  using Key = ya::YaUtils::Key;
+  using KeyCache = ya::YaUtils::KeyCache;
+
+  void SetUp() override {
+    ASSERT_TRUE(crypto.Generate_RSA_Key(public_pem, private_pem));
+  }
+
+  ya::YaUtils::Crypto crypto;
+  ya::YaUtils::CryptoBuffer public_pem, private_pem;
+  std::string data = "Hello, World!";
+};
+
+TEST_F(KeyTest, LoadOnceUseMany) {
+  auto public_key = Key::LoadPublic(public_pem);
+  auto private_key = Key::LoadPrivate(private_pem);
+  ASSERT_TRUE(public_key && private_key);
+  EXPECT_EQ(public_key->GetType(), Key::TYPE::RSA);
+  EXPECT_FALSE(public_key->IsPrivate());
+  EXPECT_TRUE(private_key->IsPrivate());
+  EXPECT_EQ(public_key->Fingerprint().size(), 64u);
+  EXPECT_EQ(public_key->Fingerprint(), private_key->Fingerprint());
+
+  for (int i = 0; i < 3; ++i) {
+    auto signature = crypto.Sign(*private_key, data);
+    ASSERT_TRUE(signature.has_value());
+    EXPECT_TRUE(crypto.Verify(*public_key, data, *signature));
+    EXPECT_FALSE(crypto.Verify(*public_key, "other", *signature));
+    // Same wire format as the PEM calls
+    EXPECT_TRUE(crypto.DSA_Verify(public_pem, data, *signature));
+
+    auto ciphertext = crypto.RSA_Encrypt(*public_key, data);
+    ASSERT_TRUE(ciphertext.has_value());
+    EXPECT_EQ(crypto.RSA_Decrypt(*private_key, *ciphertext), data);
+    EXPECT_EQ(crypto.RSA_Decrypt(private_pem, *ciphertext), data);
+  }
+
+  // A public key cannot sign or decrypt
+  EXPECT_FALSE(crypto.Sign(*public_key, data).has_value());
+}
+
+TEST_F(KeyTest, RejectsInvalidPem) {
+  ya::YaUtils::CryptoBuffer invalid(100, 'X');
+  EXPECT_FALSE(Key::LoadPublic(invalid).has_value());
+  EXPECT_FALSE(Key::LoadPrivate(invalid).has_value());
+  EXPECT_FALSE(Key::LoadPrivate(public_pem).has_value());
+
+  KeyCache cache;
+  EXPECT_FALSE(cache.GetPublic(invalid).has_value());
+  EXPECT_EQ(cache.Size(), 0u);
+}
+
+TEST_F(KeyTest, CacheHitsAndEvicts) {
+  auto cache = std::make_shared<KeyCache>(2);
+  crypto.SetKeyCache(cache);
+
+  auto signature = crypto.DSA_Sign(private_pem, data);
+  ASSERT_TRUE(signature.has_value());
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(crypto.DSA_Verify(public_pem, data, *signature));
+  }
+  auto stats = cache->GetStats();
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.hits, 9u);
+  EXPECT_EQ(cache->Size(), 2u);
+
+  // A third key pushes out the least recently used one, the private key
+  ya::YaUtils::CryptoBuffer other_public, other_private;
+  ASSERT_TRUE(crypto.Generate_RSA_Key(other_public, other_private));
+  EXPECT_TRUE(cache->GetPublic(other_public).has_value());
+  EXPECT_EQ(cache->GetStats().evictions, 1u);
+  EXPECT_TRUE(cache->GetPublic(public_pem).has_value());
+  EXPECT_EQ(cache->GetStats().misses, 3u);
+  EXPECT_TRUE(cache->GetPrivate(private_pem).has_value());
+  EXPECT_EQ(cache->GetStats().misses, 4u);
+
+  cache->Clear();
+  EXPECT_EQ(cache->Size(), 0u);
+}
+
+TEST_F(KeyTest, SharedAcrossThreads) {
+  auto cache = std::make_shared<KeyCache>();
+  auto signature = crypto.DSA_Sign(private_pem, data);
+  ASSERT_TRUE(signature.has_value());
+
+  std::atomic<int> verified{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      ya::YaUtils::Crypto local;
+      local.SetKeyCache(cache);
+      for (int i = 0; i < 50; ++i) {
+        verified += local.DSA_Verify(public_pem, data, *signature) ? 1 : 0;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(verified, 200);
+  EXPECT_EQ(cache->Size(), 1u);
+  EXPECT_GE(cache->GetStats().hits, 196u);
+}
+
+TEST_F(CryptoTest, SHA256_Hash_Batch) {
+  // Large enough in total to be spread over threads
+  std::vector<std::string> buffers;
+  for (int i = 0; i < 64; ++i) {
+    buffers.push_back(std::string(16384 + i, static_cast<char>('a' + i % 26)));
+  }
+  buffers.push_back("");
+  std::vector<std::string_view> inputs(buffers.begin(), buffers.end());
+
+  for (size_t threads : {1, 4, 0}) {
+    auto digests = crypto.SHA256_Hash_Batch(inputs, threads);
+    ASSERT_EQ(digests.size(), inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      ya::YaUtils::CryptoBuffer expected;
+      ASSERT_TRUE(crypto.SHA256_Hash(inputs[i], expected));
+      EXPECT_EQ(digests[i], expected);
+    }
+  }
+  EXPECT_TRUE(crypto.SHA256_Hash_Batch({}).empty());
+}
+
+TEST_F(CryptoTest, Verify_Batch) {
+  ya::YaUtils::CryptoBuffer public_pem, private_pem, other_pem, other_private;
+  ASSERT_TRUE(crypto.Generate_RSA_Key(public_pem, private_pem));
+  ASSERT_TRUE(crypto.Generate_RSA_Key(other_pem, other_private));
+  auto signer = ya::YaUtils::Key::LoadPrivate(private_pem);
+  auto key = ya::YaUtils::Key::LoadPublic(public_pem);
+  auto other = ya::YaUtils::Key::LoadPublic(other_pem);
+  ASSERT_TRUE(signer && key && other);
+
+  std::vector<std::string> messages;
+  std::vector<ya::YaUtils::CryptoBuffer> signatures;
+  for (int i = 0; i < 32; ++i) {
+    messages.push_back("message " + std::to_string(i));
+    signatures.push_back(crypto.Sign(*signer, messages.back()).value());
+  }
+  signatures[5][0] ^= 0xFF;
+  messages[9] += "!";
+  std::vector<std::string_view> data(messages.begin(), messages.end());
+
+  std::vector<ya::YaUtils::Key> one_key{*key};
+  auto valid = crypto.Verify_Batch(one_key, data, signatures, 4);
+  ASSERT_EQ(valid.size(), data.size());
+  for (size_t i = 0; i < valid.size(); ++i) {
+    EXPECT_EQ(valid[i], i != 5 && i != 9) << i;
+  }
+
+  // One key per message
+  std::vector<ya::YaUtils::Key> keys(data.size(), *key);
+  keys[0] = *other;
+  valid = crypto.Verify_Batch(keys, data, signatures);
+  EXPECT_FALSE(valid[0]);
+  EXPECT_TRUE(valid[1]);
+
+  // Mismatched lengths verify nothing
+  valid = crypto.Verify_Batch(
+      one_key, data, std::span(signatures).first(3));
+  EXPECT_EQ(std::count(valid.begin(), valid.end(), true), 0);
+}
+
+TEST_F(CryptoTest, SHA256_File) {
+  auto dir = std::filesystem::temp_directory_path();
+  std::vector<std::string> paths;
+  std::vector<std::string> contents = {std::string(3 << 20, 'z'), "", "abc"};
+  for (size_t i = 0; i < contents.size(); ++i) {
+    paths.push_back((dir / ("ya_utils_hash_" + std::to_string(i))).string());
+    std::ofstream(paths.back(), std::ios::binary) << contents[i];
+  }
+  paths.push_back((dir / "ya_utils_hash_missing").string());
+
+  auto digests = crypto.SHA256_File_Batch(paths, 2);
+  ASSERT_EQ(digests.size(), paths.size());
+  for (size_t i = 0; i < contents.size(); ++i) {
+    ya::YaUtils::CryptoBuffer expected;
+    ASSERT_TRUE(crypto.SHA256_Hash(contents[i], expected));
+    ASSERT_TRUE(digests[i].has_value());
+    EXPECT_EQ(*digests[i], expected);
+    EXPECT_EQ(crypto.SHA256_File(paths[i]), expected);
+    std::filesystem::remove(paths[i]);
+  }
+  EXPECT_FALSE(digests.back().has_value());
+  EXPECT_FALSE(crypto.SHA256_File(paths.back()).has_value());
+}
+
+TEST(DigestTest, Incremental) {
+  ya::YaUtils::Crypto crypto;
+  ya::YaUtils::Digest digest(ya::YaUtils::Digest::ALGO::SHA256);
+  EXPECT_EQ(digest.Size(), 32u);
+  std::string data = "The quick brown fox jumps over the lazy dog";
+  ya::YaUtils::CryptoBuffer expected;
+  ASSERT_TRUE(crypto.SHA256_Hash(data, expected));
+
+  // Final() starts the next message
+  for (int round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < data.size(); i += 7) {
+      EXPECT_TRUE(digest.Update(std::string_view(data).substr(i, 7)));
+    }
+    EXPECT_EQ(digest.Final(), expected);
+  }
+
+  ya::YaUtils::Digest md5(ya::YaUtils::Digest::ALGO::MD5);
+  EXPECT_TRUE(md5.Update("discarded"));
+  EXPECT_TRUE(md5.Reset());
+  EXPECT_TRUE(md5.Update(data));
+  ASSERT_TRUE(crypto.MD5_Hash(data, expected));
+  EXPECT_EQ(md5.Final(), expected);
+}
+
+TEST_F(CryptoTest, Ed25519_SignVerify) {
+  ya::YaUtils::CryptoBuffer public_key, private_key;
+  ASSERT_TRUE(crypto.Generate_Ed25519_Key(public_key, private_key));
+  EXPECT_EQ(ya::YaUtils::Key::LoadPublic(public_key)->GetType(),
+            ya::YaUtils::Key::TYPE::ED25519);
+
+  auto signature = crypto.Ed25519_Sign(private_key, plaintext);
+  ASSERT_TRUE(signature.has_value());
+  EXPECT_EQ(signature->size(), 64u);
+  EXPECT_TRUE(crypto.Ed25519_Verify(public_key, plaintext, *signature));
+  EXPECT_TRUE(crypto.DSA_Verify(public_key, plaintext, *signature));
+  EXPECT_FALSE(crypto.Ed25519_Verify(public_key, "other", *signature));
+  (*signature)[0] ^= 0xFF;
+  EXPECT_FALSE(crypto.Ed25519_Verify(public_key, plaintext, *signature));
+}
+
+TEST_F(CryptoTest, ECDSA_SignVerify) {
+  ya::YaUtils::CryptoBuffer public_key, private_key;
+  ASSERT_TRUE(crypto.Generate_ECDSA_Key(public_key, private_key));
+  EXPECT_EQ(ya::YaUtils::Key::LoadPublic(public_key)->GetType(),
+            ya::YaUtils::Key::TYPE::EC);
+
+  auto signature = crypto.ECDSA_Sign(private_key, plaintext);
+  ASSERT_TRUE(signature.has_value());
+  EXPECT_TRUE(crypto.ECDSA_Verify(public_key, plaintext, *signature));
+  EXPECT_FALSE(crypto.ECDSA_Verify(public_key, "other", *signature));
+
+  // Each call checks the key is of its own algorithm
+  EXPECT_FALSE(crypto.Ed25519_Sign(private_key, plaintext).has_value());
+  EXPECT_FALSE(crypto.Ed25519_Verify(public_key, plaintext, *signature));
+}
+
+TEST_F(CryptoTest, X25519_Derive) {
+  ya::YaUtils::CryptoBuffer a_public, a_private, b_public, b_private;
+  ASSERT_TRUE(crypto.Generate_X25519_Key(a_public, a_private));
+  ASSERT_TRUE(crypto.Generate_X25519_Key(b_public, b_private));
+
+  auto a_secret = crypto.X25519_Derive(a_private, b_public);
+  auto b_secret = crypto.X25519_Derive(b_private, a_public);
+  ASSERT_TRUE(a_secret && b_secret);
+  EXPECT_EQ(a_secret->size(), 32u);
+  EXPECT_EQ(*a_secret, *b_secret);
+  EXPECT_NE(crypto.X25519_Derive(a_private, a_public), a_secret);
+
+  ya::YaUtils::CryptoBuffer ed_public, ed_private;
+  ASSERT_TRUE(crypto.Generate_Ed25519_Key(ed_public, ed_private));
+  EXPECT_FALSE(crypto.X25519_Derive(a_private, ed_public).has_value());
+  EXPECT_FALSE(crypto.Ed25519_Sign(a_private, plaintext).has_value());
+}
+
+TEST_F(CryptoTest, HKDF_SHA256) {
+  // RFC 5869, test case 1
+  ya::YaUtils::CryptoBuffer ikm(22, 0x0b);
+  std::string salt, info;
+  for (char c = 0x00; c <= 0x0c; ++c) salt += c;
+  for (char c = static_cast<char>(0xf0); c != static_cast<char>(0xfa); ++c) {
+    info += c;
+  }
+  auto okm = crypto.HKDF_SHA256(ikm, salt, info, 42);
+  ASSERT_TRUE(okm.has_value());
+  const unsigned char expected[] = {
+      0x3c, 0xb2, 0x5f, 0x25, 0xfa, 0xac, 0xd5, 0x7a, 0x90, 0x43, 0x4f,
+      0x64, 0xd0, 0x36, 0x2f, 0x2a, 0x2d, 0x2d, 0x0a, 0x90, 0xcf, 0x1a,
+      0x5a, 0x4c, 0x5d, 0xb0, 0x2d, 0x56, 0xec, 0xc4, 0xc5, 0xbf, 0x34,
+      0x00, 0x72, 0x08, 0xd5, 0xb8, 0x87, 0x18, 0x58, 0x65};
+  EXPECT_EQ(*okm, ya::YaUtils::CryptoBuffer(std::begin(expected),
+                                            std::end(expected)));
+
+  EXPECT_EQ(crypto.HKDF_SHA256(ikm, "", "", 32)->size(), 32u);
+  EXPECT_FALSE(crypto.HKDF_SHA256(ikm, salt, info, 255 * 32 + 1));
+  EXPECT_FALSE(crypto.HKDF_SHA256({}, salt, info, 32));
+}
+
+namespace {
+
+uint32_t crc32c_bitwise(std::string_view data) {
+  uint32_t crc = ~0u;
+  for (unsigned char c : data) {
+    crc ^= c;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+std::string pseudo_random(size_t size) {
+  std::string data(size, '\0');
+  uint64_t x = 0x9e3779b97f4a7c15ULL;
+  for (auto& c : data) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    c = static_cast<char>(x);
+  }
+  return data;
+}
+
+}  // namespace
+
+TEST(HashTest, Crc32cKnownValues) {
+  using Hash = ya::YaUtils::Hash;
+  EXPECT_EQ(Hash::Crc32c(""), 0u);
+  EXPECT_EQ(Hash::Crc32c("123456789"), 0xe3069283u);
+  EXPECT_EQ(Hash::Crc32c(std::string(32, '\0')), 0x8a9136aau);  // RFC 3720
+
+  // Every length and alignment against the bit-at-a-time definition
+  std::string data = pseudo_random(300);
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t size = 0; size + offset <= data.size(); size += 13) {
+      auto part = std::string_view(data).substr(offset, size);
+      ASSERT_EQ(Hash::Crc32c(part), crc32c_bitwise(part)) << offset << size;
+    }
+  }
+  std::cout << "CRC32C instructions: " << Hash::HasCrc32cInstructions()
+            << std::endl;
+}
+
+TEST(HashTest, Crc32cContinues) {
+  using Hash = ya::YaUtils::Hash;
+  std::string data = pseudo_random(1000);
+  uint32_t whole = Hash::Crc32c(data);
+  for (size_t split : {0, 1, 7, 64, 999, 1000}) {
+    auto view = std::string_view(data);
+    uint32_t head = Hash::Crc32c(view.substr(0, split));
+    EXPECT_EQ(Hash::Crc32c(view.substr(split), head), whole);
+  }
+}
+
+TEST(HashTest, StreamingMatchesOneShot) {
+  using Hash = ya::YaUtils::Hash;
+  std::string data = pseudo_random(700);
+  for (size_t size : {0, 1, 15, 16, 17, 63, 64, 65, 128, 200, 700}) {
+    auto whole = std::string_view(data).substr(0, size);
+    for (size_t chunk : {1, 7, 64, 100}) {
+      Hash hash(42);
+      for (size_t i = 0; i < size; i += chunk) {
+        hash.Update(whole.substr(i, chunk));
+      }
+      EXPECT_EQ(hash.Digest64(), Hash::Hash64(whole, 42)) << size << chunk;
+      EXPECT_EQ(hash.Digest128(), Hash::Hash128(whole, 42));
+    }
+  }
+
+  Hash hash;
+  hash.Update("discarded");
+  hash.Reset();
+  hash.Update("abc");
+  EXPECT_EQ(hash.Digest64(), Hash::Hash64("abc"));
+}
+
+TEST(HashTest, Distribution) {
+  using Hash = ya::YaUtils::Hash;
+  // Pinned: the values may be stored or sent, so they must never change
+  EXPECT_EQ(Hash::Hash64("abc"), 0xa5bb9eea704a133dULL);
+  EXPECT_EQ(Hash::Hash64(std::string(100, 'x'), 7), 0x68a2d09bb7cb0fd9ULL);
+  EXPECT_EQ(Hash::Hash128("abc"),
+            (Hash::Value128{0x4fbd9fca4d6a2705ULL, 0x86a3ef2aa472c912ULL}));
+  EXPECT_EQ(Hash::Hash64(""), Hash::Hash64("", 0));
+  EXPECT_NE(Hash::Hash64(""), Hash::Hash64("", 1));
+  EXPECT_NE(Hash::Hash64("a"), Hash::Hash64(std::string_view("a\0", 2)));
+
+  std::set<uint64_t> seen;
+  std::set<uint64_t> seen_high;
+  for (int i = 0; i < 100000; ++i) {
+    std::string key = "key-" + std::to_string(i);
+    seen.insert(Hash::Hash64(key));
+    seen_high.insert(Hash::Hash128(key).high);
+  }
+  EXPECT_EQ(seen.size(), 100000u);
+  EXPECT_EQ(seen_high.size(), 100000u);
+
+  // Flipping any input bit flips about half the output bits
+  std::string data = pseudo_random(100);
+  uint64_t base = Hash::Hash64(data);
+  int total = 0;
+  for (size_t bit = 0; bit < data.size() * 8; ++bit) {
+    std::string flipped = data;
+    flipped[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+    total += std::popcount(base ^ Hash::Hash64(flipped));
+  }
+  double average = static_cast<double>(total) / (data.size() * 8);
+  EXPECT_NEAR(average, 32.0, 2.0);
+}
+
+namespace {
+
+using ThreadPool = ya::YaUtils::ThreadPool;
+
+// Sums [begin, end) by splitting in halves as tasks, from inside workers
+ThreadPool::Future<uint64_t> tree_sum(ThreadPool& pool, uint64_t begin,
+                                      uint64_t end) {
+  co_await pool.Schedule();
+  if (end - begin <= 1000) {
+    uint64_t sum = 0;
+    for (uint64_t i = begin; i < end; ++i) {
+      sum += i;
+    }
+    co_return sum;
+  }
+  uint64_t middle = begin + (end - begin) / 2;
+  auto left = tree_sum(pool, begin, middle);
+  auto right = tree_sum(pool, middle, end);
+  co_return co_await left + co_await right;
+}
+
+}  // namespace
+
+TEST(ThreadPoolTest, SubmitAndGet) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.Size(), 4u);
+  std::vector<ThreadPool::Future<int>> results;
+  for (int i = 0; i < 1000; ++i) {
+    results.push_back(pool.Submit([i] { return i * 2; }));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(results[i].Get(), i * 2);
+  }
+
+  auto failing = pool.Submit([]() -> int { throw std::logic_error("bad"); });
+  EXPECT_THROW(failing.Get(), std::logic_error);
+
+  std::atomic<int> posted{0};
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(pool.Post([&] { ++posted; }));
+  }
+  EXPECT_TRUE(pool.Post([] { throw std::runtime_error("dropped"); }));
+  pool.WaitIdle();
+  EXPECT_EQ(posted, 100);
+}
+
+TEST(ThreadPoolTest, Then) {
+  ThreadPool pool(2);
+  auto chained = pool.Submit([] { return 20; })
+                     .Then([](int x) { return x + 1; })
+                     .Then([](int x) { return std::to_string(x * 2); });
+  EXPECT_EQ(chained.Get(), "42");
+
+  std::atomic<bool> ran{false};
+  auto skipped = pool.Submit([]() -> int { throw std::logic_error("bad"); })
+                     .Then([&](int) { ran = true; });
+  EXPECT_THROW(skipped.Get(), std::logic_error);
+  EXPECT_FALSE(ran);
+}
+
+TEST(ThreadPoolTest, WorkStealingFromInsideTasks) {
+  ThreadPool pool(4);
+  // Every task spawns more from its worker, which others must steal
+  std::atomic<int> leaves{0};
+  std::function<void(int)> spawn = [&](int depth) {
+    if (depth == 0) {
+      ++leaves;
+      return;
+    }
+    for (int i = 0; i < 4; ++i) {
+      pool.Post([&spawn, depth] { spawn(depth - 1); });
+    }
+  };
+  pool.Post([&] { spawn(6); });
+  pool.WaitIdle();
+  EXPECT_EQ(leaves, 4096);
+}
+
+TEST(ThreadPoolTest, Priorities) {
+  ThreadPool pool(1);
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool release = false;
+  pool.Post([&] {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return release; });
+  });
+
+  std::vector<std::string> order;
+  auto record = [&](std::string name) {
+    return [&order, name] { order.push_back(name); };
+  };
+  pool.Post(record("low"), ThreadPool::PRIORITY::LOW);
+  pool.Post(record("normal"), ThreadPool::PRIORITY::NORMAL);
+  pool.Post(record("high"), ThreadPool::PRIORITY::HIGH);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  cv.notify_one();
+  pool.WaitIdle();
+  EXPECT_EQ(order, (std::vector<std::string>{"high", "normal", "low"}));
+}
+
+TEST(ThreadPoolTest, ParallelFor) {
+  ThreadPool pool(4);
+  std::vector<int> hits(10000, 0);
+  pool.ParallelFor(hits.size(), [&](size_t i) { ++hits[i]; });
+  EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 10000);
+
+  // Nested inside tasks without deadlock, even when every worker nests
+  std::atomic<int> total{0};
+  pool.ParallelFor(8, [&](size_t) {
+    pool.ParallelFor(100, [&](size_t) { ++total; });
+  });
+  EXPECT_EQ(total, 800);
+
+  EXPECT_THROW(pool.ParallelFor(10,
+                                [](size_t i) {
+                                  if (i == 3) throw std::logic_error("bad");
+                                }),
+               std::logic_error);
+}
+
+TEST(ThreadPoolTest, Coroutines) {
+  ThreadPool pool(4);
+  EXPECT_EQ(tree_sum(pool, 0, 1000000).Get(), 499999500000ULL);
+
+  auto awaiting = [](ThreadPool& pool) -> ThreadPool::Future<void> {
+    int value = co_await pool.Submit([] { return 7; });
+    if (value != 7) {
+      throw std::logic_error("wrong value");
+    }
+  };
+  EXPECT_NO_THROW(awaiting(pool).Get());
+}
+
+TEST(ThreadPoolTest, Shutdown) {
+  {
+    ThreadPool pool(2);
+    std::atomic<int> ran{0};
+    for (int i = 0; i < 100; ++i) {
+      pool.Post([&] {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        ++ran;
+      });
+    }
+    pool.Shutdown(true);
+    EXPECT_EQ(ran, 100);
+    EXPECT_FALSE(pool.Post([] {}));
+    EXPECT_THROW(pool.Submit([] { return 1; }).Get(), std::runtime_error);
+  }
+
+  ThreadPool pool(1);
+  std::atomic<bool> release{false};
+  pool.Post([&] {
+    while (!release) {
+      std::this_thread::yield();
+    }
+  });
+  auto dropped = pool.Submit([] { return 1; });
+  std::thread stopper([&] { pool.Shutdown(false); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  release = true;
+  stopper.join();
+  EXPECT_THROW(dropped.Get(), std::runtime_error);
+}
+
+namespace {
+
+using ya::YaUtils;
+
+struct QueueItem : YaUtils::MpscNode {
+  uint64_t value = 0;
+};
+
+// Producer p pushes p << 32 | i for i < per_producer, batch values at a
+// time, while consumers pop up to batch at a time until all have arrived.
+// push(values) and pop(out) return how many they moved. Checks that each
+// value arrives once and each consumer sees each producer's values in
+// order.
+template <typename Push, typename Pop>
+void stress_queue(size_t producers, size_t consumers, uint64_t per_producer,
+                  size_t batch, Push push, Pop pop) {
+  uint64_t total = producers * per_producer;
+  std::atomic<uint64_t> received{0};
+  std::vector<std::vector<uint64_t>> seen(consumers);
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      std::vector<uint64_t> values;
+      for (uint64_t i = 0; i < per_producer;) {
+        values.clear();
+        for (; i < per_producer && values.size() < batch; ++i) {
+          values.push_back(uint64_t{p} << 32 | i);
+        }
+        std::span<uint64_t> rest(values);
+        while (!rest.empty()) {
+          size_t pushed = push(rest);
+          if (pushed == 0) {
+            std::this_thread::yield();
+          }
+          rest = rest.subspan(pushed);
+        }
+      }
+    });
+  }
+  for (size_t c = 0; c < consumers; ++c) {
+    threads.emplace_back([&, c] {
+      std::vector<uint64_t> out(batch);
+      while (received < total) {
+        size_t popped = pop(std::span<uint64_t>(out));
+        if (popped == 0) {
+          std::this_thread::yield();
+        }
+        seen[c].insert(seen[c].end(), out.begin(), out.begin() + popped);
+        received += popped;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<uint8_t> counts(total);
+  size_t out_of_order = 0;
+  for (const auto& values : seen) {
+    std::vector<int64_t> last(producers, -1);
+    for (uint64_t value : values) {
+      uint64_t p = value >> 32;
+      auto i = static_cast<int64_t>(value & 0xffffffff);
+      ASSERT_LT(p, producers);
+      ASSERT_LT(i, static_cast<int64_t>(per_producer));
+      out_of_order += i <= last[p];
+      last[p] = i;
+      ++counts[p * per_producer + i];
+    }
+  }
+  EXPECT_EQ(out_of_order, 0u);
+  EXPECT_EQ(std::count(counts.begin(), counts.end(), 1),
+            static_cast<std::ptrdiff_t>(total));
+}
+
+}  // namespace
+
+TEST(LockFreeQueueTest, SpscRing) {
+  YaUtils::SpscRing<std::string> ring(3);
+  ASSERT_EQ(ring.Capacity(), 4u);
+  EXPECT_FALSE(ring.TryPop());
+  for (int lap = 0; lap < 10; ++lap) {
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_TRUE(ring.TryPush(std::to_string(lap + i)));
+    }
+    std::string kept = "kept";
+    EXPECT_FALSE(ring.TryPush(std::move(kept)));
+    EXPECT_EQ(kept, "kept");
+    EXPECT_EQ(ring.SizeApprox(), 4u);
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(ring.TryPop(), std::to_string(lap + i));
+    }
+    EXPECT_FALSE(ring.TryPop());
+  }
+
+  std::vector<std::string> in{"a", "b", "c", "d", "e"};
+  EXPECT_EQ(ring.TryPushBatch(std::span(in).first(1)), 1u);
+  EXPECT_EQ(ring.TryPushBatch(std::span(in).subspan(1)), 3u);
+  std::vector<std::string> out(8);
+  EXPECT_EQ(ring.TryPopBatch(out), 4u);
+  EXPECT_EQ(std::vector(out.begin(), out.begin() + 4),
+            (std::vector<std::string>{"a", "b", "c", "d"}));
+  EXPECT_EQ(in[4], "e");
+  EXPECT_EQ(ring.TryPopBatch(out), 0u);
+}
+
+TEST(LockFreeQueueTest, MpmcQueue) {
+  YaUtils::MpmcQueue<std::unique_ptr<int>> queue(1);
+  ASSERT_EQ(queue.Capacity(), 2u);
+  for (int lap = 0; lap < 10; ++lap) {
+    EXPECT_TRUE(queue.TryPush(std::make_unique<int>(lap)));
+    EXPECT_TRUE(queue.TryEmplace(new int(lap + 1)));
+    auto kept = std::make_unique<int>(-1);
+    EXPECT_FALSE(queue.TryPush(std::move(kept)));
+    EXPECT_NE(kept, nullptr);
+    EXPECT_EQ(**queue.TryPop(), lap);
+    EXPECT_EQ(**queue.TryPop(), lap + 1);
+    EXPECT_FALSE(queue.TryPop());
+  }
+
+  std::vector<std::unique_ptr<int>> in;
+  for (int i = 0; i < 3; ++i) {
+    in.push_back(std::make_unique<int>(i));
+  }
+  EXPECT_EQ(queue.TryPushBatch(in), 2u);
+  EXPECT_NE(in[2], nullptr);
+  std::vector<std::unique_ptr<int>> out(3);
+  EXPECT_EQ(queue.TryPopBatch(out), 2u);
+  EXPECT_EQ(*out[0], 0);
+  EXPECT_EQ(*out[1], 1);
+}
+
+TEST(LockFreeQueueTest, DestroysLeftovers) {
+  auto token = std::make_shared<int>(0);
+  {
+    YaUtils::SpscRing<std::shared_ptr<int>> ring(8);
+    YaUtils::MpmcQueue<std::shared_ptr<int>> queue(8);
+    for (int i = 0; i < 3; ++i) {
+      ring.TryPush(token);
+      queue.TryPush(token);
+    }
+    ring.TryPop();
+    queue.TryPop();
+    EXPECT_EQ(token.use_count(), 5);
+  }
+  EXPECT_EQ(token.use_count(), 1);
+}
+
+TEST(LockFreeQueueTest, MpscQueue) {
+  YaUtils::MpscQueue<QueueItem> queue;
+  EXPECT_EQ(queue.Pop(), nullptr);
+  EXPECT_TRUE(queue.EmptyApprox());
+
+  std::vector<QueueItem> items(5);
+  for (size_t i = 0; i < items.size(); ++i) {
+    items[i].value = i;
+  }
+  queue.Push(&items[0]);
+  std::vector<QueueItem*> batch{&items[1], &items[2], &items[3]};
+  queue.PushBatch(batch);
+  EXPECT_FALSE(queue.EmptyApprox());
+  std::vector<QueueItem*> out(8);
+  ASSERT_EQ(queue.PopBatch(out), 4u);
+  for (uint64_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(out[i]->value, i);
+  }
+  EXPECT_EQ(queue.Pop(), nullptr);
+  EXPECT_TRUE(queue.EmptyApprox());
+
+  // Popped items may be pushed again
+  queue.Push(&items[0]);
+  queue.Push(&items[4]);
+  EXPECT_EQ(queue.Pop(), &items[0]);
+  EXPECT_EQ(queue.Pop(), &items[4]);
+  EXPECT_EQ(queue.Pop(), nullptr);
+}
+
+TEST(LockFreeQueueTest, SpscRingStress) {
+  for (size_t batch : {1, 16}) {
+    YaUtils::SpscRing<uint64_t> ring(64);
+    stress_queue(
+        1, 1, 200000, batch,
+        [&](std::span<uint64_t> values) { return ring.TryPushBatch(values); },
+        [&](std::span<uint64_t> out) { return ring.TryPopBatch(out); });
+  }
+}
+
+TEST(LockFreeQueueTest, MpscQueueStress) {
+  constexpr size_t PRODUCERS = 4;
+  constexpr uint64_t PER_PRODUCER = 50000;
+  for (size_t batch : {1, 8}) {
+    YaUtils::MpscQueue<QueueItem> queue;
+    std::vector<QueueItem> items(PRODUCERS * PER_PRODUCER);
+    stress_queue(
+        PRODUCERS, 1, PER_PRODUCER, batch,
+        [&](std::span<uint64_t> values) {
+          std::vector<QueueItem*> nodes;
+          for (uint64_t value : values) {
+            auto* item = &items[(value >> 32) * PER_PRODUCER +
+                                (value & 0xffffffff)];
+            item->value = value;
+            nodes.push_back(item);
+          }
+          queue.PushBatch(nodes);
+          return values.size();
+        },
+        [&](std::span<uint64_t> out) {
+          size_t count = 0;
+          for (; count < out.size(); ++count) {
+            QueueItem* item = queue.Pop();
+            if (item == nullptr) {
+              break;
+            }
+            out[count] = item->value;
+          }
+          return count;
+        });
+  }
+}
+
+TEST(LockFreeQueueTest, MpmcQueueStress) {
+  for (size_t batch : {1, 8}) {
+    YaUtils::MpmcQueue<uint64_t> queue(64);
+    stress_queue(
+        4, 4, 50000, batch,
+        [&](std::span<uint64_t> values) {
+          return queue.TryPushBatch(values);
+        },
+        [&](std::span<uint64_t> out) { return queue.TryPopBatch(out); });
+  }
+}
+
+namespace {
+
+// Upstream that counts what the arena takes from it
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocations = 0;
+  size_t live_bytes = 0;
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    ++allocations;
+    live_bytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    live_bytes -= bytes;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+// What one request might build: a few hundred small strings
+void fill_request(std::pmr::memory_resource* resource) {
+  std::pmr::vector<std::pmr::string> names(resource);
+  for (int i = 0; i < 300; ++i) {
+    names.emplace_back("request value number " + std::to_string(i));
+  }
+  EXPECT_EQ(names[299], "request value number 299");
+}
+
+}  // namespace
+
+TEST(ArenaTest, AllocatesAligned) {
+  YaUtils::Arena arena(256);
+  std::set<void*> seen;
+  for (size_t alignment : {1, 8, 16, 64, 256}) {
+    void* p = arena.allocate(24, alignment);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % alignment, 0u);
+    EXPECT_TRUE(seen.insert(p).second);
+    std::memset(p, 0xab, 24);
+  }
+  // Bigger than a chunk gets a chunk of its own
+  void* big = arena.allocate(10000, 16);
+  std::memset(big, 0xcd, 10000);
+
+  const auto& stats = arena.GetStats();
+  EXPECT_EQ(stats.allocations, 6u);
+  EXPECT_EQ(stats.bytes_allocated, 5 * 24u + 10000);
+  EXPECT_GE(stats.bytes_reserved, 10000u);
+  EXPECT_GE(stats.chunks, 2u);
+}
+
+TEST(ArenaTest, ResetKeepsLargestChunk) {
+  CountingResource upstream;
+  {
+    YaUtils::Arena arena(1024, &upstream);
+    fill_request(&arena);
+    size_t warm_up = upstream.allocations;
+    EXPECT_GT(warm_up, 1u);
+    uint64_t peak = arena.GetStats().bytes_allocated;
+
+    arena.Reset();
+    EXPECT_EQ(arena.GetStats().bytes_allocated, 0u);
+    EXPECT_EQ(arena.GetStats().peak_allocated, peak);
+    EXPECT_EQ(arena.GetStats().bytes_reserved, upstream.live_bytes);
+
+    // Once the kept chunk fits a whole request, requests stop reaching
+    // upstream
+    for (int i = 0; i < 10; ++i) {
+      fill_request(&arena);
+      arena.Reset();
+    }
+    size_t steady = upstream.allocations;
+    for (int i = 0; i < 10; ++i) {
+      fill_request(&arena);
+      arena.Reset();
+    }
+    EXPECT_EQ(upstream.allocations, steady);
+    EXPECT_EQ(arena.GetStats().resets, 21u);
+
+    arena.Release();
+    EXPECT_EQ(upstream.live_bytes, 0u);
+    EXPECT_EQ(arena.GetStats().bytes_reserved, 0u);
+    fill_request(&arena);
+  }
+  EXPECT_EQ(upstream.live_bytes, 0u);
+}
+
+TEST(ArenaTest, BufferFirst) {
+  CountingResource upstream;
+  alignas(std::max_align_t) std::byte buffer[512];
+  YaUtils::Arena arena(buffer, &upstream);
+  void* p = arena.allocate(100, 8);
+  EXPECT_GE(static_cast<std::byte*>(p), buffer);
+  EXPECT_LT(static_cast<std::byte*>(p), buffer + sizeof(buffer));
+  EXPECT_EQ(upstream.allocations, 0u);
+
+  fill_request(&arena);
+  EXPECT_GT(upstream.allocations, 0u);
+  arena.Reset();
+  EXPECT_EQ(arena.allocate(100, 8), p);
+}
+
+TEST(ObjectPoolTest, ReusesBlocks) {
+  struct Node {
+    explicit Node(int v) : value(v) {}
+    int value;
+    char payload[100];
+  };
+  using ObjectPool = YaUtils::ObjectPool;
+
+  ObjectPool::Make<Node>(0);  // Warm the cache
+  ObjectPool::ResetStats();
+  void* first = nullptr;
+  for (int i = 0; i < 100; ++i) {
+    auto node = ObjectPool::Make<Node>(i);
+    EXPECT_EQ(node->value, i);
+    if (!first) {
+      first = node.get();
+    }
+    EXPECT_EQ(node.get(), first);
+  }
+  auto stats = ObjectPool::GetStats();
+  EXPECT_EQ(stats.hits, 100u);
+  EXPECT_EQ(stats.misses, 0u);
+  EXPECT_EQ(stats.recycled, 100u);
+  EXPECT_DOUBLE_EQ(stats.HitRate(), 1.0);
+
+  // Same class, different type
+  struct Other {
+    char bytes[sizeof(Node) - 1];
+  };
+  EXPECT_EQ(ObjectPool::Make<Other>().get(), first);
+
+  // Oversized blocks bypass the pool
+  ObjectPool::ResetStats();
+  void* large = ObjectPool::Allocate(ObjectPool::MAX_POOLED_SIZE + 1);
+  ObjectPool::Deallocate(large, ObjectPool::MAX_POOLED_SIZE + 1);
+  EXPECT_EQ(ObjectPool::GetStats().hits + ObjectPool::GetStats().misses, 0u);
+}
+
+TEST(ObjectPoolTest, ThreadLocalCaches) {
+  using ObjectPool = YaUtils::ObjectPool;
+  ObjectPool::ResetStats();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([] {
+      std::vector<ObjectPool::Ptr<std::array<uint64_t, 8>>> live;
+      for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 10; ++i) {
+          live.push_back(ObjectPool::Make<std::array<uint64_t, 8>>());
+          live.back()->fill(round);
+        }
+        live.clear();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Exited threads fold their counts in; only the first round misses
+  auto stats = ObjectPool::GetStats();
+  EXPECT_EQ(stats.hits + stats.misses, 4000u);
+  EXPECT_EQ(stats.misses, 40u);
+  EXPECT_EQ(stats.recycled, 4000u);
+}